@@ -17,10 +17,19 @@
  *
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
+#include <map>
+#include <set>
+
 #include "custom-app-helper.h"
 #include "ns3/custom-app.h"
+#include "ns3/wasmfaas-latency-histogram.h"
+#include "ns3/wasmfaas-spatial-index.h"
 #include "ns3/uinteger.h"
 #include "ns3/names.h"
+#include "ns3/ipv4.h"
+#include "ns3/channel.h"
+#include "ns3/mobility-model.h"
+#include "ns3/abort.h"
 #include "ns3/libwasmfaas.h"
 
 namespace ns3 {
@@ -62,6 +71,343 @@ CustomAppHelper::Install (NodeContainer c) const
   return apps;
 }
 
+int64_t
+CustomAppHelper::AssignStreams (NodeContainer c, int64_t stream)
+{
+  int64_t currentStream = stream;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      for (uint32_t j = 0; j < node->GetNApplications (); j++)
+        {
+          Ptr<CustomApp> app = DynamicCast<CustomApp> (node->GetApplication (j));
+          if (app)
+            {
+              currentStream += app->AssignStreams (currentStream);
+            }
+        }
+    }
+  return (currentStream - stream);
+}
+
+void
+CustomAppHelper::PrintLatencyReport (ApplicationContainer apps, std::ostream &os)
+{
+  WasmFaasLatencyHistogram total;
+  WasmFaasLatencyHistogram cold;
+  WasmFaasLatencyHistogram warm;
+  std::map<std::string, WasmFaasLatencyHistogram> modules;
+  for (ApplicationContainer::Iterator i = apps.Begin (); i != apps.End (); ++i)
+    {
+      Ptr<CustomApp> app = DynamicCast<CustomApp> (*i);
+      if (!app)
+        {
+          continue;
+        }
+      app->PrintLatencyReport (os);
+      total.Merge (app->GetLatencyHistogram ());
+      cold.Merge (app->GetColdLatencyHistogram ());
+      warm.Merge (app->GetWarmLatencyHistogram ());
+      for (auto &entry : app->GetModuleLatencyHistograms ())
+        {
+          modules[entry.first].Merge (entry.second);
+        }
+    }
+
+  os << "all " << total << std::endl;
+  os << "all cold " << cold << std::endl;
+  os << "all warm " << warm << std::endl;
+  for (auto &entry : modules)
+    {
+      os << "all module " << entry.first << " " << entry.second << std::endl;
+    }
+}
+
+void
+CustomAppHelper::RegisterFullMesh (NodeContainer c)
+{
+  std::vector<Ptr<CustomApp>> apps;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<CustomApp> app = GetCustomApp (*i);
+      if (app)
+        {
+          apps.push_back (app);
+        }
+    }
+
+  for (auto &app : apps)
+    {
+      for (auto &peer : apps)
+        {
+          if (peer != app)
+            {
+              RegisterPeer (app, peer);
+            }
+        }
+    }
+}
+
+void
+CustomAppHelper::RegisterOneHopPeers (NodeContainer c)
+{
+  std::map<uint32_t, Ptr<CustomApp>> apps;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<CustomApp> app = GetCustomApp (*i);
+      if (app)
+        {
+          apps[(*i)->GetId ()] = app;
+        }
+    }
+
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      auto app = apps.find (node->GetId ());
+      if (app == apps.end ())
+        {
+          continue;
+        }
+
+      // A node reached through several channels is registered once, at the first of them
+      std::set<uint32_t> registered;
+      for (uint32_t d = 0; d < node->GetNDevices (); d++)
+        {
+          Ptr<Channel> channel = node->GetDevice (d)->GetChannel ();
+          if (!channel)
+            {
+              continue;
+            }
+          for (std::size_t j = 0; j < channel->GetNDevices (); j++)
+            {
+              Ptr<NetDevice> device = channel->GetDevice (j);
+              Ptr<Node> neighbor = device->GetNode ();
+              auto peer = apps.find (neighbor->GetId ());
+              if (neighbor == node || peer == apps.end () ||
+                  registered.count (neighbor->GetId ()))
+                {
+                  continue;
+                }
+
+              Ptr<Ipv4> ipv4 = neighbor->GetObject<Ipv4> ();
+              int32_t interface = ipv4 ? ipv4->GetInterfaceForDevice (device) : -1;
+              if (interface < 0 || ipv4->GetNAddresses (interface) == 0)
+                {
+                  continue;
+                }
+              UintegerValue port;
+              peer->second->GetAttribute ("Port", port);
+              app->second->RegisterNode (ipv4->GetAddress (interface, 0).GetLocal (),
+                                         port.Get ());
+              registered.insert (neighbor->GetId ());
+            }
+        }
+    }
+}
+
+void
+CustomAppHelper::RegisterNearestPeers (NodeContainer c, uint32_t k, double maxDistance)
+{
+  WasmFaasSpatialIndex index;
+  index.Build (GetPositions (c));
+
+  for (uint32_t i = 0; i < c.GetN (); i++)
+    {
+      Ptr<CustomApp> app = GetCustomApp (c.Get (i));
+      if (!app)
+        {
+          continue;
+        }
+
+      Vector position = c.Get (i)->GetObject<MobilityModel> ()->GetPosition ();
+      for (auto j : index.FindNearest (position, k, maxDistance, i))
+        {
+          Ptr<CustomApp> peer = GetCustomApp (c.Get (j));
+          if (peer)
+            {
+              RegisterPeer (app, peer);
+            }
+        }
+    }
+}
+
+void
+CustomAppHelper::RegisterHierarchy (NodeContainer edges, NodeContainer accessPoints,
+                                    NodeContainer cloud)
+{
+  if (accessPoints.GetN () == 0)
+    {
+      return;
+    }
+
+  bool hasPositions = true;
+  NodeContainer positioned (edges, accessPoints);
+  for (NodeContainer::Iterator i = positioned.Begin (); i != positioned.End (); ++i)
+    {
+      if (!(*i)->GetObject<MobilityModel> ())
+        {
+          hasPositions = false;
+        }
+    }
+
+  WasmFaasSpatialIndex index;
+  if (hasPositions)
+    {
+      index.Build (GetPositions (accessPoints));
+    }
+
+  // Edge nodes of each access point, in container order
+  std::vector<std::vector<Ptr<CustomApp>>> attached (accessPoints.GetN ());
+  for (uint32_t i = 0; i < edges.GetN (); i++)
+    {
+      Ptr<CustomApp> app = GetCustomApp (edges.Get (i));
+      if (!app)
+        {
+          continue;
+        }
+
+      uint32_t ap = i % accessPoints.GetN ();
+      if (hasPositions)
+        {
+          ap = index.FindNearest (edges.Get (i)->GetObject<MobilityModel> ()->GetPosition (), 1)
+                   .front ();
+        }
+      Ptr<CustomApp> apApp = GetCustomApp (accessPoints.Get (ap));
+      if (apApp)
+        {
+          RegisterPeer (app, apApp);
+          attached[ap].push_back (app);
+        }
+    }
+
+  std::vector<Ptr<CustomApp>> cloudApps;
+  for (NodeContainer::Iterator i = cloud.Begin (); i != cloud.End (); ++i)
+    {
+      Ptr<CustomApp> app = GetCustomApp (*i);
+      if (app)
+        {
+          cloudApps.push_back (app);
+        }
+    }
+
+  for (uint32_t i = 0; i < accessPoints.GetN (); i++)
+    {
+      Ptr<CustomApp> app = GetCustomApp (accessPoints.Get (i));
+      if (!app)
+        {
+          continue;
+        }
+      for (auto &edge : attached[i])
+        {
+          RegisterPeer (app, edge);
+        }
+      for (auto &cloudApp : cloudApps)
+        {
+          RegisterPeer (app, cloudApp);
+          RegisterPeer (cloudApp, app);
+        }
+    }
+}
+
+Ptr<CustomApp>
+CustomAppHelper::GetCustomApp (Ptr<Node> node)
+{
+  for (uint32_t j = 0; j < node->GetNApplications (); j++)
+    {
+      Ptr<CustomApp> app = DynamicCast<CustomApp> (node->GetApplication (j));
+      if (app)
+        {
+          return app;
+        }
+    }
+  return 0;
+}
+
+void
+CustomAppHelper::RegisterPeer (Ptr<CustomApp> app, Ptr<CustomApp> peer)
+{
+  Ptr<Node> node = app->GetNode ();
+  Ptr<Ipv4> ipv4 = peer->GetNode ()->GetObject<Ipv4> ();
+  NS_ABORT_MSG_UNLESS (ipv4, "Peer node " << peer->GetNode ()->GetId () << " has no IPv4 stack");
+
+  std::set<Ptr<Channel>> channels;
+  for (uint32_t d = 0; d < node->GetNDevices (); d++)
+    {
+      Ptr<Channel> channel = node->GetDevice (d)->GetChannel ();
+      if (channel)
+        {
+          channels.insert (channel);
+        }
+    }
+  Ptr<Ipv4> localIpv4 = node->GetObject<Ipv4> ();
+
+  // Best address: on a channel of the node, then in one of its subnets, then any other
+  Ipv4Address best;
+  uint32_t bestRank = 3;
+  for (uint32_t i = 0; i < ipv4->GetNInterfaces (); i++)
+    {
+      Ptr<Channel> channel = ipv4->GetNetDevice (i)->GetChannel ();
+      for (uint32_t j = 0; j < ipv4->GetNAddresses (i); j++)
+        {
+          Ipv4InterfaceAddress address = ipv4->GetAddress (i, j);
+          if (address.GetLocal ().IsLocalhost ())
+            {
+              continue;
+            }
+
+          uint32_t rank = 2;
+          if (channel && channels.count (channel))
+            {
+              rank = 0;
+            }
+          else if (localIpv4)
+            {
+              for (uint32_t k = 0; k < localIpv4->GetNInterfaces () && rank > 1; k++)
+                {
+                  for (uint32_t l = 0; l < localIpv4->GetNAddresses (k); l++)
+                    {
+                      Ipv4InterfaceAddress local = localIpv4->GetAddress (k, l);
+                      if (!local.GetLocal ().IsLocalhost () &&
+                          local.GetMask () == address.GetMask () &&
+                          local.GetLocal ().CombineMask (local.GetMask ()) ==
+                              address.GetLocal ().CombineMask (address.GetMask ()))
+                        {
+                          rank = 1;
+                          break;
+                        }
+                    }
+                }
+            }
+          if (rank < bestRank)
+            {
+              best = address.GetLocal ();
+              bestRank = rank;
+            }
+        }
+    }
+  NS_ABORT_MSG_IF (bestRank == 3,
+                   "Peer node " << peer->GetNode ()->GetId () << " has no IPv4 address");
+
+  UintegerValue port;
+  peer->GetAttribute ("Port", port);
+  app->RegisterNode (best, port.Get ());
+}
+
+std::vector<Vector>
+CustomAppHelper::GetPositions (NodeContainer c)
+{
+  std::vector<Vector> positions;
+  positions.reserve (c.GetN ());
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<MobilityModel> mobility = (*i)->GetObject<MobilityModel> ();
+      NS_ABORT_MSG_UNLESS (mobility, "Node " << (*i)->GetId () << " has no MobilityModel");
+      positions.push_back (mobility->GetPosition ());
+    }
+  return positions;
+}
+
 Ptr<Application>
 CustomAppHelper::InstallPriv (Ptr<Node> node) const
 {
@@ -21,15 +21,20 @@
 #define CUSTOM_APP_HELPER_H
 
 #include <stdint.h>
+#include <ostream>
+#include <vector>
 #include "ns3/application-container.h"
 #include "ns3/node-container.h"
 #include "ns3/object-factory.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
+#include "ns3/vector.h"
 #include "ns3/libwasmfaas.h"
 
 namespace ns3 {
 
+class CustomApp;
+
 /**
  * \ingroup customapp
  * \brief Create a server application which waits for input UDP packets
@@ -87,6 +92,74 @@ public:
    */
   ApplicationContainer Install (NodeContainer c) const;
 
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by the CustomApp applications of the nodes.
+   *
+   * \param c NodeContainer of the nodes holding the applications
+   * \param stream first stream index to use
+   * \returns the number of stream indices assigned
+   */
+  int64_t AssignStreams (NodeContainer c, int64_t stream);
+
+  /**
+   * Print the latency report of every CustomApp in the container, then the
+   * latency percentiles of all of their invocations, of their cold and warm
+   * starts, and of each module.
+   *
+   * \param apps The applications, as returned by Install.
+   * \param os The output stream.
+   */
+  static void PrintLatencyReport (ApplicationContainer apps, std::ostream &os);
+
+  /**
+   * \param node A node.
+   * \returns The first CustomApp of the node, null if it has none.
+   */
+  static Ptr<CustomApp> GetCustomApp (Ptr<Node> node);
+
+  /**
+   * Register every CustomApp of the container as a peer of all the others.
+   *
+   * \param c The nodes holding the applications.
+   */
+  static void RegisterFullMesh (NodeContainer c);
+
+  /**
+   * Register as peers of each CustomApp the nodes of the container sharing
+   * a channel with it, at their address on that channel. Every device of a
+   * shared medium, such as a CSMA or Wi-Fi channel, counts as one hop.
+   *
+   * \param c The nodes holding the applications.
+   */
+  static void RegisterOneHopPeers (NodeContainer c);
+
+  /**
+   * Register as peers of each CustomApp the k nodes of the container
+   * nearest to it according to their MobilityModel, nearest first. The
+   * positions are read once and indexed in a WasmFaasSpatialIndex, so the
+   * whole container takes O(N log N).
+   *
+   * \param c The nodes holding the applications, each with a MobilityModel.
+   * \param k The number of peers of each node.
+   * \param maxDistance Only nodes within it are registered, 0 for no limit.
+   */
+  static void RegisterNearestPeers (NodeContainer c, uint32_t k, double maxDistance = 0);
+
+  /**
+   * Register the peers of an edge, access point and cloud hierarchy. Each
+   * edge node registers one access point, the nearest one if every edge
+   * and access point node has a MobilityModel, otherwise the next one in
+   * turn. Each access point registers its edge nodes and then the cloud
+   * nodes, each cloud node registers every access point.
+   *
+   * \param edges The edge nodes.
+   * \param accessPoints The access point nodes.
+   * \param cloud The cloud nodes.
+   */
+  static void RegisterHierarchy (NodeContainer edges, NodeContainer accessPoints,
+                                 NodeContainer cloud);
+
 private:
   /**
    * Install an ns3:: on the node configured with all the
@@ -97,6 +170,22 @@ private:
    */
   Ptr<Application> InstallPriv (Ptr<Node> node) const;
 
+  /**
+   * Register peer as a peer of app, at an IPv4 address of its node that app
+   * reaches directly: preferably on a channel app's node is attached to, else
+   * in a subnet of app's node, else the first one that is not a loopback one.
+   *
+   * \param app The application registering the peer.
+   * \param peer The peer application.
+   */
+  static void RegisterPeer (Ptr<CustomApp> app, Ptr<CustomApp> peer);
+
+  /**
+   * \param c Nodes each with a MobilityModel.
+   * \returns The positions of the nodes, in container order.
+   */
+  static std::vector<Vector> GetPositions (NodeContainer c);
+
   ObjectFactory m_factory; //!< Object factory.
 };
 
@@ -22,6 +22,10 @@
 #include <vector>
 #include <unordered_set>
 #include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <cmath>
+#include <cstring>
 
 #include "ns3/log.h"
 #include "ns3/ipv4-address.h"
@@ -29,15 +33,31 @@
 #include "ns3/inet-socket-address.h"
 #include "ns3/inet6-socket-address.h"
 #include "ns3/socket.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
 #include "ns3/simulator.h"
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/pointer.h"
+#include "ns3/enum.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
 #include "ns3/packet-loss-counter.h"
+#include "ns3/ipv4.h"
 
 #include "ns3/seq-ts-header.h"
 #include "custom-app.h"
-#include "libwasmfaas.h"
+#include "wasmfaas-header.h"
+#include "wasmfaas-chunk-header.h"
+#include "wasmfaas-request-tag.h"
+#include "wasmfaas-cache-policy.h"
+#include "wasmfaas-cost-model.h"
+#include "wasmfaas-event-log.h"
+#include "wasmfaas-module-store.h"
+#include "wasmfaas-module-digest.h"
+#include "libwasmfaas-ext.h"
 
 namespace ns3 {
 
@@ -63,6 +83,270 @@ CustomApp::GetTypeId (void)
                          MakeUintegerAccessor (&CustomApp::GetPacketWindowSize,
                                                &CustomApp::SetPacketWindowSize),
                          MakeUintegerChecker<uint16_t> (8, 256))
+          .AddAttribute ("TextProtocol",
+                         "Encode peer messages in the legacy ';' delimited text format "
+                         "instead of WasmFaasHeader, to reproduce old traces.",
+                         BooleanValue (false), MakeBooleanAccessor (&CustomApp::m_text_protocol),
+                         MakeBooleanChecker ())
+          .AddAttribute ("EventLog",
+                         "Binary log the protocol events are appended to, usually shared by "
+                         "every node. Its records are fixed-size and are not formatted, unlike "
+                         "the lines of the CustomApp log component.",
+                         PointerValue (), MakePointerAccessor (&CustomApp::m_event_log),
+                         MakePointerChecker<WasmFaasEventLog> ())
+          .AddAttribute ("PeerQueryFanout",
+                         "Number of peers asked at once for a missing module, in PeerSelection "
+                         "order. The first result wins, later ones are ignored. 0 asks every "
+                         "peer at once.",
+                         UintegerValue (1), MakeUintegerAccessor (&CustomApp::m_peer_query_fanout),
+                         MakeUintegerChecker<uint32_t> ())
+          .AddAttribute ("PeerSelection",
+                         "Order in which peers are asked for a missing module. LeastLoaded and "
+                         "PowerOfTwoChoices use the peer scores, see GetPeerScore.",
+                         EnumValue (CustomApp::ORDERED_SELECTION),
+                         MakeEnumAccessor (&CustomApp::m_peer_selection),
+                         MakeEnumChecker (CustomApp::ORDERED_SELECTION, "RegistrationOrder",
+                                          CustomApp::LEAST_LOADED_SELECTION, "LeastLoaded",
+                                          CustomApp::TWO_CHOICES_SELECTION, "PowerOfTwoChoices"))
+          .AddAttribute ("PeerRttAlpha",
+                         "Weight of the latest answer time of a peer in its smoothed answer "
+                         "time, as in an exponentially weighted moving average.",
+                         DoubleValue (0.2), MakeDoubleAccessor (&CustomApp::m_peer_rtt_alpha),
+                         MakeDoubleChecker<double> (0, 1))
+          .AddAttribute ("PeerLoadCost",
+                         "Score added to a peer for every invocation it advertised as queued. "
+                         "Its share of busy execution slots counts as part of one more.",
+                         TimeValue (MilliSeconds (10)),
+                         MakeTimeAccessor (&CustomApp::m_peer_load_cost), MakeTimeChecker ())
+          .AddAttribute ("ModuleLocationTtl",
+                         "How long the peer that returned a module result is remembered as its "
+                         "holder. Requests for the module go straight to that peer until then. "
+                         "0 disables the location cache.",
+                         TimeValue (Seconds (30)),
+                         MakeTimeAccessor (&CustomApp::m_module_location_ttl),
+                         MakeTimeChecker ())
+          .AddAttribute ("MaxHops",
+                         "Times an execute request may be forwarded from peer to peer. A peer "
+                         "that would forward it once more answers NOT_FOUND instead.",
+                         UintegerValue (8), MakeUintegerAccessor (&CustomApp::m_max_hops),
+                         MakeUintegerChecker<uint8_t> ())
+          .AddAttribute ("RequestTimeout",
+                         "Time to wait for the peers before sending a request again, to the "
+                         "peers that did not answer. 0 waits forever.",
+                         TimeValue (Seconds (2)), MakeTimeAccessor (&CustomApp::m_request_timeout),
+                         MakeTimeChecker ())
+          .AddAttribute ("RequestRetries",
+                         "Times a request is sent again before it fails with TIMED_OUT.",
+                         UintegerValue (2), MakeUintegerAccessor (&CustomApp::m_request_retries),
+                         MakeUintegerChecker<uint32_t> ())
+          .AddAttribute ("RequestRetryBackoff",
+                         "Factor applied to RequestTimeout at each retry of the same request.",
+                         DoubleValue (2), MakeDoubleAccessor (&CustomApp::m_request_retry_backoff),
+                         MakeDoubleChecker<double> (1))
+          .AddAttribute ("DuplicateWindow",
+                         "How long the reply to an execute request is kept. A duplicate of the "
+                         "request received meanwhile, such as a retry, gets the reply again "
+                         "instead of running the function again. Negative, the default, keeps "
+                         "it as long as a requester with the same RequestTimeout, "
+                         "RequestRetries and RequestRetryBackoff keeps retrying, and not at "
+                         "all when RequestTimeout is 0. 0 keeps no reply.",
+                         TimeValue (Seconds (-1)),
+                         MakeTimeAccessor (&CustomApp::m_duplicate_window), MakeTimeChecker ())
+          .AddAttribute ("WorkflowTimeout",
+                         "Time to wait for the result of a workflow started on this node "
+                         "before it fails with TIMED_OUT. 0 waits forever.",
+                         TimeValue (Seconds (10)),
+                         MakeTimeAccessor (&CustomApp::m_workflow_timeout), MakeTimeChecker ())
+          .AddAttribute ("GossipInterval",
+                         "Time between two gossip rounds, in which the node sends a digest of "
+                         "its modules to GossipFanout random peers. Peers ask a holder known "
+                         "from its digest before asking the others. 0 disables gossip. Needs "
+                         "the binary protocol.",
+                         TimeValue (Seconds (0)), MakeTimeAccessor (&CustomApp::m_gossip_interval),
+                         MakeTimeChecker ())
+          .AddAttribute ("GossipFanout", "Peers sent the digest at each gossip round.",
+                         UintegerValue (2), MakeUintegerAccessor (&CustomApp::m_gossip_fanout),
+                         MakeUintegerChecker<uint32_t> (1))
+          .AddAttribute ("GossipDigestBits",
+                         "Size of the gossiped module digests, in bits. Larger digests cost "
+                         "more bandwidth and send fewer requests to peers lacking the module. "
+                         "Every node must use the same size, digests of another size are "
+                         "ignored.",
+                         UintegerValue (256),
+                         MakeUintegerAccessor (&CustomApp::m_gossip_digest_bits),
+                         MakeUintegerChecker<uint32_t> (8, 65000 * 8))
+          .AddAttribute ("GossipDigestHashes", "Bits set by each module in the gossiped digests.",
+                         UintegerValue (3),
+                         MakeUintegerAccessor (&CustomApp::m_gossip_digest_hashes),
+                         MakeUintegerChecker<uint8_t> (1))
+          .AddAttribute ("GossipDigestTtl",
+                         "How long a digest received from a peer is used. Should cover a few "
+                         "gossip rounds of the peers.",
+                         TimeValue (Seconds (30)),
+                         MakeTimeAccessor (&CustomApp::m_gossip_digest_ttl), MakeTimeChecker ())
+          .AddAttribute ("ModuleCachePolicy",
+                         "Decides which modules fetched from peers are kept. Defaults to an "
+                         "unlimited LruWasmModuleCachePolicy. Only affects which modules the node "
+                         "serves and runs: evicted modules stay registered in the runtime, which "
+                         "cannot unregister them, and keep their memory.",
+                         PointerValue (),
+                         MakePointerAccessor (&CustomApp::m_module_cache_policy),
+                         MakePointerChecker<WasmModuleCachePolicy> ())
+          .AddAttribute ("ExecutionCostModel",
+                         "Simulated time taken by the functions run on this node. Every "
+                         "execution slot runs one function at a time and later invocations queue "
+                         "behind them. Without a model functions take no time.",
+                         PointerValue (),
+                         MakePointerAccessor (&CustomApp::m_execution_cost_model),
+                         MakePointerChecker<WasmExecutionCostModel> ())
+          .AddAttribute ("ExecutionSlots",
+                         "Functions that may run at once on this node, as simulated cores. Only "
+                         "used with an ExecutionCostModel.",
+                         UintegerValue (1), MakeUintegerAccessor (&CustomApp::m_execution_slots),
+                         MakeUintegerChecker<uint32_t> (1))
+          .AddAttribute ("MaxQueueSize",
+                         "Invocations that may wait for a free execution slot, 0 for unlimited.",
+                         UintegerValue (0), MakeUintegerAccessor (&CustomApp::m_max_queue_size),
+                         MakeUintegerChecker<uint32_t> ())
+          .AddAttribute ("QueueDiscipline", "Order in which waiting invocations get a slot.",
+                         EnumValue (CustomApp::FIFO_QUEUE),
+                         MakeEnumAccessor (&CustomApp::m_queue_discipline),
+                         MakeEnumChecker (CustomApp::FIFO_QUEUE, "Fifo", CustomApp::PRIORITY_QUEUE,
+                                          "Priority"))
+          .AddAttribute ("OverflowAction",
+                         "What happens to an invocation that finds the queue full. Forward "
+                         "sends it to the peers, or rejects it when there are none.",
+                         EnumValue (CustomApp::REJECT_OVERFLOW),
+                         MakeEnumAccessor (&CustomApp::m_overflow_action),
+                         MakeEnumChecker (CustomApp::REJECT_OVERFLOW, "Reject",
+                                          CustomApp::FORWARD_OVERFLOW, "Forward"))
+          .AddAttribute ("PureModules",
+                         "';' separated names of the modules whose functions are pure, see "
+                         "SetModulePure.",
+                         StringValue (""),
+                         MakeStringAccessor (&CustomApp::SetPureModules,
+                                             &CustomApp::GetPureModules),
+                         MakeStringChecker ())
+          .AddAttribute ("MemoCacheSize",
+                         "Results of pure functions kept for later invocations with the same "
+                         "arguments, 0 disables the memo cache.",
+                         UintegerValue (1024), MakeUintegerAccessor (&CustomApp::m_memo_cache_size),
+                         MakeUintegerChecker<uint32_t> ())
+          .AddAttribute ("ChunkedModuleTransfer",
+                         "Send modules as raw chunks behind a sliding window instead of one "
+                         "base64 packet. Needs the binary protocol.",
+                         BooleanValue (false),
+                         MakeBooleanAccessor (&CustomApp::m_chunked_module_transfer),
+                         MakeBooleanChecker ())
+          .AddAttribute ("ModuleChunkSize", "Bytes of module data carried by each chunk.",
+                         UintegerValue (1024),
+                         MakeUintegerAccessor (&CustomApp::m_module_chunk_size),
+                         MakeUintegerChecker<uint32_t> (1, 65000))
+          .AddAttribute ("ModuleTransferWindow",
+                         "Number of module chunks that may be sent before they are acknowledged.",
+                         UintegerValue (8),
+                         MakeUintegerAccessor (&CustomApp::m_module_transfer_window),
+                         MakeUintegerChecker<uint32_t> (1))
+          .AddAttribute ("ModuleChunkTimeout",
+                         "Time to wait for a module chunk to be acknowledged before the "
+                         "unacknowledged chunks are sent again. RequestRetryBackoff applies, "
+                         "the transfer is dropped after RequestRetries retransmissions without "
+                         "a new acknowledgement.",
+                         TimeValue (MilliSeconds (500)),
+                         MakeTimeAccessor (&CustomApp::m_module_chunk_timeout),
+                         MakeTimeChecker (MilliSeconds (1)))
+          .AddAttribute ("MaxModuleSize",
+                         "Largest module accepted from a chunked transfer, in bytes. Chunks "
+                         "announcing a larger module are dropped.",
+                         UintegerValue (64 * 1024 * 1024),
+                         MakeUintegerAccessor (&CustomApp::m_max_module_size),
+                         MakeUintegerChecker<uint32_t> ())
+          .AddAttribute ("BatchWindow",
+                         "Time execute requests and results to the same peer are held so that "
+                         "they leave as one BATCH packet. Trades latency for fewer packets. 0 "
+                         "sends every message at once. Needs the binary protocol.",
+                         TimeValue (Seconds (0)), MakeTimeAccessor (&CustomApp::m_batch_window),
+                         MakeTimeChecker ())
+          .AddAttribute ("BatchMaxSize",
+                         "Largest payload of a BATCH packet, in bytes. A batch that would grow "
+                         "larger is sent at once.",
+                         UintegerValue (1024), MakeUintegerAccessor (&CustomApp::m_batch_max_size),
+                         MakeUintegerChecker<uint32_t> (64, 65000))
+          .AddAttribute ("PrefetchCount",
+                         "Modules likely to be invoked next that are fetched from the peers "
+                         "after each invocation, while no request waits on the peers. The "
+                         "prediction follows the order in which modules were invoked on this "
+                         "node. 0 disables prefetch. Needs the binary protocol.",
+                         UintegerValue (0), MakeUintegerAccessor (&CustomApp::m_prefetch_count),
+                         MakeUintegerChecker<uint32_t> ())
+          .AddAttribute ("PrefetchThreshold",
+                         "Lowest predicted probability of being invoked next for a module to be "
+                         "prefetched.",
+                         DoubleValue (0.25),
+                         MakeDoubleAccessor (&CustomApp::m_prefetch_threshold),
+                         MakeDoubleChecker<double> (0, 1))
+          .AddTraceSource ("ModuleTransfer",
+                           "A module has been received from a peer, with its size on the wire "
+                           "and the time since the load request was sent",
+                           MakeTraceSourceAccessor (&CustomApp::m_moduleTransferTrace),
+                           "ns3::CustomApp::ModuleTransferTracedCallback")
+          .AddTraceSource ("InvocationCompleted",
+                           "An invocation made through ExecuteFunction on this node completed, "
+                           "locally or on a peer",
+                           MakeTraceSourceAccessor (&CustomApp::m_invocationCompletedTrace),
+                           "ns3::CustomApp::InvocationTracedCallback")
+          .AddTraceSource ("InvocationStart", "An invocation was made through ExecuteFunction",
+                           MakeTraceSourceAccessor (&CustomApp::m_invocationStartTrace),
+                           "ns3::CustomApp::StageTracedCallback")
+          .AddTraceSource ("DiscoveryComplete",
+                           "The module of an invocation was found, on this node or on a peer",
+                           MakeTraceSourceAccessor (&CustomApp::m_discoveryCompleteTrace),
+                           "ns3::CustomApp::StageTracedCallback")
+          .AddTraceSource ("ModuleTransferComplete",
+                           "The module of an invocation was received from a peer",
+                           MakeTraceSourceAccessor (&CustomApp::m_moduleTransferCompleteTrace),
+                           "ns3::CustomApp::StageTracedCallback")
+          .AddTraceSource ("ExecutionStart", "A function started running on this node",
+                           MakeTraceSourceAccessor (&CustomApp::m_executionStartTrace),
+                           "ns3::CustomApp::StageTracedCallback")
+          .AddTraceSource ("ExecutionEnd",
+                           "A function finished running on this node, once its cost elapsed",
+                           MakeTraceSourceAccessor (&CustomApp::m_executionEndTrace),
+                           "ns3::CustomApp::StageTracedCallback")
+          .AddTraceSource ("ResultDelivered",
+                           "The result of an invocation made through ExecuteFunction was handed "
+                           "back, successful or not",
+                           MakeTraceSourceAccessor (&CustomApp::m_resultDeliveredTrace),
+                           "ns3::CustomApp::StageTracedCallback")
+          .AddTraceSource ("BatchSent", "Messages to a peer held by BatchWindow were sent",
+                           MakeTraceSourceAccessor (&CustomApp::m_batchSentTrace),
+                           "ns3::CustomApp::BatchTracedCallback")
+          .AddTraceSource ("Prefetched",
+                           "Modules fetched from the peers ahead of their invocations",
+                           MakeTraceSourceAccessor (&CustomApp::m_prefetched),
+                           "ns3::TracedValueCallback::Uint64")
+          .AddTraceSource ("PrefetchHits", "Invocations that found their module prefetched",
+                           MakeTraceSourceAccessor (&CustomApp::m_prefetchHits),
+                           "ns3::TracedValueCallback::Uint64")
+          .AddTraceSource ("QueueDepth", "Invocations waiting for an execution slot",
+                           MakeTraceSourceAccessor (&CustomApp::m_queueDepth),
+                           "ns3::TracedValueCallback::Uint32")
+          .AddTraceSource ("QueueWait",
+                           "Time the last started invocation waited for an execution slot",
+                           MakeTraceSourceAccessor (&CustomApp::m_queueWait),
+                           "ns3::TracedValueCallback::Time")
+          .AddTraceSource ("Rejected", "Invocations turned away because the queue was full",
+                           MakeTraceSourceAccessor (&CustomApp::m_rejected),
+                           "ns3::TracedValueCallback::Uint64")
+          .AddTraceSource ("TimedOut",
+                           "Peers or module transfers given up on after the last retry",
+                           MakeTraceSourceAccessor (&CustomApp::m_timedOut),
+                           "ns3::TracedValueCallback::Uint64")
+          .AddTraceSource ("MemoHitRatio",
+                           "Share of the invocations of pure functions answered from the memo "
+                           "cache",
+                           MakeTraceSourceAccessor (&CustomApp::m_memoHitRatio),
+                           "ns3::TracedValueCallback::Double")
           .AddTraceSource ("Rx", "A packet has been received",
                            MakeTraceSourceAccessor (&CustomApp::m_rxTrace),
                            "ns3::Packet::TracedCallback")
@@ -79,14 +363,15 @@ CustomApp::CustomApp () : m_lossCounter (0)
   m_runtime_id = 0;
   m_peerAddresses = std::vector<InetSocketAddress> ();
   m_sent = 0;
-  m_is_querying_peers_idx = 0; // 0 initial state, 1 querying state
-  m_is_querying_peers = false;
-  m_module_exec_result = 0;
-  m_peer_module_exec_query_state = 0;
-  m_has_module_exec_result = false;
-  m_peers_queried = std::vector<InetSocketAddress> ();
-  m_is_waiting_for_module_load = false;
-  m_microseconds_eventloop_interval = 5;
+  m_next_request_seq = 1;
+  m_nOwnRequests = 0;
+  m_busy_slots = 0;
+  m_next_execution_seq = 0;
+  m_memo_lookups = 0;
+  m_memo_hits = 0;
+  m_peer_chooser = CreateObject<UniformRandomVariable> ();
+  m_gossip_bytes_sent = 0;
+  m_batcher.SetFlushCallback (MakeCallback (&CustomApp::SendBatch, this));
 }
 
 CustomApp::~CustomApp ()
@@ -122,10 +407,50 @@ CustomApp::GetReceived (void) const
   return m_received;
 }
 
+int64_t
+CustomApp::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_peer_chooser->SetStream (stream);
+  return 1;
+}
+
 void
 CustomApp::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  m_requests.clear ();
+  m_nOwnRequests = 0;
+  m_module_transfers.clear ();
+  m_address_owners.clear ();
+  m_module_locations.clear ();
+  m_module_cache_policy = 0;
+  m_execution_cost_model = 0;
+  m_execution_queue.clear ();
+  m_invocations.clear ();
+  m_memo_lru.clear ();
+  m_memo_index.clear ();
+  m_peer_scores.clear ();
+  m_peer_digests.clear ();
+  m_answers.clear ();
+  m_answer_expiry.clear ();
+  m_remote_executions.clear ();
+  m_workflows.Clear ();
+  m_batcher.Clear ();
+  m_batch_payload.clear ();
+  m_batch_payload.shrink_to_fit ();
+  m_module_invocations.clear ();
+  m_module_transitions.clear ();
+  m_prefetch_queue.clear ();
+  m_prefetched_modules.clear ();
+  m_cold_starts.clear ();
+  m_peer_chooser = 0;
+  m_event_log = 0;
+  m_rx_payload.clear ();
+  m_rx_payload.shrink_to_fit ();
+  m_rx_text.clear ();
+  m_rx_text.shrink_to_fit ();
+  m_query_socket = 0;
   Application::DoDispose ();
 }
 
@@ -136,6 +461,243 @@ CustomApp::InitRuntime ()
     {
       m_runtime_id = initialize_runtime ();
     }
+
+  // The runtime is the same for every node, tell once which entry point runs functions
+  static bool pathLogged = false;
+  if (!pathLogged)
+    {
+      pathLogged = true;
+      if (execute_module_typed != nullptr)
+        {
+          NS_LOG_INFO ("Runtime runs functions of typed arguments with execute_module_typed");
+        }
+      else
+        {
+          NS_LOG_WARN ("Runtime lacks execute_module_typed, functions take exactly two "
+                       "scalar arguments through execute_module");
+        }
+    }
+}
+
+static const char g_base64Chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/**
+ * \param data raw bytes
+ * \return data encoded in padded base64
+ */
+static std::string
+Base64Encode (const std::string &data)
+{
+  std::string out;
+  out.reserve ((data.size () + 2) / 3 * 4);
+  uint32_t buf = 0;
+  int bits = 0;
+  for (uint8_t c : data)
+    {
+      buf = (buf << 8) | c;
+      bits += 8;
+      while (bits >= 6)
+        {
+          bits -= 6;
+          out.push_back (g_base64Chars[(buf >> bits) & 0x3f]);
+        }
+    }
+  if (bits > 0)
+    {
+      out.push_back (g_base64Chars[(buf << (6 - bits)) & 0x3f]);
+    }
+  while (out.size () % 4)
+    {
+      out.push_back ('=');
+    }
+  return out;
+}
+
+/**
+ * \param data base64 text, padded or not
+ * \return the decoded bytes, characters outside the alphabet are skipped
+ */
+static std::string
+Base64Decode (const std::string &data)
+{
+  std::string out;
+  out.reserve (data.size () / 4 * 3);
+  uint32_t buf = 0;
+  int bits = 0;
+  for (char c : data)
+    {
+      auto pos = strchr (g_base64Chars, c);
+      if (c == '\0' || pos == nullptr)
+        {
+          continue;
+        }
+      buf = (buf << 6) | (uint32_t) (pos - g_base64Chars);
+      bits += 6;
+      if (bits >= 8)
+        {
+          bits -= 8;
+          out.push_back ((char) ((buf >> bits) & 0xff));
+        }
+    }
+  return out;
+}
+
+/**
+ * \param data base64 text
+ * \return the number of bytes Base64Decode would return for data
+ */
+static uint32_t
+GetBase64DecodedSize (const std::string &data)
+{
+  uint32_t n = 0;
+  for (char c : data)
+    {
+      if (c != '\0' && strchr (g_base64Chars, c) != nullptr)
+        {
+          n++;
+        }
+    }
+  return n * 6 / 8;
+}
+
+/**
+ * \param args function arguments
+ * \return the arguments, each preceded by a space
+ */
+static std::string
+FormatArgs (const std::vector<WasmFaasValue> &args)
+{
+  std::ostringstream oss;
+  for (auto &arg : args)
+    {
+      oss << " " << arg;
+    }
+  return oss.str ();
+}
+
+/**
+ * \param result an invocation result
+ * \return the result value, or FAILED
+ */
+static std::string
+FormatResult (const WasmFaasResult &result)
+{
+  switch (result.status)
+    {
+    case WasmFaasResult::OK:
+      break;
+    case WasmFaasResult::NOT_FOUND:
+      return "NOT_FOUND";
+    case WasmFaasResult::TIMED_OUT:
+      return "TIMED_OUT";
+    default:
+      return "FAILED";
+    }
+  std::ostringstream oss;
+  oss << result.value;
+  return oss.str ();
+}
+
+Ptr<Packet>
+CustomApp::BuildPacket (const WasmFaasHeader &header, const std::string &payload)
+{
+  NS_LOG_FUNCTION (this);
+
+  Ptr<Packet> p;
+  if (m_text_protocol)
+    {
+      // Requests only hold I32 arguments, see ExecuteFunction, results may be of any type
+      std::string text;
+      if (!header.ToText (payload, text))
+        {
+          NS_ASSERT (header.GetType () == WasmFaasHeader::EXECUTE_RESULT);
+          NS_LOG_WARN ("Only I32 results travel in the text protocol, sending a failed result");
+          auto failed = header;
+          failed.ClearArgs ();
+          failed.ToText (payload, text);
+        }
+      p = Create<Packet> ((const uint8_t *) text.c_str (), text.size ());
+      p->AddPacketTag (WasmFaasRequestTag (header.GetRequestId ()));
+    }
+  else
+    {
+      auto stamped = header;
+      SetLoad (stamped);
+      p = Create<Packet> ((const uint8_t *) payload.c_str (), payload.size ());
+      p->AddHeader (stamped);
+    }
+
+  SeqTsHeader seqTs;
+  seqTs.SetSeq (m_sent);
+  p->AddHeader (seqTs);
+  return p;
+}
+
+Ptr<Packet>
+CustomApp::BuildChunkPacket (const WasmFaasHeader &header, const WasmFaasChunkHeader &chunk,
+                             const uint8_t *data, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+
+  auto stamped = header;
+  SetLoad (stamped);
+  auto p = Create<Packet> (data, size);
+  p->AddHeader (chunk);
+  p->AddHeader (stamped);
+
+  SeqTsHeader seqTs;
+  seqTs.SetSeq (m_sent);
+  p->AddHeader (seqTs);
+  return p;
+}
+
+bool
+CustomApp::ParsePacket (Ptr<Packet> packet, WasmFaasHeader &header, WasmFaasChunkHeader &chunk,
+                        std::string &payload)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_text_protocol)
+    {
+      m_rx_text.resize (packet->GetSize ());
+      packet->CopyData ((uint8_t *) &m_rx_text[0], m_rx_text.size ());
+      if (!header.FromText (m_rx_text, payload))
+        {
+          return false;
+        }
+      WasmFaasRequestTag tag;
+      if (packet->PeekPacketTag (tag))
+        {
+          header.SetRequestId (tag.GetRequestId ());
+        }
+      return true;
+    }
+
+  // Headers are read in place, a truncated message would be read past its end
+  if (WasmFaasHeader::PeekSerializedSize (packet) == 0)
+    {
+      return false;
+    }
+  packet->RemoveHeader (header);
+  if (header.GetType () == WasmFaasHeader::MODULE_CHUNK ||
+      header.GetType () == WasmFaasHeader::MODULE_CHUNK_ACK)
+    {
+      if (packet->GetSize () < chunk.GetSerializedSize ())
+        {
+          return false;
+        }
+      packet->RemoveHeader (chunk);
+    }
+
+  // Most messages carry no payload, module data is copied once into the
+  // reused buffer
+  payload.resize (packet->GetSize ());
+  if (!payload.empty ())
+    {
+      packet->CopyData ((uint8_t *) &payload[0], payload.size ());
+    }
+  return true;
 }
 
 void
@@ -151,405 +713,2400 @@ CustomApp::QueryPeersCallback (Ptr<Socket> socket)
       m_rxTrace (packet);
       m_rxTraceWithAddresses (packet, from, localAddress);
 
-      if (packet->GetSize () > 0)
+      SeqTsHeader seqTs;
+      if (packet->GetSize () >= seqTs.GetSerializedSize ())
         {
-          SeqTsHeader seqTs;
           packet->RemoveHeader (seqTs);
 
-          auto packetSize = packet->GetSize ();
-          u_int8_t *data = new u_int8_t[packetSize];
-          packet->CopyData (data, packetSize);
+          // A batch is handled as the messages it carries, in order
+          std::vector<Ptr<Packet>> messages;
+          UnpackBatch (packet, messages);
+          for (auto &message : messages)
+            {
+              HandleQueryReply (message, socket, from);
+            }
+        }
+    }
+}
 
-          // m_peers_queried.erase (std::remove (m_peers_queried.begin (), m_peers_queried.end (),
-          //                                     InetSocketAddress::ConvertFrom (from)),
-          //                        m_peers_queried.end ());
+void
+CustomApp::HandleQueryReply (Ptr<Packet> packet, Ptr<Socket> socket, const Address &from)
+{
+  NS_LOG_FUNCTION (this << packet);
 
-          const char *strData = (char *) data;
+  WasmFaasHeader header;
+  WasmFaasChunkHeader chunk;
+  auto &payload = m_rx_payload;
+  auto size = packet->GetSize ();
+  if (!ParsePacket (packet, header, chunk, payload))
+    {
+      NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                << "DROPPED_MALFORMED_PACKET " << size);
+      LogEvent (WasmFaasEventLog::DROPPED_MALFORMED_PACKET, 0, 0);
+      return;
+    }
+  UpdatePeerLoad (from, header);
 
-          if (strData[0] == 'r')
-            {
+  auto requestId = header.GetRequestId ();
+  auto it = m_requests.find (requestId);
 
-              NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds ()
-                                        << " RECEIVED_PACKET_EXECUTE_MODULE_RESULT  "
-                                        << InetSocketAddress::ConvertFrom (from).GetIpv4 () << " "
-                                        << strData);
+  // A queued execute request is acknowledged first
+  if (header.GetType () == WasmFaasHeader::ACK)
+    {
+      if (it != m_requests.end ())
+        {
+          UpdatePeerRtt (it->second, from);
+        }
 
-              auto s = std::string ((char *) data);
+      // The peer a workflow or its result was sent to now holds it
+      m_workflows.AcknowledgeHandOver (requestId);
+      return;
+    }
 
-              std::vector<std::string> tokens;
-              size_t startPos = 0;
-              size_t endPos = 0;
-              std::string token;
-              while ((endPos = s.find (";", startPos)) != std::string::npos)
-                {
-                  token = s.substr (startPos, endPos - startPos);
-                  tokens.push_back (token);
-                  startPos = endPos + 1;
-                }
+  if (it == m_requests.end ())
+    {
+      // The last ack of a finished transfer may have been lost, the sender stops on this one
+      if (header.GetType () == WasmFaasHeader::MODULE_CHUNK)
+        {
+          WasmFaasHeader ack;
+          ack.SetType (WasmFaasHeader::MODULE_CHUNK_ACK);
+          ack.SetRequestId (requestId);
+          ack.SetModuleId (header.GetModuleId ());
+          socket->SendTo (BuildChunkPacket (ack, chunk, nullptr, 0), 0, from);
+          m_sent++;
+        }
 
-              tokens.push_back (s.substr (startPos));
+      NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds ()
+                                << " IGNORED_PACKET_UNKNOWN_REQUEST "
+                                << InetSocketAddress::ConvertFrom (from).GetIpv4 () << " "
+                                << header);
+      LogEvent (WasmFaasEventLog::IGNORED_PACKET_UNKNOWN_REQUEST, requestId, header.GetModuleId ());
+      return;
+    }
+  auto &ctx = it->second;
+  UpdatePeerRtt (ctx, from);
 
-              auto loadRequest = std::string ("l;");
-              loadRequest.append (tokens[1]);
-              loadRequest.append (";");
+  if (header.GetType () == WasmFaasHeader::EXECUTE_RESULT)
+    {
 
-              auto loadRequestStr = loadRequest.c_str ();
-              auto resp_len = strlen (loadRequestStr);
+      NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds ()
+                                << " RECEIVED_PACKET_EXECUTE_MODULE_RESULT  "
+                                << InetSocketAddress::ConvertFrom (from).GetIpv4 () << " "
+                                << header);
+      LogEvent (WasmFaasEventLog::RECEIVED_PACKET_EXECUTE_MODULE_RESULT, requestId,
+                header.GetModuleId ());
 
-              NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds ()
-                                        << " SEND_PACKET_MODULE_LOAD_REQUEST "
-                                        << InetSocketAddress::ConvertFrom (from).GetIpv4 () << " "
-                                        << loadRequestStr);
+      if (RemovePendingPeer (ctx, from) && ctx.nOutstanding > 0)
+        {
+          ctx.nOutstanding--;
+        }
 
-              auto p = Create<Packet> ((uint8_t *) loadRequestStr, resp_len);
+      // A fanned out query keeps the first result and ignores the others
+      if (ctx.hasResult)
+        {
+          return;
+        }
 
-              SeqTsHeader seqTs;
-              seqTs.SetSeq (m_sent);
-              p->AddHeader (seqTs);
-              socket->SendTo (p, 0, from);
-              m_sent++;
+      if (m_module_location_ttl.IsStrictlyPositive ())
+        {
+          auto &loc = m_module_locations[ctx.moduleName];
+          loc.holder = from;
+          loc.expires = Simulator::Now () + m_module_location_ttl;
+        }
 
-              m_module_exec_result = stoi (tokens[2]);
-              m_is_querying_peers = false;
-              m_is_querying_peers_idx = 255;
-              m_is_waiting_for_module_load = true;
+      if (header.GetNArgs () > 0)
+        {
+          ctx.result = WasmFaasResult{WasmFaasResult::OK, header.GetArg (0)};
+        }
+      else
+        {
+          ctx.result = WasmFaasResult{WasmFaasResult::FAILED, WasmFaasValue{}};
+        }
+      ctx.hasResult = true;
+      m_discoveryCompleteTrace (requestId, ctx.moduleName);
 
-              if (m_peer_module_exec_query_state == 1)
-                {
-                  m_has_module_exec_result = true;
-                  m_peer_module_exec_query_state = 2;
-                }
-            }
-          else if (strData[0] == 'c')
-            {
-              auto s = std::string ((char *) strData);
+      // Overflow forwarded to a peer does not need the module back
+      if (!m_module_cache_policy->ShouldFetch (ctx.moduleName) ||
+          IsModuleAvailable (ctx.moduleName))
+        {
+          CompletePeerQuery (requestId, true);
+          return;
+        }
 
-              std::vector<std::string> tokens;
-              size_t startPos = 0;
-              size_t endPos = 0;
-              std::string token;
-              while ((endPos = s.find (";", startPos)) != std::string::npos)
-                {
-                  token = s.substr (startPos, endPos - startPos);
-                  tokens.push_back (token);
-                  startPos = endPos + 1;
-                }
+      WasmFaasHeader loadRequest;
+      loadRequest.SetType (WasmFaasHeader::MODULE_LOAD_REQUEST);
+      loadRequest.SetRequestId (requestId);
+      loadRequest.SetModuleId (header.GetModuleId ());
+
+      NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds ()
+                                << " SEND_PACKET_MODULE_LOAD_REQUEST "
+                                << InetSocketAddress::ConvertFrom (from).GetIpv4 () << " "
+                                << loadRequest);
+      LogEvent (WasmFaasEventLog::SEND_PACKET_MODULE_LOAD_REQUEST, requestId,
+                header.GetModuleId ());
+
+      socket->SendTo (BuildPacket (loadRequest, ""), 0, from);
+      m_sent++;
+
+      ctx.isWaitingForModuleLoad = true;
+      ctx.transferStart = Simulator::Now ();
+      ctx.moduleHolder = from;
+      ctx.nRetries = 0;
+      ArmRequestTimeout (ctx);
+    }
+  else if (header.GetType () == WasmFaasHeader::MODULE_LOAD_RESULT)
+    {
+      auto moduleName = WasmFaasHeader::GetIdName (header.GetModuleId ());
 
-              tokens.push_back (s.substr (startPos));
+      NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds ()
+                                << " RECEIVED_PACKET_MODULE_LOAD_RESULT "
+                                << InetSocketAddress::ConvertFrom (from).GetIpv4 () << " "
+                                << moduleName << " " << payload.size ());
+      LogEvent (WasmFaasEventLog::RECEIVED_PACKET_MODULE_LOAD_RESULT, requestId,
+                header.GetModuleId (), payload.size ());
 
-              NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds ()
-                                        << " RECEIVED_PACKET_MODULE_LOAD_RESULT "
-                                        << InetSocketAddress::ConvertFrom (from).GetIpv4 () << " "
-                                        << tokens[1] << " " << s.size ());
+      FinishModuleLoad (requestId, moduleName, payload, payload.size (), from);
+    }
+  else if (header.GetType () == WasmFaasHeader::MODULE_CHUNK)
+    {
+      if (!WasmFaasChunkReceiver::IsValid (chunk, m_max_module_size))
+        {
+          NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds ()
+                                    << " IGNORED_MODULE_CHUNK "
+                                    << InetSocketAddress::ConvertFrom (from).GetIpv4 () << " "
+                                    << header << " " << chunk);
+          LogEvent (WasmFaasEventLog::IGNORED_MODULE_CHUNK, requestId, header.GetModuleId (),
+                    payload.size ());
+          return;
+        }
+      if (ctx.chunks.Receive (chunk, payload))
+        {
+          ctx.nRetries = 0;
+          ArmRequestTimeout (ctx);
+        }
 
-              if (!is_module_registered (m_runtime_id, tokens[1].c_str ()))
-                {
-                  register_module (m_runtime_id, tokens[1].c_str (), tokens[2].c_str ());
-                  m_is_waiting_for_module_load = false;
+      // Duplicates are acknowledged too, the first ack may have been lost
+      WasmFaasHeader ack;
+      ack.SetType (WasmFaasHeader::MODULE_CHUNK_ACK);
+      ack.SetRequestId (requestId);
+      ack.SetModuleId (header.GetModuleId ());
+      socket->SendTo (BuildChunkPacket (ack, chunk, nullptr, 0), 0, from);
+      m_sent++;
 
-                  NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds ()
-                                            << " REGISTERED MODULE "
-                                            << InetSocketAddress::ConvertFrom (from).GetIpv4 ()
-                                            << " " << tokens[1]);
-                }
-            }
-          else if (strData[0] == 'n')
+      if (ctx.chunks.IsComplete ())
+        {
+          auto moduleName = WasmFaasHeader::GetIdName (header.GetModuleId ());
+          auto size = ctx.chunks.GetData ().size ();
+
+          NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds ()
+                                    << " RECEIVED_MODULE_CHUNKS "
+                                    << InetSocketAddress::ConvertFrom (from).GetIpv4 () << " "
+                                    << moduleName << " " << size << " " << chunk.GetCount ());
+          LogEvent (WasmFaasEventLog::RECEIVED_MODULE_CHUNKS, requestId, header.GetModuleId (),
+                    size);
+
+          auto moduleData = Base64Encode (ctx.chunks.GetData ());
+          ctx.chunks.Clear ();
+          FinishModuleLoad (requestId, moduleName, moduleData, size, from);
+        }
+    }
+  else if (header.GetType () == WasmFaasHeader::NOT_FOUND)
+    {
+      // The peer asked for the module may lack it, see the MODULE_LOAD_REQUEST handler
+      auto isLoadAnswer =
+          ctx.isWaitingForModuleLoad && InetSocketAddress::IsMatchingType (from) &&
+          IsSamePeer (InetSocketAddress::ConvertFrom (from).GetIpv4 (),
+                      InetSocketAddress::ConvertFrom (ctx.moduleHolder).GetIpv4 ());
+      // Answers to retries may repeat an answer already counted
+      if (!isLoadAnswer && !RemovePendingPeer (ctx, from))
+        {
+          return;
+        }
+      if (!isLoadAnswer && ctx.nOutstanding > 0)
+        {
+          ctx.nOutstanding--;
+        }
+      if (ctx.isDirected)
+        {
+          // The known holder lost the module, fall back to asking every peer
+          NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds ()
+                                    << " INVALIDATED_MODULE_LOCATION " << ctx.moduleName << " "
+                                    << InetSocketAddress::ConvertFrom (from).GetIpv4 ());
+          LogEvent (WasmFaasEventLog::INVALIDATED_MODULE_LOCATION, requestId,
+                    header.GetModuleId ());
+
+          m_module_locations.erase (ctx.moduleName);
+          auto digest = m_peer_digests.find (InetSocketAddress::ConvertFrom (from).GetIpv4 ());
+          if (digest != m_peer_digests.end ())
             {
-              m_is_querying_peers = false;
+              digest->second.misses.insert (header.GetModuleId ());
             }
+          ctx.isDirected = false;
+        }
+      if (isLoadAnswer && ctx.isPrefetch)
+        {
+          SendNextPrefetchRequest (requestId);
+        }
+      else if (isLoadAnswer)
+        {
+          // The result is known already, only the module stays remote
+          ctx.isWaitingForModuleLoad = false;
+          CompletePeerQuery (requestId, true);
+        }
+      else if (!ctx.hasResult && ctx.nOutstanding == 0)
+        {
+          SendNextPeerQuery (requestId);
+        }
+    }
+}
+
+void
+CustomApp::FinishModuleLoad (uint64_t requestId, const std::string &moduleName,
+                             const std::string &moduleData, uint32_t bytes, Address from)
+{
+  NS_LOG_FUNCTION (this << requestId << moduleName << bytes);
+
+  auto it = m_requests.find (requestId);
+  if (it == m_requests.end () || !it->second.isWaitingForModuleLoad)
+    {
+      return;
+    }
+  auto &ctx = it->second;
+
+  // The runtime cannot unload a module, evicted modules stay registered
+  // there but are no longer used to serve requests
+  std::vector<std::string> evicted;
+  if (!m_module_cache_policy->Insert (moduleName, GetBase64DecodedSize (moduleData), evicted))
+    {
+      NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds ()
+                                << " MODULE_NOT_CACHED " << moduleName);
+      LogEvent (WasmFaasEventLog::MODULE_NOT_CACHED, requestId,
+                WasmFaasHeader::GetNameId (moduleName), bytes);
+    }
+  else if (!is_module_registered (m_runtime_id, moduleName.c_str ()))
+    {
+      WasmModuleStore::Register (m_runtime_id, moduleName, moduleData);
+
+      NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds ()
+                                << " REGISTERED MODULE "
+                                << InetSocketAddress::ConvertFrom (from).GetIpv4 () << " "
+                                << moduleName);
+      LogEvent (WasmFaasEventLog::REGISTERED_MODULE, requestId,
+                WasmFaasHeader::GetNameId (moduleName), bytes);
+    }
+  for (auto &name : evicted)
+    {
+      NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds ()
+                                << " EVICTED_MODULE " << name);
+      LogEvent (WasmFaasEventLog::EVICTED_MODULE, requestId, WasmFaasHeader::GetNameId (name));
+      m_prefetched_modules.erase (name);
+    }
+
+  m_moduleTransferTrace (moduleName, bytes, Simulator::Now () - ctx.transferStart);
+  if (!ctx.isPrefetch)
+    {
+      m_moduleTransferCompleteTrace (requestId, moduleName);
+    }
+  else if (IsModuleAvailable (moduleName))
+    {
+      m_prefetched_modules.insert (moduleName);
+      m_prefetched++;
+    }
+
+  ctx.isWaitingForModuleLoad = false;
+  CompletePeerQuery (requestId, true);
+}
+
+void
+CustomApp::SendModuleChunks (uint64_t requestId)
+{
+  NS_LOG_FUNCTION (this << requestId);
+
+  auto it = m_module_transfers.find (requestId);
+  if (it == m_module_transfers.end ())
+    {
+      return;
+    }
+  auto &transfer = it->second;
+
+  uint32_t seq;
+  while (transfer.chunks.NextChunk (m_module_transfer_window, seq))
+    {
+      SendModuleChunk (requestId, transfer, seq);
+    }
+}
+
+uint32_t
+CustomApp::SendModuleChunk (uint64_t requestId, const ModuleTransfer &transfer, uint32_t seq)
+{
+  NS_LOG_FUNCTION (this << requestId << seq);
+
+  WasmFaasHeader header;
+  header.SetType (WasmFaasHeader::MODULE_CHUNK);
+  header.SetRequestId (requestId);
+  header.SetModuleId (transfer.moduleId);
+
+  // Chunks are copied straight from the module bytes into their packet
+  WasmFaasChunkHeader chunk;
+  uint32_t size;
+  auto data = transfer.chunks.GetChunk (seq, chunk, size);
+  auto p = BuildChunkPacket (header, chunk, data, size);
+  m_socket->SendTo (p, 0, transfer.peer);
+  m_sent++;
+  return size;
+}
+
+void
+CustomApp::ResendModuleChunks (uint64_t requestId, const ModuleTransfer &transfer)
+{
+  NS_LOG_FUNCTION (this << requestId);
+
+  auto seqs = transfer.chunks.GetUnacknowledged ();
+  uint32_t bytes = 0;
+  for (auto seq : seqs)
+    {
+      bytes += SendModuleChunk (requestId, transfer, seq);
+    }
+
+  NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                            << "MODULE_CHUNKS_RETRANSMITTED "
+                            << WasmFaasHeader::GetIdName (transfer.moduleId) << " " << requestId
+                            << " " << seqs.size () << " " << transfer.nRetries);
+  LogEvent (WasmFaasEventLog::MODULE_CHUNKS_RETRANSMITTED, requestId, transfer.moduleId, bytes);
+}
+
+void
+CustomApp::ArmModuleTransferTimeout (uint64_t requestId, ModuleTransfer &transfer)
+{
+  transfer.retransmitEvent.Cancel ();
+  auto timeout = Seconds (m_module_chunk_timeout.GetSeconds () *
+                          std::pow (m_request_retry_backoff, transfer.nRetries));
+  transfer.retransmitEvent =
+      Simulator::Schedule (timeout, &CustomApp::HandleModuleTransferTimeout, this, requestId);
+}
+
+void
+CustomApp::HandleModuleTransferTimeout (uint64_t requestId)
+{
+  NS_LOG_FUNCTION (this << requestId);
+
+  auto it = m_module_transfers.find (requestId);
+  if (it == m_module_transfers.end ())
+    {
+      return;
+    }
+  auto &transfer = it->second;
+
+  // The requester is gone or gave up, its own retries would have brought acks
+  if (transfer.nRetries >= m_request_retries)
+    {
+      NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                << "MODULE_TRANSFER_EXPIRED "
+                                << WasmFaasHeader::GetIdName (transfer.moduleId) << " "
+                                << requestId << " " << transfer.chunks.GetNAcknowledged ()
+                                << " " << transfer.chunks.GetNChunks ());
+      LogEvent (WasmFaasEventLog::MODULE_TRANSFER_EXPIRED, requestId, transfer.moduleId);
+
+      m_module_transfers.erase (it);
+      return;
+    }
+
+  transfer.nRetries++;
+  ResendModuleChunks (requestId, transfer);
+  ArmModuleTransferTimeout (requestId, transfer);
+}
+
+void
+CustomApp::LogEvent (WasmFaasEventLog::EventType type, uint64_t requestId, uint32_t moduleId,
+                     uint32_t bytes)
+{
+  if (m_event_log != 0)
+    {
+      m_event_log->Write (GetNode ()->GetId (), type, requestId, moduleId, bytes);
+    }
+}
+
+uint64_t
+CustomApp::NewRequestId (void)
+{
+  // Node ID in the upper half keeps IDs unique when requests are forwarded, 0 is
+  // left for the messages that belong to no request
+  return ((uint64_t) GetNode ()->GetId () << 32) | m_next_request_seq++;
+}
+
+CustomApp::RequestContext &
+CustomApp::AddRequest (uint64_t requestId, bool isForwarded)
+{
+  auto it = m_requests.find (requestId);
+  if (it != m_requests.end () && !it->second.isForwarded)
+    {
+      m_nOwnRequests--;
+    }
+
+  auto &ctx = m_requests[requestId];
+  ctx.requestId = requestId;
+  ctx.isForwarded = isForwarded;
+  if (!isForwarded)
+    {
+      m_nOwnRequests++;
+    }
+  return ctx;
+}
+
+void
+CustomApp::RemoveRequest (std::unordered_map<uint64_t, RequestContext>::iterator it)
+{
+  if (!it->second.isForwarded)
+    {
+      m_nOwnRequests--;
+    }
+  m_requests.erase (it);
+}
+
+void
+CustomApp::QueryPeersForModule (uint64_t requestId)
+{
+  NS_LOG_FUNCTION (this << requestId);
+
+  auto &ctx = m_requests[requestId];
+  ctx.peerIdx = 0;
+  ctx.nRetries = 0;
+  ctx.timedOut = false;
+  ctx.candidates.clear ();
+  ctx.awaiting.clear ();
+  ctx.pending.clear ();
+  if (m_peer_selection != ORDERED_SELECTION)
+    {
+      for (uint32_t i = 0; i < m_peerAddresses.size (); i++)
+        {
+          ctx.candidates.push_back (i);
+        }
+    }
+  ctx.nOutstanding = 0;
+  ctx.hasResult = false;
+  ctx.isWaitingForModuleLoad = false;
+  ctx.isDirected = false;
+  ctx.isPrefetch = false;
+
+  NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                            << "INIT_QUERY_PEERS_FOR_MODULE " << ctx.moduleName << " "
+                            << requestId);
+  LogEvent (WasmFaasEventLog::INIT_QUERY_PEERS_FOR_MODULE, requestId,
+            WasmFaasHeader::GetNameId (ctx.moduleName));
+
+  auto loc = m_module_locations.find (ctx.moduleName);
+  if (loc != m_module_locations.end () && loc->second.expires <= Simulator::Now ())
+    {
+      m_module_locations.erase (loc);
+      loc = m_module_locations.end ();
+    }
+
+  if (loc != m_module_locations.end ())
+    {
+      auto request = BuildExecuteRequest (ctx);
+
+      NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                << "SEND_PACKET_EXECUTE_MODULE_REQUEST_TO_KNOWN_HOLDER "
+                                << InetSocketAddress::ConvertFrom (loc->second.holder).GetIpv4 ()
+                                << " " << request);
+      LogEvent (WasmFaasEventLog::SEND_PACKET_EXECUTE_MODULE_REQUEST_TO_KNOWN_HOLDER, requestId,
+                request.GetModuleId ());
+
+      ctx.isDirected = true;
+      ctx.nOutstanding = 1;
+      ctx.awaiting.push_back (InetSocketAddress::ConvertFrom (loc->second.holder).GetIpv4 ());
+      ctx.pending.push_back (InetSocketAddress::ConvertFrom (loc->second.holder));
+      ctx.queryStart = Simulator::Now ();
+      SendToPeer (BuildPacket (request, ""), loc->second.holder);
+      ArmRequestTimeout (ctx);
+      return;
+    }
+
+  Address holder;
+  if (FindGossipHolder (ctx.moduleName, holder))
+    {
+      auto request = BuildExecuteRequest (ctx);
+
+      NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                << "SEND_PACKET_EXECUTE_MODULE_REQUEST_TO_GOSSIP_HOLDER "
+                                << InetSocketAddress::ConvertFrom (holder).GetIpv4 () << " "
+                                << request);
+      LogEvent (WasmFaasEventLog::SEND_PACKET_EXECUTE_MODULE_REQUEST_TO_GOSSIP_HOLDER, requestId,
+                request.GetModuleId ());
+
+      ctx.isDirected = true;
+      ctx.nOutstanding = 1;
+      ctx.awaiting.push_back (InetSocketAddress::ConvertFrom (holder).GetIpv4 ());
+      ctx.pending.push_back (InetSocketAddress::ConvertFrom (holder));
+      ctx.queryStart = Simulator::Now ();
+      SendToPeer (BuildPacket (request, ""), holder);
+      ArmRequestTimeout (ctx);
+      return;
+    }
+
+  SendNextPeerQuery (requestId);
+}
+
+bool
+CustomApp::FindGossipHolder (const std::string &module_name, Address &holder)
+{
+  NS_LOG_FUNCTION (this << module_name);
+
+  auto moduleId = WasmFaasHeader::GetNameId (module_name);
+  auto found = false;
+  Time best;
+  for (auto it = m_peer_digests.begin (); it != m_peer_digests.end ();)
+    {
+      auto &entry = it->second;
+      if (entry.expires <= Simulator::Now ())
+        {
+          it = m_peer_digests.erase (it);
+          continue;
+        }
+      if (entry.misses.count (moduleId) == 0 && entry.digest.MayContain (moduleId))
+        {
+          auto score = GetPeerScore (it->first);
+          if (!found || score < best)
+            {
+              found = true;
+              best = score;
+              holder = entry.holder;
+            }
+        }
+      ++it;
+    }
+  return found;
+}
+
+void
+CustomApp::Gossip (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_gossip_event = Simulator::Schedule (m_gossip_interval, &CustomApp::Gossip, this);
+
+  WasmFaasModuleDigest digest (m_gossip_digest_bits, m_gossip_digest_hashes);
+  uint32_t nModules = 0;
+  auto modules = m_module_cache_policy->GetModules ();
+  modules.insert (modules.end (), m_pinned_modules.begin (), m_pinned_modules.end ());
+  for (auto &name : modules)
+    {
+      if (IsModuleAvailable (name))
+        {
+          digest.Add (WasmFaasHeader::GetNameId (name));
+          nModules++;
+        }
+    }
+  if (nModules == 0 || m_peerAddresses.empty ())
+    {
+      return;
+    }
+
+  WasmFaasHeader header;
+  header.SetType (WasmFaasHeader::GOSSIP);
+  std::string payload;
+  digest.Serialize (payload);
+  auto p = BuildPacket (header, payload);
+
+  // Partial shuffle, the first fanout indices are the chosen peers
+  std::vector<uint32_t> peers (m_peerAddresses.size ());
+  for (uint32_t i = 0; i < peers.size (); i++)
+    {
+      peers[i] = i;
+    }
+  uint32_t fanout = std::min<uint32_t> (m_gossip_fanout, peers.size ());
+  for (uint32_t i = 0; i < fanout; i++)
+    {
+      std::swap (peers[i], peers[m_peer_chooser->GetInteger (i, peers.size () - 1)]);
+      auto peer = m_peerAddresses[peers[i]];
+
+      NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                << "SEND_PACKET_GOSSIP " << peer.GetIpv4 () << " " << nModules
+                                << " " << payload.size ());
+      LogEvent (WasmFaasEventLog::SEND_PACKET_GOSSIP, 0, 0, payload.size ());
+
+      m_socket->SendTo (p->Copy (), 0, peer);
+      m_sent++;
+      m_gossip_bytes_sent += p->GetSize ();
+    }
+}
+
+uint64_t
+CustomApp::GetGossipBytesSent (void) const
+{
+  return m_gossip_bytes_sent;
+}
+
+WasmFaasHeader
+CustomApp::BuildExecuteRequest (const RequestContext &ctx)
+{
+  WasmFaasHeader request;
+  request.SetType (WasmFaasHeader::EXECUTE_REQUEST);
+  request.SetRequestId (ctx.requestId);
+  request.SetModuleId (WasmFaasHeader::GetNameId (ctx.moduleName));
+  request.SetFunctionId (WasmFaasHeader::GetNameId (ctx.funcName));
+  request.SetHopCount (ctx.hopCount);
+  request.SetPriority (ctx.priority);
+  for (auto &arg : ctx.args)
+    {
+      request.AddArg (arg);
+    }
+  return request;
+}
+
+void
+CustomApp::SendToPeer (Ptr<Packet> packet, const Address &peer)
+{
+  NS_LOG_FUNCTION (this << packet << peer);
+
+  if (m_query_socket == 0)
+    {
+      TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+      m_query_socket = Socket::CreateSocket (GetNode (), tid);
+      if (m_query_socket->Bind () == -1)
+        {
+          NS_FATAL_ERROR ("Failed to bind socket");
+        }
+      m_query_socket->SetRecvCallback (MakeCallback (&CustomApp::QueryPeersCallback, this));
+    }
+
+  SendBatched (m_query_socket, packet, peer);
+}
+
+void
+CustomApp::SendBatched (Ptr<Socket> socket, Ptr<Packet> packet, const Address &peer)
+{
+  NS_LOG_FUNCTION (this << socket << packet << peer);
+
+  if (m_batcher.IsEnabled ())
+    {
+      SeqTsHeader seqTs;
+      packet->RemoveHeader (seqTs);
+      if (m_batcher.Add (socket, peer, packet))
+        {
+          return;
+        }
+      packet->AddHeader (seqTs);
+    }
+  socket->SendTo (packet, 0, peer);
+  m_sent++;
+}
+
+void
+CustomApp::SendBatch (Ptr<Socket> socket, const Address &peer,
+                      const std::vector<Ptr<Packet>> &messages)
+{
+  NS_LOG_FUNCTION (this << socket << peer << messages.size ());
+
+  Ptr<Packet> p;
+  if (messages.size () == 1)
+    {
+      p = messages.front ();
+      SeqTsHeader seqTs;
+      seqTs.SetSeq (m_sent);
+      p->AddHeader (seqTs);
+    }
+  else
+    {
+      auto &payload = m_batch_payload;
+      WasmFaasBatcher::Pack (messages, payload);
+
+      WasmFaasHeader header;
+      header.SetType (WasmFaasHeader::BATCH);
+      p = BuildPacket (header, payload);
+
+      NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                << "SEND_PACKET_BATCH "
+                                << InetSocketAddress::ConvertFrom (peer).GetIpv4 () << " "
+                                << messages.size () << " " << payload.size ());
+      LogEvent (WasmFaasEventLog::SEND_PACKET_BATCH, 0, 0, payload.size ());
+    }
+
+  m_batchSentTrace (messages.size (), p->GetSize ());
+  socket->SendTo (p, 0, peer);
+  m_sent++;
+}
+
+bool
+CustomApp::UnpackBatch (Ptr<Packet> packet, std::vector<Ptr<Packet>> &messages)
+{
+  NS_LOG_FUNCTION (this << packet);
+
+  messages.clear ();
+  WasmFaasHeader header;
+  if (m_text_protocol || WasmFaasHeader::PeekSerializedSize (packet) == 0 ||
+      packet->PeekHeader (header) == 0 || header.GetType () != WasmFaasHeader::BATCH)
+    {
+      messages.push_back (packet);
+      return false;
+    }
+
+  packet->RemoveHeader (header);
+  auto &payload = m_batch_payload;
+  payload.resize (packet->GetSize ());
+  if (!payload.empty ())
+    {
+      packet->CopyData ((uint8_t *) &payload[0], payload.size ());
+    }
+  WasmFaasBatcher::Unpack (payload, messages);
+
+  NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                            << "RECEIVED_PACKET_BATCH " << messages.size () << " "
+                            << payload.size ());
+  LogEvent (WasmFaasEventLog::RECEIVED_PACKET_BATCH, 0, 0, payload.size ());
+  return true;
+}
+
+void
+CustomApp::SendNextPeerQuery (uint64_t requestId)
+{
+  NS_LOG_FUNCTION (this << requestId);
+
+  auto it = m_requests.find (requestId);
+  if (it == m_requests.end ())
+    {
+      return;
+    }
+  auto &ctx = it->second;
+
+  if (ctx.peerIdx >= m_peerAddresses.size ())
+    {
+      CompletePeerQuery (requestId, false,
+                         ctx.timedOut ? WasmFaasResult::TIMED_OUT : WasmFaasResult::NOT_FOUND);
+      return;
+    }
+
+  // The whole batch shares one packet, every peer receives a copy of it
+  auto request = BuildExecuteRequest (ctx);
+  auto p = BuildPacket (request, "");
+  uint32_t fanout = m_peer_query_fanout == 0 ? m_peerAddresses.size () : m_peer_query_fanout;
+  ctx.awaiting.clear ();
+  ctx.pending.clear ();
+  ctx.queryStart = Simulator::Now ();
+  ctx.nRetries = 0;
+  while (ctx.nOutstanding < fanout && ctx.peerIdx < m_peerAddresses.size ())
+    {
+      auto peer = m_peerAddresses[PickNextPeer (ctx)];
+
+      NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                << "SEND_PACKET_EXECUTE_MODULE_REQUEST " << peer.GetIpv4 () << " "
+                                << request);
+      LogEvent (WasmFaasEventLog::SEND_PACKET_EXECUTE_MODULE_REQUEST, requestId,
+                request.GetModuleId ());
+
+      SendToPeer (p->Copy (), peer);
+      ctx.awaiting.push_back (peer.GetIpv4 ());
+      ctx.pending.push_back (peer);
+      ctx.peerIdx++;
+      ctx.nOutstanding++;
+    }
+  ArmRequestTimeout (ctx);
+}
+
+void
+CustomApp::UpdateModulePredictor (const std::string &module_name)
+{
+  NS_LOG_FUNCTION (this << module_name);
+
+  m_module_invocations[module_name]++;
+  if (!m_last_module.empty ())
+    {
+      m_module_transitions[m_last_module][module_name]++;
+    }
+  m_last_module = module_name;
+
+  if (m_prefetch_count == 0 || m_text_protocol)
+    {
+      return;
+    }
+
+  // Until a module followed this one, the most invoked modules are the best guess
+  auto transitions = m_module_transitions.find (module_name);
+  auto &counts = transitions != m_module_transitions.end () ? transitions->second
+                                                            : m_module_invocations;
+  uint64_t total = 0;
+  std::vector<std::pair<uint32_t, std::string>> candidates;
+  for (auto &entry : counts)
+    {
+      total += entry.second;
+      candidates.push_back (std::make_pair (entry.second, entry.first));
+    }
+  // Likeliest first, by name among equals so that runs are reproducible
+  std::sort (candidates.begin (), candidates.end (),
+             [] (const std::pair<uint32_t, std::string> &a,
+                 const std::pair<uint32_t, std::string> &b) {
+               return a.first != b.first ? a.first > b.first : a.second < b.second;
+             });
+
+  m_prefetch_queue.clear ();
+  for (auto &candidate : candidates)
+    {
+      if (m_prefetch_queue.size () == m_prefetch_count ||
+          candidate.first < m_prefetch_threshold * total)
+        {
+          break;
+        }
+      // Modules available now may be evicted by then, TryPrefetch checks them
+      if (candidate.second != module_name)
+        {
+          m_prefetch_queue.push_back (candidate.second);
+        }
+    }
+}
+
+void
+CustomApp::TryPrefetch (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // Prefetches only use the link while no request of this node needs it, requests
+  // forwarded for peers and modules sent to peers do not hold them back
+  if (m_nOwnRequests > 0 || m_peerAddresses.empty ())
+    {
+      return;
+    }
+
+  while (!m_prefetch_queue.empty ())
+    {
+      auto moduleName = m_prefetch_queue.front ();
+      m_prefetch_queue.pop_front ();
+      if (IsModuleAvailable (moduleName) || !m_module_cache_policy->ShouldFetch (moduleName))
+        {
+          continue;
+        }
+
+      auto requestId = NewRequestId ();
+      auto &ctx = AddRequest (requestId, false);
+      ctx.moduleName = moduleName;
+      ctx.priority = 0;
+      ctx.hopCount = 0;
+      ctx.peerIdx = 0;
+      ctx.nRetries = 0;
+      ctx.timedOut = false;
+      ctx.nOutstanding = 0;
+      ctx.hasResult = false;
+      ctx.isWaitingForModuleLoad = true;
+      ctx.isPrefetch = true;
+
+      // The known holder is asked first, as in QueryPeersForModule
+      auto loc = m_module_locations.find (moduleName);
+      ctx.isDirected = loc != m_module_locations.end () && loc->second.expires > Simulator::Now ();
+      if (ctx.isDirected)
+        {
+          ctx.moduleHolder = loc->second.holder;
+        }
+      else
+        {
+          ctx.isDirected = FindGossipHolder (moduleName, ctx.moduleHolder);
+        }
+
+      SendNextPrefetchRequest (requestId);
+      return;
+    }
+}
+
+void
+CustomApp::SendNextPrefetchRequest (uint64_t requestId)
+{
+  NS_LOG_FUNCTION (this << requestId);
+
+  auto it = m_requests.find (requestId);
+  if (it == m_requests.end ())
+    {
+      return;
+    }
+  auto &ctx = it->second;
+
+  if (!ctx.isDirected)
+    {
+      if (ctx.peerIdx >= m_peerAddresses.size ())
+        {
+          CompletePeerQuery (requestId, false);
+          return;
+        }
+      ctx.moduleHolder = m_peerAddresses[ctx.peerIdx++];
+    }
+
+  WasmFaasHeader loadRequest;
+  loadRequest.SetType (WasmFaasHeader::MODULE_LOAD_REQUEST);
+  loadRequest.SetRequestId (requestId);
+  loadRequest.SetModuleId (WasmFaasHeader::GetNameId (ctx.moduleName));
+
+  NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                            << "SEND_PACKET_MODULE_PREFETCH_REQUEST "
+                            << InetSocketAddress::ConvertFrom (ctx.moduleHolder).GetIpv4 () << " "
+                            << loadRequest);
+  LogEvent (WasmFaasEventLog::SEND_PACKET_MODULE_PREFETCH_REQUEST, requestId,
+            loadRequest.GetModuleId ());
+
+  SendToPeer (BuildPacket (loadRequest, ""), ctx.moduleHolder);
+  ctx.transferStart = Simulator::Now ();
+  ctx.nRetries = 0;
+  ArmRequestTimeout (ctx);
+}
+
+bool
+CustomApp::RemovePendingPeer (RequestContext &ctx, const Address &from)
+{
+  if (!InetSocketAddress::IsMatchingType (from))
+    {
+      return false;
+    }
+
+  auto ip = InetSocketAddress::ConvertFrom (from).GetIpv4 ();
+  for (auto it = ctx.pending.begin (); it != ctx.pending.end (); ++it)
+    {
+      if (IsSamePeer (it->GetIpv4 (), ip))
+        {
+          if (it->GetIpv4 () != ip)
+            {
+              NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds ()
+                                        << " PEER_ANSWERED_FROM_OTHER_ADDRESS "
+                                        << it->GetIpv4 () << " " << ip << " " << ctx.requestId);
+              LogEvent (WasmFaasEventLog::PEER_ANSWERED_FROM_OTHER_ADDRESS, ctx.requestId,
+                        WasmFaasHeader::GetNameId (ctx.moduleName));
+            }
+          ctx.pending.erase (it);
+          return true;
+        }
+    }
+
+  NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds ()
+                            << " IGNORED_ANSWER_NOT_PENDING " << ip << " " << ctx.requestId);
+  LogEvent (WasmFaasEventLog::IGNORED_ANSWER_NOT_PENDING, ctx.requestId,
+            WasmFaasHeader::GetNameId (ctx.moduleName));
+  return false;
+}
+
+uint32_t
+CustomApp::GetAddressOwner (Ipv4Address address)
+{
+  auto it = m_address_owners.find (address);
+  if (it != m_address_owners.end ())
+    {
+      return it->second;
+    }
+
+  // Addresses do not move between nodes, so the owner is looked up once
+  uint32_t owner = NodeList::GetNNodes ();
+  for (auto node = NodeList::Begin (); node != NodeList::End (); ++node)
+    {
+      auto ipv4 = (*node)->GetObject<Ipv4> ();
+      if (ipv4 != 0 && ipv4->GetInterfaceForAddress (address) >= 0)
+        {
+          owner = (*node)->GetId ();
+          break;
+        }
+    }
+  m_address_owners[address] = owner;
+  return owner;
+}
+
+bool
+CustomApp::IsSamePeer (Ipv4Address a, Ipv4Address b)
+{
+  if (a == b)
+    {
+      return true;
+    }
+  auto owner = GetAddressOwner (a);
+  return owner != NodeList::GetNNodes () && owner == GetAddressOwner (b);
+}
+
+void
+CustomApp::ArmRequestTimeout (RequestContext &ctx)
+{
+  ctx.timeoutEvent.Cancel ();
+  if (!m_request_timeout.IsStrictlyPositive ())
+    {
+      return;
+    }
+
+  auto timeout = Seconds (m_request_timeout.GetSeconds () *
+                          std::pow (m_request_retry_backoff, ctx.nRetries));
+  ctx.timeoutEvent =
+      Simulator::Schedule (timeout, &CustomApp::HandleRequestTimeout, this, ctx.requestId);
+}
+
+void
+CustomApp::HandleRequestTimeout (uint64_t requestId)
+{
+  NS_LOG_FUNCTION (this << requestId);
+
+  auto it = m_requests.find (requestId);
+  if (it == m_requests.end ())
+    {
+      return;
+    }
+  auto &ctx = it->second;
+
+  if (ctx.nRetries >= m_request_retries)
+    {
+      NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                << "REQUEST_TIMED_OUT " << ctx.moduleName << " " << requestId);
+      LogEvent (WasmFaasEventLog::REQUEST_TIMED_OUT, requestId,
+                WasmFaasHeader::GetNameId (ctx.moduleName));
+
+      m_timedOut++;
+      if (ctx.isPrefetch)
+        {
+          // A silent peer counts as lacking the module
+          ctx.isDirected = false;
+          SendNextPrefetchRequest (requestId);
+          return;
+        }
+      if (ctx.hasResult || ctx.isWaitingForModuleLoad)
+        {
+          // The result is already known when only the module transfer stalled
+          CompletePeerQuery (requestId, ctx.hasResult, WasmFaasResult::TIMED_OUT);
+          return;
+        }
+
+      // Count the silent peers as not holding the module and go on with the others
+      ctx.timedOut = true;
+      ctx.isDirected = false;
+      ctx.pending.clear ();
+      ctx.nOutstanding = 0;
+      SendNextPeerQuery (requestId);
+      return;
+    }
+
+  ctx.nRetries++;
+
+  // The requester of a forwarded request retries it end to end, see ResendPendingRequest
+  if (ctx.isForwarded && !ctx.isWaitingForModuleLoad)
+    {
+      ArmRequestTimeout (ctx);
+      return;
+    }
+
+  NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                            << "REQUEST_RETRIED " << ctx.moduleName << " " << requestId << " "
+                            << ctx.nRetries);
+  LogEvent (WasmFaasEventLog::REQUEST_RETRIED, requestId,
+            WasmFaasHeader::GetNameId (ctx.moduleName));
+
+  if (ctx.isWaitingForModuleLoad)
+    {
+      WasmFaasHeader loadRequest;
+      loadRequest.SetType (WasmFaasHeader::MODULE_LOAD_REQUEST);
+      loadRequest.SetRequestId (requestId);
+      loadRequest.SetModuleId (WasmFaasHeader::GetNameId (ctx.moduleName));
+      SendToPeer (BuildPacket (loadRequest, ""), ctx.moduleHolder);
+    }
+  else
+    {
+      ResendPendingRequest (ctx);
+    }
+  ArmRequestTimeout (ctx);
+}
+
+void
+CustomApp::ResendPendingRequest (RequestContext &ctx)
+{
+  auto request = BuildExecuteRequest (ctx);
+  auto p = BuildPacket (request, "");
+  for (auto &peer : ctx.pending)
+    {
+      SendToPeer (p->Copy (), peer);
+    }
+}
+
+void
+CustomApp::RememberAnswer (const WasmFaasHeader &response)
+{
+  auto window = GetDuplicateWindow ();
+  if (!window.IsStrictlyPositive ())
+    {
+      return;
+    }
+
+  ExpireAnswers ();
+  auto inserted = m_answers.emplace (response.GetRequestId (), response);
+  if (inserted.second)
+    {
+      m_answer_expiry.emplace_back (Simulator::Now () + window, response.GetRequestId ());
+    }
+  else
+    {
+      inserted.first->second = response;
+    }
+}
+
+Time
+CustomApp::GetDuplicateWindow (void) const
+{
+  if (!m_duplicate_window.IsStrictlyNegative ())
+    {
+      return m_duplicate_window;
+    }
+
+  // The requester sends its last retry before the sum of its timeouts
+  double horizon = 0;
+  for (uint32_t i = 0; i <= m_request_retries; i++)
+    {
+      horizon += m_request_timeout.GetSeconds () * std::pow (m_request_retry_backoff, i);
+    }
+  return Seconds (horizon);
+}
+
+void
+CustomApp::ExpireAnswers (void)
+{
+  while (!m_answer_expiry.empty () && m_answer_expiry.front ().first <= Simulator::Now ())
+    {
+      m_answers.erase (m_answer_expiry.front ().second);
+      m_answer_expiry.pop_front ();
+    }
+}
+
+uint32_t
+CustomApp::PickNextPeer (RequestContext &ctx)
+{
+  NS_LOG_FUNCTION (this << ctx.requestId);
+
+  if (m_peer_selection == ORDERED_SELECTION || ctx.candidates.empty ())
+    {
+      return ctx.peerIdx;
+    }
+
+  // Candidates are unordered, the picked one is swapped with the last and popped
+  uint32_t pick = 0;
+  if (m_peer_selection == LEAST_LOADED_SELECTION)
+    {
+      for (uint32_t i = 1; i < ctx.candidates.size (); i++)
+        {
+          if (GetPeerScore (m_peerAddresses[ctx.candidates[i]].GetIpv4 ()) <
+              GetPeerScore (m_peerAddresses[ctx.candidates[pick]].GetIpv4 ()))
+            {
+              pick = i;
+            }
+        }
+    }
+  else if (ctx.candidates.size () > 1)
+    {
+      uint32_t n = ctx.candidates.size ();
+      uint32_t a = m_peer_chooser->GetInteger (0, n - 1);
+      uint32_t b = m_peer_chooser->GetInteger (0, n - 2);
+      if (b >= a)
+        {
+          b++;
+        }
+      pick = GetPeerScore (m_peerAddresses[ctx.candidates[b]].GetIpv4 ()) <
+                     GetPeerScore (m_peerAddresses[ctx.candidates[a]].GetIpv4 ())
+                 ? b
+                 : a;
+    }
+
+  auto peerIdx = ctx.candidates[pick];
+  ctx.candidates[pick] = ctx.candidates.back ();
+  ctx.candidates.pop_back ();
+  return peerIdx;
+}
+
+Time
+CustomApp::GetPeerScore (Ipv4Address peer) const
+{
+  auto it = m_peer_scores.find (peer);
+  if (it == m_peer_scores.end ())
+    {
+      return Time (0);
+    }
+  auto &score = it->second;
+  double load = score.queueDepth + score.utilization / 100.0;
+  return score.rtt + Seconds (m_peer_load_cost.GetSeconds () * load);
+}
+
+void
+CustomApp::UpdatePeerLoad (const Address &from, const WasmFaasHeader &header)
+{
+  // The text protocol does not carry the load
+  if (m_text_protocol || !InetSocketAddress::IsMatchingType (from))
+    {
+      return;
+    }
+
+  auto &score = m_peer_scores[InetSocketAddress::ConvertFrom (from).GetIpv4 ()];
+  score.queueDepth = header.GetQueueDepth ();
+  score.utilization = header.GetUtilization ();
+}
+
+void
+CustomApp::UpdatePeerRtt (RequestContext &ctx, const Address &from)
+{
+  if (!InetSocketAddress::IsMatchingType (from))
+    {
+      return;
+    }
+
+  // Scored under the address the peer was queried at
+  auto ip = InetSocketAddress::ConvertFrom (from).GetIpv4 ();
+  auto it = std::find_if (ctx.awaiting.begin (), ctx.awaiting.end (),
+                          [this, ip] (Ipv4Address peer) { return IsSamePeer (peer, ip); });
+  if (it == ctx.awaiting.end ())
+    {
+      return;
+    }
+  auto peer = *it;
+  ctx.awaiting.erase (it);
+
+  auto sample = Simulator::Now () - ctx.queryStart;
+  auto &score = m_peer_scores[peer];
+  if (score.hasRtt)
+    {
+      score.rtt = Seconds ((1 - m_peer_rtt_alpha) * score.rtt.GetSeconds () +
+                           m_peer_rtt_alpha * sample.GetSeconds ());
+    }
+  else
+    {
+      score.rtt = sample;
+      score.hasRtt = true;
+    }
+}
+
+void
+CustomApp::SetLoad (WasmFaasHeader &header) const
+{
+  header.SetQueueDepth (std::min<size_t> (m_execution_queue.size (), UINT16_MAX));
+  header.SetUtilization (m_execution_cost_model == 0 ? 0 : m_busy_slots * 100 / m_execution_slots);
+}
+
+void
+CustomApp::CompletePeerQuery (uint64_t requestId, bool found, WasmFaasResult::Status failure)
+{
+  NS_LOG_FUNCTION (this << requestId << found);
+
+  auto it = m_requests.find (requestId);
+  if (it == m_requests.end ())
+    {
+      return;
+    }
+  auto &ctx = it->second;
+  ctx.timeoutEvent.Cancel ();
+
+  if (ctx.isPrefetch)
+    {
+      if (!found)
+        {
+          NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                    << "PREFETCH_FAILED " << ctx.moduleName << " " << requestId);
+          LogEvent (WasmFaasEventLog::PREFETCH_FAILED, requestId,
+                    WasmFaasHeader::GetNameId (ctx.moduleName));
+        }
+      RemoveRequest (it);
+      TryPrefetch ();
+      return;
+    }
+
+  if (found)
+    {
+      StoreMemo (ctx.moduleName, ctx.funcName, ctx.args, ctx.result);
+    }
+
+  if (ctx.isForwarded)
+    {
+      WasmFaasHeader response;
+      response.SetRequestId (requestId);
+      response.SetModuleId (WasmFaasHeader::GetNameId (ctx.moduleName));
+      if (found)
+        {
+          response.SetType (WasmFaasHeader::EXECUTE_RESULT);
+          if (ctx.result.status == WasmFaasResult::OK)
+            {
+              response.AddArg (ctx.result.value);
+            }
+
+          NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds ()
+                                    << " SEND_PACKET_EXECUTE_MODULE_RESULT_FROM_PEER "
+                                    << response);
+          LogEvent (WasmFaasEventLog::SEND_PACKET_EXECUTE_MODULE_RESULT_FROM_PEER, requestId,
+                    response.GetModuleId ());
+        }
+      else
+        {
+          response.SetType (WasmFaasHeader::NOT_FOUND);
+
+          NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                    << "SENT_PACKET_PEER_MODULE_QUERY_NOT_FOUND " << response);
+          LogEvent (WasmFaasEventLog::SENT_PACKET_PEER_MODULE_QUERY_NOT_FOUND, requestId,
+                    response.GetModuleId ());
+        }
+
+      RememberAnswer (response);
+      SendBatched (m_socket, BuildPacket (response, ""), ctx.requester);
+      RemoveRequest (it);
+      TryPrefetch ();
+    }
+  else
+    {
+      auto result = found ? ctx.result : WasmFaasResult{failure, WasmFaasValue{}};
+      result.requestId = requestId;
+
+      NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                << "EXECUTE_MODULE_REQUEST_PEER_RESULT " << ctx.moduleName << " "
+                                << ctx.funcName << " " << requestId << " "
+                                << FormatResult (result));
+      LogEvent (WasmFaasEventLog::EXECUTE_MODULE_REQUEST_PEER_RESULT, requestId,
+                WasmFaasHeader::GetNameId (ctx.moduleName));
+
+      // The InvocationCompleted callbacks may make new requests
+      RemoveRequest (it);
+      CompleteInvocation (result);
+      TryPrefetch ();
+    }
+}
+
+void
+CustomApp::RegisterNode (Ipv4Address address, uint16_t port)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_peerAddresses.push_back (InetSocketAddress (address, port));
+
+  NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                            << "REGISTER_NODE " << address << ":" << port);
+  LogEvent (WasmFaasEventLog::REGISTER_NODE, 0, 0);
+}
+
+uint64_t
+CustomApp::GetNodeId (void)
+{
+  return m_runtime_id;
+}
+void
+CustomApp::StartApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  InitRuntime ();
+  if (m_module_cache_policy == 0)
+    {
+      m_module_cache_policy = CreateObject<LruWasmModuleCachePolicy> ();
+    }
+  if (m_socket == 0)
+    {
+      TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+      m_socket = Socket::CreateSocket (GetNode (), tid);
+      InetSocketAddress local = InetSocketAddress (Ipv4Address::GetAny (), m_port);
+      if (m_socket->Bind (local) == -1)
+        {
+          NS_FATAL_ERROR ("Failed to bind socket");
+        }
+    }
+
+  m_socket->SetRecvCallback (MakeCallback (&CustomApp::HandleRead, this));
+  m_batcher.SetWindow (m_text_protocol ? Seconds (0) : m_batch_window, m_batch_max_size);
+
+  // Random first rounds keep the nodes from gossiping in lockstep
+  if (m_gossip_interval.IsStrictlyPositive () && !m_text_protocol)
+    {
+      m_gossip_event = Simulator::Schedule (
+          Seconds (m_peer_chooser->GetValue (0, m_gossip_interval.GetSeconds ())),
+          &CustomApp::Gossip, this);
+    }
+}
+
+double
+CustomApp::GetCurrentNodeXPosition (void)
+{
+  return 0.0;
+}
+
+void
+CustomApp::StopApplication ()
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_socket != 0)
+    {
+      m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket>> ());
+    }
+  if (m_query_socket != 0)
+    {
+      m_query_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket>> ());
+    }
+  Simulator::Cancel (m_gossip_event);
+  for (auto &entry : m_requests)
+    {
+      entry.second.timeoutEvent.Cancel ();
+    }
+  m_workflows.Clear ();
+  m_batcher.Clear ();
+  for (auto &entry : m_module_transfers)
+    {
+      entry.second.retransmitEvent.Cancel ();
+    }
+}
+
+bool
+CustomApp::RegisterWasmModule (char *name, char *data_base64)
+{
+  NS_LOG_FUNCTION (this);
+  InitRuntime ();
+
+  // Peers could not tell the module from the other name of its ID
+  if (!WasmFaasHeader::RegisterName (name))
+    {
+      NS_LOG_WARN ("Cannot register module " << name << ", its ID is taken");
+      return false;
+    }
+
+  NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                            << "REGISTER_MODULE " << name);
+  LogEvent (WasmFaasEventLog::REGISTER_MODULE, 0, WasmFaasHeader::GetNameId (name),
+            GetBase64DecodedSize (data_base64));
+  if (!WasmModuleStore::Register (m_runtime_id, name, data_base64))
+    {
+      return false;
+    }
+  m_pinned_modules.insert (name);
+  return true;
+}
+
+bool
+CustomApp::IsModuleAvailable (const std::string &module_name)
+{
+  if (m_pinned_modules.count (module_name) == 0 &&
+      (m_module_cache_policy == 0 || !m_module_cache_policy->Contains (module_name)))
+    {
+      return false;
+    }
+  return is_module_registered (m_runtime_id, module_name.c_str ());
+}
+
+WasmFaasResult
+CustomApp::RunModule (const std::string &module_name, const std::string &func_name,
+                      const std::vector<WasmFaasValue> &args)
+{
+  NS_LOG_FUNCTION (this << module_name << func_name);
+
+  if (m_module_cache_policy != 0)
+    {
+      m_module_cache_policy->Access (module_name);
+    }
+
+  auto result = WasmFaasResult{WasmFaasResult::FAILED, WasmFaasValue{ArgType::I32, 0, 0}};
+  m_last_run_duration = Time (0);
+
+  // Pass the values in binary form when the runtime has the typed entry point
+  if (execute_module_typed != nullptr)
+    {
+      WasmValue values[WasmFaasHeader::MAX_ARGS];
+      uintptr_t nValues = std::min (args.size (), (size_t) WasmFaasHeader::MAX_ARGS);
+      for (uintptr_t i = 0; i < nValues; i++)
+        {
+          values[i] = WasmValue{args[i].type, args[i].lo, args[i].hi};
+        }
+
+      WasmValue out{ArgType::I32, 0, 0};
+      auto start = std::chrono::steady_clock::now ();
+      auto status = execute_module_typed (m_runtime_id, module_name.c_str (), func_name.c_str (),
+                                          values, nValues, &out);
+      m_last_run_duration = NanoSeconds (std::chrono::duration_cast<std::chrono::nanoseconds> (
+                                             std::chrono::steady_clock::now () - start)
+                                             .count ());
+      if (status == 0)
+        {
+          result.status = WasmFaasResult::OK;
+          result.value = WasmFaasValue{out.value_type, out.lo, out.hi};
+        }
+      return result;
+    }
+
+  // The legacy entry point takes exactly two values as decimal strings and
+  // returns an I32
+  if (args.size () != 2 || args[0].type == ArgType::V128 || args[1].type == ArgType::V128)
+    {
+      NS_LOG_WARN ("The runtime only runs functions of two scalar arguments");
+      return result;
+    }
+
+  std::string argStrings[2];
+  auto func = WasmFunction{};
+  func.name = func_name.c_str ();
+  for (size_t i = 0; i < 2; i++)
+    {
+      std::ostringstream oss;
+      oss << args[i];
+      argStrings[i] = oss.str ();
+      func.args[i] = WasmArg{argStrings[i].c_str (), args[i].type};
+    }
+
+  auto start = std::chrono::steady_clock::now ();
+  result.status = WasmFaasResult::OK;
+  result.value = WasmFaasValue::FromI32 (execute_module (m_runtime_id, module_name.c_str (), func));
+  m_last_run_duration = NanoSeconds (std::chrono::duration_cast<std::chrono::nanoseconds> (
+                                         std::chrono::steady_clock::now () - start)
+                                         .count ());
+  return result;
+}
+
+/**
+ * \brief Build the memo cache key of an invocation.
+ * \param key filled with the module, function and argument bytes
+ * \param module_name the module holding the function
+ * \param func_name the function
+ * \param args the function arguments
+ */
+static void
+BuildMemoKey (std::string &key, const std::string &module_name, const std::string &func_name,
+              const std::vector<WasmFaasValue> &args)
+{
+  key.clear ();
+  key.append (module_name);
+  key.push_back ('\0');
+  key.append (func_name);
+  key.push_back ('\0');
+  for (const auto &arg : args)
+    {
+      char bytes[1 + 2 * sizeof (uint64_t)];
+      bytes[0] = (char) arg.type;
+      std::memcpy (bytes + 1, &arg.lo, sizeof (uint64_t));
+      std::memcpy (bytes + 1 + sizeof (uint64_t), &arg.hi, sizeof (uint64_t));
+      key.append (bytes, sizeof (bytes));
+    }
+}
+
+void
+CustomApp::SetModulePure (const std::string &module_name, bool pure)
+{
+  NS_LOG_FUNCTION (this << module_name << pure);
+
+  if (pure)
+    {
+      m_pure_modules.insert (module_name);
+      return;
+    }
+
+  m_pure_modules.erase (module_name);
+  auto prefix = module_name + '\0';
+  for (auto it = m_memo_lru.begin (); it != m_memo_lru.end ();)
+    {
+      if (it->first.compare (0, prefix.size (), prefix) == 0)
+        {
+          m_memo_index.erase (it->first);
+          it = m_memo_lru.erase (it);
+        }
+      else
+        {
+          ++it;
+        }
+    }
+}
+
+bool
+CustomApp::IsModulePure (const std::string &module_name) const
+{
+  return m_pure_modules.count (module_name) > 0;
+}
+
+void
+CustomApp::SetPureModules (std::string modules)
+{
+  NS_LOG_FUNCTION (this << modules);
+
+  for (const auto &name : std::vector<std::string> (m_pure_modules.begin (),
+                                                     m_pure_modules.end ()))
+    {
+      SetModulePure (name, false);
+    }
+
+  std::istringstream iss (modules);
+  std::string name;
+  while (std::getline (iss, name, ';'))
+    {
+      if (!name.empty ())
+        {
+          SetModulePure (name, true);
+        }
+    }
+}
+
+std::string
+CustomApp::GetPureModules (void) const
+{
+  std::string modules;
+  for (const auto &name : m_pure_modules)
+    {
+      if (!modules.empty ())
+        {
+          modules += ';';
+        }
+      modules += name;
+    }
+  return modules;
+}
+
+bool
+CustomApp::LookupMemo (const std::string &module_name, const std::string &func_name,
+                       const std::vector<WasmFaasValue> &args, WasmFaasValue &value)
+{
+  NS_LOG_FUNCTION (this << module_name << func_name);
+
+  if (m_memo_cache_size == 0 || !IsModulePure (module_name))
+    {
+      return false;
+    }
+
+  BuildMemoKey (m_memo_key, module_name, func_name, args);
+  m_memo_lookups++;
+  auto it = m_memo_index.find (m_memo_key);
+  if (it != m_memo_index.end ())
+    {
+      m_memo_hits++;
+      m_memo_lru.splice (m_memo_lru.begin (), m_memo_lru, it->second);
+      value = it->second->second;
+    }
+  m_memoHitRatio = (double) m_memo_hits / m_memo_lookups;
+  return it != m_memo_index.end ();
+}
+
+void
+CustomApp::StoreMemo (const std::string &module_name, const std::string &func_name,
+                      const std::vector<WasmFaasValue> &args, const WasmFaasResult &result)
+{
+  NS_LOG_FUNCTION (this << module_name << func_name);
+
+  if (m_memo_cache_size == 0 || result.status != WasmFaasResult::OK ||
+      !IsModulePure (module_name))
+    {
+      return;
+    }
+
+  BuildMemoKey (m_memo_key, module_name, func_name, args);
+  auto it = m_memo_index.find (m_memo_key);
+  if (it != m_memo_index.end ())
+    {
+      it->second->second = result.value;
+      m_memo_lru.splice (m_memo_lru.begin (), m_memo_lru, it->second);
+      return;
+    }
+
+  while (m_memo_lru.size () >= m_memo_cache_size)
+    {
+      m_memo_index.erase (m_memo_lru.back ().first);
+      m_memo_lru.pop_back ();
+    }
+  m_memo_lru.emplace_front (m_memo_key, result.value);
+  m_memo_index.emplace (m_memo_key, m_memo_lru.begin ());
+}
+
+int32_t
+CustomApp::ExecuteModule (char *module_name, char *func_name, int32_t arg1, int32_t arg2)
+{
+  NS_LOG_FUNCTION (this);
+
+  auto result = ExecuteFunction (std::string (module_name), std::string (func_name),
+                                 {WasmFaasValue::FromI32 (arg1), WasmFaasValue::FromI32 (arg2)});
+  return result.status == WasmFaasResult::OK ? result.value.GetI32 () : 0;
+}
+
+WasmFaasResult
+CustomApp::ExecuteFunction (const std::string &module_name, const std::string &func_name,
+                            const std::vector<WasmFaasValue> &args, uint8_t priority)
+{
+  NS_LOG_FUNCTION (this << module_name << func_name);
+
+  auto requestId = NewRequestId ();
+
+  NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                            << "INIT_EXECUTE_MODULE_REQUEST " << module_name << " " << func_name
+                            << FormatArgs (args));
+  LogEvent (WasmFaasEventLog::INIT_EXECUTE_MODULE_REQUEST, requestId,
+            WasmFaasHeader::GetNameId (module_name));
+  m_invocations[requestId] = std::make_pair (module_name, Simulator::Now ());
+  m_invocationStartTrace (requestId, module_name);
+
+  // The text protocol carries every value as a decimal I32
+  auto isI32 = [] (const WasmFaasValue &arg) { return arg.type == ArgType::I32; };
+  if (args.size () > WasmFaasHeader::MAX_ARGS ||
+      (m_text_protocol && !std::all_of (args.begin (), args.end (), isI32)) ||
+      !WasmFaasHeader::RegisterName (module_name) || !WasmFaasHeader::RegisterName (func_name))
+    {
+      NS_LOG_WARN ("A function takes at most " << +WasmFaasHeader::MAX_ARGS
+                                               << " arguments, I32 only in the text protocol, "
+                                               << "and names whose ID no other name has");
+      auto failed = WasmFaasResult{WasmFaasResult::FAILED, WasmFaasValue{ArgType::I32, 0, 0},
+                                   requestId};
+      CompleteInvocation (failed);
+      return failed;
+    }
+
+  UpdateModulePredictor (module_name);
+  auto result = StartInvocation (requestId, module_name, func_name, args, priority);
+  TryPrefetch ();
+  return result;
+}
+
+WasmFaasResult
+CustomApp::StartInvocation (uint64_t requestId, const std::string &module_name,
+                            const std::string &func_name, const std::vector<WasmFaasValue> &args,
+                            uint8_t priority)
+{
+  NS_LOG_FUNCTION (this << requestId << module_name << func_name);
+
+  auto pending =
+      WasmFaasResult{WasmFaasResult::PENDING, WasmFaasValue{ArgType::I32, 0, 0}, requestId};
+  auto isInvocation = m_invocations.find (requestId) != m_invocations.end ();
+  if (isInvocation)
+    {
+      m_cold_starts[requestId] = false;
+    }
+
+  // A pure function may have run here or on a peer before, module or not
+  WasmFaasValue memoValue;
+  if (LookupMemo (module_name, func_name, args, memoValue))
+    {
+      auto result = WasmFaasResult{WasmFaasResult::OK, memoValue, requestId};
+
+      NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                << "MEMO_HIT " << module_name << " " << func_name
+                                << FormatArgs (args) << " " << FormatResult (result));
+      LogEvent (WasmFaasEventLog::MEMO_HIT, requestId, WasmFaasHeader::GetNameId (module_name));
+
+      CompleteInvocation (result);
+      return result;
+    }
+
+  if (IsModuleAvailable (module_name))
+    {
+      m_discoveryCompleteTrace (requestId, module_name);
+      if (m_prefetched_modules.erase (module_name))
+        {
+          NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                    << "PREFETCH_HIT " << module_name << " " << requestId);
+          LogEvent (WasmFaasEventLog::PREFETCH_HIT, requestId,
+                    WasmFaasHeader::GetNameId (module_name));
+          m_prefetchHits++;
+        }
+    }
+
+  if (IsModuleAvailable (module_name) && m_execution_cost_model != 0)
+    {
+      Execution execution;
+      execution.requestId = requestId;
+      execution.moduleName = module_name;
+      execution.funcName = func_name;
+      execution.args = args;
+      execution.priority = priority;
+      execution.hopCount = 0;
+      execution.isRemote = false;
+      EnqueueExecution (execution);
+      return pending;
+    }
+  else if (IsModuleAvailable (module_name))
+    {
+      m_executionStartTrace (requestId, module_name);
+      auto result = RunModule (module_name, func_name, args);
+      result.requestId = requestId;
+      m_executionEndTrace (requestId, module_name);
+      StoreMemo (module_name, func_name, args, result);
+
+      NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                << "EXECUTE_MODULE_REQUEST_CACHE_RESULT " << module_name << " "
+                                << func_name << FormatArgs (args) << " "
+                                << FormatResult (result));
+      LogEvent (WasmFaasEventLog::EXECUTE_MODULE_REQUEST_CACHE_RESULT, requestId,
+                WasmFaasHeader::GetNameId (module_name));
+
+      CompleteInvocation (result);
+      return result;
+    }
+  else
+    {
+      // A cold start, the module has to be found on the peers
+      if (isInvocation)
+        {
+          m_cold_starts[requestId] = true;
+        }
+
+      auto &ctx = AddRequest (requestId, false);
+      ctx.moduleName = module_name;
+      ctx.funcName = func_name;
+      ctx.args = args;
+      ctx.priority = priority;
+      ctx.hopCount = 0;
+
+      QueryPeersForModule (requestId);
+      return pending;
+    }
+}
+
+WasmFaasResult
+CustomApp::ExecuteWorkflow (const WasmFaasWorkflow &workflow, uint8_t priority)
+{
+  NS_LOG_FUNCTION (this << workflow.GetName ());
+  NS_ASSERT_MSG (workflow.GetNStages () > 0, "A workflow needs at least one stage");
+
+  auto workflowId = NewRequestId ();
+  auto name = workflow.GetName ();
+
+  NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                            << "INIT_WORKFLOW_REQUEST " << name << " " << workflowId);
+  LogEvent (WasmFaasEventLog::INIT_WORKFLOW_REQUEST, workflowId,
+            WasmFaasHeader::GetNameId (workflow.GetStage (0).moduleName));
+  m_invocations[workflowId] = std::make_pair (name, Simulator::Now ());
+  m_invocationStartTrace (workflowId, name);
+
+  if (m_workflow_timeout.IsStrictlyPositive ())
+    {
+      m_workflows.SetDeadline (workflowId,
+                               Simulator::Schedule (m_workflow_timeout,
+                                                    &CustomApp::HandleWorkflowTimeout, this,
+                                                    workflowId));
+    }
+  m_workflows.Hold (workflowId, workflow, GetLocalAddress (), priority, 0);
+
+  // Stages that run right away complete the workflow before this returns
+  AdvanceWorkflow (workflowId);
+  return WasmFaasResult{WasmFaasResult::PENDING, WasmFaasValue{ArgType::I32, 0, 0}, workflowId};
+}
+
+void
+CustomApp::AdvanceWorkflow (uint64_t workflowId)
+{
+  NS_LOG_FUNCTION (this << workflowId);
+
+  auto entry = m_workflows.Find (workflowId);
+  if (entry == nullptr)
+    {
+      return;
+    }
+  auto &ctx = *entry;
+
+  if (ctx.workflow.IsComplete ())
+    {
+      CompleteWorkflow (workflowId, WasmFaasResult{WasmFaasResult::OK, ctx.workflow.GetResult (),
+                                                   workflowId});
+      return;
+    }
+
+  auto &stage = ctx.workflow.GetStage (ctx.workflow.GetNextStage ());
+
+  // Moving the workflow to a holder spares the module transfer or the result round trip
+  if (!IsModuleAvailable (stage.moduleName) && !m_text_protocol && ctx.hopCount < m_max_hops)
+    {
+      auto loc = m_module_locations.find (stage.moduleName);
+      if (loc != m_module_locations.end () && loc->second.expires <= Simulator::Now ())
+        {
+          m_module_locations.erase (loc);
+          loc = m_module_locations.end ();
+        }
+
+      Address holder;
+      if (loc != m_module_locations.end ())
+        {
+          holder = loc->second.holder;
+        }
+      if (loc != m_module_locations.end () || FindGossipHolder (stage.moduleName, holder))
+        {
+          m_workflows.SetTask (workflowId, NewRequestId (), true, holder);
+          SendWorkflow (workflowId);
+          return;
         }
     }
+
+  m_workflows.SetTask (workflowId, NewRequestId (), false);
+
+  // The stage may complete right away and erase the context
+  StartInvocation (ctx.taskId, stage.moduleName, stage.funcName, ctx.workflow.GetNextArgs (),
+                   ctx.priority);
 }
 
 void
-CustomApp::QueryPeersForModule (char *name)
+CustomApp::FinishWorkflowStage (uint64_t workflowId, const WasmFaasResult &result)
 {
-  NS_LOG_FUNCTION (this);
-  if (m_is_querying_peers)
+  NS_LOG_FUNCTION (this << workflowId);
+
+  // The workflow may have failed meanwhile, or gone on without this stage
+  auto entry = m_workflows.Find (workflowId);
+  if (entry == nullptr || entry->isHandingOver || entry->taskId != result.requestId)
     {
-      Simulator::Schedule (MicroSeconds (m_microseconds_eventloop_interval),
-                           &CustomApp::QueryPeersForModule, this, name);
       return;
     }
+  auto &ctx = *entry;
+  auto &stage = ctx.workflow.GetStage (ctx.workflow.GetNextStage ());
 
-  m_is_querying_peers = true;
+  NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                            << "WORKFLOW_STAGE_COMPLETED " << workflowId << " "
+                            << +ctx.workflow.GetNextStage () << " " << stage.moduleName << " "
+                            << stage.funcName << " " << FormatResult (result));
+  LogEvent (WasmFaasEventLog::WORKFLOW_STAGE_COMPLETED, workflowId,
+            WasmFaasHeader::GetNameId (stage.moduleName));
 
-  if (m_is_querying_peers_idx == 0)
+  if (result.status != WasmFaasResult::OK)
     {
-      NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
-                                << "INIT_QUERY_PEERS_FOR_MODULE " << name << " "
-                                << " ");
+      CompleteWorkflow (workflowId, WasmFaasResult{result.status, WasmFaasValue{}, workflowId});
+      return;
     }
 
-  std::string s;
-  s.append ("e")
-      .append (";")
-      .append (name)
-      .append (";")
-      .append (m_query_peers_func_name)
-      .append (";")
-      .append (std::to_string (m_query_peers_func_args[0]))
-      .append (";")
-      .append (std::to_string (m_query_peers_func_args[1]))
-      .append (";");
+  ctx.workflow.SetNextResult (result.value);
+  AdvanceWorkflow (workflowId);
+}
 
-  const char *c_str = s.c_str ();
+void
+CustomApp::SendWorkflow (uint64_t workflowId)
+{
+  NS_LOG_FUNCTION (this << workflowId);
 
-  size_t len = strlen (c_str);
+  auto &ctx = *m_workflows.Find (workflowId);
 
-  uint8_t *data = new uint8_t[len];
-  memcpy (data, c_str, len);
+  WasmFaasHeader header;
+  header.SetRequestId (ctx.taskId);
+  header.SetHopCount (ctx.hopCount);
+  header.SetPriority (ctx.priority);
+  auto &payload = m_workflow_payload;
+  payload.clear ();
 
-  if (m_is_querying_peers_idx >= m_peerAddresses.size ())
+  if (ctx.hasResult)
     {
-      m_is_querying_peers = false;
-      m_is_querying_peers_idx = 0;
-
-      if (m_peer_module_exec_query_state == 1)
+      auto nStages = ctx.workflow.GetNStages ();
+      header.SetType (WasmFaasHeader::WORKFLOW_RESULT);
+      header.SetModuleId (
+          WasmFaasHeader::GetNameId (ctx.workflow.GetStage (nStages - 1).moduleName));
+      header.AddArg (WasmFaasValue::FromI32 (ctx.result.status));
+      if (ctx.result.status == WasmFaasResult::OK)
         {
-          m_has_module_exec_result = false;
-          m_peer_module_exec_query_state = 2;
+          header.AddArg (ctx.result.value);
         }
-      return;
+
+      NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                << "SEND_PACKET_WORKFLOW_RESULT "
+                                << InetSocketAddress::ConvertFrom (ctx.handOverPeer).GetIpv4 ()
+                                << " " << header);
+      LogEvent (WasmFaasEventLog::SEND_PACKET_WORKFLOW_RESULT, workflowId, header.GetModuleId ());
+    }
+  else
+    {
+      auto &stage = ctx.workflow.GetStage (ctx.workflow.GetNextStage ());
+      auto origin = InetSocketAddress::ConvertFrom (ctx.origin);
+      header.SetType (WasmFaasHeader::WORKFLOW);
+      header.SetModuleId (WasmFaasHeader::GetNameId (stage.moduleName));
+      header.SetFunctionId (WasmFaasHeader::GetNameId (stage.funcName));
+
+      WasmFaasWorkflowTable::SerializeHandOver (workflowId, origin, ctx.workflow, payload);
+
+      NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                << "SEND_PACKET_WORKFLOW "
+                                << InetSocketAddress::ConvertFrom (ctx.handOverPeer).GetIpv4 ()
+                                << " " << workflowId << " " << +ctx.workflow.GetNextStage () << " "
+                                << header);
+      LogEvent (WasmFaasEventLog::SEND_PACKET_WORKFLOW, ctx.taskId, header.GetModuleId (),
+                payload.size ());
     }
 
-  auto peer = m_peerAddresses[m_is_querying_peers_idx];
-  TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
-  auto outSocket = Socket::CreateSocket (GetNode (), tid);
+  SendToPeer (BuildPacket (header, payload), ctx.handOverPeer);
 
-  if (outSocket->Bind () == -1)
+  ctx.timeoutEvent.Cancel ();
+  if (m_request_timeout.IsStrictlyPositive ())
     {
-      NS_FATAL_ERROR ("Failed to bind socket");
+      auto timeout = Seconds (m_request_timeout.GetSeconds () *
+                              std::pow (m_request_retry_backoff, ctx.nRetries));
+      ctx.timeoutEvent = Simulator::Schedule (
+          timeout, &CustomApp::HandleWorkflowHandOverTimeout, this, workflowId);
     }
+}
+
+void
+CustomApp::HandleWorkflowHandOverTimeout (uint64_t workflowId)
+{
+  NS_LOG_FUNCTION (this << workflowId);
 
-  if (outSocket->Connect ((InetSocketAddress (peer.GetIpv4 (), peer.GetPort ()))) == -1)
+  auto entry = m_workflows.Find (workflowId);
+  if (entry == nullptr || !entry->isHandingOver)
     {
-      NS_FATAL_ERROR ("Failed to connect socket");
+      return;
     }
+  auto &ctx = *entry;
+  auto moduleName = ctx.hasResult
+                        ? ctx.workflow.GetName ()
+                        : ctx.workflow.GetStage (ctx.workflow.GetNextStage ()).moduleName;
 
-  auto p = Create<Packet> (data, len);
+  if (ctx.nRetries < m_request_retries)
+    {
+      ctx.nRetries++;
 
-  SeqTsHeader seqTs;
-  seqTs.SetSeq (m_sent);
-  p->AddHeader (seqTs);
+      NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                << "REQUEST_RETRIED " << moduleName << " " << ctx.taskId << " "
+                                << ctx.nRetries);
+      LogEvent (WasmFaasEventLog::REQUEST_RETRIED, ctx.taskId,
+                WasmFaasHeader::GetNameId (moduleName));
+
+      SendWorkflow (workflowId);
+      return;
+    }
 
   NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
-                            << "SEND_PACKET_EXECUTE_MODULE_REQUEST "
-                            << InetSocketAddress::ConvertFrom (peer).GetIpv4 () << " " << data);
+                            << "REQUEST_TIMED_OUT " << moduleName << " " << ctx.taskId);
+  LogEvent (WasmFaasEventLog::REQUEST_TIMED_OUT, ctx.taskId,
+            WasmFaasHeader::GetNameId (moduleName));
+  m_timedOut++;
+  m_workflows.ForgetTask (ctx.taskId);
+
+  // The origin fails the workflow on its own once WorkflowTimeout elapses
+  if (ctx.hasResult)
+    {
+      m_workflows.Release (workflowId);
+      return;
+    }
 
-  outSocket->Send (p);
-  m_peers_queried.push_back (peer);
-  m_is_querying_peers_idx++;
-  m_sent++;
-  Simulator::Schedule (MicroSeconds (m_microseconds_eventloop_interval),
-                       &CustomApp::QueryPeersForModule, this, name);
-  outSocket->SetRecvCallback (MakeCallback (&CustomApp::QueryPeersCallback, this));
-  //}
+  // Forget the silent holder so the stage runs here or on a peer that answers
+  m_module_locations.erase (moduleName);
+  auto digest =
+      m_peer_digests.find (InetSocketAddress::ConvertFrom (ctx.handOverPeer).GetIpv4 ());
+  if (digest != m_peer_digests.end ())
+    {
+      digest->second.misses.insert (WasmFaasHeader::GetNameId (moduleName));
+    }
+  ctx.isHandingOver = false;
+  AdvanceWorkflow (workflowId);
 }
 
 void
-CustomApp::RegisterNode (Ipv4Address address, uint16_t port)
+CustomApp::CompleteWorkflow (uint64_t workflowId, const WasmFaasResult &result)
 {
-  NS_LOG_FUNCTION (this);
+  NS_LOG_FUNCTION (this << workflowId);
 
-  m_peerAddresses.push_back (InetSocketAddress (address, port));
+  auto entry = m_workflows.Find (workflowId);
+  if (entry == nullptr)
+    {
+      return;
+    }
 
-  NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
-                            << "REGISTER_NODE " << address << ":" << port);
+  if (entry->origin == Address (GetLocalAddress ()))
+    {
+      m_workflows.Release (workflowId);
+      FinishWorkflow (result);
+      return;
+    }
+
+  // The result is handed over to the origin, the workflow ID as request ID
+  entry->hasResult = true;
+  entry->result = result;
+  m_workflows.SetTask (workflowId, workflowId, true, entry->origin);
+  SendWorkflow (workflowId);
 }
 
-uint64_t
-CustomApp::GetNodeId (void)
+void
+CustomApp::FinishWorkflow (const WasmFaasResult &result)
 {
-  return m_runtime_id;
+  NS_LOG_FUNCTION (this << result.requestId);
+
+  // A result arriving after WorkflowTimeout, or twice, is dropped
+  if (m_invocations.find (result.requestId) == m_invocations.end ())
+    {
+      return;
+    }
+  m_workflows.CancelDeadline (result.requestId);
+  CompleteInvocation (result);
 }
+
 void
-CustomApp::StartApplication (void)
+CustomApp::HandleWorkflowTimeout (uint64_t workflowId)
 {
-  NS_LOG_FUNCTION (this);
+  NS_LOG_FUNCTION (this << workflowId);
 
-  InitRuntime ();
-  if (m_socket == 0)
+  // A stage still running here finds no workflow to go on with
+  m_workflows.CancelDeadline (workflowId);
+  m_workflows.Release (workflowId);
+
+  NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                            << "REQUEST_TIMED_OUT " << workflowId);
+  LogEvent (WasmFaasEventLog::REQUEST_TIMED_OUT, workflowId, 0);
+  m_timedOut++;
+
+  CompleteInvocation (
+      WasmFaasResult{WasmFaasResult::TIMED_OUT, WasmFaasValue{ArgType::I32, 0, 0}, workflowId});
+}
+
+InetSocketAddress
+CustomApp::GetLocalAddress (void) const
+{
+  auto ipv4 = GetNode ()->GetObject<Ipv4> ();
+  for (uint32_t i = 0; ipv4 != 0 && i < ipv4->GetNInterfaces (); i++)
     {
-      TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
-      m_socket = Socket::CreateSocket (GetNode (), tid);
-      InetSocketAddress local = InetSocketAddress (Ipv4Address::GetAny (), m_port);
-      if (m_socket->Bind (local) == -1)
+      for (uint32_t j = 0; j < ipv4->GetNAddresses (i); j++)
         {
-          NS_FATAL_ERROR ("Failed to bind socket");
+          auto address = ipv4->GetAddress (i, j).GetLocal ();
+          if (!address.IsLocalhost ())
+            {
+              return InetSocketAddress (address, m_port);
+            }
         }
     }
-
-  m_socket->SetRecvCallback (MakeCallback (&CustomApp::HandleRead, this));
+  return InetSocketAddress (Ipv4Address::GetLoopback (), m_port);
 }
 
-double
-CustomApp::GetCurrentNodeXPosition (void)
+void
+CustomApp::EnqueueExecution (Execution execution)
 {
-  return 0.0;
+  NS_LOG_FUNCTION (this << execution.requestId);
+
+  if (m_busy_slots < m_execution_slots)
+    {
+      execution.enqueued = Simulator::Now ();
+      StartExecution (execution);
+      return;
+    }
+
+  if (m_max_queue_size > 0 && m_execution_queue.size () >= m_max_queue_size)
+    {
+      RejectExecution (execution);
+      return;
+    }
+
+  // FIFO keys only differ by arrival order, priority keys put higher priorities first
+  auto order = m_queue_discipline == PRIORITY_QUEUE ? 255 - execution.priority : 0;
+  execution.enqueued = Simulator::Now ();
+  m_execution_queue.emplace (std::make_pair ((uint32_t) order, m_next_execution_seq++),
+                             execution);
+  m_queueDepth = m_execution_queue.size ();
+
+  NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                            << "EXECUTION_QUEUED " << execution.moduleName << " "
+                            << execution.funcName << " " << execution.requestId << " "
+                            << m_execution_queue.size ());
+  LogEvent (WasmFaasEventLog::EXECUTION_QUEUED, execution.requestId,
+            WasmFaasHeader::GetNameId (execution.moduleName));
 }
 
 void
-CustomApp::StopApplication ()
+CustomApp::RejectExecution (const Execution &execution)
 {
-  NS_LOG_FUNCTION (this);
+  NS_LOG_FUNCTION (this << execution.requestId);
 
-  if (m_socket != 0)
+  m_rejected++;
+
+  if (m_overflow_action == FORWARD_OVERFLOW && !m_peerAddresses.empty () &&
+      execution.hopCount <= m_max_hops)
     {
-      m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket>> ());
+      NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                << "EXECUTION_FORWARDED " << execution.moduleName << " "
+                                << execution.funcName << " " << execution.requestId);
+      LogEvent (WasmFaasEventLog::EXECUTION_FORWARDED, execution.requestId,
+                WasmFaasHeader::GetNameId (execution.moduleName));
+
+      auto &ctx = AddRequest (execution.requestId, execution.isRemote);
+      ctx.moduleName = execution.moduleName;
+      ctx.funcName = execution.funcName;
+      ctx.args = execution.args;
+      ctx.priority = execution.priority;
+      ctx.hopCount = execution.hopCount;
+      ctx.requester = execution.requester;
+      m_remote_executions.erase (execution.requestId);
+
+      QueryPeersForModule (execution.requestId);
+      return;
     }
+
+  NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                            << "EXECUTION_REJECTED " << execution.moduleName << " "
+                            << execution.funcName << " " << execution.requestId);
+  LogEvent (WasmFaasEventLog::EXECUTION_REJECTED, execution.requestId,
+            WasmFaasHeader::GetNameId (execution.moduleName));
+
+  auto failed = WasmFaasResult{WasmFaasResult::FAILED, WasmFaasValue{ArgType::I32, 0, 0}};
+  DeliverExecutionResult (execution, failed);
 }
 
 void
-CustomApp::RegisterWasmModule (char *name, char *data_base64)
+CustomApp::StartExecution (const Execution &execution)
 {
-  NS_LOG_FUNCTION (this);
-  InitRuntime ();
+  NS_LOG_FUNCTION (this << execution.requestId);
+
+  m_executionStartTrace (execution.requestId, execution.moduleName);
+
+  // The result is computed now and delivered once the cost has elapsed
+  auto result = RunModule (execution.moduleName, execution.funcName, execution.args);
+  auto cost = m_execution_cost_model->GetCost (execution.moduleName, execution.funcName,
+                                               m_last_run_duration);
+  m_busy_slots++;
+  m_queueWait = Simulator::Now () - execution.enqueued;
 
   NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
-                            << "REGISTER_MODULE " << name);
-  register_module (m_runtime_id, name, data_base64);
+                            << "EXECUTION_STARTED " << execution.moduleName << " "
+                            << execution.funcName << " " << execution.requestId << " "
+                            << cost.GetMicroSeconds ());
+  LogEvent (WasmFaasEventLog::EXECUTION_STARTED, execution.requestId,
+            WasmFaasHeader::GetNameId (execution.moduleName));
+
+  Simulator::Schedule (cost, &CustomApp::FinishExecution, this, execution, result);
 }
 
-int32_t
-CustomApp::ExecuteModule (char *module_name, char *func_name, int32_t arg1, int32_t arg2)
+void
+CustomApp::FinishExecution (Execution execution, WasmFaasResult result)
 {
-  NS_LOG_FUNCTION (this);
-
-  NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
-                            << "INIT_EXECUTE_MODULE_REQUEST " << module_name << " " << func_name
-                            << " " << arg1 << " " << arg2);
+  NS_LOG_FUNCTION (this << execution.requestId);
 
-  m_query_peers_func_name = std::string (func_name);
-  m_query_peers_func_args = std::vector<int32_t> (2);
-  m_query_peers_func_args[0] = arg1;
-  m_query_peers_func_args[1] = arg2;
+  m_executionEndTrace (execution.requestId, execution.moduleName);
+  StoreMemo (execution.moduleName, execution.funcName, execution.args, result);
+  DeliverExecutionResult (execution, result);
 
-  if (is_module_registered (m_runtime_id, module_name))
+  m_busy_slots--;
+  if (!m_execution_queue.empty ())
     {
-      auto func = WasmFunction{};
-      func.name = m_query_peers_func_name.c_str ();
+      auto next = m_execution_queue.begin ()->second;
+      m_execution_queue.erase (m_execution_queue.begin ());
+      m_queueDepth = m_execution_queue.size ();
+      StartExecution (next);
+    }
+}
 
-      auto arg1s = std::to_string (m_query_peers_func_args[0]);
-      auto arg2s = std::to_string (m_query_peers_func_args[1]);
+void
+CustomApp::DeliverExecutionResult (const Execution &execution, const WasmFaasResult &result)
+{
+  NS_LOG_FUNCTION (this << execution.requestId);
 
-      func.args[0] = WasmArg{
-          arg1s.c_str (),
-          ArgType::I32,
-      };
-      func.args[1] = WasmArg{
-          arg2s.c_str (),
-          ArgType::I32,
-      };
+  if (execution.isRemote)
+    {
+      WasmFaasHeader response;
+      response.SetType (WasmFaasHeader::EXECUTE_RESULT);
+      response.SetRequestId (execution.requestId);
+      response.SetModuleId (WasmFaasHeader::GetNameId (execution.moduleName));
+      if (result.status == WasmFaasResult::OK)
+        {
+          response.AddArg (result.value);
+        }
 
-      auto result = execute_module (m_runtime_id, module_name, func);
+      NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds ()
+                                << " SEND_PACKET_EXECUTE_MODULE_RESULT " << response);
+      LogEvent (WasmFaasEventLog::SEND_PACKET_EXECUTE_MODULE_RESULT, execution.requestId,
+                response.GetModuleId ());
 
-      NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
-                                << "EXECUTE_MODULE_REQUEST_CACHE_RESULT " << module_name << " "
-                                << func_name << " " << arg1 << " " << arg2 << " " << result);
-      return result;
+      m_remote_executions.erase (execution.requestId);
+      RememberAnswer (response);
+      SendBatched (m_socket, BuildPacket (response, ""), execution.requester);
     }
   else
     {
-
-      QueryPeersForModule (module_name);
-      return 0;
+      NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                << "EXECUTE_MODULE_REQUEST_CACHE_RESULT " << execution.moduleName
+                                << " " << execution.funcName << FormatArgs (execution.args) << " "
+                                << FormatResult (result));
+      LogEvent (WasmFaasEventLog::EXECUTE_MODULE_REQUEST_CACHE_RESULT, execution.requestId,
+                WasmFaasHeader::GetNameId (execution.moduleName));
+
+      auto completed = result;
+      completed.requestId = execution.requestId;
+      CompleteInvocation (completed);
     }
 }
 
 void
-CustomApp::HandleRead (Ptr<Socket> socket)
+CustomApp::CompleteInvocation (const WasmFaasResult &result)
 {
-  NS_LOG_FUNCTION (this << socket);
-  Ptr<Packet> packet;
-  Address from;
-  Address localAddress;
+  NS_LOG_FUNCTION (this << result.requestId);
 
-  // One means that the query is still running
-  if (m_peer_module_exec_query_state == 1)
+  // A workflow stage goes on with the next stage instead of completing an invocation
+  uint64_t workflowId;
+  if (m_workflows.TakeTask (result.requestId, workflowId))
     {
-
-      Simulator::Schedule (MicroSeconds (m_microseconds_eventloop_interval), &CustomApp::HandleRead,
-                           this, socket);
+      FinishWorkflowStage (workflowId, result);
       return;
     }
-  // 2 means if has finished running
-  else if (m_peer_module_exec_query_state == 2)
+
+  std::string moduleName;
+  auto it = m_invocations.find (result.requestId);
+  if (it != m_invocations.end ())
     {
-      if (m_has_module_exec_result)
+      moduleName = it->second.first;
+      if (result.status == WasmFaasResult::OK)
         {
-
-          if (m_is_waiting_for_module_load)
+          auto latency = Simulator::Now () - it->second.second;
+          m_latency.Record (latency);
+          m_module_latency[moduleName].Record (latency);
+          auto start = m_cold_starts.find (result.requestId);
+          if (start != m_cold_starts.end ())
             {
-              Simulator::Schedule (MicroSeconds (m_microseconds_eventloop_interval),
-                                   &CustomApp::HandleRead, this, socket);
-              return;
+              (start->second ? m_cold_latency : m_warm_latency).Record (latency);
             }
-          auto response = std::string ("r;");
-          response.append (m_query_peers_func_name);
-          response.append (";");
-          response.append (std::to_string (m_module_exec_result));
-          response.append (";");
+        }
+      m_invocations.erase (it);
+    }
+  m_cold_starts.erase (result.requestId);
 
-          auto response_str = response.c_str ();
-          auto resp_len = strlen (response_str);
+  m_invocationCompletedTrace (result);
+  m_resultDeliveredTrace (result.requestId, moduleName);
+}
 
-          NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds ()
-                                    << " SEND_PACKET_EXECUTE_MODULE_RESULT_FROM_PEER "
-                                    << response_str);
+const WasmFaasLatencyHistogram &
+CustomApp::GetLatencyHistogram (void) const
+{
+  return m_latency;
+}
 
-          auto p = Create<Packet> ((uint8_t *) response_str, resp_len);
-          SeqTsHeader seqTs;
-          seqTs.SetSeq (m_sent);
-          p->AddHeader (seqTs);
-          socket->SendTo (p, 0, m_original_module_requester);
+const std::map<std::string, WasmFaasLatencyHistogram> &
+CustomApp::GetModuleLatencyHistograms (void) const
+{
+  return m_module_latency;
+}
 
-          // Cleanup
-          m_has_module_exec_result = false;
-        }
-      else
-        {
-          auto response = std::string ("n;");
-          response.append (m_query_peers_func_name);
-          response.append (";");
+const WasmFaasLatencyHistogram &
+CustomApp::GetColdLatencyHistogram (void) const
+{
+  return m_cold_latency;
+}
 
-          auto response_str = response.c_str ();
-          auto resp_len = strlen (response_str);
+const WasmFaasLatencyHistogram &
+CustomApp::GetWarmLatencyHistogram (void) const
+{
+  return m_warm_latency;
+}
 
-          auto p = Create<Packet> ((uint8_t *) response_str, resp_len);
-          SeqTsHeader seqTs;
-          seqTs.SetSeq (m_sent);
-          p->AddHeader (seqTs);
-          socket->SendTo (p, 0, m_original_module_requester);
-          m_sent++;
+void
+CustomApp::PrintLatencyReport (std::ostream &os) const
+{
+  os << "node " << GetNode ()->GetId () << " " << m_latency << std::endl;
+  os << "node " << GetNode ()->GetId () << " cold " << m_cold_latency << std::endl;
+  os << "node " << GetNode ()->GetId () << " warm " << m_warm_latency << std::endl;
+  for (auto &entry : m_module_latency)
+    {
+      os << "node " << GetNode ()->GetId () << " module " << entry.first << " " << entry.second
+         << std::endl;
+    }
+}
 
-          NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
-                                    << "SENT_PACKET_PEER_MODULE_QUERY_NOT_FOUND");
-        }
+bool
+CustomApp::IsBusy (void) const
+{
+  return m_busy_slots >= m_execution_slots;
+}
 
-      m_peer_module_exec_query_state = 0;
-      return;
-    }
+void
+CustomApp::HandleRead (Ptr<Socket> socket)
+{
+  NS_LOG_FUNCTION (this << socket);
+  Ptr<Packet> packet;
+  Address from;
+  Address localAddress;
 
   while ((packet = socket->RecvFrom (from)))
     {
       socket->GetSockName (localAddress);
       m_rxTrace (packet);
       m_rxTraceWithAddresses (packet, from, localAddress);
-      m_original_module_requester = from;
-      if (packet->GetSize () > 0)
+      SeqTsHeader seqTs;
+      if (packet->GetSize () >= seqTs.GetSerializedSize ())
         {
           //   uint32_t receivedSize = packet->GetSize ();
-          SeqTsHeader seqTs;
           packet->RemoveHeader (seqTs);
           // uint32_t currentSequenceNumber = seqTs.GetSeq ();
 
-          auto resp = HandlePeerPacket (packet, socket, from);
+          // The replies to a batch go back as one batch, without waiting for BatchWindow
+          std::vector<Ptr<Packet>> messages;
+          auto isBatch = UnpackBatch (packet, messages);
+          for (auto &message : messages)
+            {
+              auto resp = HandlePeerPacket (message, socket, from);
 
-          if (resp->GetSize () > 0)
+              if (resp != 0)
+                {
+                  SendBatched (socket, resp, from);
+                }
+            }
+          if (isBatch)
             {
-              socket->SendTo (resp, 0, from);
-              m_sent++;
+              m_batcher.Flush (socket, from);
             }
           // NS_LOG_INFO ("TraceDelay: RX " << receivedSize << " bytes from "
           //                                << InetSocketAddress::ConvertFrom (from).GetIpv4 ()
@@ -566,131 +3123,359 @@ CustomApp::HandlePeerPacket (Ptr<Packet> packet, Ptr<Socket> socket, Address fro
 {
   NS_LOG_FUNCTION (this);
 
-  auto packetSize = packet->GetSize ();
-  u_int8_t *data = new u_int8_t[packetSize];
-  packet->CopyData (data, packetSize);
+  WasmFaasHeader header;
+  WasmFaasChunkHeader chunk;
+  auto size = packet->GetSize ();
+  if (!ParsePacket (packet, header, chunk, m_rx_payload))
+    {
+      NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                << "DROPPED_MALFORMED_PACKET " << size);
+      LogEvent (WasmFaasEventLog::DROPPED_MALFORMED_PACKET, 0, 0);
+      return 0;
+    }
+  UpdatePeerLoad (from, header);
+
+  auto requestId = header.GetRequestId ();
+  auto moduleName = WasmFaasHeader::GetIdName (header.GetModuleId ());
+
+  WasmFaasHeader response;
+  response.SetRequestId (requestId);
+  response.SetModuleId (header.GetModuleId ());
 
-  std::vector<std::string> tokens;
-  switch ((char) data[0])
+  switch (header.GetType ())
     {
 
       // load module handler
-      case 'l': {
+      case WasmFaasHeader::MODULE_LOAD_REQUEST: {
         NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
                                   << "RECEIVED_PACKET_MODULE_LOAD_REQUEST"
-                                  << " " << data);
+                                  << " " << header);
+        LogEvent (WasmFaasEventLog::RECEIVED_PACKET_MODULE_LOAD_REQUEST, requestId,
+                  header.GetModuleId ());
 
-        auto moduleName = std::string ((char *) data + 2);
-        moduleName.pop_back ();
+        // A retry of the requester must not restart a transfer it already receives
+        auto active = m_module_transfers.find (requestId);
+        if (active != m_module_transfers.end () && active->second.peer == from)
+          {
+            ResendModuleChunks (requestId, active->second);
+            SendModuleChunks (requestId);
+            return 0;
+          }
 
-        auto base64_data = get_runtime_module_base64_data (m_runtime_id, moduleName.c_str ());
+        // Prefetches ask peers that may not hold the module, evicted modules stay
+        // registered in the runtime but are no longer served
+        if (!IsModuleAvailable (moduleName))
+          {
+            response.SetType (WasmFaasHeader::NOT_FOUND);
 
-        auto respStr = std::string ("c;");
-        respStr.append (moduleName);
-        respStr.append (";");
-        respStr.append (base64_data);
-        respStr.append (";");
+            NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                      << "SENT_PACKET_PEER_MODULE_QUERY_NOT_FOUND " << response);
+            LogEvent (WasmFaasEventLog::SENT_PACKET_PEER_MODULE_QUERY_NOT_FOUND, requestId,
+                      response.GetModuleId ());
+            return BuildPacket (response, "");
+          }
+
+        auto base64_data = get_runtime_module_base64_data (m_runtime_id, moduleName.c_str ());
+        auto moduleData = std::string (base64_data);
         free_ffi_string ((char *) base64_data);
 
-        NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
-                                  << "SEND_PACKET_MODULE_LOAD_RESPONSE"
-                                  << " " << moduleName << " " << respStr.size ());
+        if (m_chunked_module_transfer && !m_text_protocol)
+          {
+            auto &transfer = m_module_transfers[requestId];
+            transfer.moduleId = header.GetModuleId ();
+            transfer.peer = from;
+            transfer.chunks.Start (Base64Decode (moduleData), m_module_chunk_size);
+            transfer.nRetries = 0;
+
+            NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                      << "SEND_PACKET_MODULE_LOAD_RESPONSE_CHUNKED"
+                                      << " " << moduleName << " " << transfer.chunks.GetSize ()
+                                      << " " << transfer.chunks.GetNChunks ());
+            LogEvent (WasmFaasEventLog::SEND_PACKET_MODULE_LOAD_RESPONSE_CHUNKED, requestId,
+                      header.GetModuleId (), transfer.chunks.GetSize ());
+
+            SendModuleChunks (requestId);
+            ArmModuleTransferTimeout (requestId, transfer);
+            return 0;
+          }
 
-        auto resp = Create<Packet> ((uint8_t *) respStr.c_str (), respStr.size ());
+        response.SetType (WasmFaasHeader::MODULE_LOAD_RESULT);
 
-        SeqTsHeader seqTs;
-        seqTs.SetSeq (m_sent);
-        resp->AddHeader (seqTs);
-        return resp;
+        NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                  << "SEND_PACKET_MODULE_LOAD_RESPONSE"
+                                  << " " << moduleName << " " << moduleData.size ());
+        LogEvent (WasmFaasEventLog::SEND_PACKET_MODULE_LOAD_RESPONSE, requestId,
+                  header.GetModuleId (), moduleData.size ());
 
-        break;
+        return BuildPacket (response, moduleData);
       }
       // execute module handler
-      case 'e': {
+      case WasmFaasHeader::EXECUTE_REQUEST: {
         NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
                                   << "RECEIVED_PACKET_EXECUTE_MODULE_REQUEST"
-                                  << " " << data);
+                                  << " " << header);
+        LogEvent (WasmFaasEventLog::RECEIVED_PACKET_EXECUTE_MODULE_REQUEST, requestId,
+                  header.GetModuleId ());
+
+        // A peer sent the request again, its first reply may have been lost
+        ExpireAnswers ();
+        auto answer = m_answers.find (requestId);
+        auto pending = m_requests.find (requestId);
+        if (answer != m_answers.end () || m_remote_executions.count (requestId) ||
+            (pending != m_requests.end () && pending->second.isForwarded &&
+             pending->second.requester == from))
+          {
+            NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                      << "DUPLICATE_REQUEST " << header);
+            LogEvent (WasmFaasEventLog::DUPLICATE_REQUEST, requestId, header.GetModuleId ());
+
+            if (answer != m_answers.end ())
+              {
+                return BuildPacket (answer->second, "");
+              }
+            // Pass the retry on, the forwarded copy may have been lost as well
+            if (pending != m_requests.end () && pending->second.requester == from)
+              {
+                ResendPendingRequest (pending->second);
+              }
+            response.SetType (WasmFaasHeader::ACK);
+            return BuildPacket (response, "");
+          }
+
+        // The request looped back to a node that is already looking it up
+        if (pending != m_requests.end ())
+          {
+            response.SetType (WasmFaasHeader::NOT_FOUND);
+
+            NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                      << "SENT_PACKET_PEER_MODULE_QUERY_NOT_FOUND " << response);
+            LogEvent (WasmFaasEventLog::SENT_PACKET_PEER_MODULE_QUERY_NOT_FOUND, requestId,
+                      response.GetModuleId ());
+
+            return BuildPacket (response, "");
+          }
+
+        auto funcName = WasmFaasHeader::GetIdName (header.GetFunctionId ());
+        auto args = std::vector<WasmFaasValue> ();
+        for (uint8_t i = 0; i < header.GetNArgs (); i++)
+          {
+            args.push_back (header.GetArg (i));
+          }
 
-        auto s = std::string ((char *) data);
+        // Only a holder answers from its memo cache, the requester may ask for the module next
+        WasmFaasValue memoValue;
+        if (IsModuleAvailable (moduleName) && LookupMemo (moduleName, funcName, args, memoValue))
+          {
+            response.SetType (WasmFaasHeader::EXECUTE_RESULT);
+            response.AddArg (memoValue);
+
+            NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds ()
+                                      << " MEMO_HIT " << response);
+            LogEvent (WasmFaasEventLog::MEMO_HIT, requestId, response.GetModuleId ());
+            NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds ()
+                                      << " SEND_PACKET_EXECUTE_MODULE_RESULT " << response);
+            LogEvent (WasmFaasEventLog::SEND_PACKET_EXECUTE_MODULE_RESULT, requestId,
+                      response.GetModuleId ());
 
-        size_t startPos = 0;
-        size_t endPos = 0;
-        std::string token;
-        while ((endPos = s.find (";", startPos)) != std::string::npos)
+            RememberAnswer (response);
+            return BuildPacket (response, "");
+          }
+
+        if (IsModuleAvailable (moduleName) && m_execution_cost_model != 0)
+          {
+            Execution execution;
+            execution.requestId = requestId;
+            execution.moduleName = moduleName;
+            execution.funcName = funcName;
+            execution.args = args;
+            execution.priority = header.GetPriority ();
+            execution.hopCount = header.GetHopCount () + 1;
+            execution.isRemote = true;
+            execution.requester = from;
+            m_remote_executions.insert (requestId);
+            EnqueueExecution (execution);
+
+            response.SetType (WasmFaasHeader::ACK);
+            return BuildPacket (response, "");
+          }
+        else if (IsModuleAvailable (moduleName))
           {
-            token = s.substr (startPos, endPos - startPos);
-            tokens.push_back (token);
-            startPos = endPos + 1;
+            m_executionStartTrace (requestId, moduleName);
+            auto result = RunModule (moduleName, funcName, args);
+            m_executionEndTrace (requestId, moduleName);
+            StoreMemo (moduleName, funcName, args, result);
+
+            // A result with no value tells the requester the function failed
+            response.SetType (WasmFaasHeader::EXECUTE_RESULT);
+            if (result.status == WasmFaasResult::OK)
+              {
+                response.AddArg (result.value);
+              }
+
+            NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds ()
+                                      << " SEND_PACKET_EXECUTE_MODULE_RESULT " << response);
+            LogEvent (WasmFaasEventLog::SEND_PACKET_EXECUTE_MODULE_RESULT, requestId,
+                      response.GetModuleId ());
+
+            RememberAnswer (response);
+            return BuildPacket (response, "");
           }
+        else if (header.GetHopCount () >= m_max_hops)
+          {
+            response.SetType (WasmFaasHeader::NOT_FOUND);
 
-        tokens.push_back (s.substr (startPos));
+            NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                      << "HOP_LIMIT_REACHED " << header);
+            LogEvent (WasmFaasEventLog::HOP_LIMIT_REACHED, requestId, header.GetModuleId ());
+            NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                      << "SENT_PACKET_PEER_MODULE_QUERY_NOT_FOUND " << response);
+            LogEvent (WasmFaasEventLog::SENT_PACKET_PEER_MODULE_QUERY_NOT_FOUND, requestId,
+                      response.GetModuleId ());
+
+            return BuildPacket (response, "");
+          }
+        else
+          {
+            auto &ctx = AddRequest (requestId, true);
+            ctx.moduleName = moduleName;
+            ctx.funcName = funcName;
+            ctx.args = args;
+            ctx.priority = header.GetPriority ();
+            ctx.hopCount = header.GetHopCount () + 1;
+            ctx.requester = from;
+
+            QueryPeersForModule (requestId);
+          }
+        break;
+      }
 
-        bool isModuleRegistered = is_module_registered (m_runtime_id, tokens[1.0].c_str ());
-        m_query_peers_func_name = std::string (tokens[2].c_str ());
-        m_query_peers_func_args = std::vector<int32_t> (2);
-        m_query_peers_func_args[0] = std::stoi (tokens[3]);
-        m_query_peers_func_args[1] = std::stoi (tokens[4]);
+      // chunked module transfer window handler
+      case WasmFaasHeader::MODULE_CHUNK_ACK: {
+        auto it = m_module_transfers.find (requestId);
+        if (it == m_module_transfers.end ())
+          {
+            return 0;
+          }
+        auto &transfer = it->second;
 
-        if (isModuleRegistered)
+        if (transfer.chunks.Acknowledge (chunk.GetSeq ()))
           {
+            transfer.nRetries = 0;
+            ArmModuleTransferTimeout (requestId, transfer);
+          }
 
-            auto func = WasmFunction{};
+        if (transfer.chunks.IsComplete ())
+          {
+            transfer.retransmitEvent.Cancel ();
+            m_module_transfers.erase (it);
+          }
+        else
+          {
+            SendModuleChunks (requestId);
+          }
+        return 0;
+      }
 
-            func.name = m_query_peers_func_name.c_str ();
-            auto arg1s = std::to_string (m_query_peers_func_args[0]);
-            auto arg2s = std::to_string (m_query_peers_func_args[1]);
+      case WasmFaasHeader::GOSSIP: {
+        auto peer = InetSocketAddress::ConvertFrom (from).GetIpv4 ();
 
-            func.args[0] = WasmArg{
-                arg1s.c_str (),
-                ArgType::I32,
-            };
+        NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds ()
+                                  << " RECEIVED_PACKET_GOSSIP " << peer << " "
+                                  << m_rx_payload.size ());
+        LogEvent (WasmFaasEventLog::RECEIVED_PACKET_GOSSIP, 0, 0, m_rx_payload.size ());
 
-            func.args[1] = WasmArg{
-                arg2s.c_str (),
-                ArgType::I32,
-            };
+        auto &entry = m_peer_digests[peer];
+        entry.digest = WasmFaasModuleDigest (m_gossip_digest_bits, m_gossip_digest_hashes);
+        if (!entry.digest.Deserialize (m_rx_payload))
+          {
+            m_peer_digests.erase (peer);
+            return 0;
+          }
+        entry.holder = from;
+        entry.expires = Simulator::Now () + m_gossip_digest_ttl;
+        entry.misses.clear ();
+        return 0;
+      }
 
-            auto result = execute_module (m_runtime_id, tokens[1].c_str (), func);
+      case WasmFaasHeader::WORKFLOW: {
+        NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                  << "RECEIVED_PACKET_WORKFLOW "
+                                  << InetSocketAddress::ConvertFrom (from).GetIpv4 () << " "
+                                  << header);
+        LogEvent (WasmFaasEventLog::RECEIVED_PACKET_WORKFLOW, requestId, header.GetModuleId (),
+                  m_rx_payload.size ());
+
+        response.SetType (WasmFaasHeader::ACK);
+
+        // The sender missed the ack and handed the workflow over again
+        ExpireAnswers ();
+        auto answer = m_answers.find (requestId);
+        if (answer != m_answers.end ())
+          {
+            NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                      << "DUPLICATE_REQUEST " << header);
+            LogEvent (WasmFaasEventLog::DUPLICATE_REQUEST, requestId, header.GetModuleId ());
+            return BuildPacket (answer->second, "");
+          }
 
-            auto response = std::string ("r;");
-            response.append (tokens[1]);
-            response.append (";");
-            response.append (std::to_string (result));
-            response.append (";");
+        WasmFaasWorkflow workflow;
+        uint64_t workflowId;
+        InetSocketAddress origin (Ipv4Address::GetAny ());
+        if (!WasmFaasWorkflowTable::DeserializeHandOver (m_rx_payload, workflowId, origin,
+                                                         workflow) ||
+            workflow.IsComplete ())
+          {
+            return 0;
+          }
 
-            auto response_str = response.c_str ();
-            auto resp_len = strlen (response_str);
+        // A workflow coming back to a node still handing it over supersedes the hand-over
+        auto held = m_workflows.Find (workflowId);
+        if (held != nullptr && !held->isHandingOver)
+          {
+            return BuildPacket (response, "");
+          }
+        m_workflows.Hold (workflowId, workflow, origin, header.GetPriority (),
+                          header.GetHopCount () + 1);
 
-            NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds ()
-                                      << " SEND_PACKET_EXECUTE_MODULE_RESULT " << response_str);
+        // The ack goes out before the next stage runs
+        RememberAnswer (response);
+        Simulator::ScheduleNow (&CustomApp::AdvanceWorkflow, this, workflowId);
+        return BuildPacket (response, "");
+      }
 
-            auto p = Create<Packet> ((uint8_t *) response_str, resp_len);
-            SeqTsHeader seqTs;
-            seqTs.SetSeq (m_sent);
-            p->AddHeader (seqTs);
-            return p;
+      case WasmFaasHeader::WORKFLOW_RESULT: {
+        NS_LOG_INFO (m_runtime_id << " " << Simulator::Now ().GetMilliSeconds () << " "
+                                  << "RECEIVED_PACKET_WORKFLOW_RESULT "
+                                  << InetSocketAddress::ConvertFrom (from).GetIpv4 () << " "
+                                  << header);
+        LogEvent (WasmFaasEventLog::RECEIVED_PACKET_WORKFLOW_RESULT, requestId,
+                  header.GetModuleId ());
+
+        response.SetType (WasmFaasHeader::ACK);
+        if (header.GetNArgs () == 0)
+          {
+            return BuildPacket (response, "");
           }
-        else
+        auto status = static_cast<WasmFaasResult::Status> (header.GetArg (0).GetI32 ());
+        auto value = header.GetNArgs () > 1 ? header.GetArg (1) : WasmFaasValue{};
+        if (status == WasmFaasResult::OK && header.GetNArgs () < 2)
           {
-            m_peer_module_exec_query_state = 1;
-            QueryPeersForModule ((char *) tokens[1].c_str ());
-            Simulator::Schedule (MicroSeconds (m_microseconds_eventloop_interval),
-                                 &CustomApp::HandleRead, this, socket);
+            status = WasmFaasResult::FAILED;
           }
-        break;
+        // Duplicates are acknowledged too, the first ack may have been lost
+        FinishWorkflow (WasmFaasResult{status, value, requestId});
+        return BuildPacket (response, "");
       }
 
     default:
       break;
     }
 
-  uint8_t *default_resp = new uint8_t[1];
-  default_resp[0] = '0';
-  auto p = Create<Packet> (default_resp, 1);
-  SeqTsHeader seqTs;
-  seqTs.SetSeq (m_sent);
-  p->AddHeader (seqTs);
-  return p;
+  // Acknowledges the request the message belongs to, never an unrelated one
+  WasmFaasHeader ack;
+  ack.SetType (WasmFaasHeader::ACK);
+  ack.SetRequestId (requestId);
+  return BuildPacket (ack, "");
 }
 
 } // Namespace ns3
@@ -23,7 +23,13 @@
 #ifndef CUSTOM_APP_H
 #define CUSTOM_APP_H
 
+#include <deque>
+#include <list>
+#include <map>
+#include <ostream>
+#include <string>
 #include <vector>
+#include <unordered_map>
 #include <unordered_set>
 
 #include "ns3/application.h"
@@ -31,8 +37,22 @@
 #include "ns3/ptr.h"
 #include "ns3/address.h"
 #include "ns3/traced-callback.h"
+#include "ns3/traced-value.h"
 #include "ns3/packet-loss-counter.h"
 #include "ns3/inet-socket-address.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+#include "wasmfaas-header.h"
+#include "wasmfaas-chunk-header.h"
+#include "wasmfaas-batcher.h"
+#include "wasmfaas-module-transfer.h"
+#include "wasmfaas-cache-policy.h"
+#include "wasmfaas-cost-model.h"
+#include "wasmfaas-latency-histogram.h"
+#include "wasmfaas-event-log.h"
+#include "wasmfaas-module-digest.h"
+#include "wasmfaas-workflow.h"
+#include "wasmfaas-workflow-table.h"
 #include "libwasmfaas.h"
 
 namespace ns3 {
@@ -44,11 +64,14 @@ namespace ns3 {
 /**
  * \ingroup customapp
  *
- * \brief A UDP server, receives UDP packets from a remote host.
+ * \brief A serverless node running WebAssembly functions for itself and its peers.
  *
- * UDP packets carry a 32bits sequence number followed by a 64bits time
- * stamp in their payloads. The application uses the sequence number
- * to determine if a packet is lost, and the time stamp to compute the delay.
+ * Each node owns a Wasm runtime holding the modules registered with
+ * RegisterWasmModule. ExecuteFunction runs a function of a local module, or
+ * asks the peers over UDP to run it or to send the module when it is
+ * missing. The node answers the same requests from its peers on Port.
+ * Every UDP message starts with a SeqTsHeader followed by a WasmFaasHeader,
+ * or by the legacy text format when TextProtocol is set.
  */
 class CustomApp : public Application
 {
@@ -58,6 +81,62 @@ public:
    * \return the object TypeId
    */
   static TypeId GetTypeId (void);
+
+  /// Order in which waiting invocations get an execution slot
+  enum QueueDiscipline
+  {
+    FIFO_QUEUE, //!< Arrival order
+    PRIORITY_QUEUE //!< Highest priority first, arrival order among equals
+  };
+
+  /// What happens to an invocation that finds the queue full
+  enum OverflowAction
+  {
+    REJECT_OVERFLOW, //!< Fail the invocation
+    FORWARD_OVERFLOW //!< Ask the peers to run it
+  };
+
+  /// Order in which peers are asked for a missing module
+  enum PeerSelection
+  {
+    ORDERED_SELECTION, //!< Registration order
+    LEAST_LOADED_SELECTION, //!< Lowest peer score first
+    TWO_CHOICES_SELECTION //!< Lower score of two random peers, power of two choices
+  };
+
+  /**
+   * TracedCallback signature for completed module transfers.
+   *
+   * \param [in] moduleName The module received from a peer.
+   * \param [in] bytes The module size on the wire.
+   * \param [in] duration The time since the module load request was sent.
+   */
+  typedef void (*ModuleTransferTracedCallback) (const std::string &moduleName, uint32_t bytes,
+                                                Time duration);
+
+  /**
+   * TracedCallback signature for completed invocations.
+   *
+   * \param [in] result The invocation result, with its request ID.
+   */
+  typedef void (*InvocationTracedCallback) (const WasmFaasResult &result);
+
+  /**
+   * TracedCallback signature for the stages of an invocation.
+   *
+   * \param [in] requestId The request ID, the same on every node.
+   * \param [in] moduleName The module invoked.
+   */
+  typedef void (*StageTracedCallback) (uint64_t requestId, const std::string &moduleName);
+
+  /**
+   * TracedCallback signature for sent batches.
+   *
+   * \param [in] nMessages The number of messages in the batch.
+   * \param [in] bytes The batch size on the wire, headers included.
+   */
+  typedef void (*BatchTracedCallback) (uint32_t nMessages, uint32_t bytes);
+
   CustomApp ();
   virtual ~CustomApp ();
   /**
@@ -92,13 +171,150 @@ public:
    */
   double GetCurrentNodeXPosition (void);
 
-  void RegisterWasmModule (char *name, char *base64_data);
+  /**
+   * \brief Register a module the node always holds.
+   * \param name the module name
+   * \param base64_data the module data in base64
+   * \return false if the name has the ID of another name, see
+   *         WasmFaasHeader::RegisterName, or the module cannot be registered
+   */
+  bool RegisterWasmModule (char *name, char *base64_data);
 
   void RegisterNode (Ipv4Address address, uint16_t port);
 
+  /**
+   * \brief Run a function of two I32 arguments, see ExecuteFunction.
+   * \param module_name the module holding the function
+   * \param func_name the function to run
+   * \param arg1 the first argument
+   * \param arg2 the second argument
+   * \return the function result, 0 if it is not available locally
+   */
   int32_t ExecuteModule (char *module_name, char *func_name, int32_t arg1, int32_t arg2);
 
-  void QueryPeersForModule (char *name);
+  /**
+   * \brief Run a function with typed arguments.
+   *
+   * Runs the function right away if the module is available locally, and
+   * asks the peers to run it otherwise. With an ExecutionCostModel a local
+   * function is queued instead, and its result is logged once its cost has
+   * elapsed, like the result of a peer.
+   *
+   * Every call fires the InvocationCompleted trace once, with the request
+   * ID of the returned result, including calls that complete right away.
+   *
+   * \param module_name the module holding the function
+   * \param func_name the function to run
+   * \param args the function arguments, at most WasmFaasHeader::MAX_ARGS
+   * \param priority the invocation priority, used by the priority QueueDiscipline
+   * \return the function result, PENDING if it was queued or the peers were asked
+   */
+  WasmFaasResult ExecuteFunction (const std::string &module_name, const std::string &func_name,
+                                  const std::vector<WasmFaasValue> &args, uint8_t priority = 0);
+
+  /**
+   * \brief Run a workflow, each stage on a node holding its module.
+   *
+   * The workflow travels with the results of its stages. The node holding
+   * it runs the next stage if the module is available there, hands the
+   * workflow over to a peer known to hold the module, through the location
+   * cache or gossip, or else asks its peers to run the stage. The node that
+   * ran the last stage sends the result straight back to this node, so no
+   * stage result goes back to the caller in between. A failed stage fails
+   * the workflow with its status, and WorkflowTimeout bounds the wait.
+   *
+   * Every call fires the InvocationCompleted trace once, with the workflow
+   * ID as request ID, possibly before returning if every stage ran right
+   * away. Latencies are recorded under GetName of the workflow.
+   *
+   * \param workflow the workflow, with at least one stage
+   * \param priority the priority of every stage
+   * \return a PENDING result carrying the workflow ID
+   */
+  WasmFaasResult ExecuteWorkflow (const WasmFaasWorkflow &workflow, uint8_t priority = 0);
+
+  /**
+   * \brief Mark a module as pure, or not.
+   *
+   * Functions of a pure module always return the same result for the same
+   * arguments, so their successful results are kept in a memo cache of
+   * MemoCacheSize entries. Later invocations with the same arguments, local
+   * or from peers, get the kept result without running the function.
+   * Marking a module as not pure drops its kept results.
+   *
+   * \param module_name the module name
+   * \param pure whether the functions of the module are pure
+   */
+  void SetModulePure (const std::string &module_name, bool pure);
+
+  /**
+   * \param module_name the module name
+   * \return true if the module was marked as pure
+   */
+  bool IsModulePure (const std::string &module_name) const;
+
+  /**
+   * \return true while every execution slot of this node runs a function
+   */
+  bool IsBusy (void) const;
+
+  /**
+   * \return the latencies of the successful invocations made through
+   * ExecuteFunction on this node, from the call to the result
+   */
+  const WasmFaasLatencyHistogram &GetLatencyHistogram (void) const;
+
+  /**
+   * \return the latencies of GetLatencyHistogram, by module
+   */
+  const std::map<std::string, WasmFaasLatencyHistogram> &GetModuleLatencyHistograms (void) const;
+
+  /**
+   * \return the latencies of the ExecuteFunction invocations of
+   * GetLatencyHistogram whose module was not available on this node, and so
+   * was looked up on the peers
+   */
+  const WasmFaasLatencyHistogram &GetColdLatencyHistogram (void) const;
+
+  /**
+   * \return the latencies of the other ExecuteFunction invocations of
+   * GetLatencyHistogram, whose module was available on this node or whose
+   * result was memoized
+   */
+  const WasmFaasLatencyHistogram &GetWarmLatencyHistogram (void) const;
+
+  /**
+   * \brief Get the score of a peer, lower is better.
+   *
+   * The score is the smoothed time peers took to answer execute requests,
+   * plus PeerLoadCost for every invocation the peer last advertised as
+   * queued and for its share of busy execution slots. Peers not heard from
+   * yet score 0, so they are tried early.
+   *
+   * \param peer the peer address
+   * \return the peer score
+   */
+  Time GetPeerScore (Ipv4Address peer) const;
+
+  /**
+   * \return the bytes of module digests sent by the gossip protocol, headers included
+   */
+  uint64_t GetGossipBytesSent (void) const;
+
+  /**
+   * \brief Assign a fixed random variable stream number to the random
+   * variables used by this application.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  /**
+   * \brief Print the latency percentiles of this node and of each of its modules.
+   * \param os the output stream
+   */
+  void PrintLatencyReport (std::ostream &os) const;
 
   uint64_t GetNodeId (void);
   void InitRuntime (void);
@@ -119,34 +335,726 @@ private:
    */
   void HandleRead (Ptr<Socket> socket);
   void QueryPeersCallback (Ptr<Socket> socket);
-  Ptr<Packet> HandlePeerPacket (Ptr<Packet> packet, Ptr<Socket> socket, Address from);
-  void
-  resolveTag (char c)
+
+  /**
+   * \brief Handle a reply received on the query socket.
+   * \param packet the reply, its SeqTsHeader removed
+   * \param socket the query socket
+   * \param from the peer
+   */
+  void HandleQueryReply (Ptr<Packet> packet, Ptr<Socket> socket, const Address &from);
+
+  /**
+   * \brief State of one in-flight invocation that is waiting on its peers.
+   *
+   * Every packet exchanged for the invocation carries requestId, so several
+   * invocations can be pending on the same node at once.
+   */
+  struct RequestContext
+  {
+    uint64_t requestId; //!< ID carried in every packet of the invocation
+    std::string moduleName; //!< Module being looked up
+    std::string funcName; //!< Function to run on the module
+    std::vector<WasmFaasValue> args; //!< Function arguments
+    uint8_t priority; //!< Invocation priority
+    uint8_t hopCount; //!< Times the request was forwarded before reaching us
+    bool isForwarded; //!< True if a peer forwarded the request to us
+    Address requester; //!< Peer waiting for the result when isForwarded is set
+    uint32_t peerIdx; //!< Number of peers queried so far
+    std::vector<uint32_t> candidates; //!< Peers not queried yet, unused in registration order
+    std::vector<Ipv4Address> awaiting; //!< Queried peers that have not answered yet
+    std::vector<InetSocketAddress> pending; //!< Queried peers with no result or NOT_FOUND yet
+    Time queryStart; //!< When the current batch of peers was queried
+    Address moduleHolder; //!< Peer asked for the module while isWaitingForModuleLoad is set
+    uint32_t nRetries; //!< Times the current step was sent again after a timeout
+    EventId timeoutEvent; //!< Expiry of the current step
+    bool timedOut; //!< True once a queried peer stayed silent after the last retry
+    uint32_t nOutstanding; //!< Peers queried that have not answered yet
+    bool isDirected; //!< True while only the known module holder is queried
+    bool hasResult; //!< True once a peer returned a result
+    WasmFaasResult result; //!< Result returned by the peer
+    bool isWaitingForModuleLoad; //!< True while the module is transferred from the peer
+    Time transferStart; //!< When the module load request was sent
+    WasmFaasChunkReceiver chunks; //!< Module bytes reassembled from chunks
+    bool isPrefetch; //!< True if the module is fetched ahead of its invocations, see TryPrefetch
+  };
+
+  /**
+   * \brief Function run waiting for, or holding, an execution slot of the node.
+   */
+  struct Execution
+  {
+    uint64_t requestId; //!< Request the function runs for
+    std::string moduleName; //!< Module holding the function
+    std::string funcName; //!< Function to run
+    std::vector<WasmFaasValue> args; //!< Function arguments
+    uint8_t priority; //!< Invocation priority
+    uint8_t hopCount; //!< Hop count to use if the invocation is forwarded
+    bool isRemote; //!< True if a peer asked for the function
+    Address requester; //!< Peer waiting for the result when isRemote is set
+    Time enqueued; //!< When the invocation asked for a slot
+  };
+
+  /**
+   * \brief Latency and load of a peer, see GetPeerScore.
+   */
+  struct PeerScore
   {
-  }
+    bool hasRtt; //!< True once the peer answered an execute request
+    Time rtt; //!< Smoothed time the peer took to answer execute requests
+    uint16_t queueDepth; //!< Queue depth last advertised by the peer
+    uint8_t utilization; //!< Busy slots last advertised by the peer, in percent
+  };
+
+  /**
+   * \brief Modules a peer advertised through gossip.
+   */
+  struct PeerDigest
+  {
+    WasmFaasModuleDigest digest; //!< Modules the peer probably holds
+    Address holder; //!< Address the peer gossiped from, the one it serves requests on
+    Time expires; //!< When the digest stops being used
+    std::unordered_set<uint32_t> misses; //!< Modules the digest claims but the peer lacked
+  };
+
+  /**
+   * \brief Peer known to hold a module, learnt from its execute results.
+   */
+  struct ModuleLocation
+  {
+    Address holder; //!< Peer that returned a result for the module
+    Time expires; //!< When the entry stops being used
+  };
+
+  /**
+   * \brief Module being sent to a peer as a chunked transfer.
+   */
+  struct ModuleTransfer
+  {
+    uint32_t moduleId; //!< Module ID, see WasmFaasHeader::GetNameId
+    Address peer; //!< Peer that asked for the module
+    WasmFaasChunkSender chunks; //!< Module bytes and their window
+    uint32_t nRetries; //!< Retransmissions since the last newly acknowledged chunk
+    EventId retransmitEvent; //!< Retransmission of the unacknowledged chunks
+  };
+
+  /**
+   * \brief Append an event to the EventLog, if any.
+   * \param type the event
+   * \param requestId the request the event belongs to, 0 if none
+   * \param moduleId the module the event belongs to, 0 if none
+   * \param bytes the module bytes moved by the event, 0 if none
+   */
+  void LogEvent (WasmFaasEventLog::EventType type, uint64_t requestId, uint32_t moduleId,
+                 uint32_t bytes = 0);
+
+  /**
+   * \brief Allocate a request ID that is unique across every node.
+   * \return the new request ID
+   */
+  uint64_t NewRequestId (void);
+
+  /**
+   * \brief Whether a module can serve requests on this node.
+   *
+   * Modules registered with RegisterWasmModule always can, modules fetched
+   * from peers only while the cache policy keeps them.
+   *
+   * \param module_name the module name
+   * \return true if the module is available
+   */
+  bool IsModuleAvailable (const std::string &module_name);
+
+  /**
+   * \brief Run a function of a locally registered module.
+   * \param module_name the module holding the function
+   * \param func_name the function to run
+   * \param args the function arguments
+   * \return the function result
+   */
+  WasmFaasResult RunModule (const std::string &module_name, const std::string &func_name,
+                            const std::vector<WasmFaasValue> &args);
+
+  /**
+   * \param modules ';' separated names of the pure modules
+   */
+  void SetPureModules (std::string modules);
+  /**
+   * \return the pure modules as set by SetPureModules
+   */
+  std::string GetPureModules (void) const;
+
+  /**
+   * \brief Look up the kept result of a pure function and update the MemoHitRatio.
+   * \param module_name the module holding the function
+   * \param func_name the function
+   * \param args the function arguments
+   * \param value filled with the kept result on a hit
+   * \return true on a hit, false on a miss or if the module is not pure
+   */
+  bool LookupMemo (const std::string &module_name, const std::string &func_name,
+                   const std::vector<WasmFaasValue> &args, WasmFaasValue &value);
+
+  /**
+   * \brief Keep the result of a pure function, evicting the least recently
+   * used one if the memo cache is full. Failed results are not kept.
+   *
+   * \param module_name the module holding the function
+   * \param func_name the function
+   * \param args the function arguments
+   * \param result the function result
+   */
+  void StoreMemo (const std::string &module_name, const std::string &func_name,
+                  const std::vector<WasmFaasValue> &args, const WasmFaasResult &result);
+
+  /**
+   * \brief Start a function on a free execution slot, or queue it, or turn
+   * it away if the queue is full.
+   *
+   * \param execution the function to run
+   */
+  void EnqueueExecution (Execution execution);
+
+  /**
+   * \brief Forward or fail an invocation that found the queue full,
+   * according to OverflowAction.
+   *
+   * \param execution the invocation
+   */
+  void RejectExecution (const Execution &execution);
+
+  /**
+   * \brief Run a function on a free slot and schedule its completion after its cost.
+   * \param execution the function to run
+   */
+  void StartExecution (const Execution &execution);
+
+  /**
+   * \brief Deliver the result of a function whose cost has elapsed, then
+   * give its slot to the next queued one.
+   *
+   * \param execution the function that ran
+   * \param result its result
+   */
+  void FinishExecution (Execution execution, WasmFaasResult result);
+
+  /**
+   * \brief Log the result of a local invocation, or send it to the peer that asked.
+   * \param execution the invocation
+   * \param result its result
+   */
+  void DeliverExecutionResult (const Execution &execution, const WasmFaasResult &result);
+
+  /**
+   * \brief Record the result of an invocation made through ExecuteFunction
+   * and fire the InvocationCompleted and ResultDelivered traces.
+   *
+   * \param result the result, with its request ID
+   */
+  void CompleteInvocation (const WasmFaasResult &result);
+
+  /**
+   * \brief Run a function locally, from the memo cache or on a peer, see
+   * ExecuteFunction.
+   *
+   * \param requestId the request ID given to the function
+   * \param module_name the module holding the function
+   * \param func_name the function to run
+   * \param args the function arguments
+   * \param priority the invocation priority
+   * \return the function result, PENDING if it was queued or the peers were asked
+   */
+  WasmFaasResult StartInvocation (uint64_t requestId, const std::string &module_name,
+                                  const std::string &func_name,
+                                  const std::vector<WasmFaasValue> &args, uint8_t priority);
+
+  /**
+   * \brief Run the next stage of a workflow held here, hand the workflow
+   * over to a holder of the module, or deliver the result if every stage ran.
+   *
+   * \param workflowId the workflow
+   */
+  void AdvanceWorkflow (uint64_t workflowId);
+
+  /**
+   * \brief Record the result of the running stage of a workflow and go on
+   * with the next one.
+   *
+   * \param workflowId the workflow
+   * \param result the stage result
+   */
+  void FinishWorkflowStage (uint64_t workflowId, const WasmFaasResult &result);
+
+  /**
+   * \brief Send a workflow held here to a peer, or its result to the node
+   * that started it, and arm the hand-over timeout.
+   * \param workflowId the workflow
+   */
+  void SendWorkflow (uint64_t workflowId);
+
+  /**
+   * \brief Send the hand-over of a workflow again. Once RequestRetries
+   * retries were made, run its next stage here, or give up sending its result.
+   *
+   * \param workflowId the workflow
+   */
+  void HandleWorkflowHandOverTimeout (uint64_t workflowId);
+
+  /**
+   * \brief Send the result of a workflow held here to the node that started
+   * it, or complete the invocation if that is this node.
+   *
+   * \param workflowId the workflow
+   * \param result the workflow result
+   */
+  void CompleteWorkflow (uint64_t workflowId, const WasmFaasResult &result);
+
+  /**
+   * \brief Complete the invocation of a workflow started here, unless it
+   * already completed.
+   *
+   * \param result the workflow result, its requestId the workflow ID
+   */
+  void FinishWorkflow (const WasmFaasResult &result);
+
+  /**
+   * \brief Fail a workflow started here with no result after WorkflowTimeout.
+   * \param workflowId the workflow
+   */
+  void HandleWorkflowTimeout (uint64_t workflowId);
+
+  /**
+   * \return the address peers reach this node at, its first IPv4 address
+   * that is not a loopback one and the listening port
+   */
+  InetSocketAddress GetLocalAddress (void) const;
+
+  /**
+   * \brief Add a request to m_requests, replacing any request of the same ID.
+   * \param requestId the request ID
+   * \param isForwarded whether a peer forwarded the request to us
+   * \return the request context, its other fields left for the caller to set
+   */
+  RequestContext &AddRequest (uint64_t requestId, bool isForwarded);
+
+  /**
+   * \brief Remove a request from m_requests.
+   * \param it the request
+   */
+  void RemoveRequest (std::unordered_map<uint64_t, RequestContext>::iterator it);
+
+  /**
+   * \brief Start looking up the module of a pending request on the peers.
+   *
+   * Goes straight to the known holder of the module if the location cache
+   * has one, and to every peer otherwise.
+   *
+   * \param requestId the pending request
+   */
+  void QueryPeersForModule (uint64_t requestId);
+
+  /**
+   * \brief Find the peer to ask first for a module, from the digests it gossiped.
+   *
+   * Among the peers whose digest probably holds the module, the one with
+   * the lowest GetPeerScore is chosen. Expired digests are dropped.
+   *
+   * \param module_name the module name
+   * \param holder filled with the peer address
+   * \return true if a peer was found
+   */
+  bool FindGossipHolder (const std::string &module_name, Address &holder);
+
+  /**
+   * \brief Send the digest of the modules available here to GossipFanout
+   * random peers and schedule the next round.
+   */
+  void Gossip (void);
+
+  /**
+   * \param ctx a pending request
+   * \return the execute request message of ctx
+   */
+  WasmFaasHeader BuildExecuteRequest (const RequestContext &ctx);
+
+  /**
+   * \brief Send a packet to a peer through the shared query socket.
+   * \param packet the packet
+   * \param peer the peer address
+   */
+  void SendToPeer (Ptr<Packet> packet, const Address &peer);
+
+  /**
+   * \brief Send a packet, or add it to the batch of packets to the same peer
+   * from the same socket when BatchWindow is set, see WasmFaasBatcher.
+   *
+   * Packets larger than BatchMaxSize are sent alone, after the batch of
+   * their peer.
+   *
+   * \param socket the socket to send from
+   * \param packet the packet, SeqTsHeader included
+   * \param peer the peer address
+   */
+  void SendBatched (Ptr<Socket> socket, Ptr<Packet> packet, const Address &peer);
+
+  /**
+   * \brief Send the messages of a batch as one BATCH packet, the flush
+   * callback of m_batcher. A single message is sent as it is.
+   *
+   * \param socket the socket
+   * \param peer the peer address
+   * \param messages the messages, SeqTsHeader removed
+   */
+  void SendBatch (Ptr<Socket> socket, const Address &peer,
+                  const std::vector<Ptr<Packet>> &messages);
+
+  /**
+   * \brief Split a received BATCH message into the messages it carries.
+   * \param packet the received packet, its SeqTsHeader removed
+   * \param messages filled with the messages, or with packet itself if it
+   *        is not a batch
+   * \return true if packet is a batch
+   */
+  bool UnpackBatch (Ptr<Packet> packet, std::vector<Ptr<Packet>> &messages);
+
+  /**
+   * \brief Take the next peer to query out of the candidates of a request,
+   * according to PeerSelection.
+   *
+   * \param ctx the pending request
+   * \return the index of the peer in m_peerAddresses
+   */
+  uint32_t PickNextPeer (RequestContext &ctx);
+
+  /**
+   * \brief Record the load a peer advertised in a message.
+   * \param from the peer
+   * \param header the message
+   */
+  void UpdatePeerLoad (const Address &from, const WasmFaasHeader &header);
+
+  /**
+   * \brief Fold the answer time of a queried peer into its score, on its
+   * first answer to the current batch only.
+   *
+   * \param ctx the pending request
+   * \param from the peer that answered
+   */
+  void UpdatePeerRtt (RequestContext &ctx, const Address &from);
+
+  /**
+   * \brief Stamp the load of this node on an outgoing message.
+   * \param header the message
+   */
+  void SetLoad (WasmFaasHeader &header) const;
+
+  /**
+   * \brief Restart the timeout of the current step of a request, backed
+   * off for the retries already made.
+   *
+   * \param ctx the pending request
+   */
+  void ArmRequestTimeout (RequestContext &ctx);
+
+  /**
+   * \brief Send the current step of a request again, the execute request
+   * to the peers that did not answer or the module load request. Once
+   * RequestRetries retries were made the silent peers are passed over, and
+   * a stalled module transfer ends the request.
+   *
+   * \param requestId the pending request
+   */
+  void HandleRequestTimeout (uint64_t requestId);
+  /**
+   * \brief Send the execute request again to the peers yet to answer.
+   * \param ctx the request
+   */
+  void ResendPendingRequest (RequestContext &ctx);
+
+  /**
+   * \brief Remember the reply sent for an execute request, sent again to
+   * duplicates of the request instead of handling them.
+   *
+   * \param response the reply
+   */
+  void RememberAnswer (const WasmFaasHeader &response);
+
+  /**
+   * \brief Drop the replies kept for longer than DuplicateWindow.
+   */
+  void ExpireAnswers (void);
+
+  /**
+   * \return how long replies are kept, DuplicateWindow or by default the
+   * time a requester keeps retrying
+   */
+  Time GetDuplicateWindow (void) const;
+
+  /**
+   * \brief Strike a peer that returned a result or NOT_FOUND off the
+   * queried peers of a request.
+   *
+   * A peer with several interfaces may answer from another address than the
+   * one it was queried at, see IsSamePeer.
+   *
+   * \param ctx the pending request
+   * \param from the peer
+   * \return false if the peer was not queried, or already answered
+   */
+  bool RemovePendingPeer (RequestContext &ctx, const Address &from);
+
+  /**
+   * \param address an IPv4 address
+   * \return the ID of the node owning address, Node count if none does
+   */
+  uint32_t GetAddressOwner (Ipv4Address address);
+
+  /**
+   * \brief Whether two addresses belong to the same peer node.
+   * \param a an IPv4 address
+   * \param b an IPv4 address
+   * \return true if a and b are equal or assigned to the same node
+   */
+  bool IsSamePeer (Ipv4Address a, Ipv4Address b);
+
+  /**
+   * \brief Send the pending execute request to the next batch of peers.
+   *
+   * A batch holds PeerQueryFanout peers, picked by PickNextPeer. Called
+   * once when a query starts and again from QueryPeersCallback once every
+   * peer of the batch answered that it does not hold the module. Completes
+   * the query with no result once every peer has been asked.
+   *
+   * \param requestId the pending request
+   */
+  void SendNextPeerQuery (uint64_t requestId);
+
+  /**
+   * \brief Count an invocation of a module and predict the modules invoked
+   * next, see PrefetchCount.
+   *
+   * The prediction is a first order Markov chain over the modules invoked
+   * on this node: the modules that most often followed module_name, or the
+   * most often invoked modules until one followed it.
+   *
+   * \param module_name the module invoked
+   */
+  void UpdateModulePredictor (const std::string &module_name);
+
+  /**
+   * \brief Fetch the next predicted module that is not available here, if
+   * no request made by this node, prefetches included, is waiting on the
+   * peers. Requests forwarded to us do not hold prefetches back.
+   */
+  void TryPrefetch (void);
+
+  /**
+   * \brief Ask the next peer for the module of a prefetch: its known holder
+   * first, then the peers in registration order.
+   * \param requestId the prefetch request
+   */
+  void SendNextPrefetchRequest (uint64_t requestId);
+
+  /**
+   * \brief Finish a peer query, answer the forwarding peer if any and drop
+   * the request context.
+   *
+   * \param requestId the pending request
+   * \param found whether a peer returned a result for the module
+   * \param failure the result status of the invocation if not found
+   */
+  void CompletePeerQuery (uint64_t requestId, bool found,
+                          WasmFaasResult::Status failure = WasmFaasResult::NOT_FOUND);
+
+  /**
+   * \brief Register a module received from a peer and complete the query
+   * that asked for it.
+   *
+   * \param requestId the pending request
+   * \param moduleName the module name
+   * \param moduleData the module data in base64
+   * \param bytes the module size on the wire, reported by the ModuleTransfer trace
+   * \param from the peer that sent the module
+   */
+  void FinishModuleLoad (uint64_t requestId, const std::string &moduleName,
+                         const std::string &moduleData, uint32_t bytes, Address from);
+
+  /**
+   * \brief Send the chunks of a module transfer that fit in the window.
+   * \param requestId the request the module is transferred for
+   */
+  void SendModuleChunks (uint64_t requestId);
+
+  /**
+   * \brief Send one chunk of a module transfer.
+   * \param requestId the request the module is transferred for
+   * \param transfer the transfer
+   * \param seq the chunk sequence number
+   * \return the chunk data size, in bytes
+   */
+  uint32_t SendModuleChunk (uint64_t requestId, const ModuleTransfer &transfer, uint32_t seq);
+
+  /**
+   * \brief Send again the chunks of a module transfer that were sent but not acknowledged.
+   * \param requestId the request the module is transferred for
+   * \param transfer the transfer
+   */
+  void ResendModuleChunks (uint64_t requestId, const ModuleTransfer &transfer);
+
+  /**
+   * \brief Schedule the retransmission of a module transfer, see ModuleChunkTimeout.
+   * \param requestId the request the module is transferred for
+   * \param transfer the transfer
+   */
+  void ArmModuleTransferTimeout (uint64_t requestId, ModuleTransfer &transfer);
+
+  /**
+   * \brief Send the unacknowledged chunks again, or drop the transfer once the retries are spent.
+   * \param requestId the request the module is transferred for
+   */
+  void HandleModuleTransferTimeout (uint64_t requestId);
+
+  /**
+   * \brief Build a peer message packet in the configured protocol format.
+   * \param header the message
+   * \param payload the data following the header, if any
+   * \return the packet, SeqTsHeader included
+   */
+  Ptr<Packet> BuildPacket (const WasmFaasHeader &header, const std::string &payload);
+
+  /**
+   * \brief Build a module chunk packet, always in the binary format.
+   * \param header the message
+   * \param chunk the chunk position
+   * \param data the chunk data, null for none
+   * \param size the chunk data size, in bytes
+   * \return the packet, SeqTsHeader included
+   */
+  Ptr<Packet> BuildChunkPacket (const WasmFaasHeader &header, const WasmFaasChunkHeader &chunk,
+                                const uint8_t *data, uint32_t size);
+
+  /**
+   * \brief Decode a peer message whose SeqTsHeader was already removed.
+   * \param packet the received packet
+   * \param header filled with the message
+   * \param chunk filled with the chunk position of chunk messages
+   * \param payload filled with the data following the headers, if any. Passing
+   *        the same string every time reuses its storage.
+   * \return false if the packet does not hold a valid message
+   */
+  bool ParsePacket (Ptr<Packet> packet, WasmFaasHeader &header, WasmFaasChunkHeader &chunk,
+                    std::string &payload);
+
+  /**
+   * \brief Handle a peer message received on the listening socket.
+   * \param packet the packet, SeqTsHeader removed
+   * \param socket the listening socket
+   * \param from the peer
+   * \return the reply to send back, null for none
+   */
+  Ptr<Packet> HandlePeerPacket (Ptr<Packet> packet, Ptr<Socket> socket, Address from);
 
   uint16_t m_port; //!< Port on which we listen for incoming packets.
-  Ptr<Socket> m_socket; //!< IPv4 Soscket
+  Ptr<Socket> m_socket; //!< IPv4 socket listening on m_port
+  Ptr<Socket> m_query_socket; //!< Socket shared by every peer query
+  uint32_t m_peer_query_fanout; //!< Peers queried at once, 0 for all
+  PeerSelection m_peer_selection; //!< Order in which peers are queried
+  double m_peer_rtt_alpha; //!< Weight of a new answer time in the smoothed one
+  Time m_peer_load_cost; //!< Score added by each invocation queued on a peer
+  std::map<Ipv4Address, PeerScore> m_peer_scores; //!< Scores of the peers heard from
+  std::map<Ipv4Address, uint32_t> m_address_owners; //!< Node owning each address, see IsSamePeer
+  Ptr<UniformRandomVariable> m_peer_chooser; //!< Draws the TWO_CHOICES_SELECTION candidates
+  Time m_module_location_ttl; //!< Lifetime of module location cache entries
+  Ptr<WasmModuleCachePolicy> m_module_cache_policy; //!< Decides which fetched modules are kept
+  std::unordered_set<std::string> m_pinned_modules; //!< Modules registered by RegisterWasmModule
+  Ptr<WasmExecutionCostModel> m_execution_cost_model; //!< Simulated function run time, if any
+  uint32_t m_execution_slots; //!< Functions that may run at once
+  uint32_t m_max_queue_size; //!< Invocations that may wait for a slot, 0 for unlimited
+  QueueDiscipline m_queue_discipline; //!< Order of the waiting invocations
+  OverflowAction m_overflow_action; //!< Fate of invocations that find the queue full
+  /// Invocations waiting for a slot, by priority order and arrival sequence
+  std::map<std::pair<uint32_t, uint64_t>, Execution> m_execution_queue;
+  uint64_t m_next_execution_seq; //!< Arrival sequence of the next queued invocation
+  std::unordered_set<uint64_t> m_remote_executions; //!< Requests of peers queued or running here
+  uint32_t m_busy_slots; //!< Slots running a function
+  TracedValue<uint32_t> m_queueDepth; //!< Invocations waiting for a slot
+  TracedValue<Time> m_queueWait; //!< Wait of the last started invocation
+  TracedValue<uint64_t> m_rejected; //!< Invocations turned away by a full queue
+  TracedValue<uint64_t> m_timedOut; //!< Request steps given up after their last retry
+  Time m_last_run_duration; //!< Host time taken by the last RunModule call
+  std::unordered_set<std::string> m_pure_modules; //!< Modules whose results are memoized
+  uint32_t m_memo_cache_size; //!< Results kept in the memo cache, 0 disables it
+  /// Kept results of pure functions by key, most recently used first
+  std::list<std::pair<std::string, WasmFaasValue>> m_memo_lru;
+  /// Entries of m_memo_lru by key, see LookupMemo
+  std::unordered_map<std::string, std::list<std::pair<std::string, WasmFaasValue>>::iterator>
+      m_memo_index;
+  std::string m_memo_key; //!< Key of the last memo lookup, storage is reused
+  uint64_t m_memo_lookups; //!< Invocations of pure functions looked up
+  uint64_t m_memo_hits; //!< Lookups that found a kept result
+  TracedValue<double> m_memoHitRatio; //!< m_memo_hits over m_memo_lookups
   uint64_t m_received; //!< Number of received packets
   uint64_t m_sent; //!< Number of sent packets
+  bool m_text_protocol; //!< Use the legacy text format instead of WasmFaasHeader
+  Ptr<WasmFaasEventLog> m_event_log; //!< Binary log of the protocol events, if any
+  std::string m_rx_payload; //!< Payload of the last received message, storage is reused
+  std::string m_rx_text; //!< Last received text protocol message, storage is reused
+  bool m_chunked_module_transfer; //!< Send modules as raw chunks
+  uint32_t m_module_chunk_size; //!< Module bytes per chunk
+  uint32_t m_module_transfer_window; //!< Unacknowledged chunks allowed in flight
+  Time m_module_chunk_timeout; //!< Wait for a chunk ack before sending the chunks again
+  uint32_t m_max_module_size; //!< Largest module accepted from a chunked transfer
 
   PacketLossCounter m_lossCounter; //!< Lost packet counter
   u_int64_t m_runtime_id;
-  u_int8_t m_is_querying_peers_idx;
-  bool m_is_querying_peers;
 
-  u_int32_t m_microseconds_eventloop_interval;
+  std::unordered_map<uint64_t, RequestContext> m_requests; //!< In-flight requests by ID
+  uint32_t m_nOwnRequests; //!< Requests of m_requests made by this node, prefetches included
+  uint32_t m_next_request_seq; //!< Sequence used to build local request IDs
+  std::unordered_map<uint64_t, ModuleTransfer> m_module_transfers; //!< Outgoing chunked transfers
+  std::unordered_map<std::string, ModuleLocation> m_module_locations; //!< Known module holders
+  uint8_t m_max_hops; //!< Times a request may be forwarded
+  Time m_request_timeout; //!< Wait for the peers before a retry, 0 disables timeouts
+  uint32_t m_request_retries; //!< Retries before a request fails
+  double m_request_retry_backoff; //!< Timeout factor applied at each retry
+  Time m_duplicate_window; //!< How long replies are kept, negative for the retry horizon
+  /// Replies sent for execute requests, by request ID, see RememberAnswer
+  std::unordered_map<uint64_t, WasmFaasHeader> m_answers;
+  std::deque<std::pair<Time, uint64_t>> m_answer_expiry; //!< m_answers entries by expiry
+  WasmFaasWorkflowTable m_workflows; //!< Workflows held by this node and their tasks
+  Time m_workflow_timeout; //!< Wait for the result of a workflow, 0 for no limit
+  std::string m_workflow_payload; //!< Payload of the last workflow sent, storage is reused
+  Time m_batch_window; //!< Wait for more packets to the same peer, 0 disables batching
+  uint32_t m_batch_max_size; //!< Largest batch payload, in bytes
+  WasmFaasBatcher m_batcher; //!< Batches being filled
+  std::string m_batch_payload; //!< Payload of the last batch, storage is reused
+  uint32_t m_prefetch_count; //!< Predicted modules fetched after an invocation, 0 disables it
+  double m_prefetch_threshold; //!< Lowest probability of a module to be prefetched
+  std::unordered_map<std::string, uint32_t> m_module_invocations; //!< Invocations by module
+  /// Times each module was invoked right after another, by the module before
+  std::unordered_map<std::string, std::unordered_map<std::string, uint32_t>> m_module_transitions;
+  std::string m_last_module; //!< Module of the last invocation
+  std::deque<std::string> m_prefetch_queue; //!< Predicted modules not fetched yet, likeliest first
+  std::unordered_set<std::string> m_prefetched_modules; //!< Prefetched modules not invoked yet
+  TracedValue<uint64_t> m_prefetched; //!< Modules fetched ahead of their invocations
+  TracedValue<uint64_t> m_prefetchHits; //!< Invocations that found a prefetched module
+  Time m_gossip_interval; //!< Time between two gossip rounds, 0 disables gossip
+  uint32_t m_gossip_fanout; //!< Peers sent the digest at each round
+  uint32_t m_gossip_digest_bits; //!< Size of the gossiped digests, in bits
+  uint8_t m_gossip_digest_hashes; //!< Bits set by each module in the gossiped digests
+  Time m_gossip_digest_ttl; //!< How long a received digest is used
+  std::map<Ipv4Address, PeerDigest> m_peer_digests; //!< Digests received, by peer
+  EventId m_gossip_event; //!< Next gossip round
+  uint64_t m_gossip_bytes_sent; //!< Digest bytes sent, headers included
 
-  std::vector<InetSocketAddress> m_peers_queried;
-  std::string m_query_peers_func_name;
-  std::vector<int32_t> m_query_peers_func_args;
-  Address m_original_module_requester;
-
-  u_int32_t m_peer_module_exec_query_state;
-  bool m_has_module_exec_result;
-  int32_t m_module_exec_result;
-
-  bool m_is_waiting_for_module_load = false;
+  /// Module and start time of the invocations made through ExecuteFunction still in flight
+  std::unordered_map<uint64_t, std::pair<std::string, Time>> m_invocations;
+  WasmFaasLatencyHistogram m_latency; //!< Latencies of the invocations made on this node
+  std::map<std::string, WasmFaasLatencyHistogram> m_module_latency; //!< m_latency by module
+  /// Whether each invocation made through ExecuteFunction still in flight looked up its module
+  std::unordered_map<uint64_t, bool> m_cold_starts;
+  WasmFaasLatencyHistogram m_cold_latency; //!< m_latency of the cold invocations
+  WasmFaasLatencyHistogram m_warm_latency; //!< m_latency of the others
 
   std::vector<InetSocketAddress> m_peerAddresses; //!< Remote peer address
 
@@ -155,6 +1063,27 @@ private:
 
   /// Callbacks for tracing the packet Rx events, includes source and destination addresses
   TracedCallback<Ptr<const Packet>, const Address &, const Address &> m_rxTraceWithAddresses;
+
+  /// Callbacks for tracing completed invocations
+  TracedCallback<const WasmFaasResult &> m_invocationCompletedTrace;
+
+  /// Callbacks for tracing completed module transfers
+  TracedCallback<const std::string &, uint32_t, Time> m_moduleTransferTrace;
+
+  /// Callbacks for tracing invocations made on this node
+  TracedCallback<uint64_t, const std::string &> m_invocationStartTrace;
+  /// Callbacks for tracing invocations whose module was found, here or on a peer
+  TracedCallback<uint64_t, const std::string &> m_discoveryCompleteTrace;
+  /// Callbacks for tracing modules received for an invocation
+  TracedCallback<uint64_t, const std::string &> m_moduleTransferCompleteTrace;
+  /// Callbacks for tracing functions starting to run on this node
+  TracedCallback<uint64_t, const std::string &> m_executionStartTrace;
+  /// Callbacks for tracing functions done running on this node
+  TracedCallback<uint64_t, const std::string &> m_executionEndTrace;
+  /// Callbacks for tracing results handed back to the invocations made on this node
+  TracedCallback<uint64_t, const std::string &> m_resultDeliveredTrace;
+  /// Callbacks for sent batches
+  TracedCallback<uint32_t, uint32_t> m_batchSentTrace;
 };
 
 } // namespace ns3
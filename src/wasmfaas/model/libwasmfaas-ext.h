@@ -0,0 +1,77 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LIBWASMFAAS_EXT_H
+#define LIBWASMFAAS_EXT_H
+
+// Optional runtime entry points used by the wasmfaas module.
+//
+// libwasmfaas.h is generated by cbindgen from the runtime and must not be
+// edited. This header is maintained here and declares the entry points the
+// module uses when the runtime provides them. They are declared weak so that
+// the program still links against runtimes built without them; their
+// address is then null and callers must check it before calling them.
+
+#include <cstdint>
+
+#include "libwasmfaas.h"
+
+/// A Wasm value passed in binary form, values of up to 64 bits live in lo.
+struct WasmValue
+{
+  ArgType value_type;
+  uint64_t lo;
+  uint64_t hi;
+};
+
+extern "C" {
+
+/// Runs a function with any number of typed arguments and stores its first
+/// return value in result. Returns 0 on success.
+int32_t execute_module_typed (uint64_t runtime_id, const char *module_name,
+                              const char *function_name, const WasmValue *args, uintptr_t n_args,
+                              WasmValue *result) __attribute__ ((weak));
+
+/// Compiles a module once for every runtime of the process and returns a
+/// handle to it, 0 on failure.
+uint64_t compile_module (const char *module_data_base_64) __attribute__ ((weak));
+
+/// Registers a module compiled by compile_module in a runtime, which keeps
+/// its own instances of it. Returns null on success, else an error message
+/// to release with free_ffi_string.
+const char *register_compiled_module (uint64_t runtime_id, const char *module_name,
+                                      uint64_t module_handle) __attribute__ ((weak));
+
+/// Releases a module compiled by compile_module or load_compiled_module.
+/// Runtimes the module was registered in keep their instances of it.
+void release_compiled_module (uint64_t module_handle) __attribute__ ((weak));
+
+/// Returns the runtime version, artifacts of other versions cannot be loaded.
+const char *get_runtime_version () __attribute__ ((weak));
+
+/// Writes the precompiled artifact of a module compiled by compile_module
+/// to buffer if it holds size bytes, and returns the artifact size in any
+/// case, 0 on failure.
+uintptr_t serialize_compiled_module (uint64_t module_handle, uint8_t *buffer, uintptr_t size)
+    __attribute__ ((weak));
+
+/// Loads a precompiled artifact written by serialize_compiled_module and
+/// returns a handle to the module as compile_module does, 0 on failure. The
+/// artifact memory must stay valid while the handle is used.
+uint64_t load_compiled_module (const uint8_t *artifact, uintptr_t size) __attribute__ ((weak));
+
+} // extern "C"
+#endif // LIBWASMFAAS_EXT_H
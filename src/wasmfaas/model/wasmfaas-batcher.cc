@@ -0,0 +1,148 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "wasmfaas-batcher.h"
+#include "wasmfaas-header.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("WasmFaasBatcher");
+
+WasmFaasBatcher::WasmFaasBatcher () : m_window (Seconds (0)), m_maxSize (0)
+{
+}
+
+void
+WasmFaasBatcher::SetWindow (Time window, uint32_t maxSize)
+{
+  m_window = window;
+  m_maxSize = maxSize;
+}
+
+void
+WasmFaasBatcher::SetFlushCallback (FlushCallback callback)
+{
+  m_flush = callback;
+}
+
+bool
+WasmFaasBatcher::IsEnabled (void) const
+{
+  return m_window.IsStrictlyPositive ();
+}
+
+bool
+WasmFaasBatcher::Add (Ptr<Socket> socket, const Address &peer, Ptr<Packet> message)
+{
+  NS_LOG_FUNCTION (this << socket << peer << message);
+
+  auto key = std::make_pair (socket, peer);
+  auto it = m_batches.find (key);
+  auto size = message->GetSize () + 2;
+  if (size > m_maxSize || size > 0xffff)
+    {
+      // Messages to a peer keep their order
+      if (it != m_batches.end ())
+        {
+          Flush (socket, peer);
+        }
+      return false;
+    }
+
+  if (it != m_batches.end () && it->second.size + size > m_maxSize)
+    {
+      Flush (socket, peer);
+      it = m_batches.end ();
+    }
+  if (it == m_batches.end ())
+    {
+      it = m_batches.emplace (key, Batch ()).first;
+      it->second.size = 0;
+      it->second.flushEvent =
+          Simulator::Schedule (m_window, &WasmFaasBatcher::Flush, this, socket, peer);
+    }
+  it->second.messages.push_back (message);
+  it->second.size += size;
+  return true;
+}
+
+void
+WasmFaasBatcher::Flush (Ptr<Socket> socket, Address peer)
+{
+  NS_LOG_FUNCTION (this << socket << peer);
+
+  auto it = m_batches.find (std::make_pair (socket, peer));
+  if (it == m_batches.end ())
+    {
+      return;
+    }
+  auto messages = std::move (it->second.messages);
+  it->second.flushEvent.Cancel ();
+  m_batches.erase (it);
+  m_flush (socket, peer, messages);
+}
+
+void
+WasmFaasBatcher::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (auto &entry : m_batches)
+    {
+      entry.second.flushEvent.Cancel ();
+    }
+  m_batches.clear ();
+}
+
+void
+WasmFaasBatcher::Pack (const std::vector<Ptr<Packet>> &messages, std::string &payload)
+{
+  payload.clear ();
+  for (auto &message : messages)
+    {
+      NS_ASSERT (message->GetSize () <= 0xffff);
+      auto offset = payload.size ();
+      payload.resize (offset + 2 + message->GetSize ());
+      payload[offset] = static_cast<char> (message->GetSize () & 0xff);
+      payload[offset + 1] = static_cast<char> (message->GetSize () >> 8);
+      message->CopyData ((uint8_t *) &payload[offset + 2], message->GetSize ());
+    }
+}
+
+void
+WasmFaasBatcher::Unpack (const std::string &payload, std::vector<Ptr<Packet>> &messages)
+{
+  messages.clear ();
+  std::size_t pos = 0;
+  while (pos + 2 <= payload.size ())
+    {
+      uint32_t size = static_cast<uint8_t> (payload[pos]) |
+                      static_cast<uint8_t> (payload[pos + 1]) << 8;
+      if (pos + 2 + size > payload.size ())
+        {
+          break;
+        }
+      // An entry too short for a header holds no message, ParsePacket checks the rest
+      if (size >= WasmFaasHeader::FIXED_SIZE)
+        {
+          messages.push_back (Create<Packet> ((const uint8_t *) &payload[pos + 2], size));
+        }
+      pos += 2 + size;
+    }
+}
+
+} // namespace ns3
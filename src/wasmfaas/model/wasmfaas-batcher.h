@@ -0,0 +1,133 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef WASMFAAS_BATCHER_H
+#define WASMFAAS_BATCHER_H
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ns3/address.h"
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/socket.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup customapp
+ *
+ * \brief Holds the messages sent to a peer from a socket so that they leave
+ * as one BATCH message, see the CustomApp BatchWindow attribute.
+ *
+ * A batch is handed to the flush callback once Window elapsed since its
+ * first message, or when the next message would make it larger than the
+ * maximum size. The flush callback builds and sends the packet. Pack and
+ * Unpack convert between the messages and the BATCH payload, each message
+ * as its size (2, little endian) followed by its header and payload.
+ */
+class WasmFaasBatcher
+{
+public:
+  /// Callback sending the messages of a batch to a peer from a socket
+  typedef Callback<void, Ptr<Socket>, const Address &, const std::vector<Ptr<Packet>> &>
+      FlushCallback;
+
+  WasmFaasBatcher ();
+
+  /**
+   * \param window how long the first message of a batch waits, 0 disables batching
+   * \param maxSize the largest batch payload, in bytes
+   */
+  void SetWindow (Time window, uint32_t maxSize);
+
+  /**
+   * \param callback called with the messages of each batch, in send order
+   */
+  void SetFlushCallback (FlushCallback callback);
+
+  /**
+   * \return true if the window is strictly positive
+   */
+  bool IsEnabled (void) const;
+
+  /**
+   * \brief Add a message to the batch of a peer, starting the batch if needed.
+   *
+   * A message too large for any batch is not added. The batch of its peer
+   * is flushed first, so the caller sending the message right after keeps
+   * the messages to the peer in order.
+   *
+   * \param socket the socket to send from
+   * \param peer the peer address
+   * \param message the message, without SeqTsHeader
+   * \return false if the message was not added
+   */
+  bool Add (Ptr<Socket> socket, const Address &peer, Ptr<Packet> message);
+
+  /**
+   * \brief Hand the batch of a peer to the flush callback, if any.
+   * \param socket the socket
+   * \param peer the peer address
+   */
+  void Flush (Ptr<Socket> socket, Address peer);
+
+  /**
+   * \brief Drop every batch without flushing it.
+   */
+  void Clear (void);
+
+  /**
+   * \brief Build the payload of a BATCH message.
+   * \param messages the messages, each smaller than 64 KiB
+   * \param payload filled with the payload. Passing the same string every
+   *        time reuses its storage.
+   */
+  static void Pack (const std::vector<Ptr<Packet>> &messages, std::string &payload);
+
+  /**
+   * \brief Split the payload of a BATCH message into the messages it carries.
+   *
+   * Entries too short for a WasmFaasHeader are skipped, and a truncated
+   * entry ends the payload.
+   *
+   * \param payload the payload
+   * \param messages filled with the messages
+   */
+  static void Unpack (const std::string &payload, std::vector<Ptr<Packet>> &messages);
+
+private:
+  /// Messages waiting to be sent to a peer as one packet
+  struct Batch
+  {
+    std::vector<Ptr<Packet>> messages; //!< Messages in send order, SeqTsHeader removed
+    uint32_t size; //!< Bytes the messages take in the batch
+    EventId flushEvent; //!< End of the batch window
+  };
+
+  Time m_window; //!< Wait for more messages to the same peer, 0 disables batching
+  uint32_t m_maxSize; //!< Largest batch payload, in bytes
+  FlushCallback m_flush; //!< Sends the batches
+  std::map<std::pair<Ptr<Socket>, Address>, Batch> m_batches; //!< Batches by socket and peer
+};
+
+} // namespace ns3
+
+#endif /* WASMFAAS_BATCHER_H */
@@ -0,0 +1,343 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "wasmfaas-cache-policy.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("WasmModuleCachePolicy");
+
+NS_OBJECT_ENSURE_REGISTERED (WasmModuleCachePolicy);
+NS_OBJECT_ENSURE_REGISTERED (LruWasmModuleCachePolicy);
+NS_OBJECT_ENSURE_REGISTERED (LfuWasmModuleCachePolicy);
+NS_OBJECT_ENSURE_REGISTERED (GreedyDualSizeWasmModuleCachePolicy);
+NS_OBJECT_ENSURE_REGISTERED (NeverWasmModuleCachePolicy);
+
+TypeId
+WasmModuleCachePolicy::GetTypeId (void)
+{
+  static TypeId tid =
+      TypeId ("ns3::WasmModuleCachePolicy")
+          .SetParent<Object> ()
+          .SetGroupName ("Applications")
+          .AddAttribute ("Capacity",
+                         "Bytes of fetched modules a node may keep, 0 for unlimited. Modules "
+                         "larger than the capacity are not cached.",
+                         UintegerValue (0),
+                         MakeUintegerAccessor (&WasmModuleCachePolicy::m_capacity),
+                         MakeUintegerChecker<uint64_t> ());
+  return tid;
+}
+
+WasmModuleCachePolicy::WasmModuleCachePolicy () : m_capacity (0), m_used (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+WasmModuleCachePolicy::~WasmModuleCachePolicy ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+WasmModuleCachePolicy::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_sizes.clear ();
+  m_used = 0;
+  Object::DoDispose ();
+}
+
+bool
+WasmModuleCachePolicy::ShouldFetch (const std::string &name) const
+{
+  return true;
+}
+
+bool
+WasmModuleCachePolicy::Insert (const std::string &name, uint32_t size,
+                               std::vector<std::string> &evicted)
+{
+  NS_LOG_FUNCTION (this << name << size);
+
+  if (Contains (name))
+    {
+      Access (name);
+      return true;
+    }
+  if (!ShouldFetch (name) || (m_capacity > 0 && size > m_capacity))
+    {
+      return false;
+    }
+
+  while (m_capacity > 0 && m_used + size > m_capacity)
+    {
+      auto victim = SelectVictim ();
+      DoRemove (victim);
+      m_used -= m_sizes[victim];
+      m_sizes.erase (victim);
+      evicted.push_back (victim);
+    }
+
+  m_sizes[name] = size;
+  m_used += size;
+  DoInsert (name, size);
+  return true;
+}
+
+void
+WasmModuleCachePolicy::Access (const std::string &name)
+{
+  NS_LOG_FUNCTION (this << name);
+  if (Contains (name))
+    {
+      DoAccess (name);
+    }
+}
+
+bool
+WasmModuleCachePolicy::Contains (const std::string &name) const
+{
+  return m_sizes.find (name) != m_sizes.end ();
+}
+
+std::vector<std::string>
+WasmModuleCachePolicy::GetModules (void) const
+{
+  std::vector<std::string> names;
+  names.reserve (m_sizes.size ());
+  for (auto &entry : m_sizes)
+    {
+      names.push_back (entry.first);
+    }
+  return names;
+}
+
+uint64_t
+WasmModuleCachePolicy::GetCapacity (void) const
+{
+  return m_capacity;
+}
+
+uint64_t
+WasmModuleCachePolicy::GetUsedBytes (void) const
+{
+  return m_used;
+}
+
+TypeId
+LruWasmModuleCachePolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LruWasmModuleCachePolicy")
+                          .SetParent<WasmModuleCachePolicy> ()
+                          .SetGroupName ("Applications")
+                          .AddConstructor<LruWasmModuleCachePolicy> ();
+  return tid;
+}
+
+void
+LruWasmModuleCachePolicy::DoDispose (void)
+{
+  m_order.clear ();
+  m_entries.clear ();
+  WasmModuleCachePolicy::DoDispose ();
+}
+
+void
+LruWasmModuleCachePolicy::DoInsert (const std::string &name, uint32_t size)
+{
+  m_order.push_front (name);
+  m_entries[name] = m_order.begin ();
+}
+
+void
+LruWasmModuleCachePolicy::DoAccess (const std::string &name)
+{
+  m_order.splice (m_order.begin (), m_order, m_entries[name]);
+}
+
+void
+LruWasmModuleCachePolicy::DoRemove (const std::string &name)
+{
+  m_order.erase (m_entries[name]);
+  m_entries.erase (name);
+}
+
+std::string
+LruWasmModuleCachePolicy::SelectVictim (void)
+{
+  return m_order.back ();
+}
+
+TypeId
+LfuWasmModuleCachePolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LfuWasmModuleCachePolicy")
+                          .SetParent<WasmModuleCachePolicy> ()
+                          .SetGroupName ("Applications")
+                          .AddConstructor<LfuWasmModuleCachePolicy> ();
+  return tid;
+}
+
+LfuWasmModuleCachePolicy::LfuWasmModuleCachePolicy () : m_clock (0)
+{
+}
+
+void
+LfuWasmModuleCachePolicy::DoDispose (void)
+{
+  m_order.clear ();
+  m_entries.clear ();
+  WasmModuleCachePolicy::DoDispose ();
+}
+
+void
+LfuWasmModuleCachePolicy::DoInsert (const std::string &name, uint32_t size)
+{
+  auto key = Key (1, m_clock++, name);
+  m_order.insert (key);
+  m_entries[name] = key;
+}
+
+void
+LfuWasmModuleCachePolicy::DoAccess (const std::string &name)
+{
+  auto &key = m_entries[name];
+  m_order.erase (key);
+  key = Key (std::get<0> (key) + 1, m_clock++, name);
+  m_order.insert (key);
+}
+
+void
+LfuWasmModuleCachePolicy::DoRemove (const std::string &name)
+{
+  m_order.erase (m_entries[name]);
+  m_entries.erase (name);
+}
+
+std::string
+LfuWasmModuleCachePolicy::SelectVictim (void)
+{
+  return std::get<2> (*m_order.begin ());
+}
+
+TypeId
+GreedyDualSizeWasmModuleCachePolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::GreedyDualSizeWasmModuleCachePolicy")
+                          .SetParent<WasmModuleCachePolicy> ()
+                          .SetGroupName ("Applications")
+                          .AddConstructor<GreedyDualSizeWasmModuleCachePolicy> ();
+  return tid;
+}
+
+GreedyDualSizeWasmModuleCachePolicy::GreedyDualSizeWasmModuleCachePolicy () : m_inflation (0)
+{
+}
+
+void
+GreedyDualSizeWasmModuleCachePolicy::DoDispose (void)
+{
+  m_order.clear ();
+  m_entries.clear ();
+  m_sizes.clear ();
+  WasmModuleCachePolicy::DoDispose ();
+}
+
+void
+GreedyDualSizeWasmModuleCachePolicy::Refresh (const std::string &name)
+{
+  auto it = m_entries.find (name);
+  if (it != m_entries.end ())
+    {
+      m_order.erase (it->second);
+    }
+  auto key = Key (m_inflation + 1.0 / std::max (m_sizes[name], 1u), name);
+  m_order.insert (key);
+  m_entries[name] = key;
+}
+
+void
+GreedyDualSizeWasmModuleCachePolicy::DoInsert (const std::string &name, uint32_t size)
+{
+  m_sizes[name] = size;
+  Refresh (name);
+}
+
+void
+GreedyDualSizeWasmModuleCachePolicy::DoAccess (const std::string &name)
+{
+  Refresh (name);
+}
+
+void
+GreedyDualSizeWasmModuleCachePolicy::DoRemove (const std::string &name)
+{
+  m_order.erase (m_entries[name]);
+  m_entries.erase (name);
+  m_sizes.erase (name);
+}
+
+std::string
+GreedyDualSizeWasmModuleCachePolicy::SelectVictim (void)
+{
+  m_inflation = m_order.begin ()->first;
+  return m_order.begin ()->second;
+}
+
+TypeId
+NeverWasmModuleCachePolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::NeverWasmModuleCachePolicy")
+                          .SetParent<WasmModuleCachePolicy> ()
+                          .SetGroupName ("Applications")
+                          .AddConstructor<NeverWasmModuleCachePolicy> ();
+  return tid;
+}
+
+bool
+NeverWasmModuleCachePolicy::ShouldFetch (const std::string &name) const
+{
+  return false;
+}
+
+void
+NeverWasmModuleCachePolicy::DoInsert (const std::string &name, uint32_t size)
+{
+}
+
+void
+NeverWasmModuleCachePolicy::DoAccess (const std::string &name)
+{
+}
+
+void
+NeverWasmModuleCachePolicy::DoRemove (const std::string &name)
+{
+}
+
+std::string
+NeverWasmModuleCachePolicy::SelectVictim (void)
+{
+  NS_FATAL_ERROR ("NeverWasmModuleCachePolicy holds no module");
+  return std::string ();
+}
+
+} // namespace ns3
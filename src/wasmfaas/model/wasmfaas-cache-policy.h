@@ -0,0 +1,259 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef WASMFAAS_CACHE_POLICY_H
+#define WASMFAAS_CACHE_POLICY_H
+
+#include <list>
+#include <set>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "ns3/object.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup customapp
+ *
+ * \brief Decides which modules fetched from peers a CustomApp keeps.
+ *
+ * Modules registered with CustomApp::RegisterWasmModule are not managed by
+ * the policy and are never evicted. Every module fetched from a peer is
+ * offered to Insert, which evicts modules chosen by the subclass until the
+ * new one fits in Capacity bytes.
+ *
+ * The runtime has no way to unregister a module, so an evicted module stays
+ * registered and keeps its memory. Eviction only decides what the node
+ * serves and runs: an evicted module is fetched again on its next
+ * invocation and peers asking for it are told the node lacks it. Capacity
+ * models the cache of a real node, not the memory of the simulation.
+ */
+class WasmModuleCachePolicy : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  WasmModuleCachePolicy ();
+  virtual ~WasmModuleCachePolicy ();
+
+  /**
+   * \brief Whether a module found on a peer should be transferred at all.
+   * \param name the module name
+   * \return true if the module should be fetched and offered to Insert
+   */
+  virtual bool ShouldFetch (const std::string &name) const;
+
+  /**
+   * \brief Cache a module, evicting others to make room for it.
+   * \param name the module name
+   * \param size the module size in bytes
+   * \param evicted filled with the modules evicted to make room
+   * \return false if the module is not cached
+   */
+  bool Insert (const std::string &name, uint32_t size, std::vector<std::string> &evicted);
+
+  /**
+   * \brief Record a use of a cached module.
+   * \param name the module name
+   */
+  void Access (const std::string &name);
+
+  /**
+   * \param name the module name
+   * \return true if the module is cached
+   */
+  bool Contains (const std::string &name) const;
+
+  /**
+   * \return the names of the cached modules, in no particular order
+   */
+  std::vector<std::string> GetModules (void) const;
+
+  /**
+   * \return the capacity in bytes, 0 for unlimited
+   */
+  uint64_t GetCapacity (void) const;
+
+  /**
+   * \return the bytes taken by the cached modules
+   */
+  uint64_t GetUsedBytes (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+  /**
+   * \brief Start tracking a module that has just been cached.
+   * \param name the module name
+   * \param size the module size in bytes
+   */
+  virtual void DoInsert (const std::string &name, uint32_t size) = 0;
+  /**
+   * \brief Record a use of a cached module.
+   * \param name the module name
+   */
+  virtual void DoAccess (const std::string &name) = 0;
+  /**
+   * \brief Stop tracking a module that is being evicted.
+   * \param name the module name
+   */
+  virtual void DoRemove (const std::string &name) = 0;
+  /**
+   * \return the cached module to evict next
+   */
+  virtual std::string SelectVictim (void) = 0;
+
+private:
+  uint64_t m_capacity; //!< Capacity in bytes, 0 for unlimited
+  uint64_t m_used; //!< Bytes taken by the cached modules
+  std::unordered_map<std::string, uint32_t> m_sizes; //!< Size of every cached module
+};
+
+/**
+ * \ingroup customapp
+ *
+ * \brief Evicts the least recently used module.
+ */
+class LruWasmModuleCachePolicy : public WasmModuleCachePolicy
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+protected:
+  virtual void DoDispose (void);
+  virtual void DoInsert (const std::string &name, uint32_t size);
+  virtual void DoAccess (const std::string &name);
+  virtual void DoRemove (const std::string &name);
+  virtual std::string SelectVictim (void);
+
+private:
+  std::list<std::string> m_order; //!< Modules, most recently used first
+  std::unordered_map<std::string, std::list<std::string>::iterator> m_entries; //!< m_order entries
+};
+
+/**
+ * \ingroup customapp
+ *
+ * \brief Evicts the least frequently used module, the least recently used
+ * one among equals.
+ */
+class LfuWasmModuleCachePolicy : public WasmModuleCachePolicy
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  LfuWasmModuleCachePolicy ();
+
+protected:
+  virtual void DoDispose (void);
+  virtual void DoInsert (const std::string &name, uint32_t size);
+  virtual void DoAccess (const std::string &name);
+  virtual void DoRemove (const std::string &name);
+  virtual std::string SelectVictim (void);
+
+private:
+  /// Use count, last use and name of a module
+  typedef std::tuple<uint64_t, uint64_t, std::string> Key;
+
+  uint64_t m_clock; //!< Incremented on every use
+  std::set<Key> m_order; //!< Modules, eviction candidate first
+  std::unordered_map<std::string, Key> m_entries; //!< m_order key of every module
+};
+
+/**
+ * \ingroup customapp
+ *
+ * \brief GreedyDual-Size: evicts the module with the lowest credit.
+ *
+ * A module gets the credit L + 1 / size when cached or used, where L is the
+ * credit of the last evicted module. Large modules are evicted first, and
+ * modules that are not used age as L grows.
+ */
+class GreedyDualSizeWasmModuleCachePolicy : public WasmModuleCachePolicy
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  GreedyDualSizeWasmModuleCachePolicy ();
+
+protected:
+  virtual void DoDispose (void);
+  virtual void DoInsert (const std::string &name, uint32_t size);
+  virtual void DoAccess (const std::string &name);
+  virtual void DoRemove (const std::string &name);
+  virtual std::string SelectVictim (void);
+
+private:
+  /// Credit and name of a module
+  typedef std::pair<double, std::string> Key;
+
+  /**
+   * \brief Give a module its full credit again.
+   * \param name the module name
+   */
+  void Refresh (const std::string &name);
+
+  double m_inflation; //!< L, credit of the last evicted module
+  std::set<Key> m_order; //!< Modules, lowest credit first
+  std::unordered_map<std::string, Key> m_entries; //!< m_order key of every module
+  std::unordered_map<std::string, uint32_t> m_sizes; //!< Size of every module
+};
+
+/**
+ * \ingroup customapp
+ *
+ * \brief Never caches a module, results are taken from the peers every time.
+ */
+class NeverWasmModuleCachePolicy : public WasmModuleCachePolicy
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual bool ShouldFetch (const std::string &name) const;
+
+protected:
+  virtual void DoInsert (const std::string &name, uint32_t size);
+  virtual void DoAccess (const std::string &name);
+  virtual void DoRemove (const std::string &name);
+  virtual std::string SelectVictim (void);
+};
+
+} // namespace ns3
+
+#endif /* WASMFAAS_CACHE_POLICY_H */
@@ -0,0 +1,132 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/header.h"
+#include "wasmfaas-chunk-header.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("WasmFaasChunkHeader");
+
+NS_OBJECT_ENSURE_REGISTERED (WasmFaasChunkHeader);
+
+WasmFaasChunkHeader::WasmFaasChunkHeader () : m_seq (0), m_chunkSize (0), m_moduleSize (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+WasmFaasChunkHeader::SetSeq (uint32_t seq)
+{
+  NS_LOG_FUNCTION (this << seq);
+  m_seq = seq;
+}
+
+uint32_t
+WasmFaasChunkHeader::GetSeq (void) const
+{
+  return m_seq;
+}
+
+void
+WasmFaasChunkHeader::SetChunkSize (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  m_chunkSize = size;
+}
+
+uint32_t
+WasmFaasChunkHeader::GetChunkSize (void) const
+{
+  return m_chunkSize;
+}
+
+void
+WasmFaasChunkHeader::SetModuleSize (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  m_moduleSize = size;
+}
+
+uint32_t
+WasmFaasChunkHeader::GetModuleSize (void) const
+{
+  return m_moduleSize;
+}
+
+uint32_t
+WasmFaasChunkHeader::GetCount (void) const
+{
+  if (m_chunkSize == 0)
+    {
+      return 0;
+    }
+  return (m_moduleSize + m_chunkSize - 1) / m_chunkSize;
+}
+
+TypeId
+WasmFaasChunkHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::WasmFaasChunkHeader")
+                          .SetParent<Header> ()
+                          .SetGroupName ("Applications")
+                          .AddConstructor<WasmFaasChunkHeader> ();
+  return tid;
+}
+
+TypeId
+WasmFaasChunkHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+WasmFaasChunkHeader::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "(chunk=" << m_seq << "/" << GetCount () << " chunkSize=" << m_chunkSize
+     << " size=" << m_moduleSize << ")";
+}
+
+uint32_t
+WasmFaasChunkHeader::GetSerializedSize (void) const
+{
+  return 4 + 4 + 4;
+}
+
+void
+WasmFaasChunkHeader::Serialize (Buffer::Iterator start) const
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  i.WriteHtonU32 (m_seq);
+  i.WriteHtonU32 (m_chunkSize);
+  i.WriteHtonU32 (m_moduleSize);
+}
+
+uint32_t
+WasmFaasChunkHeader::Deserialize (Buffer::Iterator start)
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  m_seq = i.ReadNtohU32 ();
+  m_chunkSize = i.ReadNtohU32 ();
+  m_moduleSize = i.ReadNtohU32 ();
+  return GetSerializedSize ();
+}
+
+} // namespace ns3
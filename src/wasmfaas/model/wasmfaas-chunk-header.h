@@ -0,0 +1,91 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef WASMFAAS_CHUNK_HEADER_H
+#define WASMFAAS_CHUNK_HEADER_H
+
+#include "ns3/header.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup customapp
+ *
+ * \brief Position of a module chunk within a chunked module transfer.
+ *
+ * Follows the WasmFaasHeader of MODULE_CHUNK and MODULE_CHUNK_ACK messages:
+ * chunk sequence number (4), nominal chunk size (4) and module size (4), in
+ * bytes. Chunk seq starts at byte seq * chunk size of the module, only the
+ * last chunk may be shorter. The chunk data, if any, follows as payload.
+ */
+class WasmFaasChunkHeader : public Header
+{
+public:
+  WasmFaasChunkHeader ();
+
+  /**
+   * \param seq the chunk sequence number, starting at 0
+   */
+  void SetSeq (uint32_t seq);
+  /**
+   * \return the chunk sequence number
+   */
+  uint32_t GetSeq (void) const;
+
+  /**
+   * \param size the size of every chunk but the last, in bytes
+   */
+  void SetChunkSize (uint32_t size);
+  /**
+   * \return the size of every chunk but the last, in bytes
+   */
+  uint32_t GetChunkSize (void) const;
+
+  /**
+   * \param size the module size in bytes
+   */
+  void SetModuleSize (uint32_t size);
+  /**
+   * \return the module size in bytes
+   */
+  uint32_t GetModuleSize (void) const;
+
+  /**
+   * \return the number of chunks of the module
+   */
+  uint32_t GetCount (void) const;
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  uint32_t m_seq; //!< Chunk sequence number
+  uint32_t m_chunkSize; //!< Size of every chunk but the last
+  uint32_t m_moduleSize; //!< Module size in bytes
+};
+
+} // namespace ns3
+
+#endif /* WASMFAAS_CHUNK_HEADER_H */
@@ -0,0 +1,532 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "ns3/enum.h"
+#include "ns3/pointer.h"
+#include "custom-app.h"
+#include "wasmfaas-client.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("WasmFaasClient");
+
+NS_OBJECT_ENSURE_REGISTERED (WasmFaasClient);
+
+TypeId
+WasmFaasClient::GetTypeId (void)
+{
+  static TypeId tid =
+      TypeId ("ns3::WasmFaasClient")
+          .SetParent<Application> ()
+          .SetGroupName ("Applications")
+          .AddConstructor<WasmFaasClient> ()
+          .AddAttribute ("ArrivalProcess", "How invocation times are chosen.",
+                         EnumValue (WasmFaasClient::POISSON),
+                         MakeEnumAccessor (&WasmFaasClient::m_arrivalProcess),
+                         MakeEnumChecker (WasmFaasClient::POISSON, "Poisson",
+                                          WasmFaasClient::CONSTANT_RATE, "ConstantRate",
+                                          WasmFaasClient::ON_OFF, "OnOff", WasmFaasClient::TRACE,
+                                          "Trace"))
+          .AddAttribute ("Rate", "Invocations per second, during on periods for OnOff.",
+                         DoubleValue (10.0), MakeDoubleAccessor (&WasmFaasClient::m_rate),
+                         MakeDoubleChecker<double> (1e-9))
+          .AddAttribute ("MaxInvocations", "Invocations to send, 0 for unlimited.",
+                         UintegerValue (0),
+                         MakeUintegerAccessor (&WasmFaasClient::m_maxInvocations),
+                         MakeUintegerChecker<uint64_t> ())
+          .AddAttribute ("OnTime", "Duration of the on periods of OnOff, in seconds.",
+                         StringValue ("ns3::ConstantRandomVariable[Constant=1.0]"),
+                         MakePointerAccessor (&WasmFaasClient::m_onTime),
+                         MakePointerChecker<RandomVariableStream> ())
+          .AddAttribute ("OffTime", "Duration of the off periods of OnOff, in seconds.",
+                         StringValue ("ns3::ConstantRandomVariable[Constant=1.0]"),
+                         MakePointerAccessor (&WasmFaasClient::m_offTime),
+                         MakePointerChecker<RandomVariableStream> ())
+          .AddAttribute ("TraceFile",
+                         "CSV file of the Trace arrival process, one "
+                         "time,module,function,args... invocation per line.",
+                         StringValue (""), MakeStringAccessor (&WasmFaasClient::m_traceFile),
+                         MakeStringChecker ())
+          .AddAttribute ("Functions",
+                         "Invocation mix, as ';' separated module:function:weight entries, e.g. "
+                         "\"sum:sum:3;div:div:1\".",
+                         StringValue ("sum:sum:1"),
+                         MakeStringAccessor (&WasmFaasClient::SetFunctions,
+                                             &WasmFaasClient::GetFunctions),
+                         MakeStringChecker ())
+          .AddAttribute ("ArgCount", "Arguments drawn for every invocation.", UintegerValue (2),
+                         MakeUintegerAccessor (&WasmFaasClient::m_argCount),
+                         MakeUintegerChecker<uint32_t> (0, WasmFaasHeader::MAX_ARGS))
+          .AddAttribute ("ArgType", "Type of the drawn and trace arguments.",
+                         EnumValue ((int) ArgType::I32),
+                         MakeEnumAccessor (&WasmFaasClient::m_argType),
+                         MakeEnumChecker ((int) ArgType::I32, "I32", (int) ArgType::I64, "I64",
+                                          (int) ArgType::F32, "F32", (int) ArgType::F64, "F64"))
+          .AddAttribute ("ArgValue", "Values of the drawn arguments, rounded for integer types.",
+                         StringValue ("ns3::UniformRandomVariable[Min=0.0|Max=100.0]"),
+                         MakePointerAccessor (&WasmFaasClient::m_argValue),
+                         MakePointerChecker<RandomVariableStream> ())
+          .AddAttribute ("Priority", "Priority of every invocation.", UintegerValue (0),
+                         MakeUintegerAccessor (&WasmFaasClient::m_priority),
+                         MakeUintegerChecker<uint8_t> ())
+          .AddTraceSource ("Invoked", "An invocation has been sent",
+                           MakeTraceSourceAccessor (&WasmFaasClient::m_invokedTrace),
+                           "ns3::WasmFaasClient::InvokedTracedCallback")
+          .AddTraceSource ("Completed", "An invocation has completed, successfully or not",
+                           MakeTraceSourceAccessor (&WasmFaasClient::m_completedTrace),
+                           "ns3::WasmFaasClient::CompletedTracedCallback");
+  return tid;
+}
+
+WasmFaasClient::WasmFaasClient ()
+    : m_traceIdx (0),
+      m_isInvoking (false),
+      m_completedWhileInvoking (false),
+      m_sent (0),
+      m_completed (0),
+      m_failed (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_interArrival = CreateObject<ExponentialRandomVariable> ();
+  m_functionChooser = CreateObject<UniformRandomVariable> ();
+}
+
+WasmFaasClient::~WasmFaasClient ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+WasmFaasClient::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_target = 0;
+  m_pending.clear ();
+  m_trace.clear ();
+  Application::DoDispose ();
+}
+
+void
+WasmFaasClient::SetTarget (Ptr<CustomApp> target)
+{
+  NS_LOG_FUNCTION (this << target);
+  m_target = target;
+}
+
+void
+WasmFaasClient::AddFunction (const std::string &moduleName, const std::string &funcName,
+                             double weight)
+{
+  NS_LOG_FUNCTION (this << moduleName << funcName << weight);
+  double total = m_functions.empty () ? 0.0 : m_functions.back ().cumulativeWeight;
+  m_functions.push_back (Function{moduleName, funcName, total + weight});
+}
+
+void
+WasmFaasClient::SetFunctions (std::string functions)
+{
+  NS_LOG_FUNCTION (this << functions);
+
+  if (!ParseFunctions (functions, m_functions))
+    {
+      NS_FATAL_ERROR ("Invalid function mix " << functions);
+    }
+  m_functionsString = functions;
+}
+
+bool
+WasmFaasClient::ParseFunctions (const std::string &functions, std::vector<Function> &mix)
+{
+  std::vector<Function> parsed;
+  std::istringstream entries (functions);
+  std::string entry;
+  while (std::getline (entries, entry, ';'))
+    {
+      if (entry.empty ())
+        {
+          continue;
+        }
+      auto first = entry.find (':');
+      auto second = entry.find (':', first + 1);
+      if (first == std::string::npos)
+        {
+          NS_LOG_WARN ("Function mix entry " << entry << " has no function");
+          return false;
+        }
+      double weight = 1.0;
+      if (second != std::string::npos &&
+          (!ParseNumber (entry.substr (second + 1), weight) || weight < 0))
+        {
+          NS_LOG_WARN ("Invalid function mix weight in " << entry);
+          return false;
+        }
+      double total = parsed.empty () ? 0.0 : parsed.back ().cumulativeWeight;
+      parsed.push_back (Function{entry.substr (0, first),
+                                 entry.substr (first + 1, second - first - 1), total + weight});
+    }
+  mix = parsed;
+  return true;
+}
+
+std::string
+WasmFaasClient::GetFunctions (void) const
+{
+  return m_functionsString;
+}
+
+int64_t
+WasmFaasClient::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_interArrival->SetStream (stream);
+  m_functionChooser->SetStream (stream + 1);
+  m_argValue->SetStream (stream + 2);
+  m_onTime->SetStream (stream + 3);
+  m_offTime->SetStream (stream + 4);
+  return 5;
+}
+
+uint64_t
+WasmFaasClient::GetSent (void) const
+{
+  return m_sent;
+}
+
+uint64_t
+WasmFaasClient::GetCompleted (void) const
+{
+  return m_completed;
+}
+
+uint64_t
+WasmFaasClient::GetFailed (void) const
+{
+  return m_failed;
+}
+
+void
+WasmFaasClient::StartApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_target == 0)
+    {
+      for (uint32_t i = 0; i < GetNode ()->GetNApplications () && m_target == 0; i++)
+        {
+          m_target = DynamicCast<CustomApp> (GetNode ()->GetApplication (i));
+        }
+      if (m_target == 0)
+        {
+          NS_FATAL_ERROR ("WasmFaasClient needs a CustomApp on its node or a target");
+        }
+    }
+  m_target->TraceConnectWithoutContext ("InvocationCompleted",
+                                        MakeCallback (&WasmFaasClient::HandleCompleted, this));
+
+  m_startTime = Simulator::Now ();
+  switch (m_arrivalProcess)
+    {
+    case TRACE:
+      LoadTrace ();
+      m_traceIdx = 0;
+      if (!m_trace.empty ())
+        {
+          m_sendEvent = Simulator::Schedule (m_trace[0].time, &WasmFaasClient::SendTraceInvocation,
+                                             this);
+        }
+      break;
+    case ON_OFF:
+      StartOnPeriod ();
+      break;
+    default:
+      ScheduleNextArrival ();
+      break;
+    }
+}
+
+void
+WasmFaasClient::StopApplication (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Simulator::Cancel (m_sendEvent);
+  Simulator::Cancel (m_periodEvent);
+  if (m_target != 0)
+    {
+      m_target->TraceDisconnectWithoutContext (
+          "InvocationCompleted", MakeCallback (&WasmFaasClient::HandleCompleted, this));
+    }
+}
+
+void
+WasmFaasClient::LoadTrace (void)
+{
+  NS_LOG_FUNCTION (this << m_traceFile);
+
+  m_trace.clear ();
+  std::ifstream file (m_traceFile);
+  if (!file.is_open ())
+    {
+      NS_FATAL_ERROR ("Cannot open invocation trace " << m_traceFile);
+    }
+
+  std::string line;
+  uint32_t lineNumber = 0;
+  while (std::getline (file, line))
+    {
+      lineNumber++;
+      if (line.empty () || line[0] == '#')
+        {
+          continue;
+        }
+
+      TraceEntry entry;
+      if (!ParseTraceLine (line, (ArgType) m_argType, entry))
+        {
+          NS_FATAL_ERROR (m_traceFile << ":" << lineNumber << ": invalid invocation trace line "
+                                      << line);
+        }
+      m_trace.push_back (entry);
+    }
+
+  std::stable_sort (m_trace.begin (), m_trace.end (),
+                    [] (const TraceEntry &a, const TraceEntry &b) { return a.time < b.time; });
+}
+
+bool
+WasmFaasClient::ParseTraceLine (const std::string &line, ArgType argType, TraceEntry &entry)
+{
+  std::istringstream fields (line);
+  std::string field;
+  std::vector<std::string> tokens;
+  while (std::getline (fields, field, ','))
+    {
+      tokens.push_back (field);
+    }
+  if (tokens.size () < 3)
+    {
+      NS_LOG_WARN ("Invocation trace line " << line << " has no function");
+      return false;
+    }
+
+  double time;
+  if (!ParseNumber (tokens[0], time) || time < 0)
+    {
+      NS_LOG_WARN ("Invalid time " << tokens[0] << " in invocation trace line " << line);
+      return false;
+    }
+  std::vector<WasmFaasValue> args;
+  for (size_t i = 3; i < tokens.size () && args.size () < WasmFaasHeader::MAX_ARGS; i++)
+    {
+      double value;
+      if (!ParseNumber (tokens[i], value))
+        {
+          NS_LOG_WARN ("Invalid argument " << tokens[i] << " in invocation trace line " << line);
+          return false;
+        }
+      args.push_back (MakeArg (value, argType));
+    }
+  entry.time = Seconds (time);
+  entry.moduleName = tokens[1];
+  entry.funcName = tokens[2];
+  entry.args = args;
+  return true;
+}
+
+bool
+WasmFaasClient::ParseNumber (const std::string &text, double &value)
+{
+  const char *begin = text.c_str ();
+  char *end;
+  errno = 0;
+  double parsed = std::strtod (begin, &end);
+  // Trailing blanks are fine, the other leftovers mean the string is not a number
+  while (*end == ' ' || *end == '\t' || *end == '\r')
+    {
+      end++;
+    }
+  if (end == begin || *end != '\0' || errno == ERANGE || !std::isfinite (parsed))
+    {
+      return false;
+    }
+  value = parsed;
+  return true;
+}
+
+WasmFaasValue
+WasmFaasClient::MakeArg (double value, ArgType type)
+{
+  switch (type)
+    {
+    case ArgType::I64:
+      return WasmFaasValue::FromI64 ((int64_t) std::llround (value));
+    case ArgType::F32:
+      return WasmFaasValue::FromF32 ((float) value);
+    case ArgType::F64:
+      return WasmFaasValue::FromF64 (value);
+    default:
+      return WasmFaasValue::FromI32 ((int32_t) std::lround (value));
+    }
+}
+
+void
+WasmFaasClient::ScheduleNextArrival (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_maxInvocations > 0 && m_sent >= m_maxInvocations)
+    {
+      return;
+    }
+
+  auto gap = m_arrivalProcess == POISSON ? Seconds (m_interArrival->GetValue (1.0 / m_rate, 0))
+                                         : Seconds (1.0 / m_rate);
+  m_sendEvent = Simulator::Schedule (gap, &WasmFaasClient::SendInvocation, this);
+}
+
+void
+WasmFaasClient::SendInvocation (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (!m_functions.empty ())
+    {
+      auto pick = m_functionChooser->GetValue (0.0, m_functions.back ().cumulativeWeight);
+      auto it = std::upper_bound (
+          m_functions.begin (), m_functions.end (), pick,
+          [] (double w, const Function &f) { return w < f.cumulativeWeight; });
+      if (it == m_functions.end ())
+        {
+          it = m_functions.end () - 1;
+        }
+
+      std::vector<WasmFaasValue> args;
+      for (uint32_t i = 0; i < m_argCount; i++)
+        {
+          args.push_back (MakeArg (m_argValue->GetValue (), (ArgType) m_argType));
+        }
+      Invoke (it->moduleName, it->funcName, args);
+    }
+
+  ScheduleNextArrival ();
+}
+
+void
+WasmFaasClient::SendTraceInvocation (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  auto &entry = m_trace[m_traceIdx++];
+  Invoke (entry.moduleName, entry.funcName, entry.args);
+
+  if (m_traceIdx < m_trace.size () && (m_maxInvocations == 0 || m_sent < m_maxInvocations))
+    {
+      m_sendEvent = Simulator::Schedule (m_startTime + m_trace[m_traceIdx].time -
+                                             Simulator::Now (),
+                                         &WasmFaasClient::SendTraceInvocation, this);
+    }
+}
+
+void
+WasmFaasClient::StartOnPeriod (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_periodEvent =
+      Simulator::Schedule (Seconds (m_onTime->GetValue ()), &WasmFaasClient::StartOffPeriod, this);
+  ScheduleNextArrival ();
+}
+
+void
+WasmFaasClient::StartOffPeriod (void)
+{
+  NS_LOG_FUNCTION (this);
+  Simulator::Cancel (m_sendEvent);
+  m_periodEvent =
+      Simulator::Schedule (Seconds (m_offTime->GetValue ()), &WasmFaasClient::StartOnPeriod, this);
+}
+
+void
+WasmFaasClient::Invoke (const std::string &moduleName, const std::string &funcName,
+                        const std::vector<WasmFaasValue> &args)
+{
+  NS_LOG_FUNCTION (this << moduleName << funcName);
+
+  m_sent++;
+
+  // Invocations that complete right away fire the trace before returning
+  m_isInvoking = true;
+  m_invokingModule = moduleName;
+  m_completedWhileInvoking = false;
+  auto result = m_target->ExecuteFunction (moduleName, funcName, args, m_priority);
+  m_isInvoking = false;
+
+  m_invokedTrace (result.requestId, moduleName, funcName);
+  if (!m_completedWhileInvoking)
+    {
+      m_pending[result.requestId] = std::make_pair (Simulator::Now (), moduleName);
+    }
+}
+
+void
+WasmFaasClient::HandleCompleted (const WasmFaasResult &result)
+{
+  NS_LOG_FUNCTION (this << result.requestId);
+
+  std::string moduleName;
+  Time latency;
+  auto it = m_pending.find (result.requestId);
+  if (it != m_pending.end ())
+    {
+      latency = Simulator::Now () - it->second.first;
+      moduleName = it->second.second;
+      m_pending.erase (it);
+    }
+  else if (m_isInvoking)
+    {
+      moduleName = m_invokingModule;
+      m_completedWhileInvoking = true;
+    }
+  else
+    {
+      // Invocation made by someone else on the target
+      return;
+    }
+
+  if (result.status == WasmFaasResult::OK)
+    {
+      m_completed++;
+    }
+  else
+    {
+      m_failed++;
+    }
+  m_completedTrace (moduleName, result, latency);
+}
+
+} // namespace ns3
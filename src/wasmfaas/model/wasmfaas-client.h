@@ -0,0 +1,279 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef WASMFAAS_CLIENT_H
+#define WASMFAAS_CLIENT_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ns3/application.h"
+#include "ns3/event-id.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/traced-callback.h"
+#include "wasmfaas-header.h"
+
+namespace ns3 {
+
+class CustomApp;
+
+/**
+ * \ingroup customapp
+ *
+ * \brief Open loop load generator invoking functions on a CustomApp.
+ *
+ * Invocations go to the CustomApp of the client node, or to the one given
+ * to SetTarget, which runs them locally or on its peers. They arrive
+ * following the ArrivalProcess whatever the number still pending.
+ *
+ * Each invocation picks a function from the Functions mix by weight and
+ * draws ArgCount arguments from ArgValue. With the Trace arrival process
+ * the times, functions and arguments are read from TraceFile instead, one
+ * invocation per line:
+ *
+ * \verbatim
+   # time since start in seconds,module,function,args...
+   0.5,sum,sum,1,2
+   \endverbatim
+ */
+class WasmFaasClient : public Application
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /// How invocation times are chosen
+  enum ArrivalProcess
+  {
+    POISSON, //!< Exponential gaps of mean 1 / Rate
+    CONSTANT_RATE, //!< Gaps of 1 / Rate
+    ON_OFF, //!< Gaps of 1 / Rate during on periods, nothing during off periods
+    TRACE //!< Times read from TraceFile
+  };
+
+  /**
+   * TracedCallback signature for invocations sent.
+   *
+   * \param [in] requestId The request ID given by the CustomApp.
+   * \param [in] moduleName The module invoked.
+   * \param [in] funcName The function invoked.
+   */
+  typedef void (*InvokedTracedCallback) (uint64_t requestId, const std::string &moduleName,
+                                         const std::string &funcName);
+
+  /**
+   * TracedCallback signature for completed invocations.
+   *
+   * \param [in] moduleName The module invoked.
+   * \param [in] result The invocation result.
+   * \param [in] latency The time since the invocation was sent.
+   */
+  typedef void (*CompletedTracedCallback) (const std::string &moduleName,
+                                           const WasmFaasResult &result, Time latency);
+
+  WasmFaasClient ();
+  virtual ~WasmFaasClient ();
+
+  /**
+   * \param target the CustomApp receiving the invocations
+   */
+  void SetTarget (Ptr<CustomApp> target);
+
+  /**
+   * \brief Add a function to the invocation mix.
+   * \param moduleName the module holding the function
+   * \param funcName the function
+   * \param weight the relative share of invocations going to the function
+   */
+  void AddFunction (const std::string &moduleName, const std::string &funcName, double weight);
+
+  /**
+   * \brief Assign fixed random variable stream numbers to the random
+   * variables used by this client.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  /**
+   * \return the number of invocations sent
+   */
+  uint64_t GetSent (void) const;
+  /**
+   * \return the number of invocations completed with a result
+   */
+  uint64_t GetCompleted (void) const;
+  /**
+   * \return the number of invocations that failed
+   */
+  uint64_t GetFailed (void) const;
+
+  /// Function of the invocation mix
+  struct Function
+  {
+    std::string moduleName; //!< Module holding the function
+    std::string funcName; //!< Function
+    double cumulativeWeight; //!< Sum of the weights up to this function
+  };
+
+  /// Invocation read from the trace file
+  struct TraceEntry
+  {
+    Time time; //!< Time since the client start
+    std::string moduleName; //!< Module holding the function
+    std::string funcName; //!< Function
+    std::vector<WasmFaasValue> args; //!< Function arguments
+  };
+
+  /**
+   * \brief Parse an invocation mix in the format of the Functions attribute.
+   * \param functions ';' separated module:function:weight entries, the weight
+   * being 1 when left out
+   * \param mix the functions with their cumulative weights, set on success only
+   * \return whether every entry has a module, a function and a weight that is
+   * a non-negative number
+   */
+  static bool ParseFunctions (const std::string &functions, std::vector<Function> &mix);
+
+  /**
+   * \brief Parse an invocation of the TraceFile format.
+   * \param line a time,module,function,args... line, neither empty nor a comment
+   * \param argType the ArgType of the arguments
+   * \param entry the invocation, set on success only
+   * \return whether the line has a module, a function, a time that is a
+   * non-negative number and arguments that are numbers
+   */
+  static bool ParseTraceLine (const std::string &line, ArgType argType, TraceEntry &entry);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  virtual void StartApplication (void);
+  virtual void StopApplication (void);
+
+  /**
+   * \param functions ';' separated module:function:weight entries
+   */
+  void SetFunctions (std::string functions);
+  /**
+   * \return the mix as set by SetFunctions
+   */
+  std::string GetFunctions (void) const;
+
+  /**
+   * \brief Read TraceFile into m_trace.
+   */
+  void LoadTrace (void);
+
+  /**
+   * \param value a number
+   * \param type the ArgType of the value, rounding the number for integer types
+   * \return the number as an ArgType value
+   */
+  static WasmFaasValue MakeArg (double value, ArgType type);
+
+  /**
+   * \brief Parse a whole string as a finite number.
+   * \param text the string
+   * \param value the number, set on success only
+   * \return whether the string is a number in the range of a double
+   */
+  static bool ParseNumber (const std::string &text, double &value);
+
+  /**
+   * \brief Schedule the next invocation according to the arrival process.
+   */
+  void ScheduleNextArrival (void);
+  /**
+   * \brief Send an invocation drawn from the mix and schedule the next one.
+   */
+  void SendInvocation (void);
+  /**
+   * \brief Send the next trace invocation and schedule the one after it.
+   */
+  void SendTraceInvocation (void);
+  /**
+   * \brief Start an on period of the ON_OFF arrival process.
+   */
+  void StartOnPeriod (void);
+  /**
+   * \brief Start an off period of the ON_OFF arrival process.
+   */
+  void StartOffPeriod (void);
+
+  /**
+   * \brief Invoke a function on the target.
+   * \param moduleName the module holding the function
+   * \param funcName the function
+   * \param args the function arguments
+   */
+  void Invoke (const std::string &moduleName, const std::string &funcName,
+               const std::vector<WasmFaasValue> &args);
+
+  /**
+   * \brief Record a result, connected to the InvocationCompleted trace of the target.
+   * \param result the invocation result
+   */
+  void HandleCompleted (const WasmFaasResult &result);
+
+  Ptr<CustomApp> m_target; //!< CustomApp receiving the invocations
+  ArrivalProcess m_arrivalProcess; //!< How invocation times are chosen
+  double m_rate; //!< Invocations per second
+  uint64_t m_maxInvocations; //!< Invocations to send, 0 for unlimited
+  Ptr<RandomVariableStream> m_onTime; //!< On period durations, in seconds
+  Ptr<RandomVariableStream> m_offTime; //!< Off period durations, in seconds
+  std::string m_traceFile; //!< Trace of the TRACE arrival process
+  std::string m_functionsString; //!< Functions attribute value
+  std::vector<Function> m_functions; //!< Invocation mix
+  uint32_t m_argCount; //!< Arguments per invocation
+  int m_argType; //!< ArgType of the drawn arguments, int for the enum attribute
+  Ptr<RandomVariableStream> m_argValue; //!< Drawn argument values
+  uint8_t m_priority; //!< Priority of every invocation
+
+  Ptr<ExponentialRandomVariable> m_interArrival; //!< Poisson gaps
+  Ptr<UniformRandomVariable> m_functionChooser; //!< Picks a function of the mix
+  std::vector<TraceEntry> m_trace; //!< Invocations read from the trace file
+  size_t m_traceIdx; //!< Next trace invocation
+  Time m_startTime; //!< When the client started
+  EventId m_sendEvent; //!< Next invocation
+  EventId m_periodEvent; //!< End of the current on or off period
+
+  /// Send time and module of the invocations pending on the target
+  std::unordered_map<uint64_t, std::pair<Time, std::string>> m_pending;
+  bool m_isInvoking; //!< True while the target handles an invocation
+  std::string m_invokingModule; //!< Module of the invocation the target handles
+  bool m_completedWhileInvoking; //!< Set if the invocation completed before returning
+  uint64_t m_sent; //!< Invocations sent
+  uint64_t m_completed; //!< Invocations completed with a result
+  uint64_t m_failed; //!< Invocations that failed
+
+  /// Callbacks for tracing invocations sent
+  TracedCallback<uint64_t, const std::string &, const std::string &> m_invokedTrace;
+  /// Callbacks for tracing completed invocations
+  TracedCallback<const std::string &, const WasmFaasResult &, Time> m_completedTrace;
+};
+
+} // namespace ns3
+
+#endif /* WASMFAAS_CLIENT_H */
@@ -0,0 +1,160 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "wasmfaas-cost-model.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("WasmExecutionCostModel");
+
+NS_OBJECT_ENSURE_REGISTERED (WasmExecutionCostModel);
+NS_OBJECT_ENSURE_REGISTERED (ConstantWasmExecutionCostModel);
+NS_OBJECT_ENSURE_REGISTERED (ProfileWasmExecutionCostModel);
+NS_OBJECT_ENSURE_REGISTERED (WallClockWasmExecutionCostModel);
+
+TypeId
+WasmExecutionCostModel::GetTypeId (void)
+{
+  static TypeId tid =
+      TypeId ("ns3::WasmExecutionCostModel").SetParent<Object> ().SetGroupName ("Applications");
+  return tid;
+}
+
+TypeId
+ConstantWasmExecutionCostModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ConstantWasmExecutionCostModel")
+                          .SetParent<WasmExecutionCostModel> ()
+                          .SetGroupName ("Applications")
+                          .AddConstructor<ConstantWasmExecutionCostModel> ()
+                          .AddAttribute ("Cost", "Time every function takes.",
+                                         TimeValue (MilliSeconds (1)),
+                                         MakeTimeAccessor (&ConstantWasmExecutionCostModel::m_cost),
+                                         MakeTimeChecker (Time (0)));
+  return tid;
+}
+
+Time
+ConstantWasmExecutionCostModel::GetCost (const std::string &moduleName,
+                                         const std::string &funcName, Time wallClock)
+{
+  return m_cost;
+}
+
+TypeId
+ProfileWasmExecutionCostModel::GetTypeId (void)
+{
+  static TypeId tid =
+      TypeId ("ns3::ProfileWasmExecutionCostModel")
+          .SetParent<WasmExecutionCostModel> ()
+          .SetGroupName ("Applications")
+          .AddConstructor<ProfileWasmExecutionCostModel> ()
+          .AddAttribute ("DefaultCost",
+                         "Time taken by the functions of modules missing from the profile.",
+                         TimeValue (MilliSeconds (1)),
+                         MakeTimeAccessor (&ProfileWasmExecutionCostModel::m_defaultCost),
+                         MakeTimeChecker (Time (0)))
+          .AddAttribute ("Profile",
+                         "Time taken by the functions of each module, as ';' separated "
+                         "module=time entries, e.g. \"sum=2ms;div=5ms\". Setting it replaces "
+                         "the costs set before.",
+                         StringValue (""),
+                         MakeStringAccessor (&ProfileWasmExecutionCostModel::SetProfile,
+                                             &ProfileWasmExecutionCostModel::GetProfile),
+                         MakeStringChecker ());
+  return tid;
+}
+
+Time
+ProfileWasmExecutionCostModel::GetCost (const std::string &moduleName,
+                                        const std::string &funcName, Time wallClock)
+{
+  auto it = m_costs.find (moduleName);
+  return it == m_costs.end () ? m_defaultCost : it->second;
+}
+
+void
+ProfileWasmExecutionCostModel::SetModuleCost (const std::string &moduleName, Time cost)
+{
+  NS_LOG_FUNCTION (this << moduleName << cost);
+  m_costs[moduleName] = cost;
+}
+
+void
+ProfileWasmExecutionCostModel::SetProfile (std::string profile)
+{
+  NS_LOG_FUNCTION (this << profile);
+
+  m_profile = profile;
+  m_costs.clear ();
+  size_t startPos = 0;
+  while (startPos < profile.size ())
+    {
+      auto endPos = profile.find (';', startPos);
+      if (endPos == std::string::npos)
+        {
+          endPos = profile.size ();
+        }
+      auto entry = profile.substr (startPos, endPos - startPos);
+      startPos = endPos + 1;
+      // Tolerates a trailing or doubled ';'
+      if (entry.empty ())
+        {
+          continue;
+        }
+      auto sep = entry.find ('=');
+      if (sep == std::string::npos)
+        {
+          NS_FATAL_ERROR ("Invalid execution cost profile entry " << entry);
+        }
+      SetModuleCost (entry.substr (0, sep), Time (entry.substr (sep + 1)));
+    }
+}
+
+std::string
+ProfileWasmExecutionCostModel::GetProfile (void) const
+{
+  return m_profile;
+}
+
+TypeId
+WallClockWasmExecutionCostModel::GetTypeId (void)
+{
+  static TypeId tid =
+      TypeId ("ns3::WallClockWasmExecutionCostModel")
+          .SetParent<WasmExecutionCostModel> ()
+          .SetGroupName ("Applications")
+          .AddConstructor<WallClockWasmExecutionCostModel> ()
+          .AddAttribute ("CpuSpeed",
+                         "Speed of the simulated CPU relative to the host running the "
+                         "simulation. 0.5 makes every function take twice its host time.",
+                         DoubleValue (1.0),
+                         MakeDoubleAccessor (&WallClockWasmExecutionCostModel::m_cpuSpeed),
+                         MakeDoubleChecker<double> (1e-9));
+  return tid;
+}
+
+Time
+WallClockWasmExecutionCostModel::GetCost (const std::string &moduleName,
+                                          const std::string &funcName, Time wallClock)
+{
+  return NanoSeconds ((int64_t) (wallClock.GetNanoSeconds () / m_cpuSpeed));
+}
+
+} // namespace ns3
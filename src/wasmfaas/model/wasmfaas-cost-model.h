@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef WASMFAAS_COST_MODEL_H
+#define WASMFAAS_COST_MODEL_H
+
+#include <string>
+#include <unordered_map>
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup customapp
+ *
+ * \brief Simulated time a CustomApp spends running a function.
+ *
+ * The function result is computed right away, but it is only delivered
+ * once the cost has elapsed. Each execution slot of the node runs one
+ * function at a time.
+ */
+class WasmExecutionCostModel : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \param moduleName the module holding the function
+   * \param funcName the function that ran
+   * \param wallClock the host time the runtime took to run it
+   * \return the simulated time the function takes
+   */
+  virtual Time GetCost (const std::string &moduleName, const std::string &funcName,
+                        Time wallClock) = 0;
+};
+
+/**
+ * \ingroup customapp
+ *
+ * \brief Every function takes the same time.
+ */
+class ConstantWasmExecutionCostModel : public WasmExecutionCostModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual Time GetCost (const std::string &moduleName, const std::string &funcName,
+                        Time wallClock);
+
+private:
+  Time m_cost; //!< Cost of every function
+};
+
+/**
+ * \ingroup customapp
+ *
+ * \brief Functions take a time profiled for their module.
+ */
+class ProfileWasmExecutionCostModel : public WasmExecutionCostModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual Time GetCost (const std::string &moduleName, const std::string &funcName,
+                        Time wallClock);
+
+  /**
+   * \param moduleName the module name
+   * \param cost the time every function of the module takes
+   */
+  void SetModuleCost (const std::string &moduleName, Time cost);
+
+private:
+  /**
+   * \param profile ';' separated module=cost entries, e.g. "sum=2ms;div=5ms"
+   */
+  void SetProfile (std::string profile);
+  /**
+   * \return the profile as set by SetProfile
+   */
+  std::string GetProfile (void) const;
+
+  Time m_defaultCost; //!< Cost of modules missing from the profile
+  std::string m_profile; //!< Profile attribute value
+  std::unordered_map<std::string, Time> m_costs; //!< Cost by module
+};
+
+/**
+ * \ingroup customapp
+ *
+ * \brief Functions take the host time the runtime spent on them, divided by
+ * the relative speed of the simulated CPU.
+ */
+class WallClockWasmExecutionCostModel : public WasmExecutionCostModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual Time GetCost (const std::string &moduleName, const std::string &funcName,
+                        Time wallClock);
+
+private:
+  double m_cpuSpeed; //!< Speed of the simulated CPU relative to the host
+};
+
+} // namespace ns3
+
+#endif /* WASMFAAS_COST_MODEL_H */
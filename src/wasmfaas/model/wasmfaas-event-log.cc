@@ -0,0 +1,301 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "wasmfaas-event-log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("WasmFaasEventLog");
+
+NS_OBJECT_ENSURE_REGISTERED (WasmFaasEventLog);
+
+static const char g_magic[] = "WFEL";
+
+/**
+ * \param buf where to write
+ * \param value the value to write
+ * \param n the number of low order bytes of value to write, little endian
+ */
+static void
+PutLe (uint8_t *buf, uint64_t value, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      buf[i] = (uint8_t) (value >> (8 * i));
+    }
+}
+
+/**
+ * \param buf where to read
+ * \param n the number of bytes to read, little endian
+ * \return the value read
+ */
+static uint64_t
+GetLe (const uint8_t *buf, uint32_t n)
+{
+  uint64_t value = 0;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      value |= (uint64_t) buf[i] << (8 * i);
+    }
+  return value;
+}
+
+TypeId
+WasmFaasEventLog::GetTypeId (void)
+{
+  static TypeId tid =
+      TypeId ("ns3::WasmFaasEventLog")
+          .SetParent<Object> ()
+          .SetGroupName ("Applications")
+          .AddConstructor<WasmFaasEventLog> ()
+          .AddAttribute ("FileName",
+                         "File the records are written to, truncated on the first write.",
+                         StringValue ("wasmfaas-events.bin"),
+                         MakeStringAccessor (&WasmFaasEventLog::m_fileName),
+                         MakeStringChecker ())
+          .AddAttribute ("BufferSize", "Bytes of records buffered before they are written.",
+                         UintegerValue (64 * 1024),
+                         MakeUintegerAccessor (&WasmFaasEventLog::m_bufferSize),
+                         MakeUintegerChecker<uint32_t> (RECORD_SIZE));
+  return tid;
+}
+
+WasmFaasEventLog::WasmFaasEventLog () : m_nRecords (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+WasmFaasEventLog::~WasmFaasEventLog ()
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+}
+
+void
+WasmFaasEventLog::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+  m_file.close ();
+  Object::DoDispose ();
+}
+
+void
+WasmFaasEventLog::Write (uint32_t node, EventType type, uint64_t requestId, uint32_t moduleId,
+                         uint32_t bytes)
+{
+  if (!m_file.is_open ())
+    {
+      m_file.open (m_fileName, std::ios::binary | std::ios::trunc);
+      if (!m_file.is_open ())
+        {
+          NS_FATAL_ERROR ("Cannot open event log " << m_fileName);
+        }
+
+      uint8_t header[FILE_HEADER_SIZE];
+      std::copy (g_magic, g_magic + 4, header);
+      PutLe (header + 4, VERSION, 2);
+      PutLe (header + 6, RECORD_SIZE, 2);
+      m_file.write ((const char *) header, sizeof (header));
+      m_buffer.reserve (m_bufferSize);
+    }
+
+  auto offset = m_buffer.size ();
+  m_buffer.resize (offset + RECORD_SIZE);
+  auto record = &m_buffer[offset];
+  PutLe (record, Simulator::Now ().GetNanoSeconds (), 8);
+  PutLe (record + 8, node, 4);
+  PutLe (record + 12, type, 2);
+  PutLe (record + 14, 0, 2);
+  PutLe (record + 16, requestId, 8);
+  PutLe (record + 24, moduleId, 4);
+  PutLe (record + 28, bytes, 4);
+  m_nRecords++;
+
+  if (m_buffer.size () + RECORD_SIZE > m_bufferSize)
+    {
+      Flush ();
+    }
+}
+
+void
+WasmFaasEventLog::Flush (void)
+{
+  if (m_file.is_open () && !m_buffer.empty ())
+    {
+      m_file.write ((const char *) m_buffer.data (), m_buffer.size ());
+      m_file.flush ();
+    }
+  m_buffer.clear ();
+}
+
+uint64_t
+WasmFaasEventLog::GetNRecords (void) const
+{
+  return m_nRecords;
+}
+
+const char *
+WasmFaasEventLog::GetEventName (uint16_t type)
+{
+  switch (type)
+    {
+    case REGISTER_NODE:
+      return "REGISTER_NODE";
+    case REGISTER_MODULE:
+      return "REGISTER_MODULE";
+    case INIT_EXECUTE_MODULE_REQUEST:
+      return "INIT_EXECUTE_MODULE_REQUEST";
+    case EXECUTE_MODULE_REQUEST_CACHE_RESULT:
+      return "EXECUTE_MODULE_REQUEST_CACHE_RESULT";
+    case INIT_QUERY_PEERS_FOR_MODULE:
+      return "INIT_QUERY_PEERS_FOR_MODULE";
+    case SEND_PACKET_EXECUTE_MODULE_REQUEST_TO_KNOWN_HOLDER:
+      return "SEND_PACKET_EXECUTE_MODULE_REQUEST_TO_KNOWN_HOLDER";
+    case SEND_PACKET_EXECUTE_MODULE_REQUEST:
+      return "SEND_PACKET_EXECUTE_MODULE_REQUEST";
+    case RECEIVED_PACKET_EXECUTE_MODULE_REQUEST:
+      return "RECEIVED_PACKET_EXECUTE_MODULE_REQUEST";
+    case SEND_PACKET_EXECUTE_MODULE_RESULT:
+      return "SEND_PACKET_EXECUTE_MODULE_RESULT";
+    case SEND_PACKET_EXECUTE_MODULE_RESULT_FROM_PEER:
+      return "SEND_PACKET_EXECUTE_MODULE_RESULT_FROM_PEER";
+    case SENT_PACKET_PEER_MODULE_QUERY_NOT_FOUND:
+      return "SENT_PACKET_PEER_MODULE_QUERY_NOT_FOUND";
+    case RECEIVED_PACKET_EXECUTE_MODULE_RESULT:
+      return "RECEIVED_PACKET_EXECUTE_MODULE_RESULT";
+    case IGNORED_PACKET_UNKNOWN_REQUEST:
+      return "IGNORED_PACKET_UNKNOWN_REQUEST";
+    case INVALIDATED_MODULE_LOCATION:
+      return "INVALIDATED_MODULE_LOCATION";
+    case EXECUTE_MODULE_REQUEST_PEER_RESULT:
+      return "EXECUTE_MODULE_REQUEST_PEER_RESULT";
+    case SEND_PACKET_MODULE_LOAD_REQUEST:
+      return "SEND_PACKET_MODULE_LOAD_REQUEST";
+    case RECEIVED_PACKET_MODULE_LOAD_REQUEST:
+      return "RECEIVED_PACKET_MODULE_LOAD_REQUEST";
+    case SEND_PACKET_MODULE_LOAD_RESPONSE:
+      return "SEND_PACKET_MODULE_LOAD_RESPONSE";
+    case SEND_PACKET_MODULE_LOAD_RESPONSE_CHUNKED:
+      return "SEND_PACKET_MODULE_LOAD_RESPONSE_CHUNKED";
+    case RECEIVED_PACKET_MODULE_LOAD_RESULT:
+      return "RECEIVED_PACKET_MODULE_LOAD_RESULT";
+    case RECEIVED_MODULE_CHUNKS:
+      return "RECEIVED_MODULE_CHUNKS";
+    case REGISTERED_MODULE:
+      return "REGISTERED_MODULE";
+    case MODULE_NOT_CACHED:
+      return "MODULE_NOT_CACHED";
+    case EVICTED_MODULE:
+      return "EVICTED_MODULE";
+    case EXECUTION_QUEUED:
+      return "EXECUTION_QUEUED";
+    case EXECUTION_FORWARDED:
+      return "EXECUTION_FORWARDED";
+    case EXECUTION_REJECTED:
+      return "EXECUTION_REJECTED";
+    case EXECUTION_STARTED:
+      return "EXECUTION_STARTED";
+    case MEMO_HIT:
+      return "MEMO_HIT";
+    case SEND_PACKET_GOSSIP:
+      return "SEND_PACKET_GOSSIP";
+    case RECEIVED_PACKET_GOSSIP:
+      return "RECEIVED_PACKET_GOSSIP";
+    case SEND_PACKET_EXECUTE_MODULE_REQUEST_TO_GOSSIP_HOLDER:
+      return "SEND_PACKET_EXECUTE_MODULE_REQUEST_TO_GOSSIP_HOLDER";
+    case HOP_LIMIT_REACHED:
+      return "HOP_LIMIT_REACHED";
+    case DUPLICATE_REQUEST:
+      return "DUPLICATE_REQUEST";
+    case REQUEST_RETRIED:
+      return "REQUEST_RETRIED";
+    case REQUEST_TIMED_OUT:
+      return "REQUEST_TIMED_OUT";
+    case INIT_WORKFLOW_REQUEST:
+      return "INIT_WORKFLOW_REQUEST";
+    case WORKFLOW_STAGE_COMPLETED:
+      return "WORKFLOW_STAGE_COMPLETED";
+    case SEND_PACKET_WORKFLOW:
+      return "SEND_PACKET_WORKFLOW";
+    case RECEIVED_PACKET_WORKFLOW:
+      return "RECEIVED_PACKET_WORKFLOW";
+    case SEND_PACKET_WORKFLOW_RESULT:
+      return "SEND_PACKET_WORKFLOW_RESULT";
+    case RECEIVED_PACKET_WORKFLOW_RESULT:
+      return "RECEIVED_PACKET_WORKFLOW_RESULT";
+    case SEND_PACKET_BATCH:
+      return "SEND_PACKET_BATCH";
+    case RECEIVED_PACKET_BATCH:
+      return "RECEIVED_PACKET_BATCH";
+    case SEND_PACKET_MODULE_PREFETCH_REQUEST:
+      return "SEND_PACKET_MODULE_PREFETCH_REQUEST";
+    case PREFETCH_FAILED:
+      return "PREFETCH_FAILED";
+    case PREFETCH_HIT:
+      return "PREFETCH_HIT";
+    case MODULE_CHUNKS_RETRANSMITTED:
+      return "MODULE_CHUNKS_RETRANSMITTED";
+    case MODULE_TRANSFER_EXPIRED:
+      return "MODULE_TRANSFER_EXPIRED";
+    case IGNORED_MODULE_CHUNK:
+      return "IGNORED_MODULE_CHUNK";
+    case PEER_ANSWERED_FROM_OTHER_ADDRESS:
+      return "PEER_ANSWERED_FROM_OTHER_ADDRESS";
+    case IGNORED_ANSWER_NOT_PENDING:
+      return "IGNORED_ANSWER_NOT_PENDING";
+    case DROPPED_MALFORMED_PACKET:
+      return "DROPPED_MALFORMED_PACKET";
+    default:
+      return "UNKNOWN";
+    }
+}
+
+bool
+WasmFaasEventLog::ReadFileHeader (std::istream &is)
+{
+  uint8_t header[FILE_HEADER_SIZE];
+  if (!is.read ((char *) header, sizeof (header)))
+    {
+      return false;
+    }
+  return std::equal (g_magic, g_magic + 4, header) && GetLe (header + 4, 2) == VERSION &&
+         GetLe (header + 6, 2) == RECORD_SIZE;
+}
+
+bool
+WasmFaasEventLog::ReadRecord (std::istream &is, Record &record)
+{
+  uint8_t buf[RECORD_SIZE];
+  if (!is.read ((char *) buf, sizeof (buf)))
+    {
+      return false;
+    }
+  record.time = (int64_t) GetLe (buf, 8);
+  record.node = (uint32_t) GetLe (buf + 8, 4);
+  record.type = (uint16_t) GetLe (buf + 12, 2);
+  record.requestId = GetLe (buf + 16, 8);
+  record.moduleId = (uint32_t) GetLe (buf + 24, 4);
+  record.bytes = (uint32_t) GetLe (buf + 28, 4);
+  return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,188 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef WASMFAAS_EVENT_LOG_H
+#define WASMFAAS_EVENT_LOG_H
+
+#include <fstream>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "ns3/object.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup customapp
+ *
+ * \brief Append-only binary log of CustomApp protocol events.
+ *
+ * Every CustomApp given the same log through its EventLog attribute appends
+ * to the same file, so one log is usually shared by a whole run. Records
+ * are buffered and written BufferSize bytes at a time, and the buffer is
+ * flushed when the log is disposed or destroyed.
+ *
+ * The file starts with an 8 byte header, the magic "WFEL", the format
+ * version (2) and the record size (2), followed by fixed-size records:
+ * simulation time in nanoseconds (8), node ID (4), event type (2),
+ * reserved (2), request ID (8), module ID (4) and size in bytes (4). Every
+ * field is little endian. The module ID is WasmFaasHeader::GetNameId of the
+ * module name, and the size is 0 for events that move no module data.
+ *
+ * The wasmfaas-event-log-decode program turns a log into CSV.
+ */
+class WasmFaasEventLog : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /// Protocol events, named after the matching CustomApp log lines
+  enum EventType
+  {
+    REGISTER_NODE = 1,
+    REGISTER_MODULE,
+    INIT_EXECUTE_MODULE_REQUEST,
+    EXECUTE_MODULE_REQUEST_CACHE_RESULT,
+    INIT_QUERY_PEERS_FOR_MODULE,
+    SEND_PACKET_EXECUTE_MODULE_REQUEST_TO_KNOWN_HOLDER,
+    SEND_PACKET_EXECUTE_MODULE_REQUEST,
+    RECEIVED_PACKET_EXECUTE_MODULE_REQUEST,
+    SEND_PACKET_EXECUTE_MODULE_RESULT,
+    SEND_PACKET_EXECUTE_MODULE_RESULT_FROM_PEER,
+    SENT_PACKET_PEER_MODULE_QUERY_NOT_FOUND,
+    RECEIVED_PACKET_EXECUTE_MODULE_RESULT,
+    IGNORED_PACKET_UNKNOWN_REQUEST,
+    INVALIDATED_MODULE_LOCATION,
+    EXECUTE_MODULE_REQUEST_PEER_RESULT,
+    SEND_PACKET_MODULE_LOAD_REQUEST,
+    RECEIVED_PACKET_MODULE_LOAD_REQUEST,
+    SEND_PACKET_MODULE_LOAD_RESPONSE,
+    SEND_PACKET_MODULE_LOAD_RESPONSE_CHUNKED,
+    RECEIVED_PACKET_MODULE_LOAD_RESULT,
+    RECEIVED_MODULE_CHUNKS,
+    REGISTERED_MODULE,
+    MODULE_NOT_CACHED,
+    EVICTED_MODULE,
+    EXECUTION_QUEUED,
+    EXECUTION_FORWARDED,
+    EXECUTION_REJECTED,
+    EXECUTION_STARTED,
+    MEMO_HIT,
+    SEND_PACKET_GOSSIP,
+    RECEIVED_PACKET_GOSSIP,
+    SEND_PACKET_EXECUTE_MODULE_REQUEST_TO_GOSSIP_HOLDER,
+    HOP_LIMIT_REACHED,
+    DUPLICATE_REQUEST,
+    REQUEST_RETRIED,
+    REQUEST_TIMED_OUT,
+    INIT_WORKFLOW_REQUEST,
+    WORKFLOW_STAGE_COMPLETED,
+    SEND_PACKET_WORKFLOW,
+    RECEIVED_PACKET_WORKFLOW,
+    SEND_PACKET_WORKFLOW_RESULT,
+    RECEIVED_PACKET_WORKFLOW_RESULT,
+    SEND_PACKET_BATCH,
+    RECEIVED_PACKET_BATCH,
+    SEND_PACKET_MODULE_PREFETCH_REQUEST,
+    PREFETCH_FAILED,
+    PREFETCH_HIT,
+    MODULE_CHUNKS_RETRANSMITTED,
+    MODULE_TRANSFER_EXPIRED,
+    IGNORED_MODULE_CHUNK,
+    PEER_ANSWERED_FROM_OTHER_ADDRESS,
+    IGNORED_ANSWER_NOT_PENDING,
+    DROPPED_MALFORMED_PACKET
+  };
+
+  /// One decoded log record
+  struct Record
+  {
+    int64_t time; //!< Simulation time, in nanoseconds
+    uint32_t node; //!< ID of the node logging the event
+    uint16_t type; //!< EventType
+    uint64_t requestId; //!< Request the event belongs to, 0 if none
+    uint32_t moduleId; //!< Module the event belongs to, 0 if none
+    uint32_t bytes; //!< Module bytes moved by the event, 0 if none
+  };
+
+  static constexpr uint16_t VERSION = 1; //!< Format version
+  static constexpr uint16_t RECORD_SIZE = 32; //!< Encoded record size, in bytes
+  static constexpr uint32_t FILE_HEADER_SIZE = 8; //!< Encoded file header size, in bytes
+
+  WasmFaasEventLog ();
+  virtual ~WasmFaasEventLog ();
+
+  /**
+   * \brief Append a record stamped with the current simulation time.
+   * \param node the ID of the node logging the event
+   * \param type the event
+   * \param requestId the request the event belongs to, 0 if none
+   * \param moduleId the module the event belongs to, 0 if none
+   * \param bytes the module bytes moved by the event, 0 if none
+   */
+  void Write (uint32_t node, EventType type, uint64_t requestId, uint32_t moduleId,
+              uint32_t bytes);
+
+  /**
+   * \brief Write the buffered records to the file.
+   */
+  void Flush (void);
+
+  /**
+   * \return the number of records appended so far
+   */
+  uint64_t GetNRecords (void) const;
+
+  /**
+   * \param type an event type
+   * \return the event name, or UNKNOWN
+   */
+  static const char *GetEventName (uint16_t type);
+
+  /**
+   * \brief Read and check the file header of a log.
+   * \param is the log stream
+   * \return false if the stream does not hold a log of this version
+   */
+  static bool ReadFileHeader (std::istream &is);
+
+  /**
+   * \brief Read the next record of a log.
+   * \param is the log stream, past its file header
+   * \param record filled with the record
+   * \return false at the end of the log
+   */
+  static bool ReadRecord (std::istream &is, Record &record);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  std::string m_fileName; //!< Log file name
+  uint32_t m_bufferSize; //!< Bytes buffered before they are written
+  std::ofstream m_file; //!< Log file, opened on the first write
+  std::vector<uint8_t> m_buffer; //!< Records not written yet
+  uint64_t m_nRecords; //!< Records appended so far
+};
+
+} // namespace ns3
+
+#endif /* WASMFAAS_EVENT_LOG_H */
@@ -0,0 +1,612 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <unordered_map>
+#include <vector>
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/header.h"
+#include "wasmfaas-header.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("WasmFaasHeader");
+
+NS_OBJECT_ENSURE_REGISTERED (WasmFaasHeader);
+
+/**
+ * \return the names seen by WasmFaasHeader::GetNameId, by ID
+ */
+static std::unordered_map<uint32_t, std::string> &
+GetNameRegistry (void)
+{
+  static std::unordered_map<uint32_t, std::string> registry;
+  return registry;
+}
+
+WasmFaasValue
+WasmFaasValue::FromI32 (int32_t v)
+{
+  return WasmFaasValue{ArgType::I32, (uint64_t) (uint32_t) v, 0};
+}
+
+WasmFaasValue
+WasmFaasValue::FromI64 (int64_t v)
+{
+  return WasmFaasValue{ArgType::I64, (uint64_t) v, 0};
+}
+
+WasmFaasValue
+WasmFaasValue::FromF32 (float v)
+{
+  uint32_t bits;
+  std::memcpy (&bits, &v, sizeof (bits));
+  return WasmFaasValue{ArgType::F32, bits, 0};
+}
+
+WasmFaasValue
+WasmFaasValue::FromF64 (double v)
+{
+  uint64_t bits;
+  std::memcpy (&bits, &v, sizeof (bits));
+  return WasmFaasValue{ArgType::F64, bits, 0};
+}
+
+int32_t
+WasmFaasValue::GetI32 (void) const
+{
+  return (int32_t) (uint32_t) lo;
+}
+
+int64_t
+WasmFaasValue::GetI64 (void) const
+{
+  return (int64_t) lo;
+}
+
+float
+WasmFaasValue::GetF32 (void) const
+{
+  float v;
+  uint32_t bits = (uint32_t) lo;
+  std::memcpy (&v, &bits, sizeof (v));
+  return v;
+}
+
+double
+WasmFaasValue::GetF64 (void) const
+{
+  double v;
+  std::memcpy (&v, &lo, sizeof (v));
+  return v;
+}
+
+std::ostream &
+operator<< (std::ostream &os, const WasmFaasValue &value)
+{
+  switch (value.type)
+    {
+    case ArgType::I32:
+      os << value.GetI32 ();
+      break;
+    case ArgType::I64:
+      os << value.GetI64 ();
+      break;
+    case ArgType::F32:
+      os << value.GetF32 ();
+      break;
+    case ArgType::F64:
+      os << value.GetF64 ();
+      break;
+    case ArgType::V128:
+      os << "0x" << std::hex << value.hi << std::setw (16) << std::setfill ('0') << value.lo
+         << std::setfill (' ') << std::dec;
+      break;
+    default:
+      os << "ref:" << value.lo;
+      break;
+    }
+  return os;
+}
+
+WasmFaasHeader::WasmFaasHeader ()
+    : m_type (ACK),
+      m_hopCount (0),
+      m_nArgs (0),
+      m_priority (0),
+      m_requestId (0),
+      m_moduleId (0),
+      m_functionId (0),
+      m_queueDepth (0),
+      m_utilization (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+WasmFaasHeader::SetType (MessageType type)
+{
+  NS_LOG_FUNCTION (this << type);
+  m_type = type;
+}
+
+WasmFaasHeader::MessageType
+WasmFaasHeader::GetType (void) const
+{
+  return static_cast<MessageType> (m_type);
+}
+
+void
+WasmFaasHeader::SetRequestId (uint64_t requestId)
+{
+  NS_LOG_FUNCTION (this << requestId);
+  m_requestId = requestId;
+}
+
+uint64_t
+WasmFaasHeader::GetRequestId (void) const
+{
+  return m_requestId;
+}
+
+void
+WasmFaasHeader::SetModuleId (uint32_t moduleId)
+{
+  NS_LOG_FUNCTION (this << moduleId);
+  m_moduleId = moduleId;
+}
+
+uint32_t
+WasmFaasHeader::GetModuleId (void) const
+{
+  return m_moduleId;
+}
+
+void
+WasmFaasHeader::SetFunctionId (uint32_t functionId)
+{
+  NS_LOG_FUNCTION (this << functionId);
+  m_functionId = functionId;
+}
+
+uint32_t
+WasmFaasHeader::GetFunctionId (void) const
+{
+  return m_functionId;
+}
+
+void
+WasmFaasHeader::SetHopCount (uint8_t hopCount)
+{
+  NS_LOG_FUNCTION (this << +hopCount);
+  m_hopCount = hopCount;
+}
+
+uint8_t
+WasmFaasHeader::GetHopCount (void) const
+{
+  return m_hopCount;
+}
+
+void
+WasmFaasHeader::SetPriority (uint8_t priority)
+{
+  NS_LOG_FUNCTION (this << +priority);
+  m_priority = priority;
+}
+
+uint8_t
+WasmFaasHeader::GetPriority (void) const
+{
+  return m_priority;
+}
+
+void
+WasmFaasHeader::SetQueueDepth (uint16_t queueDepth)
+{
+  NS_LOG_FUNCTION (this << queueDepth);
+  m_queueDepth = queueDepth;
+}
+
+uint16_t
+WasmFaasHeader::GetQueueDepth (void) const
+{
+  return m_queueDepth;
+}
+
+void
+WasmFaasHeader::SetUtilization (uint8_t utilization)
+{
+  NS_LOG_FUNCTION (this << +utilization);
+  m_utilization = utilization;
+}
+
+uint8_t
+WasmFaasHeader::GetUtilization (void) const
+{
+  return m_utilization;
+}
+
+void
+WasmFaasHeader::AddArg (WasmFaasValue value)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (m_nArgs < MAX_ARGS, "WasmFaasHeader holds at most " << +MAX_ARGS << " args");
+  m_args[m_nArgs++] = value;
+}
+
+void
+WasmFaasHeader::ClearArgs (void)
+{
+  m_nArgs = 0;
+}
+
+uint8_t
+WasmFaasHeader::GetNArgs (void) const
+{
+  return m_nArgs;
+}
+
+WasmFaasValue
+WasmFaasHeader::GetArg (uint8_t i) const
+{
+  NS_ASSERT (i < m_nArgs);
+  return m_args[i];
+}
+
+bool
+WasmFaasHeader::ToText (const std::string &payload, std::string &text) const
+{
+  NS_LOG_FUNCTION (this);
+
+  for (uint8_t i = 0; i < m_nArgs; i++)
+    {
+      if (m_args[i].type != ArgType::I32)
+        {
+          return false;
+        }
+    }
+
+  text.clear ();
+  if (m_type == ACK)
+    {
+      text = "0";
+      return true;
+    }
+
+  text.push_back ((char) m_type);
+  text.append (";").append (GetIdName (m_moduleId)).append (";");
+
+  switch (m_type)
+    {
+    case EXECUTE_REQUEST:
+      text.append (GetIdName (m_functionId)).append (";");
+      for (uint8_t i = 0; i < m_nArgs; i++)
+        {
+          text.append (std::to_string (m_args[i].GetI32 ())).append (";");
+        }
+      break;
+    case EXECUTE_RESULT:
+      text.append (std::to_string (m_nArgs > 0 ? m_args[0].GetI32 () : 0)).append (";");
+      break;
+    case MODULE_LOAD_RESULT:
+      text.append (payload).append (";");
+      break;
+    default:
+      break;
+    }
+
+  return true;
+}
+
+/**
+ * \param token a decimal number
+ * \param value filled with the number as an I32
+ * \return false if token is not a number in range
+ */
+static bool
+ParseI32 (const std::string &token, WasmFaasValue &value)
+{
+  char *end;
+  errno = 0;
+  long v = std::strtol (token.c_str (), &end, 10);
+  if (token.empty () || *end != '\0' || errno != 0 || v < INT32_MIN || v > INT32_MAX)
+    {
+      return false;
+    }
+  value = WasmFaasValue::FromI32 (v);
+  return true;
+}
+
+bool
+WasmFaasHeader::FromText (const std::string &text, std::string &payload)
+{
+  NS_LOG_FUNCTION (this << text);
+
+  std::vector<std::string> tokens;
+  size_t startPos = 0;
+  size_t endPos = 0;
+  while ((endPos = text.find (";", startPos)) != std::string::npos)
+    {
+      tokens.push_back (text.substr (startPos, endPos - startPos));
+      startPos = endPos + 1;
+    }
+
+  if (text.empty () || text[0] == ACK)
+    {
+      m_type = ACK;
+      return true;
+    }
+
+  // Every other message starts with type and module, the request ID travels out of band
+  if (tokens.size () < 2 || tokens[0].size () != 1)
+    {
+      return false;
+    }
+
+  m_type = tokens[0][0];
+  m_requestId = 0;
+  m_moduleId = GetNameId (tokens[1]);
+  m_hopCount = 0;
+  m_nArgs = 0;
+  m_priority = 0;
+  m_queueDepth = 0;
+  m_utilization = 0;
+
+  WasmFaasValue arg;
+  switch (m_type)
+    {
+    case EXECUTE_REQUEST:
+      if (tokens.size () < 3)
+        {
+          return false;
+        }
+      m_functionId = GetNameId (tokens[2]);
+      for (size_t i = 3; i < tokens.size () && m_nArgs < MAX_ARGS; i++)
+        {
+          if (!ParseI32 (tokens[i], arg))
+            {
+              return false;
+            }
+          AddArg (arg);
+        }
+      return true;
+    case EXECUTE_RESULT:
+      if (tokens.size () < 3 || !ParseI32 (tokens[2], arg))
+        {
+          return false;
+        }
+      AddArg (arg);
+      return true;
+    case MODULE_LOAD_RESULT:
+      if (tokens.size () < 3)
+        {
+          return false;
+        }
+      payload = tokens[2];
+      return true;
+    case NOT_FOUND:
+    case MODULE_LOAD_REQUEST:
+      return true;
+    default:
+      return false;
+    }
+}
+
+/**
+ * \param name a module or function name
+ * \return the 32 bit FNV-1a hash of name
+ */
+static uint32_t
+HashName (const std::string &name)
+{
+  uint32_t id = 2166136261u;
+  for (auto c : name)
+    {
+      id ^= (uint8_t) c;
+      id *= 16777619u;
+    }
+  return id;
+}
+
+bool
+WasmFaasHeader::RegisterName (const std::string &name)
+{
+  NS_LOG_FUNCTION (name);
+
+  auto id = HashName (name);
+  auto &registry = GetNameRegistry ();
+  auto it = registry.emplace (id, name).first;
+  if (it->second != name)
+    {
+      NS_LOG_WARN ("Name " << name << " has the ID of " << it->second);
+      return false;
+    }
+  return true;
+}
+
+uint32_t
+WasmFaasHeader::GetNameId (const std::string &name)
+{
+  // A colliding name keeps the ID, GetIdName resolves it to the name registered first
+  RegisterName (name);
+  return HashName (name);
+}
+
+std::string
+WasmFaasHeader::GetIdName (uint32_t id)
+{
+  auto &registry = GetNameRegistry ();
+  auto it = registry.find (id);
+  return it == registry.end () ? std::string () : it->second;
+}
+
+uint32_t
+WasmFaasHeader::GetValueSize (ArgType type)
+{
+  switch (type)
+    {
+    case ArgType::I32:
+    case ArgType::F32:
+      return 4;
+    case ArgType::V128:
+      return 16;
+    default:
+      return 8;
+    }
+}
+
+TypeId
+WasmFaasHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::WasmFaasHeader")
+                          .SetParent<Header> ()
+                          .SetGroupName ("Applications")
+                          .AddConstructor<WasmFaasHeader> ();
+  return tid;
+}
+
+TypeId
+WasmFaasHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+WasmFaasHeader::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "(type=" << (char) m_type << " request=" << m_requestId
+     << " module=" << GetIdName (m_moduleId) << " function=" << GetIdName (m_functionId)
+     << " hops=" << +m_hopCount << " load=" << m_queueDepth << "/" << +m_utilization
+     << "% args=[";
+  for (uint8_t i = 0; i < m_nArgs; i++)
+    {
+      os << (i ? " " : "") << m_args[i];
+    }
+  os << "])";
+}
+
+uint32_t
+WasmFaasHeader::PeekSerializedSize (Ptr<const Packet> packet)
+{
+  NS_LOG_FUNCTION (packet);
+
+  // The argument count sits in the fixed part, each argument type tells its size
+  uint8_t data[FIXED_SIZE + MAX_ARGS * 17];
+  auto size = packet->CopyData (data, std::min<uint32_t> (packet->GetSize (), sizeof (data)));
+  if (size < FIXED_SIZE)
+    {
+      return 0;
+    }
+  uint32_t pos = FIXED_SIZE;
+  for (uint8_t a = 0; a < std::min (data[2], MAX_ARGS); a++)
+    {
+      if (pos >= size)
+        {
+          return 0;
+        }
+      pos += 1 + GetValueSize (static_cast<ArgType> (data[pos]));
+    }
+  return pos <= size ? pos : 0;
+}
+
+uint32_t
+WasmFaasHeader::GetSerializedSize (void) const
+{
+  uint32_t size = FIXED_SIZE;
+  for (uint8_t i = 0; i < m_nArgs; i++)
+    {
+      size += 1 + GetValueSize (m_args[i].type);
+    }
+  return size;
+}
+
+void
+WasmFaasHeader::Serialize (Buffer::Iterator start) const
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  i.WriteU8 (m_type);
+  i.WriteU8 (m_hopCount);
+  i.WriteU8 (m_nArgs);
+  i.WriteU8 (m_priority);
+  i.WriteHtonU64 (m_requestId);
+  i.WriteHtonU32 (m_moduleId);
+  i.WriteHtonU32 (m_functionId);
+  i.WriteHtonU16 (m_queueDepth);
+  i.WriteU8 (m_utilization);
+  for (uint8_t a = 0; a < m_nArgs; a++)
+    {
+      i.WriteU8 ((uint8_t) m_args[a].type);
+      switch (GetValueSize (m_args[a].type))
+        {
+        case 4:
+          i.WriteHtonU32 ((uint32_t) m_args[a].lo);
+          break;
+        case 16:
+          i.WriteHtonU64 (m_args[a].hi);
+          i.WriteHtonU64 (m_args[a].lo);
+          break;
+        default:
+          i.WriteHtonU64 (m_args[a].lo);
+          break;
+        }
+    }
+}
+
+uint32_t
+WasmFaasHeader::Deserialize (Buffer::Iterator start)
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  m_type = i.ReadU8 ();
+  m_hopCount = i.ReadU8 ();
+  m_nArgs = std::min (i.ReadU8 (), MAX_ARGS);
+  m_priority = i.ReadU8 ();
+  m_requestId = i.ReadNtohU64 ();
+  m_moduleId = i.ReadNtohU32 ();
+  m_functionId = i.ReadNtohU32 ();
+  m_queueDepth = i.ReadNtohU16 ();
+  m_utilization = i.ReadU8 ();
+  for (uint8_t a = 0; a < m_nArgs; a++)
+    {
+      m_args[a].type = static_cast<ArgType> (i.ReadU8 ());
+      m_args[a].hi = 0;
+      switch (GetValueSize (m_args[a].type))
+        {
+        case 4:
+          m_args[a].lo = i.ReadNtohU32 ();
+          break;
+        case 16:
+          m_args[a].hi = i.ReadNtohU64 ();
+          m_args[a].lo = i.ReadNtohU64 ();
+          break;
+        default:
+          m_args[a].lo = i.ReadNtohU64 ();
+          break;
+        }
+    }
+  return GetSerializedSize ();
+}
+
+} // namespace ns3
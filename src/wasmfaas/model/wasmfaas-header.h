@@ -0,0 +1,348 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef WASMFAAS_HEADER_H
+#define WASMFAAS_HEADER_H
+
+#include <string>
+
+#include "ns3/header.h"
+#include "ns3/packet.h"
+#include "libwasmfaas.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup customapp
+ *
+ * \brief A typed Wasm value carried by a WasmFaasHeader.
+ *
+ * Values of up to 64 bits live in lo, only V128 values use hi.
+ */
+struct WasmFaasValue
+{
+  ArgType type; //!< Value type
+  uint64_t lo; //!< Low 64 bits of the value
+  uint64_t hi; //!< High 64 bits of the value, V128 only
+
+  /**
+   * \param v the value
+   * \return an I32 value
+   */
+  static WasmFaasValue FromI32 (int32_t v);
+  /**
+   * \param v the value
+   * \return an I64 value
+   */
+  static WasmFaasValue FromI64 (int64_t v);
+  /**
+   * \param v the value
+   * \return an F32 value
+   */
+  static WasmFaasValue FromF32 (float v);
+  /**
+   * \param v the value
+   * \return an F64 value
+   */
+  static WasmFaasValue FromF64 (double v);
+
+  /**
+   * \return the value read as an I32
+   */
+  int32_t GetI32 (void) const;
+  /**
+   * \return the value read as an I64
+   */
+  int64_t GetI64 (void) const;
+  /**
+   * \return the value read as an F32
+   */
+  float GetF32 (void) const;
+  /**
+   * \return the value read as an F64
+   */
+  double GetF64 (void) const;
+};
+
+/**
+ * \brief Print a value according to its type.
+ * \param os the output stream
+ * \param value the value
+ * \return os
+ */
+std::ostream &operator<< (std::ostream &os, const WasmFaasValue &value);
+
+/**
+ * \ingroup customapp
+ *
+ * \brief Outcome of a function invocation.
+ */
+struct WasmFaasResult
+{
+  /// Invocation outcome
+  enum Status
+  {
+    OK, //!< The function ran, value holds its result
+    PENDING, //!< The module was not available, the invocation went to the peers
+    FAILED, //!< The function could not be run
+    NOT_FOUND, //!< No peer within MaxHops holds the module
+    TIMED_OUT //!< The peers did not answer, retries included
+  };
+
+  Status status; //!< Invocation outcome
+  WasmFaasValue value; //!< Function result when status is OK
+  uint64_t requestId; //!< Request ID of the invocation
+};
+
+/**
+ * \ingroup customapp
+ *
+ * \brief Packet header of the messages exchanged between CustomApp peers.
+ *
+ * Fixed part (23 bytes): message type (1), hop count (1), argument count (1),
+ * priority (1), request ID (8), module ID (4), function ID (4), and the load
+ * of the sender: queue depth (2) and utilization (1). It is
+ * followed by the arguments, each encoded as its ArgType (1) and its value
+ * (4, 8 or 16 bytes depending on the type). The arguments are stored inline,
+ * so building and serializing a header never allocates.
+ *
+ * Module and function names travel as 32 bit IDs. GetNameId hashes a name and
+ * records it so that GetIdName can resolve it on the receiving node. The
+ * record is a process-wide registry shared by every simulated node: a
+ * simulation shortcut that spares carrying the names, which real peers
+ * would have to exchange. Two names of the same ID cannot both be used,
+ * RegisterName tells whether a name is free to be.
+ *
+ * For EXECUTE_RESULT messages the argument list holds the function result.
+ * Module data of MODULE_LOAD_RESULT messages follows the header as payload,
+ * and so does the WasmFaasModuleDigest of GOSSIP messages. MODULE_CHUNK
+ * and MODULE_CHUNK_ACK messages are followed by a WasmFaasChunkHeader.
+ * WORKFLOW messages are followed by the workflow ID (8), the address (4)
+ * and port (2) of the node waiting for the result, and the
+ * WasmFaasWorkflow. The arguments of WORKFLOW_RESULT messages are the
+ * WasmFaasResult::Status as an I32 and the result of the last stage.
+ * BATCH messages are followed by the messages they carry, each as its size
+ * (2) and its header and payload.
+ */
+class WasmFaasHeader : public Header
+{
+public:
+  /// Message types, valued after the characters of the text protocol
+  enum MessageType : uint8_t
+  {
+    ACK = '0', //!< Acknowledgement with no content
+    EXECUTE_REQUEST = 'e', //!< Run a function of a module
+    EXECUTE_RESULT = 'r', //!< Result of an execute request
+    NOT_FOUND = 'n', //!< No reachable peer holds the module, or the peer asked for it lacks it
+    MODULE_LOAD_REQUEST = 'l', //!< Ask a peer for its copy of a module
+    MODULE_LOAD_RESULT = 'c', //!< Module data answering a load request
+    MODULE_CHUNK = 'k', //!< One chunk of a chunked module transfer
+    MODULE_CHUNK_ACK = 'a', //!< Acknowledges one chunk of a chunked module transfer
+    GOSSIP = 'g', //!< Digest of the modules held by the sender, binary protocol only
+    WORKFLOW = 'f', //!< Workflow handed over to a peer, binary protocol only
+    WORKFLOW_RESULT = 'o', //!< Result of a workflow, sent to the node that started it
+    BATCH = 'b' //!< Messages to the same peer sent as one packet, binary protocol only
+  };
+
+  /// Maximum number of arguments carried by one header
+  static constexpr uint8_t MAX_ARGS = 8;
+
+  /// Size of the fixed part of the header, in bytes
+  static constexpr uint32_t FIXED_SIZE = 23;
+
+  WasmFaasHeader ();
+
+  /**
+   * \param type the message type
+   */
+  void SetType (MessageType type);
+  /**
+   * \return the message type
+   */
+  MessageType GetType (void) const;
+
+  /**
+   * \param requestId the ID of the invocation the message belongs to
+   */
+  void SetRequestId (uint64_t requestId);
+  /**
+   * \return the ID of the invocation the message belongs to
+   */
+  uint64_t GetRequestId (void) const;
+
+  /**
+   * \param moduleId the module ID, see GetNameId
+   */
+  void SetModuleId (uint32_t moduleId);
+  /**
+   * \return the module ID
+   */
+  uint32_t GetModuleId (void) const;
+
+  /**
+   * \param functionId the function ID, see GetNameId
+   */
+  void SetFunctionId (uint32_t functionId);
+  /**
+   * \return the function ID
+   */
+  uint32_t GetFunctionId (void) const;
+
+  /**
+   * \param hopCount the number of times the request has been forwarded
+   */
+  void SetHopCount (uint8_t hopCount);
+  /**
+   * \return the number of times the request has been forwarded
+   */
+  uint8_t GetHopCount (void) const;
+
+  /**
+   * \param priority the invocation priority, higher runs first
+   */
+  void SetPriority (uint8_t priority);
+  /**
+   * \return the invocation priority, higher runs first
+   */
+  uint8_t GetPriority (void) const;
+
+  /**
+   * \param queueDepth the invocations waiting for a slot on the sender
+   */
+  void SetQueueDepth (uint16_t queueDepth);
+  /**
+   * \return the invocations waiting for a slot on the sender
+   */
+  uint16_t GetQueueDepth (void) const;
+
+  /**
+   * \param utilization the share of busy execution slots on the sender, in percent
+   */
+  void SetUtilization (uint8_t utilization);
+  /**
+   * \return the share of busy execution slots on the sender, in percent
+   */
+  uint8_t GetUtilization (void) const;
+
+  /**
+   * \brief Append an argument, at most MAX_ARGS fit in the header.
+   * \param value the argument
+   */
+  void AddArg (WasmFaasValue value);
+  /**
+   * \brief Drop every argument.
+   */
+  void ClearArgs (void);
+  /**
+   * \return the number of arguments
+   */
+  uint8_t GetNArgs (void) const;
+  /**
+   * \param i the argument index
+   * \return the i-th argument
+   */
+  WasmFaasValue GetArg (uint8_t i) const;
+
+  /**
+   * \brief Encode the message in the legacy ';' delimited text protocol.
+   *
+   * The messages keep the legacy layout: "e;module;function;arg;...;",
+   * "r;module;result;", "l;module;", "c;module;data;", "n;module;" and
+   * "0" for acks. The text protocol carries neither the request ID, see
+   * WasmFaasRequestTag, the hop count, the priority, the load nor the
+   * argument types, every value travels as a decimal I32. A result with no
+   * value is written as 0, the legacy protocol having no failed result.
+   *
+   * \param payload the data following the header, if any
+   * \param text filled with the text message
+   * \return false if an argument or the result is not an I32
+   */
+  bool ToText (const std::string &payload, std::string &text) const;
+  /**
+   * \brief Decode a message of the legacy ';' delimited text protocol.
+   *
+   * The request ID of the decoded message is 0.
+   *
+   * \param text the text message
+   * \param payload filled with the data following the header, if any
+   * \return false if the text is not a valid message
+   */
+  bool FromText (const std::string &text, std::string &payload);
+
+  /**
+   * \brief Remember a module or function name, so that GetIdName resolves its ID.
+   * \param name the module or function name
+   * \return false if another name of the same ID was registered before
+   */
+  static bool RegisterName (const std::string &name);
+  /**
+   * \brief Get the ID of a module or function name and remember the name.
+   *
+   * The ID of a name colliding with a name registered before resolves to
+   * the earlier name, see RegisterName.
+   *
+   * \param name the module or function name
+   * \return the 32 bit ID of the name
+   */
+  static uint32_t GetNameId (const std::string &name);
+  /**
+   * \param id an ID returned by GetNameId
+   * \return the name, or an empty string if the ID is unknown
+   */
+  static std::string GetIdName (uint32_t id);
+
+  /**
+   * \brief Get the size of the header at the start of a packet without removing it.
+   * \param packet the packet
+   * \return the header size, arguments included, or 0 if packet is too short
+   *         to hold them
+   */
+  static uint32_t PeekSerializedSize (Ptr<const Packet> packet);
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  /**
+   * \param type a value type
+   * \return the number of bytes the value takes on the wire
+   */
+  static uint32_t GetValueSize (ArgType type);
+
+  uint8_t m_type; //!< Message type
+  uint8_t m_hopCount; //!< Number of times the request has been forwarded
+  uint8_t m_nArgs; //!< Number of arguments
+  uint8_t m_priority; //!< Invocation priority
+  uint64_t m_requestId; //!< Invocation the message belongs to
+  uint32_t m_moduleId; //!< Module ID
+  uint32_t m_functionId; //!< Function ID
+  uint16_t m_queueDepth; //!< Invocations waiting for a slot on the sender
+  uint8_t m_utilization; //!< Busy execution slots of the sender, in percent
+  WasmFaasValue m_args[MAX_ARGS]; //!< Arguments
+};
+
+} // namespace ns3
+
+#endif /* WASMFAAS_HEADER_H */
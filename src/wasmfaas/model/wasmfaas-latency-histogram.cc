@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "ns3/assert.h"
+#include "wasmfaas-latency-histogram.h"
+
+namespace ns3 {
+
+WasmFaasLatencyHistogram::WasmFaasLatencyHistogram (uint32_t precision)
+    : m_precision (precision), m_count (0), m_min (0), m_max (0), m_sum (0)
+{
+  NS_ASSERT_MSG (precision >= 2 && precision <= 20, "Invalid histogram precision " << precision);
+}
+
+uint32_t
+WasmFaasLatencyHistogram::GetBucket (uint64_t value) const
+{
+  uint64_t exact = (uint64_t) 1 << m_precision;
+  if (value < exact)
+    {
+      return (uint32_t) value;
+    }
+
+  // Keep the precision leading bits, the first one always being set
+  uint32_t msb = 63 - __builtin_clzll (value);
+  uint32_t shift = msb - (m_precision - 1);
+  uint64_t half = exact >> 1;
+  return (uint32_t) (exact + (shift - 1) * half + ((value >> shift) - half));
+}
+
+uint64_t
+WasmFaasLatencyHistogram::GetBucketHighest (uint32_t bucket) const
+{
+  uint64_t exact = (uint64_t) 1 << m_precision;
+  if (bucket < exact)
+    {
+      return bucket;
+    }
+
+  uint64_t half = exact >> 1;
+  uint32_t shift = (bucket - exact) / half + 1;
+  uint64_t lead = half + (bucket - exact) % half;
+  return ((lead + 1) << shift) - 1;
+}
+
+void
+WasmFaasLatencyHistogram::Record (Time latency)
+{
+  uint64_t value = latency.IsStrictlyPositive () ? latency.GetNanoSeconds () : 0;
+  auto bucket = GetBucket (value);
+  if (bucket >= m_counts.size ())
+    {
+      m_counts.resize (bucket + 1, 0);
+    }
+  m_counts[bucket]++;
+
+  m_min = m_count == 0 ? value : std::min (m_min, value);
+  m_max = m_count == 0 ? value : std::max (m_max, value);
+  m_count++;
+  m_sum += value;
+}
+
+void
+WasmFaasLatencyHistogram::Merge (const WasmFaasLatencyHistogram &other)
+{
+  NS_ASSERT_MSG (other.m_precision == m_precision, "Merging histograms of different precisions");
+
+  if (other.m_count == 0)
+    {
+      return;
+    }
+  if (other.m_counts.size () > m_counts.size ())
+    {
+      m_counts.resize (other.m_counts.size (), 0);
+    }
+  for (size_t i = 0; i < other.m_counts.size (); i++)
+    {
+      m_counts[i] += other.m_counts[i];
+    }
+
+  m_min = m_count == 0 ? other.m_min : std::min (m_min, other.m_min);
+  m_max = m_count == 0 ? other.m_max : std::max (m_max, other.m_max);
+  m_count += other.m_count;
+  m_sum += other.m_sum;
+}
+
+Time
+WasmFaasLatencyHistogram::GetPercentile (double quantile) const
+{
+  if (m_count == 0)
+    {
+      return Time (0);
+    }
+
+  auto rank = (uint64_t) std::ceil (std::min (std::max (quantile, 0.0), 1.0) * m_count);
+  rank = std::max (rank, (uint64_t) 1);
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < m_counts.size (); i++)
+    {
+      seen += m_counts[i];
+      if (seen >= rank)
+        {
+          // The bucket bound may exceed every value actually recorded
+          return NanoSeconds ((int64_t) std::min (GetBucketHighest (i), m_max));
+        }
+    }
+  return NanoSeconds ((int64_t) m_max);
+}
+
+uint64_t
+WasmFaasLatencyHistogram::GetCount (void) const
+{
+  return m_count;
+}
+
+Time
+WasmFaasLatencyHistogram::GetMin (void) const
+{
+  return NanoSeconds ((int64_t) m_min);
+}
+
+Time
+WasmFaasLatencyHistogram::GetMax (void) const
+{
+  return NanoSeconds ((int64_t) m_max);
+}
+
+Time
+WasmFaasLatencyHistogram::GetMean (void) const
+{
+  return m_count == 0 ? Time (0) : NanoSeconds ((int64_t) (m_sum / m_count));
+}
+
+void
+WasmFaasLatencyHistogram::Print (std::ostream &os) const
+{
+  os << "count=" << m_count << " mean=" << GetMean ().GetNanoSeconds () / 1e6
+     << "ms p50=" << GetPercentile (0.5).GetNanoSeconds () / 1e6
+     << "ms p99=" << GetPercentile (0.99).GetNanoSeconds () / 1e6
+     << "ms p999=" << GetPercentile (0.999).GetNanoSeconds () / 1e6
+     << "ms max=" << GetMax ().GetNanoSeconds () / 1e6 << "ms";
+}
+
+std::ostream &
+operator<< (std::ostream &os, const WasmFaasLatencyHistogram &histogram)
+{
+  histogram.Print (os);
+  return os;
+}
+
+} // namespace ns3
@@ -0,0 +1,115 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef WASMFAAS_LATENCY_HISTOGRAM_H
+#define WASMFAAS_LATENCY_HISTOGRAM_H
+
+#include <ostream>
+#include <vector>
+
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup customapp
+ *
+ * \brief Latency histogram with log-linear buckets, after HdrHistogram.
+ *
+ * Latencies are recorded in nanoseconds. Values below 2^precision fall in
+ * buckets of their own, larger values share buckets with the values having
+ * the same precision leading bits, so a percentile is off by at most
+ * 2^-(precision - 1) of its value. Recording is O(1) and the memory used
+ * only grows with the logarithm of the largest value.
+ */
+class WasmFaasLatencyHistogram
+{
+public:
+  /**
+   * \param precision leading bits kept exactly, between 2 and 20
+   */
+  WasmFaasLatencyHistogram (uint32_t precision = 7);
+
+  /**
+   * \param latency the latency to record, negative latencies count as 0
+   */
+  void Record (Time latency);
+
+  /**
+   * \brief Add every value recorded by another histogram of the same precision.
+   * \param other the histogram to add
+   */
+  void Merge (const WasmFaasLatencyHistogram &other);
+
+  /**
+   * \param quantile between 0 and 1, e.g. 0.99 for the 99th percentile
+   * \return the highest latency of the bucket holding the quantile, 0 if empty
+   */
+  Time GetPercentile (double quantile) const;
+
+  /**
+   * \return the number of latencies recorded
+   */
+  uint64_t GetCount (void) const;
+  /**
+   * \return the smallest latency recorded, 0 if empty
+   */
+  Time GetMin (void) const;
+  /**
+   * \return the largest latency recorded, 0 if empty
+   */
+  Time GetMax (void) const;
+  /**
+   * \return the mean of the latencies recorded, 0 if empty
+   */
+  Time GetMean (void) const;
+
+  /**
+   * \brief Print count, mean, p50, p99, p999 and max on one line, in milliseconds.
+   * \param os the output stream
+   */
+  void Print (std::ostream &os) const;
+
+private:
+  /**
+   * \param value a latency in nanoseconds
+   * \return the bucket holding value
+   */
+  uint32_t GetBucket (uint64_t value) const;
+  /**
+   * \param bucket a bucket index
+   * \return the highest value falling in the bucket, in nanoseconds
+   */
+  uint64_t GetBucketHighest (uint32_t bucket) const;
+
+  uint32_t m_precision; //!< Leading bits kept exactly
+  std::vector<uint64_t> m_counts; //!< Values recorded per bucket, grown on demand
+  uint64_t m_count; //!< Values recorded
+  uint64_t m_min; //!< Smallest value recorded, in nanoseconds
+  uint64_t m_max; //!< Largest value recorded, in nanoseconds
+  double m_sum; //!< Sum of the values recorded, in nanoseconds
+};
+
+/**
+ * \param os the output stream
+ * \param histogram the histogram
+ * \return the output stream
+ */
+std::ostream &operator<< (std::ostream &os, const WasmFaasLatencyHistogram &histogram);
+
+} // namespace ns3
+
+#endif /* WASMFAAS_LATENCY_HISTOGRAM_H */
@@ -0,0 +1,113 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+
+#include "ns3/assert.h"
+#include "wasmfaas-module-digest.h"
+
+namespace ns3 {
+
+/**
+ * \param x a value
+ * \return x with every bit depending on every bit of the value, the
+ * MurmurHash3 finalizer
+ */
+static uint32_t
+Mix (uint32_t x)
+{
+  x ^= x >> 16;
+  x *= 0x85ebca6bu;
+  x ^= x >> 13;
+  x *= 0xc2b2ae35u;
+  x ^= x >> 16;
+  return x;
+}
+
+WasmFaasModuleDigest::WasmFaasModuleDigest (uint32_t nBits, uint8_t nHashes)
+    : m_bits ((std::max (nBits, 8u) + 7) / 8, 0), m_nHashes (nHashes)
+{
+  NS_ASSERT_MSG (nHashes > 0, "A module digest needs at least one hash");
+}
+
+uint32_t
+WasmFaasModuleDigest::GetBit (uint32_t moduleId, uint8_t i) const
+{
+  // The low bits of FNV-1a module IDs barely change between similar names,
+  // so mix them before double hashing derives the other hashes
+  uint32_t h1 = Mix (moduleId);
+  uint32_t h2 = Mix (h1 ^ 0x9e3779b9u) | 1;
+  return (h1 + i * h2) % GetNBits ();
+}
+
+void
+WasmFaasModuleDigest::Add (uint32_t moduleId)
+{
+  for (uint8_t i = 0; i < m_nHashes; i++)
+    {
+      auto bit = GetBit (moduleId, i);
+      m_bits[bit / 8] |= 1 << (bit % 8);
+    }
+}
+
+bool
+WasmFaasModuleDigest::MayContain (uint32_t moduleId) const
+{
+  for (uint8_t i = 0; i < m_nHashes; i++)
+    {
+      auto bit = GetBit (moduleId, i);
+      if ((m_bits[bit / 8] & (1 << (bit % 8))) == 0)
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+WasmFaasModuleDigest::Clear (void)
+{
+  std::fill (m_bits.begin (), m_bits.end (), 0);
+}
+
+uint32_t
+WasmFaasModuleDigest::GetNBits (void) const
+{
+  return m_bits.size () * 8;
+}
+
+void
+WasmFaasModuleDigest::Serialize (std::string &data) const
+{
+  data.clear ();
+  data.push_back ((char) m_nHashes);
+  data.append ((const char *) m_bits.data (), m_bits.size ());
+}
+
+bool
+WasmFaasModuleDigest::Deserialize (const std::string &data)
+{
+  // Bits of a filter of another size are at other positions
+  if (data.size () != m_bits.size () + 1 || data[0] == 0)
+    {
+      return false;
+    }
+  m_nHashes = (uint8_t) data[0];
+  m_bits.assign (data.begin () + 1, data.end ());
+  return true;
+}
+
+} // namespace ns3
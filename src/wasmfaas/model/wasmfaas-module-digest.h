@@ -0,0 +1,95 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef WASMFAAS_MODULE_DIGEST_H
+#define WASMFAAS_MODULE_DIGEST_H
+
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup customapp
+ *
+ * \brief Bloom filter of module IDs, gossiped by CustomApp peers.
+ *
+ * Each module ID sets nHashes bits of the filter. MayContain never misses a
+ * module that was added, but may claim a module that was not: with n
+ * modules in m bits the false positive rate is about
+ * (1 - e^(-nHashes * n / m))^nHashes.
+ *
+ * On the wire the digest is its hash count (1) followed by its bits. The
+ * filter size is not sent, so peers must use the same size: the bit a
+ * module sets depends on it.
+ */
+class WasmFaasModuleDigest
+{
+public:
+  /**
+   * \param nBits filter size in bits, rounded up to whole bytes
+   * \param nHashes bits set by each module, between 1 and 255
+   */
+  WasmFaasModuleDigest (uint32_t nBits = 256, uint8_t nHashes = 3);
+
+  /**
+   * \param moduleId the module ID, see WasmFaasHeader::GetNameId
+   */
+  void Add (uint32_t moduleId);
+
+  /**
+   * \param moduleId the module ID, see WasmFaasHeader::GetNameId
+   * \return false if the module was never added, true if it probably was
+   */
+  bool MayContain (uint32_t moduleId) const;
+
+  /**
+   * \brief Remove every module.
+   */
+  void Clear (void);
+
+  /**
+   * \return the filter size in bits
+   */
+  uint32_t GetNBits (void) const;
+
+  /**
+   * \param data filled with the wire form of the digest
+   */
+  void Serialize (std::string &data) const;
+
+  /**
+   * \param data the wire form of a digest of GetNBits bits
+   * \return false, leaving the digest unchanged, if data does not hold a
+   * valid digest of this size
+   */
+  bool Deserialize (const std::string &data);
+
+private:
+  /**
+   * \param moduleId the module ID
+   * \param i the hash index, below m_nHashes
+   * \return the bit set by the i-th hash of the module
+   */
+  uint32_t GetBit (uint32_t moduleId, uint8_t i) const;
+
+  std::vector<uint8_t> m_bits; //!< Filter bits
+  uint8_t m_nHashes; //!< Bits set by each module
+};
+
+} // namespace ns3
+
+#endif /* WASMFAAS_MODULE_DIGEST_H */
@@ -0,0 +1,368 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/global-value.h"
+#include "ns3/string.h"
+#include "ns3/boolean.h"
+#include "wasmfaas-module-store.h"
+#include "libwasmfaas-ext.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("WasmModuleStore");
+
+/**
+ * \ingroup customapp
+ * \anchor GlobalValueWasmModuleArtifactDirectory
+ * Directory of the precompiled module artifacts shared by simulation
+ * processes, see WasmModuleStore.
+ */
+static GlobalValue g_artifactDirectory =
+    GlobalValue ("WasmModuleArtifactDirectory",
+                 "Directory where compiled modules are kept for later simulation processes, "
+                 "empty to disable",
+                 StringValue (""), MakeStringChecker ());
+
+/**
+ * \ingroup customapp
+ * \anchor GlobalValueWasmModuleSharedCompile
+ * Whether modules are compiled once for every node of the process, see
+ * WasmModuleStore.
+ */
+static GlobalValue g_sharedCompile =
+    GlobalValue ("WasmModuleSharedCompile",
+                 "Compile each module once for every node, the runtime must provide "
+                 "compile_module and register_compiled_module",
+                 BooleanValue (false), MakeBooleanChecker ());
+
+namespace {
+
+/// Module compiled once for the whole process
+struct CompiledModule
+{
+  std::string data; //!< Module data in base64, to tell hash collisions apart
+  uint64_t handle; //!< Handle returned by compile_module
+  void *mapping; //!< Artifact the module was loaded from, null if compiled
+  uint64_t mappingSize; //!< Size of the artifact mapping
+};
+
+/// Magic of the artifact header
+const char g_artifactMagic[] = "WFMA";
+/// Version of the artifact header
+const uint32_t ARTIFACT_VERSION = 1;
+/// Size of the artifact header: magic, version, module hash and module size
+const uint32_t ARTIFACT_HEADER_SIZE = 24;
+
+/// Compiled modules by content hash
+std::unordered_map<uint64_t, std::vector<CompiledModule>> g_compiled;
+uint32_t g_nCompiled = 0; //!< Distinct modules compiled
+uint32_t g_nArtifactsLoaded = 0; //!< Modules loaded from artifacts
+uint64_t g_nReused = 0; //!< Registrations that reused a compiled module
+
+/**
+ * \param buf where to write
+ * \param value the value to write
+ * \param n the number of low order bytes of value to write, little endian
+ */
+void
+PutLe (uint8_t *buf, uint64_t value, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      buf[i] = (uint8_t) (value >> (8 * i));
+    }
+}
+
+/**
+ * \param buf where to read
+ * \param n the number of bytes to read, little endian
+ * \return the value read
+ */
+uint64_t
+GetLe (const uint8_t *buf, uint32_t n)
+{
+  uint64_t value = 0;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      value |= (uint64_t) buf[i] << (8 * i);
+    }
+  return value;
+}
+
+} // namespace
+
+uint64_t
+WasmModuleStore::GetHash (const std::string &moduleData)
+{
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (uint8_t c : moduleData)
+    {
+      hash ^= c;
+      hash *= 0x100000001b3ULL;
+    }
+  return hash;
+}
+
+uint64_t
+WasmModuleStore::GetHandle (const std::string &moduleData, uint64_t hash)
+{
+  auto &bucket = g_compiled[hash];
+  for (auto &compiled : bucket)
+    {
+      if (compiled.data == moduleData)
+        {
+          g_nReused++;
+          return compiled.handle;
+        }
+    }
+
+  auto path = GetArtifactPath (moduleData);
+  void *mapping = nullptr;
+  uint64_t mappingSize = 0;
+  auto handle = path.empty () ? 0 : LoadArtifact (path, moduleData, hash, mapping, mappingSize);
+  if (handle != 0)
+    {
+      g_nArtifactsLoaded++;
+    }
+  else
+    {
+      handle = compile_module (moduleData.c_str ());
+      if (handle != 0 && !path.empty ())
+        {
+          SaveArtifact (path, handle, moduleData, hash);
+        }
+    }
+
+  if (handle != 0)
+    {
+      bucket.push_back (CompiledModule{moduleData, handle, mapping, mappingSize});
+      g_nCompiled++;
+    }
+  return handle;
+}
+
+std::string
+WasmModuleStore::GetArtifactPath (const std::string &moduleData)
+{
+  StringValue directory;
+  g_artifactDirectory.GetValue (directory);
+  if (directory.Get ().empty () || get_runtime_version == nullptr ||
+      serialize_compiled_module == nullptr || load_compiled_module == nullptr)
+    {
+      return "";
+    }
+
+  // Keep the version usable in a file name
+  std::string version = get_runtime_version ();
+  for (auto &c : version)
+    {
+      if (!isalnum ((unsigned char) c) && c != '.' && c != '-')
+        {
+          c = '_';
+        }
+    }
+
+  std::ostringstream oss;
+  oss << directory.Get () << "/" << std::hex << GetHash (moduleData) << std::dec << "-"
+      << moduleData.size () << "-" << version << ".cwasm";
+  return oss.str ();
+}
+
+uint64_t
+WasmModuleStore::LoadArtifact (const std::string &path, const std::string &moduleData,
+                               uint64_t hash, void *&mapping, uint64_t &mappingSize)
+{
+  NS_LOG_FUNCTION (path << hash);
+
+  int fd = open (path.c_str (), O_RDONLY);
+  if (fd == -1)
+    {
+      return 0;
+    }
+
+  struct stat st;
+  void *artifact = MAP_FAILED;
+  if (fstat (fd, &st) == 0 && st.st_size > ARTIFACT_HEADER_SIZE)
+    {
+      artifact = mmap (nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+  close (fd);
+  if (artifact == MAP_FAILED)
+    {
+      NS_LOG_WARN ("Ignoring unusable module artifact " << path);
+      return 0;
+    }
+
+  // The header ties the artifact to the module it was compiled from, the
+  // file name alone may be shared by modules of the same hash and size
+  auto bytes = (const uint8_t *) artifact;
+  uint64_t handle = 0;
+  if (std::equal (g_artifactMagic, g_artifactMagic + 4, bytes) &&
+      GetLe (bytes + 4, 4) == ARTIFACT_VERSION && GetLe (bytes + 8, 8) == hash &&
+      GetLe (bytes + 16, 8) == moduleData.size ())
+    {
+      handle = load_compiled_module (bytes + ARTIFACT_HEADER_SIZE,
+                                     st.st_size - ARTIFACT_HEADER_SIZE);
+    }
+  if (handle == 0)
+    {
+      NS_LOG_WARN ("Ignoring unusable module artifact " << path);
+      munmap (artifact, st.st_size);
+      return 0;
+    }
+
+  // The mapping is shared with the other processes and kept until Clear
+  mapping = artifact;
+  mappingSize = st.st_size;
+  return handle;
+}
+
+void
+WasmModuleStore::SaveArtifact (const std::string &path, uint64_t handle,
+                               const std::string &moduleData, uint64_t hash)
+{
+  NS_LOG_FUNCTION (path << handle << hash);
+
+  auto compiledSize = serialize_compiled_module (handle, nullptr, 0);
+  std::vector<uint8_t> artifact (ARTIFACT_HEADER_SIZE + compiledSize);
+  auto compiled = artifact.data () + ARTIFACT_HEADER_SIZE;
+  if (compiledSize == 0 ||
+      serialize_compiled_module (handle, compiled, compiledSize) != compiledSize)
+    {
+      NS_LOG_WARN ("Cannot serialize module artifact " << path);
+      return;
+    }
+  std::copy (g_artifactMagic, g_artifactMagic + 4, artifact.begin ());
+  PutLe (artifact.data () + 4, ARTIFACT_VERSION, 4);
+  PutLe (artifact.data () + 8, hash, 8);
+  PutLe (artifact.data () + 16, moduleData.size (), 8);
+
+  auto directory = path.substr (0, path.rfind ('/'));
+  if (mkdir (directory.c_str (), 0755) == -1 && errno != EEXIST)
+    {
+      NS_LOG_WARN ("Cannot create module artifact directory " << directory);
+      return;
+    }
+
+  // Concurrent processes each write their own file, the last rename wins
+  std::ostringstream tmp;
+  tmp << path << "." << getpid () << ".tmp";
+  auto file = fopen (tmp.str ().c_str (), "wb");
+  if (file == nullptr)
+    {
+      NS_LOG_WARN ("Cannot write module artifact " << tmp.str ());
+      return;
+    }
+  auto written = fwrite (artifact.data (), 1, artifact.size (), file);
+  if (fclose (file) != 0 || written != artifact.size () ||
+      rename (tmp.str ().c_str (), path.c_str ()) != 0)
+    {
+      NS_LOG_WARN ("Cannot write module artifact " << path);
+      remove (tmp.str ().c_str ());
+    }
+}
+
+bool
+WasmModuleStore::Register (uint64_t runtimeId, const std::string &moduleName,
+                           const std::string &moduleData)
+{
+  NS_LOG_FUNCTION (runtimeId << moduleName << moduleData.size ());
+
+  BooleanValue shared;
+  g_sharedCompile.GetValue (shared);
+  if (!shared.Get ())
+    {
+      register_module (runtimeId, moduleName.c_str (), moduleData.c_str ());
+      return is_module_registered (runtimeId, moduleName.c_str ());
+    }
+  NS_ABORT_MSG_IF (compile_module == nullptr || register_compiled_module == nullptr,
+                   "WasmModuleSharedCompile needs a runtime with compile_module and "
+                   "register_compiled_module");
+
+  auto handle = GetHandle (moduleData, GetHash (moduleData));
+  if (handle == 0)
+    {
+      NS_LOG_WARN ("Cannot compile module " << moduleName);
+      return false;
+    }
+  auto error = register_compiled_module (runtimeId, moduleName.c_str (), handle);
+  if (error != nullptr)
+    {
+      NS_LOG_WARN ("Cannot register module " << moduleName << ": " << error);
+      free_ffi_string ((char *) error);
+      return false;
+    }
+  return true;
+}
+
+uint32_t
+WasmModuleStore::GetNCompiled (void)
+{
+  return g_nCompiled;
+}
+
+uint64_t
+WasmModuleStore::GetNReused (void)
+{
+  return g_nReused;
+}
+
+uint32_t
+WasmModuleStore::GetNArtifactsLoaded (void)
+{
+  return g_nArtifactsLoaded;
+}
+
+void
+WasmModuleStore::Clear (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  for (auto &bucket : g_compiled)
+    {
+      for (auto &compiled : bucket.second)
+        {
+          // The runtime may read the artifact until the module is released
+          if (release_compiled_module != nullptr)
+            {
+              release_compiled_module (compiled.handle);
+            }
+          if (compiled.mapping != nullptr)
+            {
+              munmap (compiled.mapping, compiled.mappingSize);
+            }
+        }
+    }
+  g_compiled.clear ();
+  g_nCompiled = 0;
+  g_nArtifactsLoaded = 0;
+  g_nReused = 0;
+}
+
+} // namespace ns3
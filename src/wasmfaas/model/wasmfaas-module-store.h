@@ -0,0 +1,140 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef WASMFAAS_MODULE_STORE_H
+#define WASMFAAS_MODULE_STORE_H
+
+#include <stdint.h>
+#include <string>
+
+namespace ns3 {
+
+/**
+ * \ingroup customapp
+ *
+ * \brief Process-wide store of compiled modules, shared by every CustomApp.
+ *
+ * Sharing is enabled by the WasmModuleSharedCompile global value and needs
+ * a runtime providing compile_module and register_compiled_module, see
+ * libwasmfaas-ext.h; registering a module aborts otherwise. When disabled,
+ * the default, every registration compiles the module again with
+ * register_module.
+ *
+ * Modules are keyed by a hash of their content. The first registration of a
+ * module compiles it with compile_module, later registrations of the same
+ * content on any node reference the compiled module by its handle, so a
+ * module held by many simulated nodes is compiled and stored once. Each node
+ * keeps its own runtime and instances.
+ *
+ * When sharing is enabled, compiled modules can also be kept on disk, to be
+ * reused by later and concurrent simulation processes, by setting the
+ * WasmModuleArtifactDirectory global value to a directory, e.g. with
+ * --WasmModuleArtifactDirectory=/tmp/wasmfaas-artifacts. Artifacts are
+ * named after the module hash, size and runtime version, memory mapped when
+ * loaded and written to a temporary file renamed into place, so processes
+ * never see a partial artifact. A 24 byte little endian header precedes the
+ * runtime artifact: the magic "WFMA", the header version (uint32), the full
+ * hash (uint64) and the size (uint64) of the module data; artifacts whose
+ * header does not match the module are compiled again. The mappings are
+ * kept until Clear.
+ */
+class WasmModuleStore
+{
+public:
+  /**
+   * \brief Register a module in a runtime, compiling it only if no node did before.
+   * \param runtimeId the runtime of the node
+   * \param moduleName the module name
+   * \param moduleData the module data in base64
+   * \return false if the module could not be compiled or registered
+   */
+  static bool Register (uint64_t runtimeId, const std::string &moduleName,
+                        const std::string &moduleData);
+
+  /**
+   * \param moduleData module data
+   * \return the 64 bit FNV-1a hash of moduleData
+   */
+  static uint64_t GetHash (const std::string &moduleData);
+
+  /**
+   * \return the number of distinct modules compiled or loaded from artifacts so far
+   */
+  static uint32_t GetNCompiled (void);
+
+  /**
+   * \return the number of registrations that reused a compiled module
+   */
+  static uint64_t GetNReused (void);
+
+  /**
+   * \return the number of modules loaded from precompiled artifacts
+   */
+  static uint32_t GetNArtifactsLoaded (void);
+
+  /**
+   * \brief Forget the compiled modules and reset the counters.
+   *
+   * The compiled modules are released with release_compiled_module when
+   * the runtime provides it. The next registration of each module compiles
+   * it, or loads its artifact, again. Runtimes keep the modules already
+   * registered in them.
+   */
+  static void Clear (void);
+
+private:
+  friend class WasmModuleStoreTestCase;
+
+  /**
+   * \brief Compile a module, or find it compiled already.
+   * \param moduleData the module data in base64
+   * \param hash the hash of moduleData, see GetHash
+   * \return the compiled module handle, 0 on failure
+   */
+  static uint64_t GetHandle (const std::string &moduleData, uint64_t hash);
+
+  /**
+   * \param moduleData the module data in base64
+   * \return the path of the artifact of moduleData, empty if artifacts are disabled
+   */
+  static std::string GetArtifactPath (const std::string &moduleData);
+
+  /**
+   * \brief Map an artifact and load the module it holds.
+   * \param path the artifact path
+   * \param moduleData the module data in base64 the artifact must be compiled from
+   * \param hash the hash of moduleData, see GetHash
+   * \param mapping set to the artifact mapping, to unmap once the module is released
+   * \param mappingSize set to the size of the artifact mapping
+   * \return the compiled module handle, 0 if there is no usable artifact
+   */
+  static uint64_t LoadArtifact (const std::string &path, const std::string &moduleData,
+                                uint64_t hash, void *&mapping, uint64_t &mappingSize);
+
+  /**
+   * \brief Write the artifact of a compiled module.
+   * \param path the artifact path
+   * \param handle the compiled module handle
+   * \param moduleData the module data in base64 the module was compiled from
+   * \param hash the hash of moduleData, see GetHash
+   */
+  static void SaveArtifact (const std::string &path, uint64_t handle,
+                            const std::string &moduleData, uint64_t hash);
+};
+
+} // namespace ns3
+
+#endif /* WASMFAAS_MODULE_STORE_H */
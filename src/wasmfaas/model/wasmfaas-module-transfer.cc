@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+
+#include "ns3/assert.h"
+#include "wasmfaas-module-transfer.h"
+
+namespace ns3 {
+
+WasmFaasChunkSender::WasmFaasChunkSender ()
+  : m_chunkSize (1), m_baseSeq (0), m_nextSeq (0), m_nAcked (0)
+{
+}
+
+void
+WasmFaasChunkSender::Start (std::string data, uint32_t chunkSize)
+{
+  NS_ASSERT (chunkSize > 0);
+  m_data = std::move (data);
+  m_chunkSize = chunkSize;
+  m_baseSeq = 0;
+  m_nextSeq = 0;
+  m_nAcked = 0;
+  m_acked.assign (std::max<size_t> (1, (m_data.size () + chunkSize - 1) / chunkSize), false);
+}
+
+bool
+WasmFaasChunkSender::NextChunk (uint32_t window, uint32_t &seq)
+{
+  if (m_nextSeq >= m_acked.size () || m_nextSeq - m_baseSeq >= window)
+    {
+      return false;
+    }
+  seq = m_nextSeq++;
+  return true;
+}
+
+std::vector<uint32_t>
+WasmFaasChunkSender::GetUnacknowledged (void) const
+{
+  std::vector<uint32_t> seqs;
+  for (uint32_t seq = m_baseSeq; seq < m_nextSeq; seq++)
+    {
+      if (!m_acked[seq])
+        {
+          seqs.push_back (seq);
+        }
+    }
+  return seqs;
+}
+
+bool
+WasmFaasChunkSender::Acknowledge (uint32_t seq)
+{
+  if (seq >= m_acked.size () || m_acked[seq])
+    {
+      return false;
+    }
+  m_acked[seq] = true;
+  m_nAcked++;
+  while (m_baseSeq < m_acked.size () && m_acked[m_baseSeq])
+    {
+      m_baseSeq++;
+    }
+  return true;
+}
+
+bool
+WasmFaasChunkSender::IsComplete (void) const
+{
+  return m_nAcked == m_acked.size ();
+}
+
+const uint8_t *
+WasmFaasChunkSender::GetChunk (uint32_t seq, WasmFaasChunkHeader &chunk, uint32_t &size) const
+{
+  chunk.SetChunkSize (m_chunkSize);
+  chunk.SetModuleSize (m_data.size ());
+  chunk.SetSeq (seq);
+  auto offset = std::min ((size_t) seq * m_chunkSize, m_data.size ());
+  size = std::min ((size_t) m_chunkSize, m_data.size () - offset);
+  return (const uint8_t *) m_data.data () + offset;
+}
+
+uint32_t
+WasmFaasChunkSender::GetSize (void) const
+{
+  return m_data.size ();
+}
+
+uint32_t
+WasmFaasChunkSender::GetNChunks (void) const
+{
+  return m_acked.size ();
+}
+
+uint32_t
+WasmFaasChunkSender::GetNAcknowledged (void) const
+{
+  return m_nAcked;
+}
+
+WasmFaasChunkReceiver::WasmFaasChunkReceiver () : m_nReceived (0), m_started (false)
+{
+}
+
+bool
+WasmFaasChunkReceiver::IsValid (const WasmFaasChunkHeader &chunk, uint32_t maxSize)
+{
+  // The sizes come from the wire, only a module without bytes has no chunk beyond seq 0
+  return chunk.GetChunkSize () != 0 && chunk.GetModuleSize () <= maxSize &&
+         chunk.GetSeq () < std::max (chunk.GetCount (), 1u);
+}
+
+bool
+WasmFaasChunkReceiver::Receive (const WasmFaasChunkHeader &chunk, const std::string &data)
+{
+  auto count = chunk.GetCount ();
+  if (!m_started || m_received.size () != count || m_data.size () != chunk.GetModuleSize ())
+    {
+      m_data.assign (chunk.GetModuleSize (), '\0');
+      m_received.assign (count, false);
+      m_nReceived = 0;
+      m_started = true;
+    }
+
+  auto seq = chunk.GetSeq ();
+  uint64_t offset = (uint64_t) seq * chunk.GetChunkSize ();
+  if (seq >= count || m_received[seq] || offset + data.size () > m_data.size ())
+    {
+      return false;
+    }
+  m_data.replace (offset, data.size (), data);
+  m_received[seq] = true;
+  m_nReceived++;
+  return true;
+}
+
+bool
+WasmFaasChunkReceiver::IsComplete (void) const
+{
+  return m_started && m_nReceived == m_received.size ();
+}
+
+const std::string &
+WasmFaasChunkReceiver::GetData (void) const
+{
+  return m_data;
+}
+
+uint32_t
+WasmFaasChunkReceiver::GetNReceived (void) const
+{
+  return m_nReceived;
+}
+
+void
+WasmFaasChunkReceiver::Clear (void)
+{
+  m_data.clear ();
+  m_data.shrink_to_fit ();
+  m_received.clear ();
+  m_nReceived = 0;
+  m_started = false;
+}
+
+} // namespace ns3
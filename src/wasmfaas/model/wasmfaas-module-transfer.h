@@ -0,0 +1,163 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef WASMFAAS_MODULE_TRANSFER_H
+#define WASMFAAS_MODULE_TRANSFER_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "wasmfaas-chunk-header.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup customapp
+ *
+ * \brief Sending side of a chunked module transfer, see the CustomApp
+ * ChunkedModuleTransfer attribute.
+ *
+ * Chunks are sent in order through a sliding window that starts at the
+ * first unacknowledged chunk, so chunks acknowledged past a lost one do
+ * not open the window. A module without bytes still takes one empty chunk.
+ * The caller sends the chunks and schedules the retransmissions.
+ */
+class WasmFaasChunkSender
+{
+public:
+  WasmFaasChunkSender ();
+
+  /**
+   * \brief Start a transfer, forgetting any earlier one.
+   * \param data the raw module bytes
+   * \param chunkSize the module bytes per chunk, not 0
+   */
+  void Start (std::string data, uint32_t chunkSize);
+
+  /**
+   * \brief Take the next chunk to send if it fits in the window.
+   * \param window the number of unacknowledged chunks allowed in flight
+   * \param seq set to the chunk sequence number
+   * \return false if every chunk was sent or the window is full
+   */
+  bool NextChunk (uint32_t window, uint32_t &seq);
+
+  /**
+   * \return the chunks sent but not acknowledged, in order
+   */
+  std::vector<uint32_t> GetUnacknowledged (void) const;
+
+  /**
+   * \param seq a chunk sequence number
+   * \return true if the chunk was not acknowledged before
+   */
+  bool Acknowledge (uint32_t seq);
+
+  /**
+   * \return true once every chunk is acknowledged
+   */
+  bool IsComplete (void) const;
+
+  /**
+   * \param seq a chunk sequence number
+   * \param chunk filled with the chunk position of the chunk
+   * \param size set to the chunk size, in bytes
+   * \return the chunk bytes
+   */
+  const uint8_t *GetChunk (uint32_t seq, WasmFaasChunkHeader &chunk, uint32_t &size) const;
+
+  /**
+   * \return the module size, in bytes
+   */
+  uint32_t GetSize (void) const;
+  /**
+   * \return the number of chunks of the module
+   */
+  uint32_t GetNChunks (void) const;
+  /**
+   * \return the number of chunks acknowledged
+   */
+  uint32_t GetNAcknowledged (void) const;
+
+private:
+  std::string m_data; //!< Raw module bytes
+  uint32_t m_chunkSize; //!< Module bytes per chunk
+  uint32_t m_baseSeq; //!< First unacknowledged chunk, the window starts there
+  uint32_t m_nextSeq; //!< Next chunk to send
+  uint32_t m_nAcked; //!< Number of acknowledged chunks
+  std::vector<bool> m_acked; //!< Acknowledged chunks, one entry per chunk
+};
+
+/**
+ * \ingroup customapp
+ *
+ * \brief Receiving side of a chunked module transfer, reassembles the
+ * module from chunks arriving in any order.
+ *
+ * A chunk announcing another module size or chunk count restarts the
+ * reassembly, the sender restarted the transfer.
+ */
+class WasmFaasChunkReceiver
+{
+public:
+  WasmFaasChunkReceiver ();
+
+  /**
+   * \param chunk the chunk position
+   * \param maxSize the largest module accepted, in bytes
+   * \return false if the sizes of chunk are inconsistent or exceed maxSize
+   */
+  static bool IsValid (const WasmFaasChunkHeader &chunk, uint32_t maxSize);
+
+  /**
+   * \brief Store a chunk checked by IsValid.
+   * \param chunk the chunk position
+   * \param data the chunk bytes
+   * \return true if the chunk was not received before
+   */
+  bool Receive (const WasmFaasChunkHeader &chunk, const std::string &data);
+
+  /**
+   * \return true once every chunk of the module was received
+   */
+  bool IsComplete (void) const;
+
+  /**
+   * \return the module bytes reassembled so far
+   */
+  const std::string &GetData (void) const;
+
+  /**
+   * \return the number of chunks received
+   */
+  uint32_t GetNReceived (void) const;
+
+  /**
+   * \brief Forget the module and release its storage.
+   */
+  void Clear (void);
+
+private:
+  std::string m_data; //!< Module bytes reassembled so far
+  std::vector<bool> m_received; //!< Chunks of m_data received so far
+  uint32_t m_nReceived; //!< Number of set entries of m_received
+  bool m_started; //!< True once a chunk was received
+};
+
+} // namespace ns3
+
+#endif /* WASMFAAS_MODULE_TRANSFER_H */
@@ -0,0 +1,92 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "wasmfaas-request-tag.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("WasmFaasRequestTag");
+
+NS_OBJECT_ENSURE_REGISTERED (WasmFaasRequestTag);
+
+WasmFaasRequestTag::WasmFaasRequestTag () : m_requestId (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+WasmFaasRequestTag::WasmFaasRequestTag (uint64_t requestId) : m_requestId (requestId)
+{
+  NS_LOG_FUNCTION (this << requestId);
+}
+
+void
+WasmFaasRequestTag::SetRequestId (uint64_t requestId)
+{
+  NS_LOG_FUNCTION (this << requestId);
+  m_requestId = requestId;
+}
+
+uint64_t
+WasmFaasRequestTag::GetRequestId (void) const
+{
+  return m_requestId;
+}
+
+TypeId
+WasmFaasRequestTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::WasmFaasRequestTag")
+                          .SetParent<Tag> ()
+                          .SetGroupName ("Applications")
+                          .AddConstructor<WasmFaasRequestTag> ();
+  return tid;
+}
+
+TypeId
+WasmFaasRequestTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+WasmFaasRequestTag::GetSerializedSize (void) const
+{
+  return 8;
+}
+
+void
+WasmFaasRequestTag::Serialize (TagBuffer i) const
+{
+  NS_LOG_FUNCTION (this << &i);
+  i.WriteU64 (m_requestId);
+}
+
+void
+WasmFaasRequestTag::Deserialize (TagBuffer i)
+{
+  NS_LOG_FUNCTION (this << &i);
+  m_requestId = i.ReadU64 ();
+}
+
+void
+WasmFaasRequestTag::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "requestId=" << m_requestId;
+}
+
+} // namespace ns3
@@ -0,0 +1,72 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef WASMFAAS_REQUEST_TAG_H
+#define WASMFAAS_REQUEST_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup customapp
+ *
+ * \brief Request ID of a message of the legacy text protocol.
+ *
+ * The text protocol keeps the layout of the original ';' delimited
+ * messages, which have no request ID. CustomApp peers carry it out of band
+ * in this packet tag, so the bytes on the wire stay those of the legacy
+ * protocol. A message without the tag belongs to no request, as request
+ * ID 0 does.
+ */
+class WasmFaasRequestTag : public Tag
+{
+public:
+  WasmFaasRequestTag ();
+
+  /**
+   * \param requestId the request ID
+   */
+  explicit WasmFaasRequestTag (uint64_t requestId);
+
+  /**
+   * \param requestId the request ID
+   */
+  void SetRequestId (uint64_t requestId);
+  /**
+   * \return the request ID
+   */
+  uint64_t GetRequestId (void) const;
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+private:
+  uint64_t m_requestId; //!< Request ID
+};
+
+} // namespace ns3
+
+#endif /* WASMFAAS_REQUEST_TAG_H */
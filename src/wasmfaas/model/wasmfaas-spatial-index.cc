@@ -0,0 +1,148 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <queue>
+
+#include "wasmfaas-spatial-index.h"
+
+namespace ns3 {
+
+const uint32_t WasmFaasSpatialIndex::NONE;
+
+WasmFaasSpatialIndex::WasmFaasSpatialIndex ()
+{
+}
+
+double
+WasmFaasSpatialIndex::GetCoordinate (const Vector &point, uint8_t axis)
+{
+  return axis == 0 ? point.x : axis == 1 ? point.y : point.z;
+}
+
+void
+WasmFaasSpatialIndex::Build (const std::vector<Vector> &points)
+{
+  m_points = points;
+  m_order.resize (points.size ());
+  for (uint32_t i = 0; i < m_order.size (); i++)
+    {
+      m_order[i] = i;
+    }
+  BuildRange (0, m_order.size (), 0);
+}
+
+void
+WasmFaasSpatialIndex::BuildRange (uint32_t lo, uint32_t hi, uint8_t axis)
+{
+  if (hi - lo < 2)
+    {
+      return;
+    }
+
+  // Partitioning around the median is linear, so each level of the tree costs O(N)
+  uint32_t mid = lo + (hi - lo) / 2;
+  std::nth_element (m_order.begin () + lo, m_order.begin () + mid, m_order.begin () + hi,
+                    [this, axis] (uint32_t a, uint32_t b) {
+                      return GetCoordinate (m_points[a], axis) < GetCoordinate (m_points[b], axis);
+                    });
+  BuildRange (lo, mid, (axis + 1) % 3);
+  BuildRange (mid + 1, hi, (axis + 1) % 3);
+}
+
+uint32_t
+WasmFaasSpatialIndex::GetN (void) const
+{
+  return m_points.size ();
+}
+
+std::vector<uint32_t>
+WasmFaasSpatialIndex::FindNearest (const Vector &position, uint32_t k, double maxDistance,
+                                   uint32_t skip) const
+{
+  std::vector<uint32_t> nearest;
+  if (k == 0 || m_points.empty ())
+    {
+      return nearest;
+    }
+
+  // Squared distance and index of the best points so far, the worst on top
+  std::priority_queue<std::pair<double, uint32_t>> best;
+  double bound = maxDistance > 0 ? maxDistance * maxDistance : -1;
+
+  struct Range
+  {
+    uint32_t lo;
+    uint32_t hi;
+    uint8_t axis;
+    double planeDistance; //!< Squared distance to the plane bounding the range
+  };
+  std::vector<Range> stack;
+  stack.push_back ({0, static_cast<uint32_t> (m_order.size ()), 0, 0});
+  while (!stack.empty ())
+    {
+      auto range = stack.back ();
+      stack.pop_back ();
+      // The bound may have shrunk since the range was pushed
+      if (range.lo >= range.hi || (bound >= 0 && range.planeDistance > bound))
+        {
+          continue;
+        }
+
+      uint32_t mid = range.lo + (range.hi - range.lo) / 2;
+      uint32_t point = m_order[mid];
+      const Vector &p = m_points[point];
+      double dx = p.x - position.x;
+      double dy = p.y - position.y;
+      double dz = p.z - position.z;
+      double d2 = dx * dx + dy * dy + dz * dz;
+      if (point != skip && (bound < 0 || d2 <= bound))
+        {
+          best.push (std::make_pair (d2, point));
+          if (best.size () > k)
+            {
+              best.pop ();
+            }
+          if (best.size () == k)
+            {
+              bound = best.top ().first;
+            }
+        }
+
+      double delta = GetCoordinate (position, range.axis) - GetCoordinate (p, range.axis);
+      uint8_t next = (range.axis + 1) % 3;
+      // The far side can only hold better points if the splitting plane is within the bound
+      Range nearSide = {mid + 1, range.hi, next, range.planeDistance};
+      Range farSide = {range.lo, mid, next, std::max (range.planeDistance, delta * delta)};
+      if (delta < 0)
+        {
+          std::swap (nearSide.lo, farSide.lo);
+          std::swap (nearSide.hi, farSide.hi);
+        }
+      stack.push_back (farSide);
+      stack.push_back (nearSide);
+    }
+
+  nearest.resize (best.size ());
+  for (auto i = nearest.size (); i > 0; i--)
+    {
+      nearest[i - 1] = best.top ().second;
+      best.pop ();
+    }
+  return nearest;
+}
+
+} // namespace ns3
@@ -0,0 +1,88 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef WASMFAAS_SPATIAL_INDEX_H
+#define WASMFAAS_SPATIAL_INDEX_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "ns3/vector.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup customapp
+ *
+ * \brief k-d tree over a fixed set of positions, used by CustomAppHelper
+ * to find the nearest peers of each node.
+ *
+ * The tree is stored implicitly in a permutation of the point indices:
+ * each range holds its median at its middle, the points below it on the
+ * splitting axis before and the others after. Building takes O(N log N)
+ * and a k nearest query about O(log N + k).
+ */
+class WasmFaasSpatialIndex
+{
+public:
+  WasmFaasSpatialIndex ();
+
+  /**
+   * \param points the positions to index, replacing any indexed before
+   */
+  void Build (const std::vector<Vector> &points);
+
+  /**
+   * \return the number of indexed positions
+   */
+  uint32_t GetN (void) const;
+
+  /**
+   * \param position where to search from
+   * \param k the number of points wanted
+   * \param maxDistance only points within it are returned, 0 for no limit
+   * \param skip index of a point to leave out, such as the one at position
+   * \return the indices of up to k nearest points, nearest first
+   */
+  std::vector<uint32_t> FindNearest (const Vector &position, uint32_t k, double maxDistance = 0,
+                                     uint32_t skip = NONE) const;
+
+  /// Value of skip leaving no point out
+  static const uint32_t NONE = 0xffffffff;
+
+private:
+  /**
+   * \brief Order m_order[lo, hi) as a subtree splitting on axis.
+   * \param lo first index of the range
+   * \param hi end of the range
+   * \param axis the coordinate split on, 0 to 2
+   */
+  void BuildRange (uint32_t lo, uint32_t hi, uint8_t axis);
+
+  /**
+   * \param point a position
+   * \param axis the coordinate, 0 to 2
+   * \return the coordinate of point
+   */
+  static double GetCoordinate (const Vector &point, uint8_t axis);
+
+  std::vector<Vector> m_points; //!< Indexed positions
+  std::vector<uint32_t> m_order; //!< Point indices in tree order
+};
+
+} // namespace ns3
+
+#endif /* WASMFAAS_SPATIAL_INDEX_H */
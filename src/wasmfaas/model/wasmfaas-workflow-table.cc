@@ -0,0 +1,188 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "wasmfaas-workflow-table.h"
+
+namespace ns3 {
+
+WasmFaasWorkflowTable::Entry &
+WasmFaasWorkflowTable::Hold (uint64_t workflowId, const WasmFaasWorkflow &workflow,
+                             const Address &origin, uint8_t priority, uint8_t hopCount)
+{
+  auto held = m_entries.find (workflowId);
+  if (held != m_entries.end ())
+    {
+      held->second.timeoutEvent.Cancel ();
+      m_tasks.erase (held->second.taskId);
+    }
+
+  auto &entry = m_entries[workflowId];
+  entry.workflow = workflow;
+  entry.origin = origin;
+  entry.priority = priority;
+  entry.hopCount = hopCount;
+  entry.taskId = 0;
+  entry.isHandingOver = false;
+  entry.nRetries = 0;
+  entry.hasResult = false;
+  return entry;
+}
+
+WasmFaasWorkflowTable::Entry *
+WasmFaasWorkflowTable::Find (uint64_t workflowId)
+{
+  auto it = m_entries.find (workflowId);
+  return it == m_entries.end () ? nullptr : &it->second;
+}
+
+void
+WasmFaasWorkflowTable::SetTask (uint64_t workflowId, uint64_t taskId, bool isHandOver,
+                                const Address &peer)
+{
+  auto &entry = m_entries[workflowId];
+  entry.taskId = taskId;
+  entry.isHandingOver = isHandOver;
+  if (isHandOver)
+    {
+      entry.handOverPeer = peer;
+      entry.nRetries = 0;
+    }
+  m_tasks[taskId] = workflowId;
+}
+
+bool
+WasmFaasWorkflowTable::TakeTask (uint64_t taskId, uint64_t &workflowId)
+{
+  auto task = m_tasks.find (taskId);
+  if (task == m_tasks.end ())
+    {
+      return false;
+    }
+  workflowId = task->second;
+  m_tasks.erase (task);
+  return true;
+}
+
+void
+WasmFaasWorkflowTable::ForgetTask (uint64_t taskId)
+{
+  m_tasks.erase (taskId);
+}
+
+bool
+WasmFaasWorkflowTable::AcknowledgeHandOver (uint64_t taskId)
+{
+  auto task = m_tasks.find (taskId);
+  if (task == m_tasks.end ())
+    {
+      return false;
+    }
+  auto entry = m_entries.find (task->second);
+  if (entry == m_entries.end () || !entry->second.isHandingOver ||
+      entry->second.taskId != taskId)
+    {
+      return false;
+    }
+  entry->second.timeoutEvent.Cancel ();
+  m_entries.erase (entry);
+  m_tasks.erase (task);
+  return true;
+}
+
+void
+WasmFaasWorkflowTable::Release (uint64_t workflowId)
+{
+  auto it = m_entries.find (workflowId);
+  if (it != m_entries.end ())
+    {
+      it->second.timeoutEvent.Cancel ();
+      m_entries.erase (it);
+    }
+}
+
+void
+WasmFaasWorkflowTable::SetDeadline (uint64_t workflowId, EventId event)
+{
+  m_deadlines[workflowId] = event;
+}
+
+void
+WasmFaasWorkflowTable::CancelDeadline (uint64_t workflowId)
+{
+  auto deadline = m_deadlines.find (workflowId);
+  if (deadline != m_deadlines.end ())
+    {
+      deadline->second.Cancel ();
+      m_deadlines.erase (deadline);
+    }
+}
+
+void
+WasmFaasWorkflowTable::Clear (void)
+{
+  for (auto &entry : m_entries)
+    {
+      entry.second.timeoutEvent.Cancel ();
+    }
+  for (auto &entry : m_deadlines)
+    {
+      entry.second.Cancel ();
+    }
+  m_entries.clear ();
+  m_tasks.clear ();
+  m_deadlines.clear ();
+}
+
+void
+WasmFaasWorkflowTable::SerializeHandOver (uint64_t workflowId, const InetSocketAddress &origin,
+                                          const WasmFaasWorkflow &workflow, std::string &payload)
+{
+  payload.clear ();
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      payload += static_cast<char> ((workflowId >> (8 * i)) & 0xff);
+    }
+  uint8_t address[4];
+  origin.GetIpv4 ().Serialize (address);
+  payload.append (reinterpret_cast<const char *> (address), sizeof (address));
+  payload += static_cast<char> (origin.GetPort () & 0xff);
+  payload += static_cast<char> (origin.GetPort () >> 8);
+
+  std::string stages;
+  workflow.Serialize (stages);
+  payload += stages;
+}
+
+bool
+WasmFaasWorkflowTable::DeserializeHandOver (const std::string &payload, uint64_t &workflowId,
+                                            InetSocketAddress &origin, WasmFaasWorkflow &workflow)
+{
+  if (payload.size () < 14 || !workflow.Deserialize (payload.substr (14)))
+    {
+      return false;
+    }
+  workflowId = 0;
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      workflowId |= static_cast<uint64_t> (static_cast<uint8_t> (payload[i])) << (8 * i);
+    }
+  origin = InetSocketAddress (
+      Ipv4Address::Deserialize (reinterpret_cast<const uint8_t *> (&payload[8])),
+      static_cast<uint8_t> (payload[12]) | static_cast<uint8_t> (payload[13]) << 8);
+  return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,166 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef WASMFAAS_WORKFLOW_TABLE_H
+#define WASMFAAS_WORKFLOW_TABLE_H
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+
+#include "ns3/address.h"
+#include "ns3/event-id.h"
+#include "ns3/inet-socket-address.h"
+#include "wasmfaas-header.h"
+#include "wasmfaas-workflow.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup customapp
+ *
+ * \brief Workflows held by a CustomApp, see CustomApp::ExecuteWorkflow.
+ *
+ * A held workflow waits for one task at a time: a stage running here or
+ * on a peer, or its hand-over to a peer, which carries the workflow or
+ * its result. Tasks are known by their request ID, so the result or ack
+ * of a task finds its workflow. The table also keeps the deadlines of the
+ * workflows started on the node.
+ *
+ * On the wire a hand-over is the workflow ID (8), the origin address (4)
+ * and port (2), little endian, followed by the serialized workflow.
+ */
+class WasmFaasWorkflowTable
+{
+public:
+  /// Workflow held by the node
+  struct Entry
+  {
+    WasmFaasWorkflow workflow; //!< The workflow, with the results of the stages run so far
+    Address origin; //!< Node waiting for the result
+    uint8_t priority; //!< Priority of every stage
+    uint8_t hopCount; //!< Times the workflow was handed over before reaching us
+    uint64_t taskId; //!< Request ID of the running stage or of the hand-over
+    bool isHandingOver; //!< True until the peer the workflow went to acknowledges it
+    Address handOverPeer; //!< Peer the workflow went to while isHandingOver is set
+    uint32_t nRetries; //!< Times the hand-over was sent again
+    EventId timeoutEvent; //!< Expiry of the hand-over
+    bool hasResult; //!< True once the result is handed over to the origin instead
+    WasmFaasResult result; //!< Workflow result while hasResult is set
+  };
+
+  /**
+   * \brief Hold a workflow, superseding a hand-over of it still in progress.
+   * \param workflowId the workflow ID
+   * \param workflow the workflow
+   * \param origin the node waiting for the result
+   * \param priority the priority of every stage
+   * \param hopCount the times the workflow was handed over before reaching us
+   * \return the entry of the workflow, waiting for no task
+   */
+  Entry &Hold (uint64_t workflowId, const WasmFaasWorkflow &workflow, const Address &origin,
+               uint8_t priority, uint8_t hopCount);
+
+  /**
+   * \param workflowId a workflow ID
+   * \return the entry of the workflow, null if it is not held
+   */
+  Entry *Find (uint64_t workflowId);
+
+  /**
+   * \brief Make a held workflow wait for a task.
+   * \param workflowId the workflow ID
+   * \param taskId the request ID of the task
+   * \param isHandOver true if the task is a hand-over
+   * \param peer the peer of the hand-over
+   */
+  void SetTask (uint64_t workflowId, uint64_t taskId, bool isHandOver,
+                const Address &peer = Address ());
+
+  /**
+   * \brief Find and forget the workflow waiting for a task.
+   * \param taskId the request ID of the task
+   * \param workflowId set to the workflow ID
+   * \return false if no workflow waits for the task
+   */
+  bool TakeTask (uint64_t taskId, uint64_t &workflowId);
+
+  /**
+   * \param taskId the request ID of a task no workflow waits for any longer
+   */
+  void ForgetTask (uint64_t taskId);
+
+  /**
+   * \brief Drop a workflow whose hand-over the peer acknowledged.
+   * \param taskId the request ID of the acknowledged message
+   * \return true if the message was a hand-over in progress
+   */
+  bool AcknowledgeHandOver (uint64_t taskId);
+
+  /**
+   * \brief Stop holding a workflow. Its tasks stay known, so a stage still
+   * running finds no workflow to go on with.
+   * \param workflowId the workflow ID
+   */
+  void Release (uint64_t workflowId);
+
+  /**
+   * \param workflowId a workflow started on the node
+   * \param event the timeout of the workflow
+   */
+  void SetDeadline (uint64_t workflowId, EventId event);
+
+  /**
+   * \param workflowId a workflow started on the node
+   */
+  void CancelDeadline (uint64_t workflowId);
+
+  /**
+   * \brief Cancel every timeout and forget every workflow.
+   */
+  void Clear (void);
+
+  /**
+   * \brief Build the payload of a WORKFLOW message.
+   * \param workflowId the workflow ID
+   * \param origin the node waiting for the result
+   * \param workflow the workflow
+   * \param payload filled with the payload. Passing the same string every
+   *        time reuses its storage.
+   */
+  static void SerializeHandOver (uint64_t workflowId, const InetSocketAddress &origin,
+                                 const WasmFaasWorkflow &workflow, std::string &payload);
+
+  /**
+   * \brief Read the payload of a WORKFLOW message.
+   * \param payload the payload
+   * \param workflowId set to the workflow ID
+   * \param origin set to the node waiting for the result
+   * \param workflow filled with the workflow
+   * \return false if the payload is malformed
+   */
+  static bool DeserializeHandOver (const std::string &payload, uint64_t &workflowId,
+                                   InetSocketAddress &origin, WasmFaasWorkflow &workflow);
+
+private:
+  std::unordered_map<uint64_t, Entry> m_entries; //!< Workflows held, by workflow ID
+  std::unordered_map<uint64_t, uint64_t> m_tasks; //!< Workflow IDs by task request ID
+  std::unordered_map<uint64_t, EventId> m_deadlines; //!< Timeouts by workflow ID
+};
+
+} // namespace ns3
+
+#endif /* WASMFAAS_WORKFLOW_TABLE_H */
@@ -0,0 +1,296 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/assert.h"
+#include "wasmfaas-workflow.h"
+
+namespace ns3 {
+
+/**
+ * \param data the wire form being built
+ * \param v the value to append, little endian
+ * \param size the number of bytes to append
+ */
+static void
+AppendBytes (std::string &data, uint64_t v, uint32_t size)
+{
+  for (uint32_t i = 0; i < size; i++)
+    {
+      data += static_cast<char> ((v >> (8 * i)) & 0xff);
+    }
+}
+
+/**
+ * \param data the wire form being read
+ * \param pos the read position, moved past the bytes read
+ * \param size the number of bytes to read
+ * \param v filled with the value read, little endian
+ * \return false if data is too short
+ */
+static bool
+ReadBytes (const std::string &data, std::size_t &pos, uint32_t size, uint64_t &v)
+{
+  if (pos + size > data.size ())
+    {
+      return false;
+    }
+  v = 0;
+  for (uint32_t i = 0; i < size; i++)
+    {
+      v |= static_cast<uint64_t> (static_cast<uint8_t> (data[pos + i])) << (8 * i);
+    }
+  pos += size;
+  return true;
+}
+
+/**
+ * \param data the wire form being built
+ * \param value the value to append, its type offset by MAX_STAGES
+ */
+static void
+AppendValue (std::string &data, const WasmFaasValue &value)
+{
+  AppendBytes (data, WasmFaasWorkflow::MAX_STAGES + static_cast<uint8_t> (value.type), 1);
+  AppendBytes (data, value.lo, 8);
+  if (value.type == ArgType::V128)
+    {
+      AppendBytes (data, value.hi, 8);
+    }
+}
+
+/**
+ * \param data the wire form being read
+ * \param pos the read position, just past the type byte
+ * \param type the type byte, offset by MAX_STAGES
+ * \param value filled with the value read
+ * \return false if data is too short or the type is unknown
+ */
+static bool
+ReadValue (const std::string &data, std::size_t &pos, uint64_t type, WasmFaasValue &value)
+{
+  if (type < WasmFaasWorkflow::MAX_STAGES ||
+      type > WasmFaasWorkflow::MAX_STAGES + static_cast<uint8_t> (ArgType::V128))
+    {
+      return false;
+    }
+  value.type = static_cast<ArgType> (type - WasmFaasWorkflow::MAX_STAGES);
+  value.hi = 0;
+  return ReadBytes (data, pos, 8, value.lo) &&
+         (value.type != ArgType::V128 || ReadBytes (data, pos, 8, value.hi));
+}
+
+WasmFaasWorkflow::Binding
+WasmFaasWorkflow::Binding::Value (const WasmFaasValue &value)
+{
+  return Binding{false, 0, value};
+}
+
+WasmFaasWorkflow::Binding
+WasmFaasWorkflow::Binding::StageResult (uint8_t stage)
+{
+  return Binding{true, stage, WasmFaasValue{ArgType::I32, 0, 0}};
+}
+
+WasmFaasWorkflow::WasmFaasWorkflow ()
+{
+}
+
+uint8_t
+WasmFaasWorkflow::AddStage (const std::string &moduleName, const std::string &funcName,
+                            const std::vector<Binding> &args)
+{
+  NS_ASSERT_MSG (m_stages.size () < MAX_STAGES,
+                 "A workflow has at most " << +MAX_STAGES << " stages");
+  NS_ASSERT_MSG (args.size () <= WasmFaasHeader::MAX_ARGS,
+                 "A function takes at most " << +WasmFaasHeader::MAX_ARGS << " arguments");
+  for (auto &arg : args)
+    {
+      NS_ASSERT_MSG (!arg.isStageResult || arg.stage < m_stages.size (),
+                     "A stage may only use the results of the stages added before it");
+    }
+
+  m_stages.push_back (Stage{moduleName, funcName, args});
+  return m_stages.size () - 1;
+}
+
+uint8_t
+WasmFaasWorkflow::GetNStages (void) const
+{
+  return m_stages.size ();
+}
+
+const WasmFaasWorkflow::Stage &
+WasmFaasWorkflow::GetStage (uint8_t stage) const
+{
+  return m_stages.at (stage);
+}
+
+uint8_t
+WasmFaasWorkflow::GetNextStage (void) const
+{
+  return m_results.size ();
+}
+
+bool
+WasmFaasWorkflow::IsComplete (void) const
+{
+  return m_results.size () == m_stages.size ();
+}
+
+std::vector<WasmFaasValue>
+WasmFaasWorkflow::GetNextArgs (void) const
+{
+  NS_ASSERT (!IsComplete ());
+  std::vector<WasmFaasValue> args;
+  for (auto &arg : m_stages[m_results.size ()].args)
+    {
+      args.push_back (arg.isStageResult ? m_results[arg.stage] : arg.value);
+    }
+  return args;
+}
+
+void
+WasmFaasWorkflow::SetNextResult (const WasmFaasValue &result)
+{
+  NS_ASSERT (!IsComplete ());
+  m_results.push_back (result);
+}
+
+WasmFaasValue
+WasmFaasWorkflow::GetResult (void) const
+{
+  NS_ASSERT (IsComplete () && !m_results.empty ());
+  return m_results.back ();
+}
+
+std::string
+WasmFaasWorkflow::GetName (void) const
+{
+  std::string name;
+  for (auto &stage : m_stages)
+    {
+      name += (name.empty () ? "" : ">") + stage.moduleName;
+    }
+  return name;
+}
+
+void
+WasmFaasWorkflow::Serialize (std::string &data) const
+{
+  data.clear ();
+  AppendBytes (data, m_stages.size (), 1);
+  AppendBytes (data, m_results.size (), 1);
+  for (auto &stage : m_stages)
+    {
+      AppendBytes (data, WasmFaasHeader::GetNameId (stage.moduleName), 4);
+      AppendBytes (data, WasmFaasHeader::GetNameId (stage.funcName), 4);
+      AppendBytes (data, stage.args.size (), 1);
+      for (auto &arg : stage.args)
+        {
+          if (arg.isStageResult)
+            {
+              AppendBytes (data, arg.stage, 1);
+            }
+          else
+            {
+              AppendValue (data, arg.value);
+            }
+        }
+    }
+  for (auto &result : m_results)
+    {
+      AppendValue (data, result);
+    }
+}
+
+bool
+WasmFaasWorkflow::Deserialize (const std::string &data)
+{
+  m_stages.clear ();
+  m_results.clear ();
+
+  // Kept aside until the whole workflow is read, a rejected one leaves the workflow empty
+  std::vector<Stage> stages;
+  std::vector<WasmFaasValue> results;
+  std::size_t pos = 0;
+  uint64_t nStages;
+  uint64_t nResults;
+  if (!ReadBytes (data, pos, 1, nStages) || !ReadBytes (data, pos, 1, nResults) ||
+      nStages > MAX_STAGES || nResults > nStages)
+    {
+      return false;
+    }
+
+  for (uint64_t i = 0; i < nStages; i++)
+    {
+      uint64_t moduleId;
+      uint64_t functionId;
+      uint64_t nArgs;
+      if (!ReadBytes (data, pos, 4, moduleId) || !ReadBytes (data, pos, 4, functionId) ||
+          !ReadBytes (data, pos, 1, nArgs) || nArgs > WasmFaasHeader::MAX_ARGS)
+        {
+          return false;
+        }
+
+      Stage stage;
+      stage.moduleName = WasmFaasHeader::GetIdName (moduleId);
+      stage.funcName = WasmFaasHeader::GetIdName (functionId);
+      for (uint64_t j = 0; j < nArgs; j++)
+        {
+          uint64_t kind;
+          if (!ReadBytes (data, pos, 1, kind))
+            {
+              return false;
+            }
+          if (kind < MAX_STAGES)
+            {
+              if (kind >= i)
+                {
+                  return false;
+                }
+              stage.args.push_back (Binding::StageResult (kind));
+              continue;
+            }
+          WasmFaasValue value;
+          if (!ReadValue (data, pos, kind, value))
+            {
+              return false;
+            }
+          stage.args.push_back (Binding::Value (value));
+        }
+      stages.push_back (stage);
+    }
+
+  for (uint64_t i = 0; i < nResults; i++)
+    {
+      uint64_t type;
+      WasmFaasValue value;
+      if (!ReadBytes (data, pos, 1, type) || !ReadValue (data, pos, type, value))
+        {
+          return false;
+        }
+      results.push_back (value);
+    }
+  if (pos != data.size ())
+    {
+      return false;
+    }
+  m_stages = stages;
+  m_results = results;
+  return true;
+}
+
+} // namespace ns3
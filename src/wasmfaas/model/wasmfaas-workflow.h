@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef WASMFAAS_WORKFLOW_H
+#define WASMFAAS_WORKFLOW_H
+
+#include <string>
+#include <vector>
+
+#include "wasmfaas-header.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup customapp
+ *
+ * \brief DAG of functions run by CustomApp::ExecuteWorkflow, the results of
+ * earlier stages feeding the arguments of later ones.
+ *
+ * Stages are added in an order compatible with the DAG, each argument
+ * being a value or the result of an earlier stage, and run in that order.
+ * The result of the workflow is the result of its last stage. For example
+ * (a + b) / c is
+ *
+ * \code
+ *   WasmFaasWorkflow workflow;
+ *   auto s = workflow.AddStage ("sum", "sum", {WasmFaasWorkflow::Binding::Value (a),
+ *                                              WasmFaasWorkflow::Binding::Value (b)});
+ *   workflow.AddStage ("div", "div", {WasmFaasWorkflow::Binding::StageResult (s),
+ *                                     WasmFaasWorkflow::Binding::Value (c)});
+ * \endcode
+ *
+ * The workflow travels between nodes with the results of the stages run so
+ * far. On the wire it is its stage count (1) and the number of stages run
+ * (1), then for each stage its module ID (4), function ID (4), argument
+ * count (1) and arguments, and then the results of the stages run. An
+ * argument is a stage index (1) below MAX_STAGES, or a value: its ArgType
+ * plus MAX_STAGES (1) and its value (8, or 16 for V128). Results are
+ * encoded as values.
+ */
+class WasmFaasWorkflow
+{
+public:
+  /// Maximum number of stages of a workflow
+  static constexpr uint8_t MAX_STAGES = 16;
+
+  /// Argument of a stage
+  struct Binding
+  {
+    bool isStageResult; //!< True if the argument is the result of an earlier stage
+    uint8_t stage; //!< The earlier stage when isStageResult is set
+    WasmFaasValue value; //!< The argument otherwise
+
+    /**
+     * \param value the argument
+     * \return a binding to the value
+     */
+    static Binding Value (const WasmFaasValue &value);
+    /**
+     * \param stage an earlier stage, as returned by AddStage
+     * \return a binding to the result of the stage
+     */
+    static Binding StageResult (uint8_t stage);
+  };
+
+  /// Function of the workflow
+  struct Stage
+  {
+    std::string moduleName; //!< Module holding the function
+    std::string funcName; //!< Function to run
+    std::vector<Binding> args; //!< Function arguments
+  };
+
+  WasmFaasWorkflow ();
+
+  /**
+   * \brief Append a stage, to run after the stages added before it.
+   * \param moduleName the module holding the function
+   * \param funcName the function to run
+   * \param args the function arguments, at most WasmFaasHeader::MAX_ARGS,
+   *        bound to values or to the results of stages added before
+   * \return the stage index, used to bind the stage result
+   */
+  uint8_t AddStage (const std::string &moduleName, const std::string &funcName,
+                    const std::vector<Binding> &args);
+
+  /**
+   * \return the number of stages
+   */
+  uint8_t GetNStages (void) const;
+  /**
+   * \param stage the stage index
+   * \return the stage
+   */
+  const Stage &GetStage (uint8_t stage) const;
+
+  /**
+   * \return the index of the next stage to run, GetNStages once every stage ran
+   */
+  uint8_t GetNextStage (void) const;
+  /**
+   * \return true once every stage ran
+   */
+  bool IsComplete (void) const;
+
+  /**
+   * \return the arguments of the next stage, with the results of the stages they are bound to
+   */
+  std::vector<WasmFaasValue> GetNextArgs (void) const;
+  /**
+   * \brief Record the result of the next stage, making the stage after it the next one.
+   * \param result the result
+   */
+  void SetNextResult (const WasmFaasValue &result);
+  /**
+   * \return the result of the last stage, once the workflow is complete
+   */
+  WasmFaasValue GetResult (void) const;
+
+  /**
+   * \return the module names of the stages joined by '>', e.g. "sum>div"
+   */
+  std::string GetName (void) const;
+
+  /**
+   * \param data filled with the wire form of the workflow
+   */
+  void Serialize (std::string &data) const;
+
+  /**
+   * \param data the wire form of a workflow
+   * \return false if data does not hold a valid workflow, leaving the workflow empty
+   */
+  bool Deserialize (const std::string &data);
+
+private:
+  std::vector<Stage> m_stages; //!< Stages in run order
+  std::vector<WasmFaasValue> m_results; //!< Results of the stages run so far
+};
+
+} // namespace ns3
+
+#endif /* WASMFAAS_WORKFLOW_H */
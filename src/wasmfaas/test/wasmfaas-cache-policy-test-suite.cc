@@ -0,0 +1,236 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/object-factory.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+#include "ns3/wasmfaas-cache-policy.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that LruWasmModuleCachePolicy evicts the least recently used modules first
+ */
+class LruWasmModuleCachePolicyTestCase : public TestCase
+{
+public:
+  LruWasmModuleCachePolicyTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+LruWasmModuleCachePolicyTestCase::LruWasmModuleCachePolicyTestCase ()
+  : TestCase ("Eviction order of LruWasmModuleCachePolicy")
+{
+}
+
+void
+LruWasmModuleCachePolicyTestCase::DoRun (void)
+{
+  auto cache =
+      CreateObjectWithAttributes<LruWasmModuleCachePolicy> ("Capacity", UintegerValue (300));
+  std::vector<std::string> evicted;
+
+  cache->Insert ("a", 100, evicted);
+  cache->Insert ("b", 100, evicted);
+  cache->Insert ("c", 100, evicted);
+  NS_TEST_ASSERT_MSG_EQ (evicted.size (), 0, "Evicted before the cache was full");
+  NS_TEST_ASSERT_MSG_EQ (cache->GetUsedBytes (), 300, "Wrong used bytes");
+
+  cache->Access ("a");
+  NS_TEST_ASSERT_MSG_EQ (cache->Insert ("d", 100, evicted), true, "Module not cached");
+  NS_TEST_ASSERT_MSG_EQ (evicted.size (), 1, "Wrong number of evictions");
+  NS_TEST_ASSERT_MSG_EQ (evicted[0], "b", "The least recently used module was not evicted");
+
+  // Room for a large module is made in recency order
+  evicted.clear ();
+  NS_TEST_ASSERT_MSG_EQ (cache->Insert ("e", 200, evicted), true, "Module not cached");
+  NS_TEST_ASSERT_MSG_EQ (evicted.size (), 2, "Wrong number of evictions");
+  NS_TEST_ASSERT_MSG_EQ (evicted[0], "c", "Wrong first victim");
+  NS_TEST_ASSERT_MSG_EQ (evicted[1], "a", "Wrong second victim");
+  NS_TEST_ASSERT_MSG_EQ (cache->Contains ("d"), true, "Recent module evicted");
+  NS_TEST_ASSERT_MSG_EQ (cache->GetUsedBytes (), 300, "Wrong used bytes");
+
+  evicted.clear ();
+  NS_TEST_ASSERT_MSG_EQ (cache->Insert ("f", 301, evicted), false,
+                         "Module larger than the capacity cached");
+  NS_TEST_ASSERT_MSG_EQ (evicted.size (), 0, "Evicted for a module that cannot fit");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that LfuWasmModuleCachePolicy evicts the least frequently used modules
+ * first, the least recently used one among equals
+ */
+class LfuWasmModuleCachePolicyTestCase : public TestCase
+{
+public:
+  LfuWasmModuleCachePolicyTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+LfuWasmModuleCachePolicyTestCase::LfuWasmModuleCachePolicyTestCase ()
+  : TestCase ("Eviction order of LfuWasmModuleCachePolicy")
+{
+}
+
+void
+LfuWasmModuleCachePolicyTestCase::DoRun (void)
+{
+  auto cache =
+      CreateObjectWithAttributes<LfuWasmModuleCachePolicy> ("Capacity", UintegerValue (300));
+  std::vector<std::string> evicted;
+
+  cache->Insert ("a", 100, evicted);
+  cache->Insert ("b", 100, evicted);
+  cache->Insert ("c", 100, evicted);
+  cache->Access ("a");
+  cache->Access ("a");
+  cache->Access ("b");
+  cache->Access ("c");
+
+  // b and c are used as often, b less recently
+  NS_TEST_ASSERT_MSG_EQ (cache->Insert ("d", 100, evicted), true, "Module not cached");
+  NS_TEST_ASSERT_MSG_EQ (evicted.size (), 1, "Wrong number of evictions");
+  NS_TEST_ASSERT_MSG_EQ (evicted[0], "b", "Wrong victim among equally used modules");
+
+  // The new module has been used once only
+  evicted.clear ();
+  cache->Insert ("e", 100, evicted);
+  NS_TEST_ASSERT_MSG_EQ (evicted.size (), 1, "Wrong number of evictions");
+  NS_TEST_ASSERT_MSG_EQ (evicted[0], "d", "The least frequently used module was not evicted");
+  NS_TEST_ASSERT_MSG_EQ (cache->Contains ("a"), true, "Most used module evicted");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that GreedyDualSizeWasmModuleCachePolicy evicts large modules first
+ * and ages the modules that are not used
+ */
+class GreedyDualSizeWasmModuleCachePolicyTestCase : public TestCase
+{
+public:
+  GreedyDualSizeWasmModuleCachePolicyTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+GreedyDualSizeWasmModuleCachePolicyTestCase::GreedyDualSizeWasmModuleCachePolicyTestCase ()
+  : TestCase ("Eviction order of GreedyDualSizeWasmModuleCachePolicy")
+{
+}
+
+void
+GreedyDualSizeWasmModuleCachePolicyTestCase::DoRun (void)
+{
+  auto cache =
+      CreateObjectWithAttributes<GreedyDualSizeWasmModuleCachePolicy> ("Capacity",
+                                                                        UintegerValue (1000));
+  std::vector<std::string> evicted;
+
+  cache->Insert ("small", 100, evicted);
+  cache->Insert ("large", 500, evicted);
+  cache->Insert ("medium", 400, evicted);
+
+  // Credits: small 1/100, medium 1/400, large 1/500
+  cache->Insert ("d", 100, evicted);
+  NS_TEST_ASSERT_MSG_EQ (evicted.size (), 1, "Wrong number of evictions");
+  NS_TEST_ASSERT_MSG_EQ (evicted[0], "large", "The largest module was not evicted first");
+
+  evicted.clear ();
+  cache->Insert ("e", 500, evicted);
+  NS_TEST_ASSERT_MSG_EQ (evicted.size (), 1, "Wrong number of evictions");
+  NS_TEST_ASSERT_MSG_EQ (evicted[0], "medium", "Wrong second victim");
+
+  // Each eviction raised L by the victim credit, a module not used since it was
+  // cached now has less credit than a larger module cached later
+  evicted.clear ();
+  for (uint32_t i = 0; i < 40; i++)
+    {
+      auto name = "big" + std::to_string (i);
+      cache->Insert (name, 400, evicted);
+      cache->Access ("d");
+    }
+  NS_TEST_ASSERT_MSG_EQ (cache->Contains ("small"), false, "An unused module never aged out");
+  NS_TEST_ASSERT_MSG_EQ (cache->Contains ("d"), true, "A small module in use was evicted");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that NeverWasmModuleCachePolicy fetches and caches nothing
+ */
+class NeverWasmModuleCachePolicyTestCase : public TestCase
+{
+public:
+  NeverWasmModuleCachePolicyTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+NeverWasmModuleCachePolicyTestCase::NeverWasmModuleCachePolicyTestCase ()
+  : TestCase ("NeverWasmModuleCachePolicy caches nothing")
+{
+}
+
+void
+NeverWasmModuleCachePolicyTestCase::DoRun (void)
+{
+  auto cache = CreateObject<NeverWasmModuleCachePolicy> ();
+  std::vector<std::string> evicted;
+
+  NS_TEST_ASSERT_MSG_EQ (cache->ShouldFetch ("a"), false, "Module fetched");
+  NS_TEST_ASSERT_MSG_EQ (cache->Insert ("a", 100, evicted), false, "Module cached");
+  NS_TEST_ASSERT_MSG_EQ (cache->Contains ("a"), false, "Module cached");
+  NS_TEST_ASSERT_MSG_EQ (cache->GetUsedBytes (), 0, "Wrong used bytes");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * WasmModuleCachePolicy test suite
+ */
+class WasmModuleCachePolicyTestSuite : public TestSuite
+{
+public:
+  WasmModuleCachePolicyTestSuite ();
+};
+
+WasmModuleCachePolicyTestSuite::WasmModuleCachePolicyTestSuite ()
+  : TestSuite ("wasmfaas-cache-policy", UNIT)
+{
+  AddTestCase (new LruWasmModuleCachePolicyTestCase, TestCase::QUICK);
+  AddTestCase (new LfuWasmModuleCachePolicyTestCase, TestCase::QUICK);
+  AddTestCase (new GreedyDualSizeWasmModuleCachePolicyTestCase, TestCase::QUICK);
+  AddTestCase (new NeverWasmModuleCachePolicyTestCase, TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static WasmModuleCachePolicyTestSuite g_wasmModuleCachePolicyTestSuite;
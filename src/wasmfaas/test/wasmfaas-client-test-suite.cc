@@ -0,0 +1,142 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <string>
+#include <vector>
+#include "ns3/nstime.h"
+#include "ns3/test.h"
+#include "ns3/wasmfaas-client.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that WasmFaasClient parses invocation mixes into cumulative weights
+ * and rejects the malformed ones as a whole
+ */
+class WasmFaasClientFunctionsTestCase : public TestCase
+{
+public:
+  WasmFaasClientFunctionsTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WasmFaasClientFunctionsTestCase::WasmFaasClientFunctionsTestCase ()
+  : TestCase ("Parse the invocation mix of WasmFaasClient")
+{
+}
+
+void
+WasmFaasClientFunctionsTestCase::DoRun (void)
+{
+  std::vector<WasmFaasClient::Function> mix;
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasClient::ParseFunctions ("sum:sum:3;;div:div;m:f:0.5;", mix),
+                         true, "Valid mix rejected");
+  NS_TEST_ASSERT_MSG_EQ (mix.size (), 3, "Wrong number of functions");
+  NS_TEST_EXPECT_MSG_EQ (mix[0].moduleName, "sum", "Wrong module");
+  NS_TEST_EXPECT_MSG_EQ (mix[0].funcName, "sum", "Wrong function");
+  NS_TEST_EXPECT_MSG_EQ (mix[0].cumulativeWeight, 3, "Wrong weight");
+  NS_TEST_EXPECT_MSG_EQ (mix[1].moduleName, "div", "Wrong module without weight");
+  NS_TEST_EXPECT_MSG_EQ (mix[1].funcName, "div", "Wrong function without weight");
+  NS_TEST_EXPECT_MSG_EQ (mix[1].cumulativeWeight, 4, "Missing weight not 1");
+  NS_TEST_EXPECT_MSG_EQ (mix[2].cumulativeWeight, 4.5, "Wrong fractional weight");
+
+  // A rejected mix leaves the previous one as it was
+  for (std::string functions : {"sum", "sum:sum;div", "sum:sum:x", "sum:sum:-1", "sum:sum:1:2",
+                                "sum:sum:1e999", "sum:sum:"})
+    {
+      NS_TEST_EXPECT_MSG_EQ (WasmFaasClient::ParseFunctions (functions, mix), false,
+                             "Malformed mix " << functions << " accepted");
+    }
+  NS_TEST_EXPECT_MSG_EQ (mix.size (), 3, "Rejected mix changed the functions");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that WasmFaasClient parses invocation trace lines and rejects the
+ * malformed ones
+ */
+class WasmFaasClientTraceTestCase : public TestCase
+{
+public:
+  WasmFaasClientTraceTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WasmFaasClientTraceTestCase::WasmFaasClientTraceTestCase ()
+  : TestCase ("Parse the invocation trace lines of WasmFaasClient")
+{
+}
+
+void
+WasmFaasClientTraceTestCase::DoRun (void)
+{
+  WasmFaasClient::TraceEntry entry;
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasClient::ParseTraceLine ("0.5,sum,add,1,2.6 ", ArgType::I32, entry),
+                         true, "Valid line rejected");
+  NS_TEST_EXPECT_MSG_EQ (entry.time, MilliSeconds (500), "Wrong time");
+  NS_TEST_EXPECT_MSG_EQ (entry.moduleName, "sum", "Wrong module");
+  NS_TEST_EXPECT_MSG_EQ (entry.funcName, "add", "Wrong function");
+  NS_TEST_ASSERT_MSG_EQ (entry.args.size (), 2, "Wrong number of arguments");
+  NS_TEST_EXPECT_MSG_EQ (entry.args[0].GetI32 (), 1, "Wrong argument");
+  NS_TEST_EXPECT_MSG_EQ (entry.args[1].GetI32 (), 3, "Integer argument not rounded");
+
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasClient::ParseTraceLine ("2,div,div,0.25", ArgType::F64, entry),
+                         true, "Valid F64 line rejected");
+  NS_TEST_ASSERT_MSG_EQ (entry.args.size (), 1, "Wrong number of F64 arguments");
+  NS_TEST_EXPECT_MSG_EQ (entry.args[0].GetF64 (), 0.25, "Wrong F64 argument");
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasClient::ParseTraceLine ("3,sum,sum", ArgType::I32, entry), true,
+                         "Line without arguments rejected");
+  NS_TEST_EXPECT_MSG_EQ (entry.args.size (), 0, "Arguments kept from the previous line");
+
+  // A rejected line leaves the entry as it was
+  for (std::string line : {"1,sum", "x,sum,sum,1", "-1,sum,sum,1", "1,sum,sum,1,two",
+                           "nan,sum,sum", "1,sum,sum,1e999", "1,sum,sum,,2"})
+    {
+      NS_TEST_EXPECT_MSG_EQ (WasmFaasClient::ParseTraceLine (line, ArgType::I32, entry), false,
+                             "Malformed line " << line << " accepted");
+    }
+  NS_TEST_EXPECT_MSG_EQ (entry.time, Seconds (3), "Rejected line changed the entry");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * WasmFaasClient test suite
+ */
+class WasmFaasClientTestSuite : public TestSuite
+{
+public:
+  WasmFaasClientTestSuite ();
+};
+
+WasmFaasClientTestSuite::WasmFaasClientTestSuite () : TestSuite ("wasmfaas-client", UNIT)
+{
+  AddTestCase (new WasmFaasClientFunctionsTestCase, TestCase::QUICK);
+  AddTestCase (new WasmFaasClientTraceTestCase, TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static WasmFaasClientTestSuite g_wasmFaasClientTestSuite;
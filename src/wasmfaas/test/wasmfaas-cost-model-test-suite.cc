@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/double.h"
+#include "ns3/nstime.h"
+#include "ns3/object-factory.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+#include "ns3/wasmfaas-cost-model.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that a Profile sets the cost of its modules and replaces the costs
+ * set before it, and that other modules take DefaultCost
+ */
+class ProfileWasmExecutionCostModelTestCase : public TestCase
+{
+public:
+  ProfileWasmExecutionCostModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+ProfileWasmExecutionCostModelTestCase::ProfileWasmExecutionCostModelTestCase ()
+  : TestCase ("Costs of ProfileWasmExecutionCostModel")
+{
+}
+
+void
+ProfileWasmExecutionCostModelTestCase::DoRun (void)
+{
+  auto model = CreateObjectWithAttributes<ProfileWasmExecutionCostModel> (
+      "DefaultCost", TimeValue (MilliSeconds (1)), "Profile", StringValue ("sum=2ms;div=5ms"));
+  NS_TEST_EXPECT_MSG_EQ (model->GetCost ("sum", "sum", Seconds (1)), MilliSeconds (2),
+                         "Wrong cost of sum");
+  NS_TEST_EXPECT_MSG_EQ (model->GetCost ("div", "div", Seconds (1)), MilliSeconds (5),
+                         "Wrong cost of div");
+  NS_TEST_EXPECT_MSG_EQ (model->GetCost ("mul", "mul", Seconds (1)), MilliSeconds (1),
+                         "Module out of the profile not at DefaultCost");
+
+  // A later profile replaces the whole profile and the costs set one by one
+  model->SetModuleCost ("mul", MilliSeconds (7));
+  NS_TEST_EXPECT_MSG_EQ (model->GetCost ("mul", "mul", Seconds (1)), MilliSeconds (7),
+                         "Wrong cost of mul");
+  model->SetAttribute ("Profile", StringValue (";sum=3ms;;"));
+  NS_TEST_EXPECT_MSG_EQ (model->GetCost ("sum", "sum", Seconds (1)), MilliSeconds (3),
+                         "Profile did not override the cost of sum");
+  NS_TEST_EXPECT_MSG_EQ (model->GetCost ("div", "div", Seconds (1)), MilliSeconds (1),
+                         "Cost of div kept from the previous profile");
+  NS_TEST_EXPECT_MSG_EQ (model->GetCost ("mul", "mul", Seconds (1)), MilliSeconds (1),
+                         "Cost of mul kept past the profile");
+  StringValue profile;
+  model->GetAttribute ("Profile", profile);
+  NS_TEST_EXPECT_MSG_EQ (profile.Get (), ";sum=3ms;;", "Wrong profile read back");
+
+  // An entry repeated in one profile takes its last cost
+  model->SetAttribute ("Profile", StringValue ("sum=3ms;sum=4ms"));
+  NS_TEST_EXPECT_MSG_EQ (model->GetCost ("sum", "sum", Seconds (1)), MilliSeconds (4),
+                         "Later entry did not override an earlier one");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check the costs of ConstantWasmExecutionCostModel and
+ * WallClockWasmExecutionCostModel
+ */
+class WasmExecutionCostModelTestCase : public TestCase
+{
+public:
+  WasmExecutionCostModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WasmExecutionCostModelTestCase::WasmExecutionCostModelTestCase ()
+  : TestCase ("Costs of the constant and wall clock cost models")
+{
+}
+
+void
+WasmExecutionCostModelTestCase::DoRun (void)
+{
+  auto constant = CreateObjectWithAttributes<ConstantWasmExecutionCostModel> (
+      "Cost", TimeValue (MilliSeconds (3)));
+  NS_TEST_EXPECT_MSG_EQ (constant->GetCost ("sum", "sum", Seconds (1)), MilliSeconds (3),
+                         "Wrong constant cost");
+
+  auto wallClock = CreateObjectWithAttributes<WallClockWasmExecutionCostModel> (
+      "CpuSpeed", DoubleValue (0.5));
+  NS_TEST_EXPECT_MSG_EQ (wallClock->GetCost ("sum", "sum", MicroSeconds (20)), MicroSeconds (40),
+                         "Half speed CPU not twice as slow");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * WasmExecutionCostModel test suite
+ */
+class WasmExecutionCostModelTestSuite : public TestSuite
+{
+public:
+  WasmExecutionCostModelTestSuite ();
+};
+
+WasmExecutionCostModelTestSuite::WasmExecutionCostModelTestSuite ()
+  : TestSuite ("wasmfaas-cost-model", UNIT)
+{
+  AddTestCase (new ProfileWasmExecutionCostModelTestCase, TestCase::QUICK);
+  AddTestCase (new WasmExecutionCostModelTestCase, TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static WasmExecutionCostModelTestSuite g_wasmExecutionCostModelTestSuite;
@@ -0,0 +1,179 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <vector>
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/test.h"
+#include "ns3/wasmfaas-event-log.h"
+
+using namespace ns3;
+
+/**
+ * \param fileName a file
+ * \return the bytes of the file
+ */
+static std::vector<uint8_t>
+ReadBytes (const std::string &fileName)
+{
+  std::ifstream file (fileName, std::ios::binary);
+  return std::vector<uint8_t> (std::istreambuf_iterator<char> (file),
+                               std::istreambuf_iterator<char> ());
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that the records written by WasmFaasEventLog read back the same,
+ * in the documented 32 byte layout and only once their buffer is full
+ */
+class WasmFaasEventLogRoundTripTestCase : public TestCase
+{
+public:
+  WasmFaasEventLogRoundTripTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Check the size of the log file.
+   * \param records the number of records expected in the file
+   */
+  void CheckFileSize (uint32_t records);
+
+  std::string m_fileName; //!< Log file name
+};
+
+WasmFaasEventLogRoundTripTestCase::WasmFaasEventLogRoundTripTestCase ()
+  : TestCase ("Write and read back WasmFaasEventLog records")
+{
+}
+
+void
+WasmFaasEventLogRoundTripTestCase::CheckFileSize (uint32_t records)
+{
+  NS_TEST_EXPECT_MSG_EQ (ReadBytes (m_fileName).size (),
+                         WasmFaasEventLog::FILE_HEADER_SIZE +
+                             records * WasmFaasEventLog::RECORD_SIZE,
+                         "Wrong number of records written at " << Simulator::Now ());
+}
+
+void
+WasmFaasEventLogRoundTripTestCase::DoRun (void)
+{
+  m_fileName = CreateTempDirFilename ("wasmfaas-events.bin");
+  std::vector<WasmFaasEventLog::Record> written = {
+      {0, 0, WasmFaasEventLog::REGISTER_NODE, 0, 0, 0},
+      {1500, 7, WasmFaasEventLog::SEND_PACKET_MODULE_LOAD_RESPONSE_CHUNKED, 0x0123456789abcdefULL,
+       0xdeadbeef, 4096},
+      {3000000000LL, 0xffffffff, WasmFaasEventLog::IGNORED_ANSWER_NOT_PENDING, ~0ULL, 1,
+       0xffffffff},
+      {3000000001LL, 2, WasmFaasEventLog::REQUEST_TIMED_OUT, 42, 2, 0},
+      {3600000000000LL, 3, WasmFaasEventLog::EVICTED_MODULE, 0, 3, 100}};
+
+  // Three records fill the buffer, the fourth and fifth wait for Flush
+  auto log = CreateObjectWithAttributes<WasmFaasEventLog> (
+      "FileName", StringValue (m_fileName), "BufferSize",
+      UintegerValue (3 * WasmFaasEventLog::RECORD_SIZE));
+  for (const auto &record : written)
+    {
+      Simulator::Schedule (NanoSeconds (record.time), &WasmFaasEventLog::Write, log, record.node,
+                           (WasmFaasEventLog::EventType) record.type, record.requestId,
+                           record.moduleId, record.bytes);
+    }
+  Simulator::Schedule (NanoSeconds (written[2].time),
+                       &WasmFaasEventLogRoundTripTestCase::CheckFileSize, this, 3);
+  Simulator::Schedule (NanoSeconds (written[3].time),
+                       &WasmFaasEventLogRoundTripTestCase::CheckFileSize, this, 3);
+  Simulator::Run ();
+  CheckFileSize (3);
+  log->Flush ();
+  CheckFileSize (5);
+  NS_TEST_ASSERT_MSG_EQ (log->GetNRecords (), written.size (), "Wrong number of records");
+  log->Dispose ();
+  Simulator::Destroy ();
+
+  // The second record, field by field at its documented offsets
+  auto bytes = ReadBytes (m_fileName);
+  const uint8_t expected[WasmFaasEventLog::RECORD_SIZE] = {
+      0xdc, 0x05, 0, 0, 0, 0, 0, 0, 7, 0, 0, 0, 19, 0, 0, 0,
+      0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01, 0xef, 0xbe, 0xad, 0xde, 0, 0x10, 0, 0};
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasEventLog::SEND_PACKET_MODULE_LOAD_RESPONSE_CHUNKED, 19,
+                         "Event type renumbered");
+  for (uint32_t i = 0; i < WasmFaasEventLog::RECORD_SIZE; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t) bytes[WasmFaasEventLog::FILE_HEADER_SIZE +
+                                              WasmFaasEventLog::RECORD_SIZE + i],
+                             (uint32_t) expected[i], "Wrong byte " << i << " of a record");
+    }
+
+  std::ifstream file (m_fileName, std::ios::binary);
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasEventLog::ReadFileHeader (file), true, "File header rejected");
+  for (const auto &entry : written)
+    {
+      WasmFaasEventLog::Record record;
+      NS_TEST_ASSERT_MSG_EQ (WasmFaasEventLog::ReadRecord (file, record), true, "Record missing");
+      NS_TEST_EXPECT_MSG_EQ (record.time, entry.time, "Wrong time");
+      NS_TEST_EXPECT_MSG_EQ (record.node, entry.node, "Wrong node");
+      NS_TEST_EXPECT_MSG_EQ (record.type, entry.type, "Wrong event type");
+      NS_TEST_EXPECT_MSG_EQ (record.requestId, entry.requestId, "Wrong request ID");
+      NS_TEST_EXPECT_MSG_EQ (record.moduleId, entry.moduleId, "Wrong module ID");
+      NS_TEST_EXPECT_MSG_EQ (record.bytes, entry.bytes, "Wrong byte count");
+    }
+  WasmFaasEventLog::Record record;
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasEventLog::ReadRecord (file, record), false, "Record past the end");
+
+  // A truncated record is the end of the log, another format is no log at all
+  std::string truncated (bytes.begin (), bytes.end () - 1);
+  std::istringstream shortLog (truncated);
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasEventLog::ReadFileHeader (shortLog), true, "File header rejected");
+  for (uint32_t i = 0; i + 1 < written.size (); i++)
+    {
+      WasmFaasEventLog::ReadRecord (shortLog, record);
+    }
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasEventLog::ReadRecord (shortLog, record), false,
+                         "Truncated record read");
+  std::istringstream otherVersion (std::string ("WFEL\x02\x00\x20\x00", 8));
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasEventLog::ReadFileHeader (otherVersion), false,
+                         "Other format version accepted");
+  std::istringstream notALog ("WFEX\x01");
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasEventLog::ReadFileHeader (notALog), false, "Bad magic accepted");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * WasmFaasEventLog test suite
+ */
+class WasmFaasEventLogTestSuite : public TestSuite
+{
+public:
+  WasmFaasEventLogTestSuite ();
+};
+
+WasmFaasEventLogTestSuite::WasmFaasEventLogTestSuite () : TestSuite ("wasmfaas-event-log", UNIT)
+{
+  AddTestCase (new WasmFaasEventLogRoundTripTestCase, TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static WasmFaasEventLogTestSuite g_wasmFaasEventLogTestSuite;
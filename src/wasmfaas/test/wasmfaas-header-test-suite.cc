@@ -0,0 +1,368 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <sstream>
+#include "ns3/packet.h"
+#include "ns3/test.h"
+#include "ns3/wasmfaas-chunk-header.h"
+#include "ns3/wasmfaas-header.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup customapp
+ * \defgroup customapp-test CustomApp module tests
+ */
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that a header with every argument type survives Serialize and Deserialize
+ */
+class WasmFaasHeaderBinaryTestCase : public TestCase
+{
+public:
+  WasmFaasHeaderBinaryTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WasmFaasHeaderBinaryTestCase::WasmFaasHeaderBinaryTestCase ()
+  : TestCase ("Binary round trip of WasmFaasHeader")
+{
+}
+
+void
+WasmFaasHeaderBinaryTestCase::DoRun (void)
+{
+  WasmFaasHeader header;
+  header.SetType (WasmFaasHeader::EXECUTE_REQUEST);
+  header.SetRequestId (0x0123456789abcdefULL);
+  header.SetModuleId (WasmFaasHeader::GetNameId ("sum"));
+  header.SetFunctionId (WasmFaasHeader::GetNameId ("add"));
+  header.SetHopCount (3);
+  header.SetPriority (2);
+  header.SetQueueDepth (513);
+  header.SetUtilization (77);
+  header.AddArg (WasmFaasValue::FromI32 (-7));
+  header.AddArg (WasmFaasValue::FromI64 (-1234567890123LL));
+  header.AddArg (WasmFaasValue::FromF32 (1.5f));
+  header.AddArg (WasmFaasValue::FromF64 (-2.25));
+  WasmFaasValue v128;
+  v128.type = ArgType::V128;
+  v128.hi = 0x1122334455667788ULL;
+  v128.lo = 0x0000000000000042ULL;
+  header.AddArg (v128);
+
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (header);
+  NS_TEST_ASSERT_MSG_EQ (packet->GetSize (), header.GetSerializedSize (), "Wrong packet size");
+
+  WasmFaasHeader copy;
+  packet->RemoveHeader (copy);
+  NS_TEST_ASSERT_MSG_EQ (copy.GetType (), WasmFaasHeader::EXECUTE_REQUEST, "Wrong type");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetRequestId (), 0x0123456789abcdefULL, "Wrong request ID");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetModuleId (), header.GetModuleId (), "Wrong module ID");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetFunctionId (), header.GetFunctionId (), "Wrong function ID");
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasHeader::GetIdName (copy.GetModuleId ()), "sum",
+                         "Module name not resolved");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetHopCount (), 3, "Wrong hop count");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetPriority (), 2, "Wrong priority");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetQueueDepth (), 513, "Wrong queue depth");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetUtilization (), 77, "Wrong utilization");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetNArgs (), 5, "Wrong argument count");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetArg (0).GetI32 (), -7, "Wrong I32 argument");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetArg (1).GetI64 (), -1234567890123LL, "Wrong I64 argument");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetArg (2).GetF32 (), 1.5f, "Wrong F32 argument");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetArg (3).GetF64 (), -2.25, "Wrong F64 argument");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetArg (4).hi, v128.hi, "Wrong V128 high bits");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetArg (4).lo, v128.lo, "Wrong V128 low bits");
+
+  std::ostringstream os;
+  os << copy.GetArg (4);
+  NS_TEST_ASSERT_MSG_EQ (os.str (), "0x11223344556677880000000000000042",
+                         "V128 printed without the leading zeros of the low bits");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check the text protocol round trip and that malformed messages are rejected
+ */
+class WasmFaasHeaderTextTestCase : public TestCase
+{
+public:
+  WasmFaasHeaderTextTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WasmFaasHeaderTextTestCase::WasmFaasHeaderTextTestCase ()
+  : TestCase ("Text round trip of WasmFaasHeader")
+{
+}
+
+void
+WasmFaasHeaderTextTestCase::DoRun (void)
+{
+  std::string payload;
+
+  WasmFaasHeader request;
+  request.SetType (WasmFaasHeader::EXECUTE_REQUEST);
+  request.SetRequestId (18446744073709551615ULL);
+  request.SetModuleId (WasmFaasHeader::GetNameId ("sum"));
+  request.SetFunctionId (WasmFaasHeader::GetNameId ("add"));
+  request.AddArg (WasmFaasValue::FromI32 (-2147483647 - 1));
+  request.AddArg (WasmFaasValue::FromI32 (42));
+  std::string text;
+  NS_TEST_ASSERT_MSG_EQ (request.ToText ("", text), true, "Valid request not encoded");
+  NS_TEST_ASSERT_MSG_EQ (text, "e;sum;add;-2147483648;42;", "Wrong text form");
+
+  // The request ID is not part of the legacy layout
+  WasmFaasHeader copy;
+  NS_TEST_ASSERT_MSG_EQ (copy.FromText (text, payload), true, "Valid request rejected");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetType (), WasmFaasHeader::EXECUTE_REQUEST, "Wrong type");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetRequestId (), 0, "Wrong request ID");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetModuleId (), request.GetModuleId (), "Wrong module ID");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetFunctionId (), request.GetFunctionId (), "Wrong function ID");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetNArgs (), 2, "Wrong argument count");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetArg (0).GetI32 (), -2147483647 - 1, "Wrong first argument");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetArg (1).GetI32 (), 42, "Wrong second argument");
+
+  WasmFaasHeader result;
+  result.SetType (WasmFaasHeader::EXECUTE_RESULT);
+  result.SetRequestId (9);
+  result.SetModuleId (WasmFaasHeader::GetNameId ("sum"));
+  result.AddArg (WasmFaasValue::FromI32 (-5));
+  NS_TEST_ASSERT_MSG_EQ (result.ToText ("", text), true, "Valid result not encoded");
+  NS_TEST_ASSERT_MSG_EQ (text, "r;sum;-5;", "Wrong text form of a result");
+  NS_TEST_ASSERT_MSG_EQ (copy.FromText (text, payload), true, "Valid result rejected");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetType (), WasmFaasHeader::EXECUTE_RESULT, "Wrong type");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetArg (0).GetI32 (), -5, "Wrong result");
+
+  WasmFaasHeader load;
+  load.SetType (WasmFaasHeader::MODULE_LOAD_REQUEST);
+  load.SetRequestId (10);
+  load.SetModuleId (WasmFaasHeader::GetNameId ("sum"));
+  NS_TEST_ASSERT_MSG_EQ (load.ToText ("", text), true, "Valid load request not encoded");
+  NS_TEST_ASSERT_MSG_EQ (text, "l;sum;", "Wrong text form of a load request");
+  load.SetType (WasmFaasHeader::MODULE_LOAD_RESULT);
+  NS_TEST_ASSERT_MSG_EQ (load.ToText ("AGFzbQ==", text), true, "Valid load result not encoded");
+  NS_TEST_ASSERT_MSG_EQ (text, "c;sum;AGFzbQ==;", "Wrong text form of a load result");
+  NS_TEST_ASSERT_MSG_EQ (copy.FromText (text, payload), true, "Valid load result rejected");
+  NS_TEST_ASSERT_MSG_EQ (payload, "AGFzbQ==", "Wrong module payload");
+
+  WasmFaasHeader ack;
+  ack.SetType (WasmFaasHeader::ACK);
+  NS_TEST_ASSERT_MSG_EQ (ack.ToText ("", text), true, "Ack not encoded");
+  NS_TEST_ASSERT_MSG_EQ (text, "0", "Wrong text form of an ack");
+  NS_TEST_ASSERT_MSG_EQ (copy.FromText (text, payload), true, "Ack rejected");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetType (), WasmFaasHeader::ACK, "Wrong type");
+
+  // Only I32 values travel as text, other types are not truncated
+  request.AddArg (WasmFaasValue::FromI64 (1ll << 32));
+  NS_TEST_ASSERT_MSG_EQ (request.ToText ("", text), false, "I64 argument encoded as text");
+  result.ClearArgs ();
+  result.AddArg (WasmFaasValue::FromF64 (0.5));
+  NS_TEST_ASSERT_MSG_EQ (result.ToText ("", text), false, "F64 result encoded as text");
+
+  const char *malformed[] = {
+      "e;sum;", // function missing
+      "e;sum;add;one;", // argument not a number
+      "e;sum;add;2147483648;", // argument out of I32 range
+      "r;sum;", // result missing
+      "r;sum;1.5;", // result not an I32
+      "c;sum;", // module data missing
+      "ee;sum;add;", // type longer than one character
+      "z;sum;", // unknown type
+      "e", // too few fields
+  };
+  for (const char *text : malformed)
+    {
+      NS_TEST_EXPECT_MSG_EQ (copy.FromText (text, payload), false,
+                             "Malformed message " << text << " accepted");
+    }
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that PeekSerializedSize tells truncated headers apart
+ */
+class WasmFaasHeaderTruncatedTestCase : public TestCase
+{
+public:
+  WasmFaasHeaderTruncatedTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WasmFaasHeaderTruncatedTestCase::WasmFaasHeaderTruncatedTestCase ()
+  : TestCase ("PeekSerializedSize of truncated WasmFaasHeaders")
+{
+}
+
+void
+WasmFaasHeaderTruncatedTestCase::DoRun (void)
+{
+  WasmFaasHeader header;
+  header.SetType (WasmFaasHeader::EXECUTE_RESULT);
+  header.SetRequestId (5);
+  header.AddArg (WasmFaasValue::FromI64 (-1));
+  WasmFaasValue v128;
+  v128.type = ArgType::V128;
+  v128.lo = 1;
+  v128.hi = 2;
+  header.AddArg (v128);
+
+  Ptr<Packet> packet = Create<Packet> (4);
+  packet->AddHeader (header);
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasHeader::PeekSerializedSize (packet), header.GetSerializedSize (),
+                         "Wrong size of a complete header");
+  NS_TEST_ASSERT_MSG_EQ (packet->GetSize (), header.GetSerializedSize () + 4, "Header removed");
+
+  for (uint32_t size = 0; size < header.GetSerializedSize (); size++)
+    {
+      auto truncated = packet->CreateFragment (0, size);
+      NS_TEST_ASSERT_MSG_EQ (WasmFaasHeader::PeekSerializedSize (truncated), 0,
+                             "Header truncated to " << size << " bytes accepted");
+    }
+
+  WasmFaasHeader ack;
+  ack.SetType (WasmFaasHeader::ACK);
+  packet = Create<Packet> ();
+  packet->AddHeader (ack);
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasHeader::PeekSerializedSize (packet), WasmFaasHeader::FIXED_SIZE,
+                         "Wrong size of a header without arguments");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check the WasmFaasChunkHeader round trip and chunk count
+ */
+class WasmFaasChunkHeaderTestCase : public TestCase
+{
+public:
+  WasmFaasChunkHeaderTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WasmFaasChunkHeaderTestCase::WasmFaasChunkHeaderTestCase ()
+  : TestCase ("Round trip and chunk count of WasmFaasChunkHeader")
+{
+}
+
+void
+WasmFaasChunkHeaderTestCase::DoRun (void)
+{
+  WasmFaasChunkHeader chunk;
+  chunk.SetSeq (7);
+  chunk.SetChunkSize (1024);
+  chunk.SetModuleSize (7 * 1024 + 1);
+
+  Ptr<Packet> packet = Create<Packet> (3);
+  packet->AddHeader (chunk);
+  NS_TEST_ASSERT_MSG_EQ (packet->GetSize (), 3 + chunk.GetSerializedSize (), "Wrong packet size");
+
+  WasmFaasChunkHeader copy;
+  packet->RemoveHeader (copy);
+  NS_TEST_ASSERT_MSG_EQ (copy.GetSeq (), 7, "Wrong seq");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetChunkSize (), 1024, "Wrong chunk size");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetModuleSize (), 7 * 1024 + 1, "Wrong module size");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetCount (), 8, "A partial last chunk counts as a chunk");
+  NS_TEST_ASSERT_MSG_EQ (packet->GetSize (), 3, "Chunk data not left as payload");
+
+  copy.SetModuleSize (8 * 1024);
+  NS_TEST_ASSERT_MSG_EQ (copy.GetCount (), 8, "Wrong count for a multiple of the chunk size");
+  copy.SetModuleSize (1);
+  NS_TEST_ASSERT_MSG_EQ (copy.GetCount (), 1, "Wrong count for a one byte module");
+  copy.SetModuleSize (0);
+  NS_TEST_ASSERT_MSG_EQ (copy.GetCount (), 0, "A module without bytes has no chunk");
+  copy.SetModuleSize (100);
+  copy.SetChunkSize (0);
+  NS_TEST_ASSERT_MSG_EQ (copy.GetCount (), 0, "A zero chunk size must not divide by zero");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that a name colliding with the ID of a registered name is refused
+ * instead of aborting the simulation
+ */
+class WasmFaasHeaderNameTestCase : public TestCase
+{
+public:
+  WasmFaasHeaderNameTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WasmFaasHeaderNameTestCase::WasmFaasHeaderNameTestCase ()
+  : TestCase ("Registration of colliding WasmFaasHeader names")
+{
+}
+
+void
+WasmFaasHeaderNameTestCase::DoRun (void)
+{
+  // glbvs and yacxa have the same 32 bit FNV-1a hash
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasHeader::GetNameId ("glbvs"), WasmFaasHeader::GetNameId ("yacxa"),
+                         "Names expected to collide");
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasHeader::RegisterName ("glbvs"), true, "Registered name refused");
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasHeader::RegisterName ("glbvs"), true, "Name refused twice");
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasHeader::RegisterName ("yacxa"), false, "Colliding name accepted");
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasHeader::GetIdName (WasmFaasHeader::GetNameId ("yacxa")), "glbvs",
+                         "Colliding name replaced the first one");
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasHeader::GetIdName (WasmFaasHeader::GetNameId ("header-test")),
+                         "header-test", "Name not resolved");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * WasmFaasHeader test suite
+ */
+class WasmFaasHeaderTestSuite : public TestSuite
+{
+public:
+  WasmFaasHeaderTestSuite ();
+};
+
+WasmFaasHeaderTestSuite::WasmFaasHeaderTestSuite ()
+  : TestSuite ("wasmfaas-header", UNIT)
+{
+  AddTestCase (new WasmFaasHeaderBinaryTestCase, TestCase::QUICK);
+  AddTestCase (new WasmFaasHeaderTextTestCase, TestCase::QUICK);
+  AddTestCase (new WasmFaasHeaderTruncatedTestCase, TestCase::QUICK);
+  AddTestCase (new WasmFaasChunkHeaderTestCase, TestCase::QUICK);
+  AddTestCase (new WasmFaasHeaderNameTestCase, TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static WasmFaasHeaderTestSuite g_wasmFaasHeaderTestSuite;
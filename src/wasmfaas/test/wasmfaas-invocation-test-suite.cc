@@ -0,0 +1,352 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/node-container.h"
+#include "ns3/csma-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/custom-app.h"
+#include "ns3/custom-app-helper.h"
+#include "wasmfaas-runtime-double.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that functions of any number of typed arguments run through
+ * execute_module_typed, on the calling node and on a peer
+ */
+class WasmFaasTypedInvocationTestCase : public TestCase
+{
+public:
+  WasmFaasTypedInvocationTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Record a completed invocation of the calling node.
+   * \param result the invocation result
+   */
+  void InvocationCompleted (const WasmFaasResult &result);
+  /**
+   * \brief Run functions of the module held by the node.
+   * \param app the node holding the module
+   */
+  void CallLocal (Ptr<CustomApp> app);
+  /**
+   * \brief Run a function of V128 arguments held by a peer only.
+   * \param app the calling node
+   */
+  void CallRemote (Ptr<CustomApp> app);
+  /**
+   * \brief Run a function of the module fetched from the peer.
+   * \param app the calling node
+   */
+  void CallFetched (Ptr<CustomApp> app);
+
+  std::vector<WasmFaasResult> m_completed; //!< Results of the calling node
+  std::vector<WasmValue> m_remoteArgs; //!< Arguments the peer ran the V128 function with
+};
+
+WasmFaasTypedInvocationTestCase::WasmFaasTypedInvocationTestCase ()
+  : TestCase ("Typed invocations of N arguments, locally and on a peer")
+{
+}
+
+void
+WasmFaasTypedInvocationTestCase::InvocationCompleted (const WasmFaasResult &result)
+{
+  if (m_completed.empty ())
+    {
+      m_remoteArgs = WasmFaasRuntimeDouble::lastArgs;
+    }
+  m_completed.push_back (result);
+}
+
+void
+WasmFaasTypedInvocationTestCase::CallLocal (Ptr<CustomApp> app)
+{
+  std::vector<WasmFaasValue> args;
+  for (int32_t i = 1; i <= WasmFaasHeader::MAX_ARGS; i++)
+    {
+      args.push_back (WasmFaasValue::FromI32 (i));
+    }
+  auto nCalls = WasmFaasRuntimeDouble::nTypedCalls;
+  auto result = app->ExecuteFunction ("sum", "sum", args);
+  NS_TEST_EXPECT_MSG_EQ (WasmFaasRuntimeDouble::nTypedCalls, nCalls + 1,
+                         "Typed entry point not used");
+  NS_TEST_EXPECT_MSG_EQ (WasmFaasRuntimeDouble::lastArgs.size (), args.size (),
+                         "Arguments lost on the way to the runtime");
+  NS_TEST_EXPECT_MSG_EQ (result.status, WasmFaasResult::OK, "Local call failed");
+  NS_TEST_EXPECT_MSG_EQ ((int) result.value.type, (int) ArgType::I32, "Wrong result type");
+  NS_TEST_EXPECT_MSG_EQ (result.value.GetI32 (), 36, "Wrong sum of eight arguments");
+
+  result = app->ExecuteFunction (
+      "sum", "sum",
+      {WasmFaasValue::FromF64 (0.5), WasmFaasValue::FromF64 (0.25), WasmFaasValue::FromF64 (2)});
+  NS_TEST_EXPECT_MSG_EQ (result.status, WasmFaasResult::OK, "Call of three F64 failed");
+  NS_TEST_EXPECT_MSG_EQ (result.value.GetF64 (), 2.75, "Wrong sum of three F64");
+
+  result = app->ExecuteFunction ("div", "div",
+                                 {WasmFaasValue::FromI64 (-1ll << 40), WasmFaasValue::FromI64 (4)});
+  NS_TEST_EXPECT_MSG_EQ (result.value.GetI64 (), -(1ll << 38), "Wrong I64 quotient");
+
+  result = app->ExecuteFunction ("div", "div", {WasmFaasValue::FromI32 (1)});
+  NS_TEST_EXPECT_MSG_EQ (result.status, WasmFaasResult::FAILED, "Runtime failure not reported");
+
+  args.push_back (WasmFaasValue::FromI32 (9));
+  nCalls = WasmFaasRuntimeDouble::nTypedCalls;
+  result = app->ExecuteFunction ("sum", "sum", args);
+  NS_TEST_EXPECT_MSG_EQ (result.status, WasmFaasResult::FAILED, "Too many arguments accepted");
+  NS_TEST_EXPECT_MSG_EQ (WasmFaasRuntimeDouble::nTypedCalls, nCalls, "Too many arguments run");
+}
+
+void
+WasmFaasTypedInvocationTestCase::CallRemote (Ptr<CustomApp> app)
+{
+  WasmFaasValue a;
+  a.type = ArgType::V128;
+  a.lo = 0xffffffffffffffffULL;
+  a.hi = 0x1122334455667788ULL;
+  WasmFaasValue b = a;
+  b.lo = 2;
+  b.hi = 0x0100000000000001ULL;
+
+  auto result = app->ExecuteFunction ("sum", "sum", {a, b});
+  NS_TEST_EXPECT_MSG_EQ (result.status, WasmFaasResult::PENDING, "Module found on the caller");
+}
+
+void
+WasmFaasTypedInvocationTestCase::CallFetched (Ptr<CustomApp> app)
+{
+  auto result = app->ExecuteFunction (
+      "sum", "sum",
+      {WasmFaasValue::FromI64 (1), WasmFaasValue::FromI64 (2), WasmFaasValue::FromI64 (3)});
+  NS_TEST_EXPECT_MSG_EQ (result.status, WasmFaasResult::OK, "Fetched module not run locally");
+  NS_TEST_EXPECT_MSG_EQ (result.value.GetI64 (), 6, "Wrong sum of three I64");
+}
+
+void
+WasmFaasTypedInvocationTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  CsmaHelper csma;
+  auto devices = csma.Install (nodes);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper address ("10.1.1.0", "255.255.255.0");
+  address.Assign (devices);
+
+  CustomAppHelper helper (3000);
+  auto apps = helper.Install (nodes);
+  CustomAppHelper::RegisterFullMesh (nodes);
+
+  auto holder = CustomAppHelper::GetCustomApp (nodes.Get (0));
+  auto caller = CustomAppHelper::GetCustomApp (nodes.Get (1));
+  auto sum = get_static_module_data (StaticModuleList::WasmSum);
+  auto div = get_static_module_data (StaticModuleList::WasmDiv);
+  holder->RegisterWasmModule ((char *) "sum", sum);
+  holder->RegisterWasmModule ((char *) "div", div);
+  free_ffi_string (sum);
+  free_ffi_string (div);
+
+  caller->TraceConnectWithoutContext (
+      "InvocationCompleted",
+      MakeCallback (&WasmFaasTypedInvocationTestCase::InvocationCompleted, this));
+
+  apps.Start (Seconds (0));
+  apps.Stop (Seconds (10));
+  Simulator::Schedule (Seconds (1), &WasmFaasTypedInvocationTestCase::CallLocal, this, holder);
+  Simulator::Schedule (Seconds (2), &WasmFaasTypedInvocationTestCase::CallRemote, this, caller);
+  Simulator::Schedule (Seconds (5), &WasmFaasTypedInvocationTestCase::CallFetched, this, caller);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_completed.size (), 2, "Wrong number of completed invocations");
+  auto &remote = m_completed[0];
+  NS_TEST_ASSERT_MSG_EQ (remote.status, WasmFaasResult::OK, "Call on the peer failed");
+  NS_TEST_ASSERT_MSG_EQ ((int) remote.value.type, (int) ArgType::V128, "Wrong result type");
+  NS_TEST_ASSERT_MSG_EQ (remote.value.lo, 1, "Wrong low lane of the V128 sum");
+  NS_TEST_ASSERT_MSG_EQ (remote.value.hi, 0x1222334455667789ULL, "Wrong high lane of the V128 sum");
+
+  // The arguments the peer ran the function with went through the binary header
+  NS_TEST_ASSERT_MSG_EQ (m_remoteArgs.size (), 2, "Wrong argument count on the peer");
+  NS_TEST_ASSERT_MSG_EQ ((int) m_remoteArgs[1].value_type, (int) ArgType::V128,
+                         "Wrong argument type on the peer");
+  NS_TEST_ASSERT_MSG_EQ (m_remoteArgs[1].lo, 2, "Wrong low bits on the peer");
+  NS_TEST_ASSERT_MSG_EQ (m_remoteArgs[1].hi, 0x0100000000000001ULL, "Wrong high bits on the peer");
+  NS_TEST_ASSERT_MSG_EQ (m_completed[1].value.GetI64 (), 6, "Wrong result of the fetched module");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that modules and functions whose name collides with the ID of
+ * another name are refused
+ */
+class WasmFaasNameCollisionTestCase : public TestCase
+{
+public:
+  WasmFaasNameCollisionTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WasmFaasNameCollisionTestCase::WasmFaasNameCollisionTestCase ()
+  : TestCase ("Names colliding with another name are refused")
+{
+}
+
+void
+WasmFaasNameCollisionTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (1);
+  CustomAppHelper helper (3000);
+  helper.Install (nodes);
+  auto app = CustomAppHelper::GetCustomApp (nodes.Get (0));
+  auto sum = get_static_module_data (StaticModuleList::WasmSum);
+
+  // glbvp and yacxb have the same 32 bit FNV-1a hash
+  NS_TEST_ASSERT_MSG_EQ (app->RegisterWasmModule ((char *) "glbvp", sum), true,
+                         "Module not registered");
+  NS_TEST_ASSERT_MSG_EQ (app->RegisterWasmModule ((char *) "yacxb", sum), false,
+                         "Colliding module registered");
+  free_ffi_string (sum);
+
+  auto result = app->ExecuteFunction ("glbvp", "sum", {WasmFaasValue::FromI32 (1)});
+  NS_TEST_ASSERT_MSG_EQ (result.status, WasmFaasResult::OK, "Registered module not run");
+  result = app->ExecuteFunction ("yacxb", "sum", {WasmFaasValue::FromI32 (1)});
+  NS_TEST_ASSERT_MSG_EQ (result.status, WasmFaasResult::FAILED, "Colliding module called");
+  result = app->ExecuteFunction ("glbvp", "yacxb", {WasmFaasValue::FromI32 (1)});
+  NS_TEST_ASSERT_MSG_EQ (result.status, WasmFaasResult::FAILED, "Colliding function called");
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that the results of pure functions are reused without running them,
+ * and that the least recently used one is evicted once MemoCacheSize are kept
+ */
+class WasmFaasMemoTestCase : public TestCase
+{
+public:
+  WasmFaasMemoTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Check one call of a function of two I32 arguments.
+   * \param app the node holding the module
+   * \param module the module, named after the function
+   * \param a the first argument
+   * \param expected the expected result of the function with 2 as second argument
+   * \param run whether the function must reach the runtime
+   */
+  void Call (Ptr<CustomApp> app, std::string module, int32_t a, int32_t expected, bool run);
+};
+
+WasmFaasMemoTestCase::WasmFaasMemoTestCase ()
+  : TestCase ("Pure function results are reused and evicted least recently used first")
+{
+}
+
+void
+WasmFaasMemoTestCase::Call (Ptr<CustomApp> app, std::string module, int32_t a, int32_t expected,
+                            bool run)
+{
+  auto nCalls = WasmFaasRuntimeDouble::nTypedCalls;
+  auto result = app->ExecuteFunction (module, module,
+                                      {WasmFaasValue::FromI32 (a), WasmFaasValue::FromI32 (2)});
+  NS_TEST_EXPECT_MSG_EQ (result.status, WasmFaasResult::OK, module << " (" << a << ", 2) failed");
+  NS_TEST_EXPECT_MSG_EQ (result.value.GetI32 (), expected, "Wrong result of " << module);
+  NS_TEST_EXPECT_MSG_EQ (WasmFaasRuntimeDouble::nTypedCalls, nCalls + run,
+                         module << " (" << a << ", 2) " << (run ? "not run" : "run again"));
+}
+
+void
+WasmFaasMemoTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (1);
+  CustomAppHelper helper (3000);
+  helper.SetAttribute ("PureModules", StringValue ("sum"));
+  helper.SetAttribute ("MemoCacheSize", UintegerValue (2));
+  helper.Install (nodes);
+  auto app = CustomAppHelper::GetCustomApp (nodes.Get (0));
+  auto sum = get_static_module_data (StaticModuleList::WasmSum);
+  auto div = get_static_module_data (StaticModuleList::WasmDiv);
+  app->RegisterWasmModule ((char *) "sum", sum);
+  app->RegisterWasmModule ((char *) "div", div);
+  free_ffi_string (sum);
+  free_ffi_string (div);
+
+  Call (app, "sum", 1, 3, true);
+  Call (app, "sum", 1, 3, false);
+  Call (app, "div", 4, 2, true);
+  Call (app, "div", 4, 2, true);
+
+  // sum (1, 2) is used again after sum (2, 2), so sum (3, 2) evicts the latter
+  Call (app, "sum", 2, 4, true);
+  Call (app, "sum", 1, 3, false);
+  Call (app, "sum", 3, 5, true);
+  Call (app, "sum", 1, 3, false);
+  Call (app, "sum", 3, 5, false);
+  Call (app, "sum", 2, 4, true);
+
+  // A module no longer pure forgets its results
+  app->SetModulePure ("sum", false);
+  Call (app, "sum", 1, 3, true);
+  Call (app, "sum", 1, 3, true);
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * CustomApp invocation test suite
+ */
+class WasmFaasInvocationTestSuite : public TestSuite
+{
+public:
+  WasmFaasInvocationTestSuite ();
+};
+
+WasmFaasInvocationTestSuite::WasmFaasInvocationTestSuite ()
+  : TestSuite ("wasmfaas-invocation", UNIT)
+{
+  AddTestCase (new WasmFaasTypedInvocationTestCase, TestCase::QUICK);
+  AddTestCase (new WasmFaasNameCollisionTestCase, TestCase::QUICK);
+  AddTestCase (new WasmFaasMemoTestCase, TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static WasmFaasInvocationTestSuite g_wasmFaasInvocationTestSuite;
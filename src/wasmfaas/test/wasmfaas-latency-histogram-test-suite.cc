@@ -0,0 +1,161 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/nstime.h"
+#include "ns3/test.h"
+#include "ns3/wasmfaas-latency-histogram.h"
+
+using namespace ns3;
+
+/**
+ * \param precision the histogram precision
+ * \param value a latency in nanoseconds
+ * \return the highest latency of the bucket holding value, in nanoseconds
+ */
+static uint64_t
+GetBucketHighest (uint32_t precision, uint64_t value)
+{
+  // With a far larger second value the median is the bound of the bucket of value
+  WasmFaasLatencyHistogram histogram (precision);
+  histogram.Record (NanoSeconds (value));
+  histogram.Record (NanoSeconds ((int64_t) 1 << 50));
+  return histogram.GetPercentile (0.5).GetNanoSeconds ();
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check the bucket bounds of WasmFaasLatencyHistogram against its error bound
+ */
+class WasmFaasLatencyHistogramBucketTestCase : public TestCase
+{
+public:
+  WasmFaasLatencyHistogramBucketTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WasmFaasLatencyHistogramBucketTestCase::WasmFaasLatencyHistogramBucketTestCase ()
+  : TestCase ("Bucket bounds of WasmFaasLatencyHistogram")
+{
+}
+
+void
+WasmFaasLatencyHistogramBucketTestCase::DoRun (void)
+{
+  for (uint32_t precision : {2u, 7u, 10u})
+    {
+      uint64_t exact = (uint64_t) 1 << precision;
+      for (uint64_t value = 0; value < exact; value++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (GetBucketHighest (precision, value), value,
+                                 "Value below 2^precision not kept exactly");
+        }
+
+      for (uint32_t bit = precision; bit < 40; bit++)
+        {
+          uint64_t base = (uint64_t) 1 << bit;
+          for (uint64_t value : {base, base + 1, base + base / 3, 2 * base - 1})
+            {
+              uint64_t highest = GetBucketHighest (precision, value);
+              NS_TEST_ASSERT_MSG_GT_OR_EQ (highest, value, "Bucket bound below its value");
+              NS_TEST_ASSERT_MSG_LT_OR_EQ ((double) (highest - value) / value,
+                                           1.0 / (1 << (precision - 1)),
+                                           "Bucket wider than the precision allows");
+              // The bound belongs to the bucket, the next value starts another one
+              NS_TEST_ASSERT_MSG_EQ (GetBucketHighest (precision, highest), highest,
+                                     "Bucket bound outside its bucket");
+              NS_TEST_ASSERT_MSG_GT (GetBucketHighest (precision, highest + 1), highest,
+                                     "Buckets overlap");
+            }
+        }
+    }
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check the statistics of WasmFaasLatencyHistogram, merged histograms included
+ */
+class WasmFaasLatencyHistogramStatisticsTestCase : public TestCase
+{
+public:
+  WasmFaasLatencyHistogramStatisticsTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WasmFaasLatencyHistogramStatisticsTestCase::WasmFaasLatencyHistogramStatisticsTestCase ()
+  : TestCase ("Statistics of WasmFaasLatencyHistogram")
+{
+}
+
+void
+WasmFaasLatencyHistogramStatisticsTestCase::DoRun (void)
+{
+  WasmFaasLatencyHistogram empty;
+  NS_TEST_ASSERT_MSG_EQ (empty.GetCount (), 0, "Wrong count");
+  NS_TEST_ASSERT_MSG_EQ (empty.GetPercentile (0.99), Time (0), "Empty percentile not 0");
+  NS_TEST_ASSERT_MSG_EQ (empty.GetMean (), Time (0), "Empty mean not 0");
+
+  WasmFaasLatencyHistogram low;
+  WasmFaasLatencyHistogram high;
+  for (int64_t i = 1; i <= 100; i++)
+    {
+      low.Record (MicroSeconds (i));
+      high.Record (MilliSeconds (i));
+    }
+  low.Record (Seconds (-1));
+  NS_TEST_ASSERT_MSG_EQ (low.GetMin (), Time (0), "A negative latency does not count as 0");
+  NS_TEST_ASSERT_MSG_EQ (low.GetMax (), MicroSeconds (100), "Wrong max");
+
+  low.Merge (high);
+  NS_TEST_ASSERT_MSG_EQ (low.GetCount (), 201, "Wrong merged count");
+  NS_TEST_ASSERT_MSG_EQ (low.GetMax (), MilliSeconds (100), "Wrong merged max");
+  NS_TEST_ASSERT_MSG_EQ (low.GetPercentile (1), MilliSeconds (100), "p100 is not the max");
+  NS_TEST_ASSERT_MSG_EQ (low.GetPercentile (0), Time (0), "p0 is not the min");
+
+  // The median is the 101st value, 100us, within 2^-6 at the default precision
+  auto median = low.GetPercentile (0.5);
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (median, MicroSeconds (100), "Median below its value");
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (median, NanoSeconds (101563), "Median beyond the precision");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * WasmFaasLatencyHistogram test suite
+ */
+class WasmFaasLatencyHistogramTestSuite : public TestSuite
+{
+public:
+  WasmFaasLatencyHistogramTestSuite ();
+};
+
+WasmFaasLatencyHistogramTestSuite::WasmFaasLatencyHistogramTestSuite ()
+  : TestSuite ("wasmfaas-latency-histogram", UNIT)
+{
+  AddTestCase (new WasmFaasLatencyHistogramBucketTestCase, TestCase::QUICK);
+  AddTestCase (new WasmFaasLatencyHistogramStatisticsTestCase, TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static WasmFaasLatencyHistogramTestSuite g_wasmFaasLatencyHistogramTestSuite;
@@ -0,0 +1,170 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <string>
+#include "ns3/test.h"
+#include "ns3/wasmfaas-header.h"
+#include "ns3/wasmfaas-module-digest.h"
+
+using namespace ns3;
+
+/**
+ * \param i a module index
+ * \return the ID of the module named after i
+ */
+static uint32_t
+GetModuleId (uint32_t i)
+{
+  return WasmFaasHeader::GetNameId ("module-" + std::to_string (i));
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check Add and MayContain of WasmFaasModuleDigest: no module added is
+ * ever missed, and few others are claimed
+ */
+class WasmFaasModuleDigestMembershipTestCase : public TestCase
+{
+public:
+  WasmFaasModuleDigestMembershipTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WasmFaasModuleDigestMembershipTestCase::WasmFaasModuleDigestMembershipTestCase ()
+  : TestCase ("Add and MayContain of WasmFaasModuleDigest")
+{
+}
+
+void
+WasmFaasModuleDigestMembershipTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasModuleDigest (10).GetNBits (), 16, "Size not rounded up");
+
+  WasmFaasModuleDigest digest (4096, 3);
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (digest.MayContain (GetModuleId (i)), false,
+                             "Empty digest claims module " << i);
+    }
+
+  const uint32_t nAdded = 1000;
+  for (uint32_t i = 0; i < nAdded; i++)
+    {
+      digest.Add (GetModuleId (i));
+    }
+  for (uint32_t i = 0; i < nAdded; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (digest.MayContain (GetModuleId (i)), true, "Missed module " << i);
+    }
+
+  // About (1 - e^(-3 * 1000 / 4096))^3 = 14% of the others are claimed
+  uint32_t falsePositives = 0;
+  const uint32_t nOthers = 10000;
+  for (uint32_t i = nAdded; i < nAdded + nOthers; i++)
+    {
+      falsePositives += digest.MayContain (GetModuleId (i));
+    }
+  NS_TEST_ASSERT_MSG_LT ((double) falsePositives / nOthers, 0.2, "Too many false positives");
+  NS_TEST_ASSERT_MSG_GT (falsePositives, 0, "Digest too precise for its size");
+
+  digest.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (digest.MayContain (GetModuleId (0)), false, "Clear kept a module");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check Serialize and Deserialize of WasmFaasModuleDigest
+ */
+class WasmFaasModuleDigestSerializationTestCase : public TestCase
+{
+public:
+  WasmFaasModuleDigestSerializationTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WasmFaasModuleDigestSerializationTestCase::WasmFaasModuleDigestSerializationTestCase ()
+  : TestCase ("Serialize and Deserialize a WasmFaasModuleDigest")
+{
+}
+
+void
+WasmFaasModuleDigestSerializationTestCase::DoRun (void)
+{
+  WasmFaasModuleDigest sent (512, 5);
+  for (uint32_t i = 0; i < 50; i++)
+    {
+      sent.Add (GetModuleId (i));
+    }
+  std::string data;
+  sent.Serialize (data);
+  NS_TEST_ASSERT_MSG_EQ (data.size (), 1 + 512 / 8, "Wrong wire size");
+  NS_TEST_ASSERT_MSG_EQ ((uint32_t) (uint8_t) data[0], 5, "Wrong hash count");
+
+  // The hash count comes from the wire, the size must match
+  WasmFaasModuleDigest received (512, 1);
+  NS_TEST_ASSERT_MSG_EQ (received.Deserialize (data), true, "Digest rejected");
+  for (uint32_t i = 0; i < 200; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (received.MayContain (GetModuleId (i)),
+                             sent.MayContain (GetModuleId (i)), "Module " << i << " differs");
+    }
+  std::string again;
+  received.Serialize (again);
+  NS_TEST_ASSERT_MSG_EQ (again, data, "Round trip changed the digest");
+
+  // Rejected data leaves the digest as it was
+  WasmFaasModuleDigest other (256);
+  other.Add (GetModuleId (0));
+  NS_TEST_ASSERT_MSG_EQ (other.Deserialize (data), false, "Digest of another size accepted");
+  NS_TEST_ASSERT_MSG_EQ (other.Deserialize (""), false, "Empty data accepted");
+  NS_TEST_ASSERT_MSG_EQ (other.Deserialize (std::string (1, '\x03')), false,
+                         "Digest without bits accepted");
+  NS_TEST_ASSERT_MSG_EQ (other.Deserialize (std::string (1 + 256 / 8, '\0')), false,
+                         "Digest without hashes accepted");
+  NS_TEST_ASSERT_MSG_EQ (other.GetNBits (), 256, "Rejected data changed the size");
+  NS_TEST_ASSERT_MSG_EQ (other.MayContain (GetModuleId (0)), true,
+                         "Rejected data changed the bits");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * WasmFaasModuleDigest test suite
+ */
+class WasmFaasModuleDigestTestSuite : public TestSuite
+{
+public:
+  WasmFaasModuleDigestTestSuite ();
+};
+
+WasmFaasModuleDigestTestSuite::WasmFaasModuleDigestTestSuite ()
+  : TestSuite ("wasmfaas-module-digest", UNIT)
+{
+  AddTestCase (new WasmFaasModuleDigestMembershipTestCase, TestCase::QUICK);
+  AddTestCase (new WasmFaasModuleDigestSerializationTestCase, TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static WasmFaasModuleDigestTestSuite g_wasmFaasModuleDigestTestSuite;
@@ -0,0 +1,271 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/boolean.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/custom-app.h"
+#include "ns3/custom-app-helper.h"
+#include "ns3/wasmfaas-module-store.h"
+#include "wasmfaas-runtime-double.h"
+
+namespace ns3 {
+
+/**
+ * \param moduleData module data
+ * \return the artifact WasmModuleStore writes for moduleData compiled by the runtime double
+ */
+static std::string
+GetArtifact (const std::string &moduleData)
+{
+  std::string artifact = "WFMA";
+  uint64_t fields[3] = {1, WasmModuleStore::GetHash (moduleData), moduleData.size ()};
+  uint32_t sizes[3] = {4, 8, 8};
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      for (uint32_t j = 0; j < sizes[i]; j++)
+        {
+          artifact.push_back ((char) (fields[i] >> (8 * j)));
+        }
+    }
+  return artifact + "WFDA" + moduleData;
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that WasmModuleStore compiles a module registered on many nodes
+ * once when sharing is enabled, tells apart modules of the same hash and
+ * releases the compiled modules when cleared
+ */
+class WasmModuleStoreTestCase : public TestCase
+{
+public:
+  WasmModuleStoreTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WasmModuleStoreTestCase::WasmModuleStoreTestCase ()
+  : TestCase ("WasmModuleStore compiles each module once")
+{
+}
+
+void
+WasmModuleStoreTestCase::DoRun (void)
+{
+  WasmModuleStore::Clear ();
+  auto nCompiles = WasmFaasRuntimeDouble::nCompiles;
+
+  // Without WasmModuleSharedCompile every node compiles its own module
+  NodeContainer nodes;
+  nodes.Create (4);
+  CustomAppHelper helper (3000);
+  helper.Install (nodes);
+  std::string sum = "AGFzbQEAAAB0ZXN0LXN0b3JlLXN1bQ==";
+  CustomAppHelper::GetCustomApp (nodes.Get (0))
+      ->RegisterWasmModule ((char *) "sum", (char *) sum.c_str ());
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasRuntimeDouble::nCompiles, nCompiles,
+                         "Module compiled while sharing is disabled");
+  NS_TEST_ASSERT_MSG_EQ (WasmModuleStore::GetNCompiled (), 0,
+                         "Module kept while sharing is disabled");
+
+  Config::SetGlobal ("WasmModuleSharedCompile", BooleanValue (true));
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      CustomAppHelper::GetCustomApp (nodes.Get (i))
+          ->RegisterWasmModule ((char *) "sum", (char *) sum.c_str ());
+    }
+  NS_TEST_ASSERT_MSG_EQ (WasmModuleStore::GetNCompiled (), 1, "Module compiled per node");
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasRuntimeDouble::nCompiles, nCompiles + 1,
+                         "Runtime compiled the module per node");
+  NS_TEST_ASSERT_MSG_EQ (WasmModuleStore::GetNReused (), nodes.GetN () - 1,
+                         "Wrong number of reused modules");
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      // Every node runs the module registered from the shared compiled one
+      auto result = CustomAppHelper::GetCustomApp (nodes.Get (i))
+                        ->ExecuteFunction ("sum", "sum",
+                                           {WasmFaasValue::FromI32 (1), WasmFaasValue::FromI32 (2)});
+      NS_TEST_ASSERT_MSG_EQ (result.status, WasmFaasResult::OK, "Module missing on node " << i);
+      NS_TEST_ASSERT_MSG_EQ (result.value.GetI32 (), 3, "Wrong result on node " << i);
+    }
+
+  std::string div = "AGFzbQEAAAB0ZXN0LXN0b3JlLWRpdg==";
+  CustomAppHelper::GetCustomApp (nodes.Get (0))
+      ->RegisterWasmModule ((char *) "div", (char *) div.c_str ());
+  NS_TEST_ASSERT_MSG_EQ (WasmModuleStore::GetNCompiled (), 2, "Other content not compiled");
+
+  // Modules of the same hash share a bucket but never a compiled module
+  uint64_t hash = WasmModuleStore::GetHash (sum);
+  auto first = WasmModuleStore::GetHandle (sum, hash);
+  auto second = WasmModuleStore::GetHandle (div, hash);
+  NS_TEST_ASSERT_MSG_EQ (WasmModuleStore::GetNCompiled (), 3, "Colliding module not compiled");
+  NS_TEST_ASSERT_MSG_NE (first, second, "Colliding modules share a compiled module");
+  NS_TEST_ASSERT_MSG_EQ (WasmModuleStore::GetHandle (sum, hash), first, "Wrong module reused");
+  NS_TEST_ASSERT_MSG_EQ (WasmModuleStore::GetHandle (div, hash), second, "Wrong module reused");
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasRuntimeDouble::compiled[second - 1], div,
+                         "Wrong colliding module compiled");
+  NS_TEST_ASSERT_MSG_EQ (WasmModuleStore::GetNCompiled (), 3, "Colliding module compiled again");
+
+  // Failed compilations are not kept, the next registration tries again
+  nCompiles = WasmFaasRuntimeDouble::nCompiles;
+  NS_TEST_ASSERT_MSG_EQ (WasmModuleStore::Register (1, "empty", ""), false,
+                         "Module failing to compile registered");
+  NS_TEST_ASSERT_MSG_EQ (WasmModuleStore::Register (1, "empty", ""), false,
+                         "Module failing to compile registered");
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasRuntimeDouble::nCompiles, nCompiles + 2,
+                         "Failed compilation kept");
+  NS_TEST_ASSERT_MSG_EQ (WasmModuleStore::GetNCompiled (), 3, "Failed compilation counted");
+
+  // Clearing the store releases every compiled module
+  auto nReleased = WasmFaasRuntimeDouble::nReleased;
+  WasmModuleStore::Clear ();
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasRuntimeDouble::nReleased, nReleased + 3,
+                         "Compiled modules not released");
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasRuntimeDouble::compiled[first - 1], "", "Module not released");
+  NS_TEST_ASSERT_MSG_EQ (WasmModuleStore::GetNCompiled (), 0, "Clear kept the counters");
+  Config::SetGlobal ("WasmModuleSharedCompile", BooleanValue (false));
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that compiled modules written to WasmModuleArtifactDirectory are
+ * loaded by a later store instead of being compiled again, unless their
+ * header does not match the module
+ */
+class WasmModuleStoreArtifactTestCase : public TestCase
+{
+public:
+  WasmModuleStoreArtifactTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WasmModuleStoreArtifactTestCase::WasmModuleStoreArtifactTestCase ()
+  : TestCase ("WasmModuleStore reloads the artifacts it wrote")
+{
+}
+
+void
+WasmModuleStoreArtifactTestCase::DoRun (void)
+{
+  auto directory = CreateTempDirFilename ("wasmfaas-artifacts");
+  Config::SetGlobal ("WasmModuleSharedCompile", BooleanValue (true));
+  Config::SetGlobal ("WasmModuleArtifactDirectory", StringValue (directory));
+  WasmModuleStore::Clear ();
+
+  std::string sum = "AGFzbQEAAAB0ZXN0LWFydGlmYWN0LXN1bQ==";
+  std::ostringstream path;
+  path << directory << "/" << std::hex << WasmModuleStore::GetHash (sum) << std::dec << "-"
+       << sum.size () << "-double-1.cwasm";
+
+  auto nCompiles = WasmFaasRuntimeDouble::nCompiles;
+  auto runtime = initialize_runtime ();
+  NS_TEST_ASSERT_MSG_EQ (WasmModuleStore::Register (runtime, "sum", sum), true,
+                         "Module not registered");
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasRuntimeDouble::nCompiles, nCompiles + 1, "Module not compiled");
+  NS_TEST_ASSERT_MSG_EQ (WasmModuleStore::GetNArtifactsLoaded (), 0, "Artifact loaded early");
+  std::ifstream file (path.str (), std::ios::binary);
+  std::string artifact ((std::istreambuf_iterator<char> (file)), std::istreambuf_iterator<char> ());
+  file.close ();
+  NS_TEST_ASSERT_MSG_EQ (artifact, GetArtifact (sum), "Wrong artifact written to " << path.str ());
+
+  // A fresh store, as in a later process, loads the artifact
+  WasmModuleStore::Clear ();
+  auto nLoaded = WasmFaasRuntimeDouble::nArtifactsLoaded;
+  runtime = initialize_runtime ();
+  NS_TEST_ASSERT_MSG_EQ (WasmModuleStore::Register (runtime, "sum", sum), true,
+                         "Module not registered from its artifact");
+  NS_TEST_ASSERT_MSG_EQ (WasmModuleStore::GetNArtifactsLoaded (), 1, "Artifact not loaded");
+  NS_TEST_ASSERT_MSG_EQ (WasmModuleStore::GetNCompiled (), 1, "Loaded module not counted");
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasRuntimeDouble::nCompiles, nCompiles + 1,
+                         "Module compiled despite its artifact");
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasRuntimeDouble::nArtifactsLoaded, nLoaded + 1,
+                         "Runtime did not load the artifact");
+  NS_TEST_ASSERT_MSG_EQ (is_module_registered (runtime, "sum"), true, "Module not in the runtime");
+
+  // The loaded module is released before its artifact is unmapped
+  auto nReleased = WasmFaasRuntimeDouble::nReleased;
+  WasmModuleStore::Clear ();
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasRuntimeDouble::nReleased, nReleased + 1,
+                         "Loaded module not released");
+
+  // Unusable artifacts, or artifacts of another module, are compiled again and replaced
+  std::string other = artifact;
+  other[8] ^= 1;
+  std::vector<std::string> rejected = {"not an artifact", artifact.substr (0, 24), other,
+                                       "WFMA" + artifact.substr (24)};
+  for (uint32_t i = 0; i < rejected.size (); i++)
+    {
+      std::ofstream corrupt (path.str (), std::ios::binary | std::ios::trunc);
+      corrupt << rejected[i];
+      corrupt.close ();
+      nCompiles = WasmFaasRuntimeDouble::nCompiles;
+      NS_TEST_ASSERT_MSG_EQ (WasmModuleStore::Register (initialize_runtime (), "sum", sum), true,
+                             "Module not registered past corrupt artifact " << i);
+      NS_TEST_ASSERT_MSG_EQ (WasmModuleStore::GetNArtifactsLoaded (), 0,
+                             "Corrupt artifact " << i << " loaded");
+      NS_TEST_ASSERT_MSG_EQ (WasmFaasRuntimeDouble::nCompiles, nCompiles + 1,
+                             "Module not compiled past corrupt artifact " << i);
+      file.open (path.str (), std::ios::binary);
+      artifact.assign (std::istreambuf_iterator<char> (file), std::istreambuf_iterator<char> ());
+      file.close ();
+      NS_TEST_ASSERT_MSG_EQ (artifact, GetArtifact (sum),
+                             "Corrupt artifact " << i << " not replaced");
+      WasmModuleStore::Clear ();
+    }
+
+  Config::SetGlobal ("WasmModuleArtifactDirectory", StringValue (""));
+  WasmModuleStore::Clear ();
+  Config::SetGlobal ("WasmModuleSharedCompile", BooleanValue (false));
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * WasmModuleStore test suite
+ */
+class WasmModuleStoreTestSuite : public TestSuite
+{
+public:
+  WasmModuleStoreTestSuite ();
+};
+
+WasmModuleStoreTestSuite::WasmModuleStoreTestSuite () : TestSuite ("wasmfaas-module-store", UNIT)
+{
+  AddTestCase (new WasmModuleStoreTestCase, TestCase::QUICK);
+  AddTestCase (new WasmModuleStoreArtifactTestCase, TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static WasmModuleStoreTestSuite g_wasmModuleStoreTestSuite;
+
+} // namespace ns3
@@ -0,0 +1,183 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <string>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/wasmfaas-module-transfer.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check the window of WasmFaasChunkSender: a lost chunk holds it while the
+ * chunks after it are acknowledged, and only unacknowledged chunks are sent
+ * again
+ */
+class WasmFaasChunkSenderTestCase : public TestCase
+{
+public:
+  WasmFaasChunkSenderTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WasmFaasChunkSenderTestCase::WasmFaasChunkSenderTestCase ()
+  : TestCase ("Sliding window of WasmFaasChunkSender")
+{
+}
+
+void
+WasmFaasChunkSenderTestCase::DoRun (void)
+{
+  WasmFaasChunkSender sender;
+  sender.Start (std::string (2500, 'x'), 1000);
+  NS_TEST_ASSERT_MSG_EQ (sender.GetNChunks (), 3, "Wrong chunk count");
+  NS_TEST_ASSERT_MSG_EQ (sender.GetSize (), 2500, "Wrong module size");
+
+  uint32_t seq;
+  NS_TEST_ASSERT_MSG_EQ (sender.NextChunk (2, seq), true, "First chunk held");
+  NS_TEST_EXPECT_MSG_EQ (seq, 0, "Chunks out of order");
+  NS_TEST_ASSERT_MSG_EQ (sender.NextChunk (2, seq), true, "Second chunk held");
+  NS_TEST_EXPECT_MSG_EQ (seq, 1, "Chunks out of order");
+  NS_TEST_ASSERT_MSG_EQ (sender.NextChunk (2, seq), false, "Window overrun");
+
+  // Chunk 0 is lost, the ack of chunk 1 does not open the window
+  NS_TEST_EXPECT_MSG_EQ (sender.Acknowledge (1), true, "Ack ignored");
+  NS_TEST_EXPECT_MSG_EQ (sender.Acknowledge (1), false, "Duplicate ack counted");
+  NS_TEST_EXPECT_MSG_EQ (sender.Acknowledge (3), false, "Ack past the module counted");
+  NS_TEST_ASSERT_MSG_EQ (sender.NextChunk (2, seq), false, "Window opened past a lost chunk");
+  auto unacked = sender.GetUnacknowledged ();
+  NS_TEST_ASSERT_MSG_EQ (unacked.size (), 1, "Wrong chunks to send again");
+  NS_TEST_EXPECT_MSG_EQ (unacked[0], 0, "Wrong chunk to send again");
+
+  NS_TEST_EXPECT_MSG_EQ (sender.Acknowledge (0), true, "Ack ignored");
+  NS_TEST_ASSERT_MSG_EQ (sender.NextChunk (2, seq), true, "Window not opened");
+  NS_TEST_EXPECT_MSG_EQ (seq, 2, "Chunks out of order");
+  NS_TEST_EXPECT_MSG_EQ (sender.NextChunk (2, seq), false, "Chunk past the module");
+
+  WasmFaasChunkHeader chunk;
+  uint32_t size;
+  sender.GetChunk (2, chunk, size);
+  NS_TEST_EXPECT_MSG_EQ (size, 500, "Wrong size of the last chunk");
+  NS_TEST_EXPECT_MSG_EQ (chunk.GetSeq (), 2, "Wrong chunk position");
+  NS_TEST_EXPECT_MSG_EQ (chunk.GetModuleSize (), 2500, "Wrong chunk module size");
+  NS_TEST_EXPECT_MSG_EQ (sender.IsComplete (), false, "Complete before the last ack");
+  sender.Acknowledge (2);
+  NS_TEST_EXPECT_MSG_EQ (sender.IsComplete (), true, "Incomplete after the last ack");
+  NS_TEST_EXPECT_MSG_EQ (sender.GetNAcknowledged (), 3, "Wrong ack count");
+
+  // A module without bytes still takes one chunk
+  sender.Start ("", 1000);
+  NS_TEST_ASSERT_MSG_EQ (sender.GetNChunks (), 1, "Empty module takes no chunk");
+  NS_TEST_ASSERT_MSG_EQ (sender.NextChunk (1, seq), true, "Empty chunk held");
+  sender.GetChunk (seq, chunk, size);
+  NS_TEST_EXPECT_MSG_EQ (size, 0, "Empty module has bytes");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that WasmFaasChunkReceiver reassembles chunks received in any
+ * order, once each, and restarts on a chunk of another layout
+ */
+class WasmFaasChunkReceiverTestCase : public TestCase
+{
+public:
+  WasmFaasChunkReceiverTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WasmFaasChunkReceiverTestCase::WasmFaasChunkReceiverTestCase ()
+  : TestCase ("Reassembly of WasmFaasChunkReceiver")
+{
+}
+
+void
+WasmFaasChunkReceiverTestCase::DoRun (void)
+{
+  std::string module = "0123456789";
+  WasmFaasChunkSender sender;
+  sender.Start (module, 4);
+  std::vector<WasmFaasChunkHeader> chunks (3);
+  std::vector<std::string> data (3);
+  for (uint32_t seq = 0; seq < 3; seq++)
+    {
+      uint32_t size;
+      auto bytes = sender.GetChunk (seq, chunks[seq], size);
+      data[seq].assign ((const char *) bytes, size);
+      NS_TEST_ASSERT_MSG_EQ (WasmFaasChunkReceiver::IsValid (chunks[seq], 10), true,
+                             "Chunk " << seq << " rejected");
+    }
+  NS_TEST_EXPECT_MSG_EQ (WasmFaasChunkReceiver::IsValid (chunks[0], 9), false,
+                         "Module larger than the limit accepted");
+  WasmFaasChunkHeader past = chunks[2];
+  past.SetSeq (3);
+  NS_TEST_EXPECT_MSG_EQ (WasmFaasChunkReceiver::IsValid (past, 10), false,
+                         "Chunk past the module accepted");
+  WasmFaasChunkHeader empty = chunks[0];
+  empty.SetChunkSize (0);
+  NS_TEST_EXPECT_MSG_EQ (WasmFaasChunkReceiver::IsValid (empty, 10), false,
+                         "Chunk without size accepted");
+
+  WasmFaasChunkReceiver receiver;
+  NS_TEST_EXPECT_MSG_EQ (receiver.IsComplete (), false, "Complete before any chunk");
+  NS_TEST_EXPECT_MSG_EQ (receiver.Receive (chunks[2], data[2]), true, "Chunk 2 dropped");
+  NS_TEST_EXPECT_MSG_EQ (receiver.Receive (chunks[0], data[0]), true, "Chunk 0 dropped");
+  NS_TEST_EXPECT_MSG_EQ (receiver.Receive (chunks[0], data[0]), false, "Duplicate stored");
+  NS_TEST_EXPECT_MSG_EQ (receiver.IsComplete (), false, "Complete with a chunk missing");
+
+  // The sender restarted with another chunk size, the reassembly restarts too
+  WasmFaasChunkHeader other = chunks[0];
+  other.SetChunkSize (5);
+  NS_TEST_EXPECT_MSG_EQ (receiver.Receive (other, "01234"), true, "Restarted chunk dropped");
+  NS_TEST_EXPECT_MSG_EQ (receiver.GetNReceived (), 1, "Reassembly not restarted");
+
+  receiver.Clear ();
+  receiver.Receive (chunks[1], data[1]);
+  receiver.Receive (chunks[2], data[2]);
+  receiver.Receive (chunks[0], data[0]);
+  NS_TEST_ASSERT_MSG_EQ (receiver.IsComplete (), true, "Incomplete with every chunk");
+  NS_TEST_EXPECT_MSG_EQ (receiver.GetData (), module, "Module not reassembled");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Chunked module transfer test suite
+ */
+class WasmFaasModuleTransferTestSuite : public TestSuite
+{
+public:
+  WasmFaasModuleTransferTestSuite ();
+};
+
+WasmFaasModuleTransferTestSuite::WasmFaasModuleTransferTestSuite ()
+  : TestSuite ("wasmfaas-module-transfer", UNIT)
+{
+  AddTestCase (new WasmFaasChunkSenderTestCase, TestCase::QUICK);
+  AddTestCase (new WasmFaasChunkReceiverTestCase, TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static WasmFaasModuleTransferTestSuite g_wasmFaasModuleTransferTestSuite;
@@ -0,0 +1,1410 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <limits>
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/pointer.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/enum.h"
+#include "ns3/seq-ts-header.h"
+#include "ns3/error-model.h"
+#include "ns3/ethernet-header.h"
+#include "ns3/node-container.h"
+#include "ns3/csma-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/custom-app.h"
+#include "ns3/custom-app-helper.h"
+#include "ns3/wasmfaas-batcher.h"
+#include "ns3/wasmfaas-cache-policy.h"
+#include "ns3/wasmfaas-cost-model.h"
+#include "ns3/wasmfaas-event-log.h"
+#include "wasmfaas-runtime-double.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup customapp-test
+ *
+ * Drop IPv4 frames received by a CSMA device, past the first ones, and no
+ * ARP frame
+ */
+class WasmFaasDropIpv4ErrorModel : public ErrorModel
+{
+public:
+  /**
+   * \param nDrops the number of IPv4 frames to drop
+   * \param nSkips the number of IPv4 frames to let through before the first drop
+   */
+  WasmFaasDropIpv4ErrorModel (uint32_t nDrops, uint32_t nSkips = 0)
+    : m_nDrops (nDrops), m_nSkips (nSkips)
+  {
+  }
+
+private:
+  virtual bool
+  DoCorrupt (Ptr<Packet> p)
+  {
+    EthernetHeader header (false);
+    p->PeekHeader (header);
+    if (header.GetLengthType () != 0x0800 || m_nDrops == 0)
+      {
+        return false;
+      }
+    if (m_nSkips > 0)
+      {
+        m_nSkips--;
+        return false;
+      }
+    m_nDrops--;
+    return true;
+  }
+
+  virtual void
+  DoReset (void)
+  {
+  }
+
+  uint32_t m_nDrops; //!< IPv4 frames left to drop
+  uint32_t m_nSkips; //!< IPv4 frames left to let through before the first drop
+};
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Base of the request tests: CustomApp nodes on one CSMA link logging to
+ * one event log, and the results of the invocations of node 0
+ */
+class WasmFaasRequestTestCase : public TestCase
+{
+public:
+  /**
+   * \param name the test name
+   * \param nNodes the number of nodes
+   */
+  WasmFaasRequestTestCase (std::string name, uint32_t nNodes);
+
+protected:
+  /**
+   * \brief Build the nodes and install the applications, without peers.
+   * \param helper the helper installing the applications
+   */
+  void Setup (CustomAppHelper &helper);
+
+  /**
+   * \brief Call sum with two arguments on node 0.
+   */
+  void CallSum (void);
+
+  /**
+   * \brief Record a completed invocation of node 0.
+   * \param result the invocation result
+   */
+  void InvocationCompleted (const WasmFaasResult &result);
+
+  /**
+   * \brief Run the simulation and flush the event log.
+   */
+  void Run (void);
+
+  /**
+   * \param node the node ID
+   * \param type the event type
+   * \return the number of events of this type logged by the node
+   */
+  uint32_t CountEvents (uint32_t node, WasmFaasEventLog::EventType type);
+
+  /**
+   * \param node the node ID
+   * \param type the event type
+   * \return the times of the events of this type logged by the node, in order
+   */
+  std::vector<Time> GetEventTimes (uint32_t node, WasmFaasEventLog::EventType type);
+
+  NodeContainer m_nodes; //!< Nodes
+  Ipv4InterfaceContainer m_interfaces; //!< Addresses of the nodes
+  std::vector<WasmFaasResult> m_completed; //!< Results of node 0
+  std::vector<Time> m_completedAt; //!< When the results of node 0 came
+
+private:
+  uint32_t m_nNodes; //!< Number of nodes
+  ApplicationContainer m_apps; //!< The CustomApp of every node
+  std::string m_logName; //!< Event log file name
+  Ptr<WasmFaasEventLog> m_log; //!< Event log
+};
+
+WasmFaasRequestTestCase::WasmFaasRequestTestCase (std::string name, uint32_t nNodes)
+  : TestCase (name), m_nNodes (nNodes)
+{
+}
+
+void
+WasmFaasRequestTestCase::Setup (CustomAppHelper &helper)
+{
+  m_nodes.Create (m_nNodes);
+  CsmaHelper csma;
+  auto devices = csma.Install (m_nodes);
+  InternetStackHelper internet;
+  internet.Install (m_nodes);
+  Ipv4AddressHelper address ("10.1.1.0", "255.255.255.0");
+  m_interfaces = address.Assign (devices);
+
+  m_logName = CreateTempDirFilename ("wasmfaas-events.bin");
+  m_log = CreateObjectWithAttributes<WasmFaasEventLog> ("FileName", StringValue (m_logName));
+  helper.SetAttribute ("EventLog", PointerValue (m_log));
+  m_apps = helper.Install (m_nodes);
+  m_apps.Start (Seconds (0));
+  m_apps.Stop (Seconds (30));
+
+  CustomAppHelper::GetCustomApp (m_nodes.Get (0))
+      ->TraceConnectWithoutContext (
+          "InvocationCompleted",
+          MakeCallback (&WasmFaasRequestTestCase::InvocationCompleted, this));
+}
+
+void
+WasmFaasRequestTestCase::CallSum (void)
+{
+  auto result = CustomAppHelper::GetCustomApp (m_nodes.Get (0))
+                    ->ExecuteFunction ("sum", "sum",
+                                       {WasmFaasValue::FromI32 (20), WasmFaasValue::FromI32 (22)});
+  NS_TEST_EXPECT_MSG_EQ (result.status, WasmFaasResult::PENDING, "Module found on the caller");
+}
+
+void
+WasmFaasRequestTestCase::InvocationCompleted (const WasmFaasResult &result)
+{
+  m_completed.push_back (result);
+  m_completedAt.push_back (Simulator::Now ());
+}
+
+void
+WasmFaasRequestTestCase::Run (void)
+{
+  Simulator::Schedule (Seconds (1), &WasmFaasRequestTestCase::CallSum, this);
+  Simulator::Run ();
+  m_log->Dispose ();
+  Simulator::Destroy ();
+}
+
+uint32_t
+WasmFaasRequestTestCase::CountEvents (uint32_t node, WasmFaasEventLog::EventType type)
+{
+  return GetEventTimes (node, type).size ();
+}
+
+std::vector<Time>
+WasmFaasRequestTestCase::GetEventTimes (uint32_t node, WasmFaasEventLog::EventType type)
+{
+  std::ifstream file (m_logName, std::ios::binary);
+  std::vector<Time> times;
+  WasmFaasEventLog::Record record;
+  if (WasmFaasEventLog::ReadFileHeader (file))
+    {
+      while (WasmFaasEventLog::ReadRecord (file, record))
+        {
+          if (record.node == node && record.type == type)
+            {
+              times.push_back (NanoSeconds (record.time));
+            }
+        }
+    }
+  return times;
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that a request whose reply was lost is sent again, and that the
+ * holder answers the retry without running the function again
+ */
+class WasmFaasRequestRetryTestCase : public WasmFaasRequestTestCase
+{
+public:
+  WasmFaasRequestRetryTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WasmFaasRequestRetryTestCase::WasmFaasRequestRetryTestCase ()
+  : WasmFaasRequestTestCase ("A lost reply is retried and the function runs once", 2)
+{
+}
+
+void
+WasmFaasRequestRetryTestCase::DoRun (void)
+{
+  CustomAppHelper helper (3000);
+  Setup (helper);
+  CustomAppHelper::RegisterFullMesh (m_nodes);
+  auto sum = get_static_module_data (StaticModuleList::WasmSum);
+  CustomAppHelper::GetCustomApp (m_nodes.Get (1))->RegisterWasmModule ((char *) "sum", sum);
+  free_ffi_string (sum);
+  m_nodes.Get (0)->GetDevice (0)->SetAttribute (
+      "ReceiveErrorModel", PointerValue (CreateObject<WasmFaasDropIpv4ErrorModel> (1)));
+
+  auto nCalls = WasmFaasRuntimeDouble::nTypedCalls;
+  Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_completed.size (), 1, "Wrong number of completed invocations");
+  NS_TEST_ASSERT_MSG_EQ (m_completed[0].status, WasmFaasResult::OK, "Retried request failed");
+  NS_TEST_ASSERT_MSG_EQ (m_completed[0].value.GetI32 (), 42, "Wrong result");
+  // The retry leaves after the default 2 s RequestTimeout
+  NS_TEST_ASSERT_MSG_GT (m_completedAt[0], Seconds (3), "Result came before the retry");
+  NS_TEST_ASSERT_MSG_LT (m_completedAt[0], Seconds (3.1), "Result came late");
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasRuntimeDouble::nTypedCalls, nCalls + 1,
+                         "Function not run exactly once");
+  NS_TEST_ASSERT_MSG_EQ (CountEvents (0, WasmFaasEventLog::REQUEST_RETRIED), 1,
+                         "Request not retried once");
+  NS_TEST_ASSERT_MSG_EQ (CountEvents (1, WasmFaasEventLog::DUPLICATE_REQUEST), 1,
+                         "Retry not seen as a duplicate");
+  NS_TEST_ASSERT_MSG_EQ (CountEvents (1, WasmFaasEventLog::SEND_PACKET_EXECUTE_MODULE_RESULT), 1,
+                         "Function run for the retry");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that a request whose replies are all lost fails with TIMED_OUT
+ * after its last retry
+ */
+class WasmFaasRequestTimeoutTestCase : public WasmFaasRequestTestCase
+{
+public:
+  WasmFaasRequestTimeoutTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WasmFaasRequestTimeoutTestCase::WasmFaasRequestTimeoutTestCase ()
+  : WasmFaasRequestTestCase ("A request times out after its last retry", 2)
+{
+}
+
+void
+WasmFaasRequestTimeoutTestCase::DoRun (void)
+{
+  CustomAppHelper helper (3000);
+  Setup (helper);
+  CustomAppHelper::RegisterFullMesh (m_nodes);
+  auto sum = get_static_module_data (StaticModuleList::WasmSum);
+  CustomAppHelper::GetCustomApp (m_nodes.Get (1))->RegisterWasmModule ((char *) "sum", sum);
+  free_ffi_string (sum);
+  m_nodes.Get (0)->GetDevice (0)->SetAttribute (
+      "ReceiveErrorModel", PointerValue (CreateObject<WasmFaasDropIpv4ErrorModel> (
+                               std::numeric_limits<uint32_t>::max ())));
+
+  auto nCalls = WasmFaasRuntimeDouble::nTypedCalls;
+  Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_completed.size (), 1, "Wrong number of completed invocations");
+  NS_TEST_ASSERT_MSG_EQ (m_completed[0].status, WasmFaasResult::TIMED_OUT, "Request not timed out");
+  // Two retries with the default timeouts, 2 s, 4 s and 8 s
+  NS_TEST_ASSERT_MSG_EQ (m_completedAt[0], Seconds (15), "Timed out at the wrong time");
+  NS_TEST_ASSERT_MSG_EQ (CountEvents (0, WasmFaasEventLog::REQUEST_RETRIED), 2,
+                         "Wrong number of retries");
+  NS_TEST_ASSERT_MSG_EQ (CountEvents (0, WasmFaasEventLog::REQUEST_TIMED_OUT), 1,
+                         "Time out not logged");
+  // The reply is kept by default for as long as the retries last
+  NS_TEST_ASSERT_MSG_EQ (CountEvents (1, WasmFaasEventLog::DUPLICATE_REQUEST), 2,
+                         "Retries not seen as duplicates");
+  NS_TEST_ASSERT_MSG_EQ (WasmFaasRuntimeDouble::nTypedCalls, nCalls + 1,
+                         "Function not run exactly once");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that a request forwarded around a loop of peers none of which
+ * holds the module ends with NOT_FOUND at MaxHops
+ */
+class WasmFaasRequestHopLimitTestCase : public WasmFaasRequestTestCase
+{
+public:
+  WasmFaasRequestHopLimitTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WasmFaasRequestHopLimitTestCase::WasmFaasRequestHopLimitTestCase ()
+  : WasmFaasRequestTestCase ("A forwarded request stops at MaxHops", 3)
+{
+}
+
+void
+WasmFaasRequestHopLimitTestCase::DoRun (void)
+{
+  // Each node only knows the next one, node 2 knows node 0
+  CustomAppHelper helper (3000);
+  helper.SetAttribute ("MaxHops", UintegerValue (1));
+  Setup (helper);
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      CustomAppHelper::GetCustomApp (m_nodes.Get (i))
+          ->RegisterNode (m_interfaces.GetAddress ((i + 1) % m_nodes.GetN ()), 3000);
+    }
+
+  Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_completed.size (), 1, "Wrong number of completed invocations");
+  NS_TEST_ASSERT_MSG_EQ (m_completed[0].status, WasmFaasResult::NOT_FOUND,
+                         "Request not stopped at the hop limit");
+  NS_TEST_ASSERT_MSG_LT (m_completedAt[0], Seconds (1.1), "Hop limit reached by a time out");
+  NS_TEST_ASSERT_MSG_EQ (CountEvents (1, WasmFaasEventLog::HOP_LIMIT_REACHED), 0,
+                         "First hop stopped");
+  NS_TEST_ASSERT_MSG_EQ (CountEvents (2, WasmFaasEventLog::HOP_LIMIT_REACHED), 1,
+                         "Second hop not stopped");
+  NS_TEST_ASSERT_MSG_EQ (CountEvents (0, WasmFaasEventLog::RECEIVED_PACKET_EXECUTE_MODULE_REQUEST),
+                         0, "Request looped back to the caller");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that peers of the text protocol pair a request and its reply by
+ * the request ID carried out of band, and refuse non-I32 arguments
+ */
+class WasmFaasRequestTextTestCase : public WasmFaasRequestTestCase
+{
+public:
+  WasmFaasRequestTextTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Record a message received by node 1.
+   * \param packet the message, past its SeqTsHeader
+   */
+  void HolderRx (Ptr<const Packet> packet);
+
+  std::vector<std::string> m_holderRx; //!< Messages received by node 1
+};
+
+WasmFaasRequestTextTestCase::WasmFaasRequestTextTestCase ()
+  : WasmFaasRequestTestCase ("A request of the text protocol keeps the legacy layout", 2)
+{
+}
+
+void
+WasmFaasRequestTextTestCase::HolderRx (Ptr<const Packet> packet)
+{
+  auto copy = packet->Copy ();
+  SeqTsHeader seqTs;
+  copy->RemoveHeader (seqTs);
+  std::string text (copy->GetSize (), '\0');
+  copy->CopyData ((uint8_t *) &text[0], text.size ());
+  m_holderRx.push_back (text);
+}
+
+void
+WasmFaasRequestTextTestCase::DoRun (void)
+{
+  CustomAppHelper helper (3000);
+  helper.SetAttribute ("TextProtocol", BooleanValue (true));
+  Setup (helper);
+  CustomAppHelper::RegisterFullMesh (m_nodes);
+  auto sum = get_static_module_data (StaticModuleList::WasmSum);
+  CustomAppHelper::GetCustomApp (m_nodes.Get (1))->RegisterWasmModule ((char *) "sum", sum);
+  free_ffi_string (sum);
+  CustomAppHelper::GetCustomApp (m_nodes.Get (1))
+      ->TraceConnectWithoutContext ("Rx",
+                                    MakeCallback (&WasmFaasRequestTextTestCase::HolderRx, this));
+
+  auto result = CustomAppHelper::GetCustomApp (m_nodes.Get (0))
+                    ->ExecuteFunction ("sum", "sum",
+                                       {WasmFaasValue::FromI64 (1), WasmFaasValue::FromI64 (2)});
+  NS_TEST_ASSERT_MSG_EQ (result.status, WasmFaasResult::FAILED, "I64 arguments sent as text");
+  m_completed.clear ();
+  Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_completed.size (), 1, "Wrong number of completed invocations");
+  NS_TEST_ASSERT_MSG_EQ (m_completed[0].status, WasmFaasResult::OK, "Text request failed");
+  NS_TEST_ASSERT_MSG_EQ (m_completed[0].value.GetI32 (), 42, "Wrong result");
+  NS_TEST_ASSERT_MSG_GT (m_holderRx.size (), 0, "Request not received");
+  NS_TEST_ASSERT_MSG_EQ (m_holderRx[0], "e;sum;sum;20;22;", "Request not in the legacy layout");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that a message that does not parse is dropped with an event
+ * instead of being answered
+ */
+class WasmFaasRequestMalformedTestCase : public WasmFaasRequestTestCase
+{
+public:
+  WasmFaasRequestMalformedTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Send a message too short for a WasmFaasHeader to node 1.
+   */
+  void SendMalformed (void);
+  /**
+   * \brief Count the replies to the malformed message.
+   * \param socket the socket the message was sent from
+   */
+  void ReceiveReply (Ptr<Socket> socket);
+
+  Ptr<Socket> m_socket; //!< Socket of node 0 sending the malformed message
+  uint32_t m_nReplies; //!< Replies received by m_socket
+};
+
+WasmFaasRequestMalformedTestCase::WasmFaasRequestMalformedTestCase ()
+  : WasmFaasRequestTestCase ("A malformed message is dropped", 2), m_nReplies (0)
+{
+}
+
+void
+WasmFaasRequestMalformedTestCase::SendMalformed (void)
+{
+  m_socket = Socket::CreateSocket (m_nodes.Get (0), UdpSocketFactory::GetTypeId ());
+  m_socket->Bind ();
+  m_socket->SetRecvCallback (MakeCallback (&WasmFaasRequestMalformedTestCase::ReceiveReply, this));
+  auto packet = Create<Packet> ((const uint8_t *) "e;x", 3);
+  packet->AddHeader (SeqTsHeader ());
+  m_socket->SendTo (packet, 0, InetSocketAddress (m_interfaces.GetAddress (1), 3000));
+}
+
+void
+WasmFaasRequestMalformedTestCase::ReceiveReply (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      m_nReplies++;
+    }
+}
+
+void
+WasmFaasRequestMalformedTestCase::DoRun (void)
+{
+  CustomAppHelper helper (3000);
+  Setup (helper);
+  CustomAppHelper::RegisterFullMesh (m_nodes);
+  auto sum = get_static_module_data (StaticModuleList::WasmSum);
+  CustomAppHelper::GetCustomApp (m_nodes.Get (1))->RegisterWasmModule ((char *) "sum", sum);
+  free_ffi_string (sum);
+
+  Simulator::Schedule (Seconds (0.5), &WasmFaasRequestMalformedTestCase::SendMalformed, this);
+  Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (CountEvents (1, WasmFaasEventLog::DROPPED_MALFORMED_PACKET), 1,
+                         "Malformed message not dropped");
+  NS_TEST_ASSERT_MSG_EQ (m_nReplies, 0, "Malformed message answered");
+  // The peer still serves well formed requests
+  NS_TEST_ASSERT_MSG_EQ (m_completed.size (), 1, "Wrong number of completed invocations");
+  NS_TEST_ASSERT_MSG_EQ (m_completed[0].status, WasmFaasResult::OK, "Request failed");
+  m_socket = 0;
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that a chunked module transfer recovers a lost chunk or a lost
+ * acknowledgement, and delivers the module intact and once
+ */
+class WasmFaasRequestChunkLossTestCase : public WasmFaasRequestTestCase
+{
+public:
+  /**
+   * \param loseAck true to lose the acknowledgement of a chunk instead of the chunk
+   */
+  WasmFaasRequestChunkLossTestCase (bool loseAck);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Record a message received by node 0.
+   * \param packet the message
+   */
+  void CallerRx (Ptr<const Packet> packet);
+  /**
+   * \brief Record a module received by node 0.
+   * \param moduleName the module name
+   * \param bytes the module size on the wire
+   * \param duration the time since the load request was sent
+   */
+  void ModuleTransfer (const std::string &moduleName, uint32_t bytes, Time duration);
+
+  bool m_loseAck; //!< Whether an acknowledgement is lost instead of a chunk
+  std::vector<Time> m_callerRx; //!< When node 0 received messages
+  std::vector<uint32_t> m_transfers; //!< Sizes of the modules received by node 0
+};
+
+WasmFaasRequestChunkLossTestCase::WasmFaasRequestChunkLossTestCase (bool loseAck)
+  : WasmFaasRequestTestCase (loseAck ? "A lost chunk acknowledgement is recovered"
+                                     : "A lost module chunk is sent again",
+                             2),
+    m_loseAck (loseAck)
+{
+}
+
+void
+WasmFaasRequestChunkLossTestCase::CallerRx (Ptr<const Packet> packet)
+{
+  m_callerRx.push_back (Simulator::Now ());
+}
+
+void
+WasmFaasRequestChunkLossTestCase::ModuleTransfer (const std::string &moduleName, uint32_t bytes,
+                                                  Time duration)
+{
+  NS_TEST_EXPECT_MSG_EQ (moduleName, "sum", "Wrong module received");
+  m_transfers.push_back (bytes);
+}
+
+void
+WasmFaasRequestChunkLossTestCase::DoRun (void)
+{
+  CustomAppHelper helper (3000);
+  helper.SetAttribute ("ChunkedModuleTransfer", BooleanValue (true));
+  helper.SetAttribute ("ModuleTransferWindow", UintegerValue (4));
+  Setup (helper);
+  CustomAppHelper::RegisterFullMesh (m_nodes);
+
+  // 8 chunks of 1024 bytes, the last one shorter
+  std::string sum;
+  for (uint32_t i = 0; i < 900; i++)
+    {
+      sum += "AGFzbQEAAAB0";
+    }
+  CustomAppHelper::GetCustomApp (m_nodes.Get (1))
+      ->RegisterWasmModule ((char *) "sum", (char *) sum.c_str ());
+
+  auto caller = CustomAppHelper::GetCustomApp (m_nodes.Get (0));
+  caller->TraceConnectWithoutContext (
+      "Rx", MakeCallback (&WasmFaasRequestChunkLossTestCase::CallerRx, this));
+  caller->TraceConnectWithoutContext (
+      "ModuleTransfer", MakeCallback (&WasmFaasRequestChunkLossTestCase::ModuleTransfer, this));
+
+  // Node 0 receives the result then the chunks, node 1 the request, the load
+  // request then the acknowledgements: lose chunk 1 or the acknowledgement of chunk 1
+  auto lossy = m_loseAck ? 1 : 0;
+  auto nSkips = m_loseAck ? 3 : 2;
+  m_nodes.Get (lossy)->GetDevice (0)->SetAttribute (
+      "ReceiveErrorModel", PointerValue (CreateObject<WasmFaasDropIpv4ErrorModel> (1, nSkips)));
+  Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_completed.size (), 1, "Wrong number of completed invocations");
+  NS_TEST_ASSERT_MSG_EQ (m_completed[0].status, WasmFaasResult::OK, "Request failed");
+  NS_TEST_ASSERT_MSG_EQ (m_transfers.size (), 1, "Module not received exactly once");
+  NS_TEST_ASSERT_MSG_EQ (m_transfers[0], 8100, "Wrong module size on the wire");
+  NS_TEST_ASSERT_MSG_EQ (CountEvents (0, WasmFaasEventLog::RECEIVED_MODULE_CHUNKS), 1,
+                         "Module not reassembled exactly once");
+  NS_TEST_ASSERT_MSG_EQ (CountEvents (1, WasmFaasEventLog::MODULE_CHUNKS_RETRANSMITTED), 1,
+                         "Chunk not sent again exactly once");
+  NS_TEST_ASSERT_MSG_EQ (CountEvents (1, WasmFaasEventLog::MODULE_TRANSFER_EXPIRED), 0,
+                         "Transfer expired");
+  auto data = get_runtime_module_base64_data (caller->GetNodeId (), "sum");
+  NS_TEST_ASSERT_MSG_EQ (std::string (data), sum, "Module not received intact");
+  free_ffi_string ((char *) data);
+
+  // Before the chunk timeout, the unacknowledged chunk 1 holds the window
+  // at chunks 1 to 4, acknowledged later chunks do not open it further:
+  // node 0 got the result and chunks 0 to 4 but the lost one
+  uint32_t nEarly = 0;
+  for (auto &at : m_callerRx)
+    {
+      nEarly += at < m_callerRx.front () + MilliSeconds (400);
+    }
+  uint32_t nExpected = m_loseAck ? 6 : 5;
+  NS_TEST_ASSERT_MSG_EQ (nEarly, nExpected, "Window not held by the first unacknowledged chunk");
+  // The chunk sent again, lost or acknowledged in vain, completes the module
+  NS_TEST_ASSERT_MSG_EQ (m_callerRx.size (), nExpected + 4, "Wrong number of messages received");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that a workflow is handed over to the known holder of its first
+ * module, runs its next stage on a peer from there, and that its result
+ * comes straight back to the node that started it
+ */
+class WasmFaasRequestWorkflowTestCase : public WasmFaasRequestTestCase
+{
+public:
+  WasmFaasRequestWorkflowTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Start (20 + 22) / 2 on node 0.
+   */
+  void StartWorkflow (void);
+
+  uint64_t m_workflowId; //!< ID of the workflow started by node 0
+};
+
+WasmFaasRequestWorkflowTestCase::WasmFaasRequestWorkflowTestCase ()
+  : WasmFaasRequestTestCase ("A workflow is handed over to the holder of its module", 3),
+    m_workflowId (0)
+{
+}
+
+void
+WasmFaasRequestWorkflowTestCase::StartWorkflow (void)
+{
+  WasmFaasWorkflow workflow;
+  auto sum = workflow.AddStage (
+      "sum", "sum", {WasmFaasWorkflow::Binding::Value (WasmFaasValue::FromI32 (20)),
+                     WasmFaasWorkflow::Binding::Value (WasmFaasValue::FromI32 (22))});
+  workflow.AddStage ("div", "div",
+                     {WasmFaasWorkflow::Binding::StageResult (sum),
+                      WasmFaasWorkflow::Binding::Value (WasmFaasValue::FromI32 (2))});
+  auto result = CustomAppHelper::GetCustomApp (m_nodes.Get (0))->ExecuteWorkflow (workflow);
+  NS_TEST_EXPECT_MSG_EQ (result.status, WasmFaasResult::PENDING, "Workflow run on the caller");
+  m_workflowId = result.requestId;
+}
+
+void
+WasmFaasRequestWorkflowTestCase::DoRun (void)
+{
+  CustomAppHelper helper (3000);
+  Setup (helper);
+  CustomAppHelper::RegisterFullMesh (m_nodes);
+  auto sum = get_static_module_data (StaticModuleList::WasmSum);
+  CustomAppHelper::GetCustomApp (m_nodes.Get (1))->RegisterWasmModule ((char *) "sum", sum);
+  free_ffi_string (sum);
+  auto div = get_static_module_data (StaticModuleList::WasmDiv);
+  CustomAppHelper::GetCustomApp (m_nodes.Get (2))->RegisterWasmModule ((char *) "div", div);
+  free_ffi_string (div);
+
+  // The call of sum at 1 s makes node 1 the known holder of sum, which node 0 cannot keep
+  CustomAppHelper::GetCustomApp (m_nodes.Get (0))
+      ->SetAttribute ("ModuleCachePolicy",
+                      PointerValue (CreateObjectWithAttributes<LruWasmModuleCachePolicy> (
+                          "Capacity", UintegerValue (1))));
+  Simulator::Schedule (Seconds (2), &WasmFaasRequestWorkflowTestCase::StartWorkflow, this);
+  Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_completed.size (), 2, "Wrong number of completed invocations");
+  NS_TEST_ASSERT_MSG_EQ (m_completed[1].requestId, m_workflowId, "Workflow not completed");
+  NS_TEST_ASSERT_MSG_EQ (m_completed[1].status, WasmFaasResult::OK, "Workflow failed");
+  NS_TEST_EXPECT_MSG_EQ (m_completed[1].value.GetI32 (), 21, "Wrong workflow result");
+  NS_TEST_EXPECT_MSG_EQ (CountEvents (0, WasmFaasEventLog::SEND_PACKET_WORKFLOW), 1,
+                         "Workflow not handed over to the holder of sum");
+  NS_TEST_EXPECT_MSG_EQ (CountEvents (0, WasmFaasEventLog::WORKFLOW_STAGE_COMPLETED), 0,
+                         "Stage completed on the caller");
+  NS_TEST_EXPECT_MSG_EQ (CountEvents (1, WasmFaasEventLog::WORKFLOW_STAGE_COMPLETED), 2,
+                         "Stages not completed on the holder of sum");
+  NS_TEST_EXPECT_MSG_EQ (CountEvents (1, WasmFaasEventLog::SEND_PACKET_WORKFLOW_RESULT), 1,
+                         "Result not sent straight to the caller");
+  NS_TEST_EXPECT_MSG_EQ (CountEvents (0, WasmFaasEventLog::REQUEST_RETRIED), 0,
+                         "Hand-over not acknowledged");
+  NS_TEST_EXPECT_MSG_EQ (CountEvents (1, WasmFaasEventLog::REQUEST_RETRIED), 0,
+                         "Result not acknowledged");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that invocations to one peer within BatchWindow leave as one
+ * BATCH packet, and that their results come back as one too
+ */
+class WasmFaasRequestBatchTestCase : public WasmFaasRequestTestCase
+{
+public:
+  WasmFaasRequestBatchTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Record a batch sent by a node.
+   * \param node the node ID, as trace context
+   * \param nMessages the number of messages in the batch
+   * \param bytes the batch size on the wire
+   */
+  void BatchSent (std::string node, uint32_t nMessages, uint32_t bytes);
+
+  std::vector<uint32_t> m_batches[2]; //!< Messages of each batch sent, by node
+};
+
+WasmFaasRequestBatchTestCase::WasmFaasRequestBatchTestCase ()
+  : WasmFaasRequestTestCase ("Invocations to one peer leave as one batch", 2)
+{
+}
+
+void
+WasmFaasRequestBatchTestCase::BatchSent (std::string node, uint32_t nMessages, uint32_t bytes)
+{
+  m_batches[std::stoi (node)].push_back (nMessages);
+}
+
+void
+WasmFaasRequestBatchTestCase::DoRun (void)
+{
+  CustomAppHelper helper (3000);
+  helper.SetAttribute ("BatchWindow", TimeValue (MilliSeconds (10)));
+  Setup (helper);
+  CustomAppHelper::RegisterFullMesh (m_nodes);
+  auto sum = get_static_module_data (StaticModuleList::WasmSum);
+  CustomAppHelper::GetCustomApp (m_nodes.Get (1))->RegisterWasmModule ((char *) "sum", sum);
+  free_ffi_string (sum);
+  for (uint32_t node = 0; node < 2; node++)
+    {
+      CustomAppHelper::GetCustomApp (m_nodes.Get (node))
+          ->TraceConnect ("BatchSent", std::to_string (node),
+                          MakeCallback (&WasmFaasRequestBatchTestCase::BatchSent, this));
+    }
+
+  // Node 0 takes results only, so nothing but requests and results is batched
+  CustomAppHelper::GetCustomApp (m_nodes.Get (0))
+      ->SetAttribute ("ModuleCachePolicy",
+                      PointerValue (CreateObject<NeverWasmModuleCachePolicy> ()));
+
+  // With the call of sum at 1 s, three invocations go to node 1 at once
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Simulator::Schedule (Seconds (1), &WasmFaasRequestBatchTestCase::CallSum, this);
+    }
+  Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_completed.size (), 3, "Wrong number of completed invocations");
+  for (uint32_t i = 0; i < m_completed.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_completed[i].status, WasmFaasResult::OK, "Invocation failed");
+      NS_TEST_EXPECT_MSG_EQ (m_completed[i].value.GetI32 (), 42, "Wrong result");
+      NS_TEST_EXPECT_MSG_EQ (m_completedAt[i], m_completedAt[0], "Results not batched");
+      NS_TEST_EXPECT_MSG_GT_OR_EQ (m_completedAt[i], Seconds (1) + MilliSeconds (10),
+                                   "Request sent before the end of BatchWindow");
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_batches[0].size (), 1, "Requests not sent as one batch");
+  NS_TEST_EXPECT_MSG_EQ (m_batches[0][0], 3, "Wrong number of requests in the batch");
+  NS_TEST_ASSERT_MSG_EQ (m_batches[1].size (), 1, "Results not sent as one batch");
+  NS_TEST_EXPECT_MSG_EQ (m_batches[1][0], 3, "Wrong number of results in the batch");
+  NS_TEST_EXPECT_MSG_EQ (CountEvents (1, WasmFaasEventLog::RECEIVED_PACKET_BATCH), 1,
+                         "Requests not received as a batch");
+  NS_TEST_EXPECT_MSG_EQ (CountEvents (0, WasmFaasEventLog::RECEIVED_PACKET_BATCH), 1,
+                         "Results not received as a batch");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that a truncated entry of a BATCH packet is dropped while the
+ * entries before it are answered
+ */
+class WasmFaasRequestTruncatedBatchTestCase : public WasmFaasRequestTestCase
+{
+public:
+  WasmFaasRequestTruncatedBatchTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Send node 1 a batch of a request to sum and of a truncated entry.
+   */
+  void SendBatch (void);
+
+  /**
+   * \brief Record the replies of node 1.
+   * \param socket the socket the batch was sent from
+   */
+  void ReceiveReply (Ptr<Socket> socket);
+
+  Ptr<Socket> m_socket; //!< Socket the batch is sent from
+  std::vector<WasmFaasHeader> m_replies; //!< Replies of node 1
+};
+
+WasmFaasRequestTruncatedBatchTestCase::WasmFaasRequestTruncatedBatchTestCase ()
+  : WasmFaasRequestTestCase ("A truncated batch entry is dropped", 2)
+{
+}
+
+void
+WasmFaasRequestTruncatedBatchTestCase::SendBatch (void)
+{
+  WasmFaasHeader request;
+  request.SetType (WasmFaasHeader::EXECUTE_REQUEST);
+  request.SetRequestId (77);
+  request.SetModuleId (WasmFaasHeader::GetNameId ("sum"));
+  request.SetFunctionId (WasmFaasHeader::GetNameId ("sum"));
+  request.AddArg (WasmFaasValue::FromI32 (1));
+  request.AddArg (WasmFaasValue::FromI32 (2));
+  auto message = Create<Packet> ();
+  message->AddHeader (request);
+
+  // The second entry claims 40 bytes and holds 5
+  std::string payload;
+  WasmFaasBatcher::Pack ({message}, payload);
+  payload += std::string ("\x28\x00" "abcde", 7);
+  WasmFaasHeader batch;
+  batch.SetType (WasmFaasHeader::BATCH);
+  auto packet = Create<Packet> ((const uint8_t *) payload.data (), payload.size ());
+  packet->AddHeader (batch);
+  packet->AddHeader (SeqTsHeader ());
+
+  m_socket = Socket::CreateSocket (m_nodes.Get (0), UdpSocketFactory::GetTypeId ());
+  m_socket->Bind ();
+  m_socket->SetRecvCallback (
+      MakeCallback (&WasmFaasRequestTruncatedBatchTestCase::ReceiveReply, this));
+  m_socket->SendTo (packet, 0, InetSocketAddress (m_interfaces.GetAddress (1), 3000));
+}
+
+void
+WasmFaasRequestTruncatedBatchTestCase::ReceiveReply (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      SeqTsHeader seqTs;
+      WasmFaasHeader reply;
+      packet->RemoveHeader (seqTs);
+      packet->RemoveHeader (reply);
+      m_replies.push_back (reply);
+    }
+}
+
+void
+WasmFaasRequestTruncatedBatchTestCase::DoRun (void)
+{
+  CustomAppHelper helper (3000);
+  helper.SetAttribute ("BatchWindow", TimeValue (MilliSeconds (10)));
+  Setup (helper);
+  CustomAppHelper::RegisterFullMesh (m_nodes);
+  auto sum = get_static_module_data (StaticModuleList::WasmSum);
+  CustomAppHelper::GetCustomApp (m_nodes.Get (1))->RegisterWasmModule ((char *) "sum", sum);
+  free_ffi_string (sum);
+
+  Simulator::Schedule (Seconds (0.5), &WasmFaasRequestTruncatedBatchTestCase::SendBatch, this);
+  Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (CountEvents (1, WasmFaasEventLog::RECEIVED_PACKET_BATCH), 1,
+                         "Batch not received");
+  NS_TEST_ASSERT_MSG_EQ (m_replies.size (), 1, "Truncated entry answered");
+  NS_TEST_EXPECT_MSG_EQ (m_replies[0].GetType (), WasmFaasHeader::EXECUTE_RESULT,
+                         "Request before the truncated entry not answered");
+  NS_TEST_EXPECT_MSG_EQ (m_replies[0].GetRequestId (), 77, "Reply to another request");
+  NS_TEST_EXPECT_MSG_EQ (m_replies[0].GetArg (0).GetI32 (), 3, "Wrong result");
+  NS_TEST_EXPECT_MSG_EQ (CountEvents (1, WasmFaasEventLog::DROPPED_MALFORMED_PACKET), 0,
+                         "Truncated entry parsed");
+  // The peer still serves well formed requests
+  NS_TEST_ASSERT_MSG_EQ (m_completed.size (), 1, "Wrong number of completed invocations");
+  NS_TEST_ASSERT_MSG_EQ (m_completed[0].status, WasmFaasResult::OK, "Request failed");
+  m_socket = 0;
+}
+
+/**
+ * \param counter the copy of a counter to update
+ * \param oldValue the previous value of the counter
+ * \param newValue the new value of the counter
+ */
+static void
+SetCounter (uint64_t *counter, uint64_t oldValue, uint64_t newValue)
+{
+  *counter = newValue;
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that a missing module is asked from PeerQueryFanout peers at once,
+ * in registration order, and that the first answer wins
+ */
+class WasmFaasRequestFanoutTestCase : public WasmFaasRequestTestCase
+{
+public:
+  /**
+   * \param fanout the PeerQueryFanout of node 0, 0 for every peer
+   */
+  WasmFaasRequestFanoutTestCase (uint32_t fanout);
+
+private:
+  virtual void DoRun (void);
+
+  uint32_t m_fanout; //!< PeerQueryFanout of node 0
+};
+
+WasmFaasRequestFanoutTestCase::WasmFaasRequestFanoutTestCase (uint32_t fanout)
+  : WasmFaasRequestTestCase ("A module query fans out to " +
+                                 (fanout == 0 ? std::string ("every peer")
+                                              : std::to_string (fanout) + " peer" +
+                                                    (fanout > 1 ? "s" : "")),
+                             4),
+    m_fanout (fanout)
+{
+}
+
+void
+WasmFaasRequestFanoutTestCase::DoRun (void)
+{
+  CustomAppHelper helper (3000);
+  helper.SetAttribute ("PeerQueryFanout", UintegerValue (m_fanout));
+  Setup (helper);
+  CustomAppHelper::RegisterFullMesh (m_nodes);
+  auto sum = get_static_module_data (StaticModuleList::WasmSum);
+  for (uint32_t i = 1; i < m_nodes.GetN (); i++)
+    {
+      CustomAppHelper::GetCustomApp (m_nodes.Get (i))->RegisterWasmModule ((char *) "sum", sum);
+    }
+  free_ffi_string (sum);
+
+  // Node 0 does not fetch sum, so only the execute requests are counted
+  CustomAppHelper::GetCustomApp (m_nodes.Get (0))
+      ->SetAttribute ("ModuleCachePolicy",
+                      PointerValue (CreateObject<NeverWasmModuleCachePolicy> ()));
+  Run ();
+
+  uint32_t nAsked = m_fanout == 0 ? m_nodes.GetN () - 1 : m_fanout;
+  NS_TEST_EXPECT_MSG_EQ (CountEvents (0, WasmFaasEventLog::SEND_PACKET_EXECUTE_MODULE_REQUEST),
+                         nAsked, "Wrong number of peers asked");
+  for (uint32_t i = 1; i < m_nodes.GetN (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (
+          CountEvents (i, WasmFaasEventLog::RECEIVED_PACKET_EXECUTE_MODULE_REQUEST), (i <= nAsked),
+          "Wrong number of requests received by node " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (CountEvents (0, WasmFaasEventLog::REQUEST_RETRIED), 0,
+                         "Request sent again");
+  NS_TEST_ASSERT_MSG_EQ (m_completed.size (), 1, "Wrong number of completed invocations");
+  if (m_completed.size () != 1)
+    {
+      return; // The runner goes on after a failed assertion unless told to stop
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_completed[0].status, WasmFaasResult::OK, "Invocation failed");
+  NS_TEST_EXPECT_MSG_EQ (m_completed[0].value.GetI32 (), 42, "Wrong result");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that the peer that returned a result is asked directly for the same
+ * module until ModuleLocationTtl has passed, and the peers are asked again
+ * afterwards
+ */
+class WasmFaasRequestLocationTestCase : public WasmFaasRequestTestCase
+{
+public:
+  WasmFaasRequestLocationTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WasmFaasRequestLocationTestCase::WasmFaasRequestLocationTestCase ()
+  : WasmFaasRequestTestCase ("A known module holder is asked directly until its TTL", 2)
+{
+}
+
+void
+WasmFaasRequestLocationTestCase::DoRun (void)
+{
+  CustomAppHelper helper (3000);
+  helper.SetAttribute ("ModuleLocationTtl", TimeValue (Seconds (5)));
+  Setup (helper);
+  CustomAppHelper::RegisterFullMesh (m_nodes);
+  auto sum = get_static_module_data (StaticModuleList::WasmSum);
+  CustomAppHelper::GetCustomApp (m_nodes.Get (1))->RegisterWasmModule ((char *) "sum", sum);
+  free_ffi_string (sum);
+  CustomAppHelper::GetCustomApp (m_nodes.Get (0))
+      ->SetAttribute ("ModuleCachePolicy",
+                      PointerValue (CreateObject<NeverWasmModuleCachePolicy> ()));
+
+  // The location learnt at 1 s serves the call at 3 s, whose result renews it
+  // until 8 s, and has expired at 9 s
+  Simulator::Schedule (Seconds (3), &WasmFaasRequestLocationTestCase::CallSum, this);
+  Simulator::Schedule (Seconds (9), &WasmFaasRequestLocationTestCase::CallSum, this);
+  Run ();
+
+  auto queries = GetEventTimes (0, WasmFaasEventLog::SEND_PACKET_EXECUTE_MODULE_REQUEST);
+  auto direct =
+      GetEventTimes (0, WasmFaasEventLog::SEND_PACKET_EXECUTE_MODULE_REQUEST_TO_KNOWN_HOLDER);
+  NS_TEST_ASSERT_MSG_EQ (queries.size (), 2, "Wrong number of peer queries");
+  NS_TEST_ASSERT_MSG_EQ (direct.size (), 1, "Wrong number of requests to the known holder");
+  if (queries.size () != 2 || direct.size () != 1)
+    {
+      return; // The runner goes on after a failed assertion unless told to stop
+    }
+  NS_TEST_EXPECT_MSG_EQ (queries[0], Seconds (1), "First call not sent to the peers");
+  NS_TEST_EXPECT_MSG_EQ (direct[0], Seconds (3), "Known holder not asked directly");
+  NS_TEST_EXPECT_MSG_EQ (queries[1], Seconds (9), "Expired location still used");
+  NS_TEST_ASSERT_MSG_EQ (m_completed.size (), 3, "Wrong number of completed invocations");
+  for (const auto &result : m_completed)
+    {
+      NS_TEST_EXPECT_MSG_EQ (result.status, WasmFaasResult::OK, "Invocation failed");
+    }
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that LeastLoaded peer selection moves the invocations of node 0 off
+ * the peer that advertised the higher load, though it answers faster, where
+ * registration order keeps asking the first peer
+ */
+class WasmFaasRequestPeerLoadTestCase : public WasmFaasRequestTestCase
+{
+public:
+  /**
+   * \param leastLoaded true for LeastLoaded peer selection, false for RegistrationOrder
+   */
+  WasmFaasRequestPeerLoadTestCase (bool leastLoaded);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Start a long div on node 2, which keeps one of its slots busy.
+   */
+  void LoadNode2 (void);
+
+  bool m_leastLoaded; //!< Whether node 0 selects peers by their score
+};
+
+WasmFaasRequestPeerLoadTestCase::WasmFaasRequestPeerLoadTestCase (bool leastLoaded)
+  : WasmFaasRequestTestCase (leastLoaded ? "LeastLoaded avoids the peer that advertised load"
+                                         : "RegistrationOrder ignores the advertised load",
+                             3),
+    m_leastLoaded (leastLoaded)
+{
+}
+
+void
+WasmFaasRequestPeerLoadTestCase::LoadNode2 (void)
+{
+  auto result = CustomAppHelper::GetCustomApp (m_nodes.Get (2))
+                    ->ExecuteFunction ("div", "div",
+                                       {WasmFaasValue::FromI32 (42), WasmFaasValue::FromI32 (2)});
+  NS_TEST_EXPECT_MSG_EQ (result.status, WasmFaasResult::PENDING, "div not queued on node 2");
+}
+
+void
+WasmFaasRequestPeerLoadTestCase::DoRun (void)
+{
+  CustomAppHelper helper (3000);
+  helper.SetAttribute ("PeerSelection",
+                       EnumValue (m_leastLoaded ? CustomApp::LEAST_LOADED_SELECTION
+                                                : CustomApp::ORDERED_SELECTION));
+  helper.SetAttribute ("PeerLoadCost", TimeValue (MilliSeconds (100)));
+  helper.SetAttribute ("ModuleLocationTtl", TimeValue (Seconds (0)));
+  Setup (helper);
+  CustomAppHelper::RegisterFullMesh (m_nodes);
+  auto sum = get_static_module_data (StaticModuleList::WasmSum);
+  auto div = get_static_module_data (StaticModuleList::WasmDiv);
+  for (uint32_t i = 1; i < m_nodes.GetN (); i++)
+    {
+      auto app = CustomAppHelper::GetCustomApp (m_nodes.Get (i));
+      app->RegisterWasmModule ((char *) "sum", sum);
+      app->RegisterWasmModule ((char *) "div", div);
+      app->SetAttribute ("ExecutionCostModel",
+                         PointerValue (CreateObjectWithAttributes<ProfileWasmExecutionCostModel> (
+                             "DefaultCost", TimeValue (MilliSeconds (10)), "Profile",
+                             StringValue ("div=5s"))));
+      app->SetAttribute ("ExecutionSlots", UintegerValue (2));
+    }
+  free_ffi_string (sum);
+  free_ffi_string (div);
+  CustomAppHelper::GetCustomApp (m_nodes.Get (0))
+      ->SetAttribute ("ModuleCachePolicy",
+                      PointerValue (CreateObject<NeverWasmModuleCachePolicy> ()));
+
+  // Node 2 runs div from 0.5 s to 5.5 s: the answer of node 1 at 1 s
+  // advertises one slot busy, that of node 2 at 2 s both. Node 2 acknowledged
+  // sooner, so only the load sends the call at 3 s back to node 1
+  Simulator::Schedule (Seconds (0.5), &WasmFaasRequestPeerLoadTestCase::LoadNode2, this);
+  Simulator::Schedule (Seconds (2), &WasmFaasRequestPeerLoadTestCase::CallSum, this);
+  Simulator::Schedule (Seconds (3), &WasmFaasRequestPeerLoadTestCase::CallSum, this);
+  Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (CountEvents (1, WasmFaasEventLog::RECEIVED_PACKET_EXECUTE_MODULE_REQUEST),
+                         (m_leastLoaded ? 2 : 3), "Wrong number of invocations sent to node 1");
+  NS_TEST_EXPECT_MSG_EQ (CountEvents (2, WasmFaasEventLog::RECEIVED_PACKET_EXECUTE_MODULE_REQUEST),
+                         (m_leastLoaded ? 1 : 0), "Wrong number of invocations sent to node 2");
+  auto toNode2 = GetEventTimes (2, WasmFaasEventLog::RECEIVED_PACKET_EXECUTE_MODULE_REQUEST);
+  if (m_leastLoaded && toNode2.size () == 1)
+    {
+      NS_TEST_EXPECT_MSG_LT (toNode2[0], Seconds (3), "Load of node 2 not avoided");
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_completed.size (), 3, "Wrong number of completed invocations");
+  for (const auto &result : m_completed)
+    {
+      NS_TEST_EXPECT_MSG_EQ (result.status, WasmFaasResult::OK, "Invocation failed");
+    }
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that a node with one execution slot and room for one waiting
+ * invocation runs the first of three invocations, queues the second and
+ * rejects or forwards the third
+ */
+class WasmFaasRequestOverflowTestCase : public WasmFaasRequestTestCase
+{
+public:
+  /**
+   * \param forward true to forward the overflowing invocation instead of rejecting it
+   */
+  WasmFaasRequestOverflowTestCase (bool forward);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Call sum (value, 0) on node 0.
+   * \param value the first argument, which identifies the result
+   */
+  void Call (int32_t value);
+
+  bool m_forward; //!< Whether the overflowing invocation is forwarded
+};
+
+WasmFaasRequestOverflowTestCase::WasmFaasRequestOverflowTestCase (bool forward)
+  : WasmFaasRequestTestCase (forward ? "An invocation past a full queue is forwarded"
+                                     : "An invocation past a full queue is rejected",
+                             2),
+    m_forward (forward)
+{
+}
+
+void
+WasmFaasRequestOverflowTestCase::Call (int32_t value)
+{
+  auto result = CustomAppHelper::GetCustomApp (m_nodes.Get (0))
+                    ->ExecuteFunction ("sum", "sum",
+                                       {WasmFaasValue::FromI32 (value),
+                                        WasmFaasValue::FromI32 (0)});
+  NS_TEST_EXPECT_MSG_EQ (result.status, WasmFaasResult::PENDING, "Invocation " << value << " done");
+}
+
+void
+WasmFaasRequestOverflowTestCase::DoRun (void)
+{
+  CustomAppHelper helper (3000);
+  Setup (helper);
+  CustomAppHelper::RegisterFullMesh (m_nodes);
+  auto sum = get_static_module_data (StaticModuleList::WasmSum);
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      CustomAppHelper::GetCustomApp (m_nodes.Get (i))->RegisterWasmModule ((char *) "sum", sum);
+    }
+  free_ffi_string (sum);
+
+  auto app = CustomAppHelper::GetCustomApp (m_nodes.Get (0));
+  app->SetAttribute ("ExecutionCostModel",
+                     PointerValue (CreateObjectWithAttributes<ConstantWasmExecutionCostModel> (
+                         "Cost", TimeValue (MilliSeconds (10)))));
+  app->SetAttribute ("ExecutionSlots", UintegerValue (1));
+  app->SetAttribute ("MaxQueueSize", UintegerValue (1));
+  app->SetAttribute ("OverflowAction", EnumValue (m_forward ? CustomApp::FORWARD_OVERFLOW
+                                                            : CustomApp::REJECT_OVERFLOW));
+  // The sum of Run, scheduled after these two at the same time, overflows
+  Simulator::Schedule (Seconds (1), &WasmFaasRequestOverflowTestCase::Call, this, 1);
+  Simulator::Schedule (Seconds (1), &WasmFaasRequestOverflowTestCase::Call, this, 2);
+  Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (CountEvents (0, WasmFaasEventLog::EXECUTION_STARTED), 2,
+                         "Wrong number of invocations run by node 0");
+  NS_TEST_EXPECT_MSG_EQ (CountEvents (0, WasmFaasEventLog::EXECUTION_QUEUED), 1,
+                         "Wrong number of invocations queued by node 0");
+  NS_TEST_EXPECT_MSG_EQ (CountEvents (0, WasmFaasEventLog::EXECUTION_FORWARDED), m_forward,
+                         "Wrong number of invocations forwarded by node 0");
+  NS_TEST_EXPECT_MSG_EQ (CountEvents (0, WasmFaasEventLog::EXECUTION_REJECTED), !m_forward,
+                         "Wrong number of invocations rejected by node 0");
+  NS_TEST_ASSERT_MSG_EQ (m_completed.size (), 3, "Wrong number of completed invocations");
+  if (m_completed.size () != 3)
+    {
+      return; // The runner goes on after a failed assertion unless told to stop
+    }
+
+  // The last completes first, at once when rejected and one round trip later
+  // when forwarded, then the first and the queued second 10 ms apart
+  NS_TEST_EXPECT_MSG_EQ (m_completed[0].status,
+                         (m_forward ? WasmFaasResult::OK : WasmFaasResult::FAILED),
+                         "Wrong status of the overflowing invocation");
+  NS_TEST_EXPECT_MSG_EQ ((m_completedAt[0] == Seconds (1)), !m_forward,
+                         "Wrong completion time of the overflowing invocation");
+  NS_TEST_EXPECT_MSG_LT (m_completedAt[0], Seconds (1.01), "Overflowing invocation waited");
+  for (uint32_t i = 1; i < 3; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_completed[i].status, WasmFaasResult::OK, "Invocation failed");
+      NS_TEST_EXPECT_MSG_EQ (m_completed[i].value.GetI32 (), (int32_t) i, "Wrong order");
+      NS_TEST_EXPECT_MSG_EQ (m_completedAt[i], Seconds (1) + MilliSeconds (10 * i),
+                             "Wrong completion time of invocation " << i);
+    }
+  if (m_forward)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_completed[0].value.GetI32 (), 42, "Wrong forwarded result");
+      NS_TEST_EXPECT_MSG_EQ (CountEvents (1, WasmFaasEventLog::SEND_PACKET_EXECUTE_MODULE_RESULT),
+                             1, "Forwarded invocation not run by node 1");
+    }
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that the module predicted to be invoked next is prefetched once
+ * the requests of the node are done, and that its invocation finds it
+ */
+class WasmFaasRequestPrefetchTestCase : public WasmFaasRequestTestCase
+{
+public:
+  WasmFaasRequestPrefetchTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Call a function of node 1 on node 0.
+   * \param module the module, named after the function
+   * \param status the expected status of ExecuteFunction
+   */
+  void Call (std::string module, WasmFaasResult::Status status);
+
+  uint64_t m_prefetched; //!< Last value of the Prefetched counter of node 0
+  uint64_t m_prefetchHits; //!< Last value of the PrefetchHits counter of node 0
+};
+
+WasmFaasRequestPrefetchTestCase::WasmFaasRequestPrefetchTestCase ()
+  : WasmFaasRequestTestCase ("The next module is prefetched once the requests are done", 2),
+    m_prefetched (0),
+    m_prefetchHits (0)
+{
+}
+
+void
+WasmFaasRequestPrefetchTestCase::Call (std::string module, WasmFaasResult::Status status)
+{
+  auto result = CustomAppHelper::GetCustomApp (m_nodes.Get (0))
+                    ->ExecuteFunction (module, module,
+                                       {WasmFaasValue::FromI32 (20), WasmFaasValue::FromI32 (2)});
+  NS_TEST_EXPECT_MSG_EQ (result.status, status, "Wrong status of " << module);
+}
+
+void
+WasmFaasRequestPrefetchTestCase::DoRun (void)
+{
+  CustomAppHelper helper (3000);
+  helper.SetAttribute ("PrefetchCount", UintegerValue (1));
+  Setup (helper);
+  CustomAppHelper::RegisterFullMesh (m_nodes);
+  auto app = CustomAppHelper::GetCustomApp (m_nodes.Get (0));
+  for (auto module : {StaticModuleList::WasmSum, StaticModuleList::WasmDiv})
+    {
+      auto data = get_static_module_data (module);
+      CustomAppHelper::GetCustomApp (m_nodes.Get (1))
+          ->RegisterWasmModule ((char *) (module == StaticModuleList::WasmSum ? "sum" : "div"),
+                                data);
+      free_ffi_string (data);
+    }
+
+  // Node 0 keeps one module of 8 bytes at a time, so fetching div evicts sum
+  app->SetAttribute ("ModuleCachePolicy",
+                     PointerValue (CreateObjectWithAttributes<LruWasmModuleCachePolicy> (
+                         "Capacity", UintegerValue (12))));
+
+  // After sum at 1 s, div at 2 s predicts sum, evicted once div arrives. Were
+  // the prediction tried while div is pending, sum would still be there. The
+  // hit on sum at 3 s predicts div in turn, evicted by the prefetched sum
+  Simulator::Schedule (Seconds (2), &WasmFaasRequestPrefetchTestCase::Call, this, "div",
+                       WasmFaasResult::PENDING);
+  Simulator::Schedule (Seconds (3), &WasmFaasRequestPrefetchTestCase::Call, this, "sum",
+                       WasmFaasResult::OK);
+  app->TraceConnectWithoutContext ("Prefetched",
+                                   MakeBoundCallback (&SetCounter, &m_prefetched));
+  app->TraceConnectWithoutContext ("PrefetchHits",
+                                   MakeBoundCallback (&SetCounter, &m_prefetchHits));
+  Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_prefetched, 2, "Wrong number of prefetched modules");
+  NS_TEST_EXPECT_MSG_EQ (m_prefetchHits, 1, "Wrong number of prefetch hits");
+  auto prefetches = GetEventTimes (0, WasmFaasEventLog::SEND_PACKET_MODULE_PREFETCH_REQUEST);
+  NS_TEST_ASSERT_MSG_EQ (prefetches.size (), 2, "Wrong number of prefetches");
+  NS_TEST_ASSERT_MSG_EQ (m_completed.size (), 3, "Wrong number of completed invocations");
+  if (prefetches.size () != 2 || m_completed.size () != 3)
+    {
+      return; // The runner goes on after a failed assertion unless told to stop
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_completed[1].value.GetI32 (), 10, "Wrong result of div");
+  NS_TEST_EXPECT_MSG_EQ (m_completed[2].value.GetI32 (), 22, "Wrong result of sum");
+  NS_TEST_EXPECT_MSG_EQ (m_completedAt[2], Seconds (3), "Prefetched sum not run at once");
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (prefetches[0], m_completedAt[1],
+                               "Prefetch sent while a request of the node was pending");
+  NS_TEST_EXPECT_MSG_LT (prefetches[0], Seconds (3), "Prefetch of sum not sent before sum");
+  NS_TEST_EXPECT_MSG_EQ (prefetches[1], Seconds (3), "Prefetch of div not sent after sum");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * CustomApp request retry, time out, hop limit, text protocol, malformed
+ * message, chunked transfer, workflow hand-over, batching, query fan-out, location cache,
+ * peer selection, queue overflow and prefetch test suite
+ */
+class WasmFaasRequestTestSuite : public TestSuite
+{
+public:
+  WasmFaasRequestTestSuite ();
+};
+
+WasmFaasRequestTestSuite::WasmFaasRequestTestSuite () : TestSuite ("wasmfaas-request", UNIT)
+{
+  AddTestCase (new WasmFaasRequestRetryTestCase, TestCase::QUICK);
+  AddTestCase (new WasmFaasRequestTimeoutTestCase, TestCase::QUICK);
+  AddTestCase (new WasmFaasRequestHopLimitTestCase, TestCase::QUICK);
+  AddTestCase (new WasmFaasRequestTextTestCase, TestCase::QUICK);
+  AddTestCase (new WasmFaasRequestMalformedTestCase, TestCase::QUICK);
+  AddTestCase (new WasmFaasRequestChunkLossTestCase (false), TestCase::QUICK);
+  AddTestCase (new WasmFaasRequestChunkLossTestCase (true), TestCase::QUICK);
+  AddTestCase (new WasmFaasRequestWorkflowTestCase, TestCase::QUICK);
+  AddTestCase (new WasmFaasRequestBatchTestCase, TestCase::QUICK);
+  AddTestCase (new WasmFaasRequestTruncatedBatchTestCase, TestCase::QUICK);
+  AddTestCase (new WasmFaasRequestFanoutTestCase (1), TestCase::QUICK);
+  AddTestCase (new WasmFaasRequestFanoutTestCase (2), TestCase::QUICK);
+  AddTestCase (new WasmFaasRequestFanoutTestCase (0), TestCase::QUICK);
+  AddTestCase (new WasmFaasRequestLocationTestCase, TestCase::QUICK);
+  AddTestCase (new WasmFaasRequestPeerLoadTestCase (true), TestCase::QUICK);
+  AddTestCase (new WasmFaasRequestPeerLoadTestCase (false), TestCase::QUICK);
+  AddTestCase (new WasmFaasRequestOverflowTestCase (false), TestCase::QUICK);
+  AddTestCase (new WasmFaasRequestOverflowTestCase (true), TestCase::QUICK);
+  AddTestCase (new WasmFaasRequestPrefetchTestCase, TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static WasmFaasRequestTestSuite g_wasmFaasRequestTestSuite;
@@ -0,0 +1,211 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+
+#include "ns3/abort.h"
+
+#include "wasmfaas-runtime-double.h"
+
+namespace ns3 {
+
+uint32_t WasmFaasRuntimeDouble::nTypedCalls = 0;
+std::string WasmFaasRuntimeDouble::lastFunction;
+std::vector<WasmValue> WasmFaasRuntimeDouble::lastArgs;
+uint32_t WasmFaasRuntimeDouble::nCompiles = 0;
+std::vector<std::string> WasmFaasRuntimeDouble::compiled;
+uint32_t WasmFaasRuntimeDouble::nArtifactsLoaded = 0;
+uint32_t WasmFaasRuntimeDouble::nReleased = 0;
+
+} // namespace ns3
+
+using namespace ns3;
+
+static const char g_artifactMagic[] = "WFDA";
+
+/**
+ * \param a a value
+ * \param b a value of the type of a
+ * \return a + b in the type of a, V128 values as two I64 lanes
+ */
+static WasmValue
+AddValues (const WasmValue &a, const WasmValue &b)
+{
+  WasmValue sum = a;
+  switch (a.value_type)
+    {
+      case ArgType::I32: {
+        sum.lo = (uint32_t) (a.lo + b.lo);
+        break;
+      }
+      case ArgType::F32: {
+        float x, y;
+        auto ax = (uint32_t) a.lo;
+        auto by = (uint32_t) b.lo;
+        std::memcpy (&x, &ax, sizeof (x));
+        std::memcpy (&y, &by, sizeof (y));
+        x += y;
+        uint32_t bits;
+        std::memcpy (&bits, &x, sizeof (bits));
+        sum.lo = bits;
+        break;
+      }
+      case ArgType::F64: {
+        double x, y;
+        std::memcpy (&x, &a.lo, sizeof (x));
+        std::memcpy (&y, &b.lo, sizeof (y));
+        x += y;
+        std::memcpy (&sum.lo, &x, sizeof (x));
+        break;
+      }
+      case ArgType::V128: {
+        sum.lo = a.lo + b.lo;
+        sum.hi = a.hi + b.hi;
+        break;
+      }
+      default: {
+        sum.lo = a.lo + b.lo;
+        break;
+      }
+    }
+  return sum;
+}
+
+extern "C" {
+
+int32_t
+execute_module_typed (uint64_t runtime_id, const char *module_name, const char *function_name,
+                      const WasmValue *args, uintptr_t n_args, WasmValue *result)
+{
+  WasmFaasRuntimeDouble::nTypedCalls++;
+  WasmFaasRuntimeDouble::lastFunction = function_name;
+  WasmFaasRuntimeDouble::lastArgs.assign (args, args + n_args);
+
+  if (!is_module_registered (runtime_id, module_name) || n_args == 0)
+    {
+      return 1;
+    }
+  for (uintptr_t i = 1; i < n_args; i++)
+    {
+      if (args[i].value_type != args[0].value_type)
+        {
+          return 1;
+        }
+    }
+
+  if (strcmp (function_name, "sum") == 0)
+    {
+      *result = args[0];
+      for (uintptr_t i = 1; i < n_args; i++)
+        {
+          *result = AddValues (*result, args[i]);
+        }
+      return 0;
+    }
+  if (strcmp (function_name, "div") == 0 && n_args == 2)
+    {
+      *result = args[0];
+      switch (args[0].value_type)
+        {
+        case ArgType::I32:
+          if ((int32_t) args[1].lo == 0)
+            {
+              return 1;
+            }
+          result->lo = (uint32_t) ((int32_t) args[0].lo / (int32_t) args[1].lo);
+          return 0;
+        case ArgType::I64:
+          if ((int64_t) args[1].lo == 0)
+            {
+              return 1;
+            }
+          result->lo = (uint64_t) ((int64_t) args[0].lo / (int64_t) args[1].lo);
+          return 0;
+        default:
+          return 1;
+        }
+    }
+  return 1;
+}
+
+uint64_t
+compile_module (const char *module_data_base_64)
+{
+  WasmFaasRuntimeDouble::nCompiles++;
+  if (*module_data_base_64 == '\0')
+    {
+      return 0;
+    }
+  WasmFaasRuntimeDouble::compiled.push_back (module_data_base_64);
+  return WasmFaasRuntimeDouble::compiled.size ();
+}
+
+const char *
+register_compiled_module (uint64_t runtime_id, const char *module_name, uint64_t module_handle)
+{
+  NS_ABORT_MSG_IF (module_handle == 0 || module_handle > WasmFaasRuntimeDouble::compiled.size () ||
+                       WasmFaasRuntimeDouble::compiled[module_handle - 1].empty (),
+                   "Unknown compiled module " << module_handle);
+  return register_module (runtime_id, module_name,
+                          WasmFaasRuntimeDouble::compiled[module_handle - 1].c_str ());
+}
+
+void
+release_compiled_module (uint64_t module_handle)
+{
+  NS_ABORT_MSG_IF (module_handle == 0 || module_handle > WasmFaasRuntimeDouble::compiled.size () ||
+                       WasmFaasRuntimeDouble::compiled[module_handle - 1].empty (),
+                   "Unknown compiled module " << module_handle);
+  WasmFaasRuntimeDouble::nReleased++;
+  WasmFaasRuntimeDouble::compiled[module_handle - 1].clear ();
+}
+
+const char *
+get_runtime_version ()
+{
+  return "double-1";
+}
+
+uintptr_t
+serialize_compiled_module (uint64_t module_handle, uint8_t *buffer, uintptr_t size)
+{
+  if (module_handle == 0 || module_handle > WasmFaasRuntimeDouble::compiled.size ())
+    {
+      return 0;
+    }
+  auto artifact = g_artifactMagic + WasmFaasRuntimeDouble::compiled[module_handle - 1];
+  if (buffer != nullptr && size >= artifact.size ())
+    {
+      std::memcpy (buffer, artifact.data (), artifact.size ());
+    }
+  return artifact.size ();
+}
+
+uint64_t
+load_compiled_module (const uint8_t *artifact, uintptr_t size)
+{
+  auto magicSize = sizeof (g_artifactMagic) - 1;
+  if (size <= magicSize || std::memcmp (artifact, g_artifactMagic, magicSize) != 0)
+    {
+      return 0;
+    }
+  WasmFaasRuntimeDouble::nArtifactsLoaded++;
+  WasmFaasRuntimeDouble::compiled.emplace_back ((const char *) artifact + magicSize,
+                                                size - magicSize);
+  return WasmFaasRuntimeDouble::compiled.size ();
+}
+
+} // extern "C"
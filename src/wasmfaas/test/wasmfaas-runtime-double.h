@@ -0,0 +1,62 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef WASMFAAS_RUNTIME_DOUBLE_H
+#define WASMFAAS_RUNTIME_DOUBLE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "ns3/libwasmfaas-ext.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup customapp-test
+ *
+ * \brief Calls made to the optional runtime entry points defined by the test library.
+ *
+ * libwasmfaas-ext.h declares the optional entry points weak, so the definitions
+ * of the test library take their place in every test, whether the runtime
+ * has them or not.
+ *
+ * execute_module_typed runs the functions of the modules registered in
+ * the runtime by name: sum adds its arguments in the type of the first one,
+ * V128 values as two I64 lanes, and div divides its first argument by its
+ * second one. Any other function, or a division by zero, fails.
+ *
+ * compile_module keeps the module data, its handle being the position of
+ * the data in compiled plus one, and register_compiled_module registers the
+ * kept data with register_module. release_compiled_module empties the kept
+ * data, later uses of the handle abort. The artifact of a compiled module is
+ * the magic "WFDA" followed by its data, and get_runtime_version is
+ * "double-1".
+ */
+struct WasmFaasRuntimeDouble
+{
+  static uint32_t nTypedCalls; //!< Calls of execute_module_typed
+  static std::string lastFunction; //!< Function of the last execute_module_typed call
+  static std::vector<WasmValue> lastArgs; //!< Arguments of the last execute_module_typed call
+  static uint32_t nCompiles; //!< Calls of compile_module
+  static std::vector<std::string> compiled; //!< Data of the compiled modules, by handle - 1
+  static uint32_t nArtifactsLoaded; //!< Successful calls of load_compiled_module
+  static uint32_t nReleased; //!< Calls of release_compiled_module
+};
+
+} // namespace ns3
+
+#endif /* WASMFAAS_RUNTIME_DOUBLE_H */
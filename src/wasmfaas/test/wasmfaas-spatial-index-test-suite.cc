@@ -0,0 +1,165 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+
+#include "ns3/double.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/test.h"
+#include "ns3/wasmfaas-spatial-index.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check WasmFaasSpatialIndex::FindNearest against a brute-force search
+ */
+class WasmFaasSpatialIndexTestCase : public TestCase
+{
+public:
+  WasmFaasSpatialIndexTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Compare FindNearest with a brute-force search of the same points.
+   * \param index the index built from points
+   * \param points the indexed positions
+   * \param position where to search from
+   * \param k the number of points wanted
+   * \param maxDistance only points within it count, 0 for no limit
+   * \param skip index of a point to leave out
+   */
+  void CheckNearest (const WasmFaasSpatialIndex &index, const std::vector<Vector> &points,
+                     const Vector &position, uint32_t k, double maxDistance, uint32_t skip);
+};
+
+WasmFaasSpatialIndexTestCase::WasmFaasSpatialIndexTestCase ()
+  : TestCase ("FindNearest of WasmFaasSpatialIndex against a brute-force search")
+{
+}
+
+void
+WasmFaasSpatialIndexTestCase::CheckNearest (const WasmFaasSpatialIndex &index,
+                                            const std::vector<Vector> &points,
+                                            const Vector &position, uint32_t k,
+                                            double maxDistance, uint32_t skip)
+{
+  std::vector<double> expected;
+  for (uint32_t i = 0; i < points.size (); i++)
+    {
+      double distance = CalculateDistance (points[i], position);
+      if (i != skip && (maxDistance == 0 || distance <= maxDistance))
+        {
+          expected.push_back (distance);
+        }
+    }
+  std::sort (expected.begin (), expected.end ());
+  expected.resize (std::min<std::size_t> (k, expected.size ()));
+
+  // Points at equal distances may come in any order, their distances may not
+  auto nearest = index.FindNearest (position, k, maxDistance, skip);
+  NS_TEST_ASSERT_MSG_EQ (nearest.size (), expected.size (), "Wrong number of points");
+  for (uint32_t i = 0; i < nearest.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_NE (nearest[i], skip, "Skipped point returned");
+      NS_TEST_ASSERT_MSG_EQ_TOL (CalculateDistance (points[nearest[i]], position), expected[i],
+                                 1e-9, "Point " << i << " is not the next nearest");
+    }
+}
+
+void
+WasmFaasSpatialIndexTestCase::DoRun (void)
+{
+  WasmFaasSpatialIndex index;
+  NS_TEST_ASSERT_MSG_EQ (index.FindNearest (Vector (0, 0, 0), 3).size (), 0,
+                         "Point found in an empty index");
+
+  auto coordinate = CreateObject<UniformRandomVariable> ();
+  coordinate->SetAttribute ("Min", DoubleValue (0));
+  coordinate->SetAttribute ("Max", DoubleValue (1000));
+  coordinate->SetStream (1);
+
+  for (uint32_t n : {1u, 2u, 7u, 100u, 1000u})
+    {
+      // Planar points as a MobilityModel usually gives, then spatial ones
+      for (bool planar : {true, false})
+        {
+          std::vector<Vector> points;
+          for (uint32_t i = 0; i < n; i++)
+            {
+              points.push_back (Vector (coordinate->GetValue (), coordinate->GetValue (),
+                                        planar ? 0 : coordinate->GetValue ()));
+            }
+          index.Build (points);
+          NS_TEST_ASSERT_MSG_EQ (index.GetN (), n, "Wrong number of indexed points");
+
+          for (uint32_t q = 0; q < 20; q++)
+            {
+              Vector position (coordinate->GetValue (), coordinate->GetValue (),
+                               planar ? 0 : coordinate->GetValue ());
+              for (uint32_t k : {1u, 4u, 16u})
+                {
+                  CheckNearest (index, points, position, k, 0, WasmFaasSpatialIndex::NONE);
+                  CheckNearest (index, points, position, k, 150, WasmFaasSpatialIndex::NONE);
+                  CheckNearest (index, points, points[q % n], k, 0, q % n);
+                }
+            }
+        }
+    }
+
+  // Duplicates and ties on a grid
+  std::vector<Vector> grid;
+  for (uint32_t x = 0; x < 10; x++)
+    {
+      for (uint32_t y = 0; y < 10; y++)
+        {
+          grid.push_back (Vector (x, y, 0));
+          grid.push_back (Vector (x, y, 0));
+        }
+    }
+  index.Build (grid);
+  for (uint32_t k : {1u, 5u, 9u, 200u, 300u})
+    {
+      CheckNearest (index, grid, Vector (4, 4, 0), k, 0, WasmFaasSpatialIndex::NONE);
+      CheckNearest (index, grid, Vector (4.5, 4.5, 0), k, 1, WasmFaasSpatialIndex::NONE);
+      CheckNearest (index, grid, grid[88], k, 0, 88);
+    }
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * WasmFaasSpatialIndex test suite
+ */
+class WasmFaasSpatialIndexTestSuite : public TestSuite
+{
+public:
+  WasmFaasSpatialIndexTestSuite ();
+};
+
+WasmFaasSpatialIndexTestSuite::WasmFaasSpatialIndexTestSuite ()
+  : TestSuite ("wasmfaas-spatial-index", UNIT)
+{
+  AddTestCase (new WasmFaasSpatialIndexTestCase, TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static WasmFaasSpatialIndexTestSuite g_wasmFaasSpatialIndexTestSuite;
@@ -0,0 +1,267 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/wasmfaas-workflow.h"
+#include "ns3/wasmfaas-workflow-table.h"
+
+using namespace ns3;
+
+/**
+ * \return a workflow of three stages using every kind of argument, the first one run
+ */
+static WasmFaasWorkflow
+CreateWorkflow (void)
+{
+  WasmFaasValue v128;
+  v128.type = ArgType::V128;
+  v128.lo = 0x42;
+  v128.hi = 0x1122334455667788;
+
+  WasmFaasWorkflow workflow;
+  auto sum = workflow.AddStage (
+      "sum", "sum", {WasmFaasWorkflow::Binding::Value (WasmFaasValue::FromI32 (-3)),
+                     WasmFaasWorkflow::Binding::Value (WasmFaasValue::FromI64 (1ll << 40))});
+  auto div = workflow.AddStage (
+      "div", "div", {WasmFaasWorkflow::Binding::StageResult (sum),
+                     WasmFaasWorkflow::Binding::Value (WasmFaasValue::FromF64 (2.5))});
+  workflow.AddStage ("vec", "splat", {WasmFaasWorkflow::Binding::StageResult (div),
+                                      WasmFaasWorkflow::Binding::StageResult (sum),
+                                      WasmFaasWorkflow::Binding::Value (v128),
+                                      WasmFaasWorkflow::Binding::Value (
+                                          WasmFaasValue::FromF32 (0.5f))});
+  workflow.SetNextResult (WasmFaasValue::FromI64 (7));
+  return workflow;
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that a WasmFaasWorkflow survives Serialize and Deserialize
+ */
+class WasmFaasWorkflowRoundTripTestCase : public TestCase
+{
+public:
+  WasmFaasWorkflowRoundTripTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WasmFaasWorkflowRoundTripTestCase::WasmFaasWorkflowRoundTripTestCase ()
+  : TestCase ("Serialize and Deserialize a WasmFaasWorkflow")
+{
+}
+
+void
+WasmFaasWorkflowRoundTripTestCase::DoRun (void)
+{
+  auto workflow = CreateWorkflow ();
+  std::string data;
+  workflow.Serialize (data);
+
+  WasmFaasWorkflow copy;
+  NS_TEST_ASSERT_MSG_EQ (copy.Deserialize (data), true, "Workflow not deserialized");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetName (), "sum>div>vec", "Wrong stages");
+  NS_TEST_ASSERT_MSG_EQ (+copy.GetNextStage (), 1, "Results of the stages run lost");
+
+  for (uint8_t i = 0; i < workflow.GetNStages (); i++)
+    {
+      auto &stage = workflow.GetStage (i);
+      auto &copyStage = copy.GetStage (i);
+      NS_TEST_ASSERT_MSG_EQ (copyStage.funcName, stage.funcName, "Wrong function");
+      NS_TEST_ASSERT_MSG_EQ (copyStage.args.size (), stage.args.size (), "Wrong argument count");
+      for (uint32_t j = 0; j < stage.args.size (); j++)
+        {
+          auto &arg = stage.args[j];
+          auto &copyArg = copyStage.args[j];
+          NS_TEST_ASSERT_MSG_EQ (copyArg.isStageResult, arg.isStageResult, "Wrong binding");
+          if (arg.isStageResult)
+            {
+              NS_TEST_ASSERT_MSG_EQ (+copyArg.stage, +arg.stage, "Wrong bound stage");
+              continue;
+            }
+          NS_TEST_ASSERT_MSG_EQ ((int) copyArg.value.type, (int) arg.value.type, "Wrong type");
+          NS_TEST_ASSERT_MSG_EQ (copyArg.value.lo, arg.value.lo, "Wrong low bits");
+          NS_TEST_ASSERT_MSG_EQ (copyArg.value.hi, arg.value.hi, "Wrong high bits");
+        }
+    }
+
+  // The copy runs on from where the workflow stopped
+  auto args = copy.GetNextArgs ();
+  NS_TEST_ASSERT_MSG_EQ (args.size (), 2, "Wrong argument count");
+  NS_TEST_ASSERT_MSG_EQ (args[0].GetI64 (), 7, "Stage result not bound");
+  copy.SetNextResult (WasmFaasValue::FromF64 (2.8));
+  copy.SetNextResult (WasmFaasValue::FromI32 (1));
+  NS_TEST_ASSERT_MSG_EQ (copy.IsComplete (), true, "Workflow not complete");
+  NS_TEST_ASSERT_MSG_EQ (copy.GetResult ().GetI32 (), 1, "Wrong result");
+
+  std::string again;
+  copy.Serialize (again);
+  NS_TEST_ASSERT_MSG_EQ (workflow.Deserialize (again), true, "Complete workflow rejected");
+  NS_TEST_ASSERT_MSG_EQ (workflow.IsComplete (), true, "Complete workflow not complete");
+
+  WasmFaasWorkflow empty;
+  empty.Serialize (data);
+  NS_TEST_ASSERT_MSG_EQ (data.size (), 2, "Wrong empty wire form");
+  NS_TEST_ASSERT_MSG_EQ (copy.Deserialize (data), true, "Empty workflow rejected");
+  NS_TEST_ASSERT_MSG_EQ (+copy.GetNStages (), 0, "Stages left from before");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check that WasmFaasWorkflow::Deserialize rejects truncated and malformed input
+ */
+class WasmFaasWorkflowMalformedTestCase : public TestCase
+{
+public:
+  WasmFaasWorkflowMalformedTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WasmFaasWorkflowMalformedTestCase::WasmFaasWorkflowMalformedTestCase ()
+  : TestCase ("Deserialize rejects malformed WasmFaasWorkflows")
+{
+}
+
+void
+WasmFaasWorkflowMalformedTestCase::DoRun (void)
+{
+  std::string data;
+  CreateWorkflow ().Serialize (data);
+
+  WasmFaasWorkflow workflow;
+  for (std::size_t size = 0; size < data.size (); size++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (workflow.Deserialize (data.substr (0, size)), false,
+                             "Workflow truncated to " << size << " bytes accepted");
+      NS_TEST_ASSERT_MSG_EQ (+workflow.GetNStages (), 0, "Stages of a rejected workflow kept");
+    }
+  NS_TEST_ASSERT_MSG_EQ (workflow.Deserialize (data + '\0'), false, "Trailing byte accepted");
+
+  // Stage and result counts
+  auto bad = data;
+  bad[0] = WasmFaasWorkflow::MAX_STAGES + 1;
+  NS_TEST_ASSERT_MSG_EQ (workflow.Deserialize (bad), false, "Too many stages accepted");
+  bad = data;
+  bad[1] = 4;
+  NS_TEST_ASSERT_MSG_EQ (workflow.Deserialize (bad), false, "More results than stages accepted");
+
+  // First stage: module and function IDs, then the argument count at 10
+  bad = data;
+  bad[10] = WasmFaasHeader::MAX_ARGS + 1;
+  NS_TEST_ASSERT_MSG_EQ (workflow.Deserialize (bad), false, "Too many arguments accepted");
+
+  // The kind of its first argument at 11 is a value type, never a stage
+  bad = data;
+  bad[11] = 0;
+  NS_TEST_ASSERT_MSG_EQ (workflow.Deserialize (bad), false, "Stage bound to itself accepted");
+  bad[11] = WasmFaasWorkflow::MAX_STAGES + static_cast<uint8_t> (ArgType::V128) + 1;
+  NS_TEST_ASSERT_MSG_EQ (workflow.Deserialize (bad), false, "Unknown value type accepted");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * Check the hand-over encoding of WasmFaasWorkflowTable, and that the ack
+ * of a hand-over drops the workflow while a stage result finds it
+ */
+class WasmFaasWorkflowTableTestCase : public TestCase
+{
+public:
+  WasmFaasWorkflowTableTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+WasmFaasWorkflowTableTestCase::WasmFaasWorkflowTableTestCase ()
+  : TestCase ("Tasks and hand-overs of WasmFaasWorkflowTable")
+{
+}
+
+void
+WasmFaasWorkflowTableTestCase::DoRun (void)
+{
+  std::string payload;
+  auto origin = InetSocketAddress (Ipv4Address ("10.1.1.1"), 3000);
+  WasmFaasWorkflowTable::SerializeHandOver (0x0102030405060708ULL, origin, CreateWorkflow (),
+                                            payload);
+  uint64_t workflowId;
+  InetSocketAddress readOrigin (Ipv4Address::GetAny ());
+  WasmFaasWorkflow workflow;
+  NS_TEST_ASSERT_MSG_EQ (
+      WasmFaasWorkflowTable::DeserializeHandOver (payload, workflowId, readOrigin, workflow), true,
+      "Hand-over rejected");
+  NS_TEST_EXPECT_MSG_EQ (workflowId, 0x0102030405060708ULL, "Wrong workflow ID");
+  NS_TEST_EXPECT_MSG_EQ (readOrigin.GetIpv4 (), origin.GetIpv4 (), "Wrong origin address");
+  NS_TEST_EXPECT_MSG_EQ (readOrigin.GetPort (), 3000, "Wrong origin port");
+  NS_TEST_EXPECT_MSG_EQ (+workflow.GetNextStage (), 1, "Wrong workflow");
+  NS_TEST_EXPECT_MSG_EQ (
+      WasmFaasWorkflowTable::DeserializeHandOver (payload.substr (0, 13), workflowId, readOrigin,
+                                                  workflow),
+      false, "Truncated hand-over accepted");
+
+  WasmFaasWorkflowTable table;
+  table.Hold (1, workflow, origin, 0, 0);
+  table.SetTask (1, 10, false);
+  NS_TEST_EXPECT_MSG_EQ (table.AcknowledgeHandOver (10), false, "Stage acknowledged as hand-over");
+  NS_TEST_ASSERT_MSG_EQ (table.TakeTask (10, workflowId), true, "Stage result lost");
+  NS_TEST_EXPECT_MSG_EQ (workflowId, 1, "Stage result of another workflow");
+  NS_TEST_EXPECT_MSG_EQ (table.TakeTask (10, workflowId), false, "Stage result taken twice");
+
+  table.SetTask (1, 11, true, origin);
+  NS_TEST_EXPECT_MSG_EQ (table.Find (1)->isHandingOver, true, "Hand-over not recorded");
+  NS_TEST_EXPECT_MSG_EQ (table.AcknowledgeHandOver (12), false, "Unrelated ack accepted");
+  NS_TEST_EXPECT_MSG_EQ (table.AcknowledgeHandOver (11), true, "Hand-over ack ignored");
+  NS_TEST_EXPECT_MSG_EQ ((table.Find (1) == nullptr), true, "Workflow kept after its hand-over");
+
+  // A stage still running when its workflow is released finds no workflow
+  table.Hold (2, workflow, origin, 0, 0);
+  table.SetTask (2, 20, false);
+  table.Release (2);
+  NS_TEST_EXPECT_MSG_EQ ((table.Find (2) == nullptr), true, "Released workflow kept");
+  NS_TEST_EXPECT_MSG_EQ (table.TakeTask (20, workflowId), true, "Task of a released workflow lost");
+}
+
+/**
+ * \ingroup customapp-test
+ * \ingroup tests
+ *
+ * WasmFaasWorkflow test suite
+ */
+class WasmFaasWorkflowTestSuite : public TestSuite
+{
+public:
+  WasmFaasWorkflowTestSuite ();
+};
+
+WasmFaasWorkflowTestSuite::WasmFaasWorkflowTestSuite ()
+  : TestSuite ("wasmfaas-workflow", UNIT)
+{
+  AddTestCase (new WasmFaasWorkflowRoundTripTestCase, TestCase::QUICK);
+  AddTestCase (new WasmFaasWorkflowMalformedTestCase, TestCase::QUICK);
+  AddTestCase (new WasmFaasWorkflowTableTestCase, TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static WasmFaasWorkflowTestSuite g_wasmFaasWorkflowTestSuite;
@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+
+#include "ns3/core-module.h"
+#include "ns3/wasmfaas-event-log.h"
+#include "ns3/wasmfaas-header.h"
+
+// Turn a WasmFaasEventLog file into CSV, one line per record:
+//
+//   time_ns,node,event,request_id,module,bytes
+//
+// Module IDs are printed as hexadecimal unless their name is given with
+// --modules, e.g.
+//
+//   ./waf --run "wasmfaas-event-log-decode --input=wasmfaas-events.bin --modules=sum,div"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("WasmFaasEventLogDecode");
+
+int
+main (int argc, char *argv[])
+{
+  std::string input = "wasmfaas-events.bin";
+  std::string output = "";
+  std::string modules = "";
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("input", "Event log to decode", input);
+  cmd.AddValue ("output", "CSV file to write, standard output if empty", output);
+  cmd.AddValue ("modules", "',' separated module names to resolve module IDs", modules);
+  cmd.Parse (argc, argv);
+
+  std::unordered_map<uint32_t, std::string> moduleNames;
+  std::istringstream names (modules);
+  std::string name;
+  while (std::getline (names, name, ','))
+    {
+      if (!name.empty ())
+        {
+          moduleNames[WasmFaasHeader::GetNameId (name)] = name;
+        }
+    }
+
+  std::ifstream in (input, std::ios::binary);
+  if (!in.is_open ())
+    {
+      NS_FATAL_ERROR ("Cannot open event log " << input);
+    }
+  if (!WasmFaasEventLog::ReadFileHeader (in))
+    {
+      NS_FATAL_ERROR (input << " is not an event log of this version");
+    }
+
+  std::ofstream file;
+  if (!output.empty ())
+    {
+      file.open (output);
+      if (!file.is_open ())
+        {
+          NS_FATAL_ERROR ("Cannot open " << output);
+        }
+    }
+  std::ostream &os = output.empty () ? std::cout : file;
+
+  os << "time_ns,node,event,request_id,module,bytes\n";
+  WasmFaasEventLog::Record record;
+  while (WasmFaasEventLog::ReadRecord (in, record))
+    {
+      os << record.time << "," << record.node << ","
+         << WasmFaasEventLog::GetEventName (record.type) << "," << record.requestId << ",";
+      if (record.moduleId != 0)
+        {
+          auto it = moduleNames.find (record.moduleId);
+          if (it != moduleNames.end ())
+            {
+              os << it->second;
+            }
+          else
+            {
+              os << "0x" << std::hex << record.moduleId << std::dec;
+            }
+        }
+      os << "," << record.bytes << "\n";
+    }
+
+  return 0;
+}
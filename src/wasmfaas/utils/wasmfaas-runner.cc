@@ -0,0 +1,727 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/csma-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/custom-app.h"
+#include "ns3/custom-app-helper.h"
+#include "ns3/wasmfaas-client.h"
+#include "ns3/wasmfaas-client-helper.h"
+#include "ns3/wasmfaas-event-log.h"
+
+// Build and run a wasmfaas experiment described by a scenario file, e.g.
+//
+//   ./waf --run "wasmfaas-runner --scenario=src/wasmfaas/utils/wifi.scenario"
+//
+// Each line holds a directive and its arguments, '#' starts a comment.
+// Directives may come in any order, they are applied in the order below.
+//
+//   define <name> <value>
+//       Default of $name, overridden by --define="name=value;...". ${name}
+//       and $name are replaced by the value anywhere in the file.
+//   seed <seed> [run=<run>]
+//       RngSeedManager seed and run number.
+//   time [start=1s] [clients=2s] [stop=20s]
+//       When the CustomApps start, the clients start and the run stops.
+//   topology <type> [nodes=N] [dataRate=100Mbps] [delay=2ms] [loss=0]
+//            [spacing=10] [gridWidth=10]
+//       csma   nodes on one LAN
+//       chain  point-to-point line, node i linked to node i + 1
+//       star   point-to-point links from node 0 to every other node
+//       wifi   node 0 server, point-to-point to the access point node 1,
+//              nodes 2 and up Wi-Fi stations, set by stations=N
+//       Every node is placed on a grid of spacing meters, gridWidth nodes
+//       per row. loss is the packet error rate of every wired device.
+//   peers <mode> [k=4] [distance=0] [edges=..] [aps=..] [cloud=..]
+//       mesh, one-hop, nearest or hierarchy, see the Register methods of
+//       CustomAppHelper. The wifi hierarchy defaults to the stations, the
+//       access point and the server.
+//   app <nodes> <Attribute>=<value> ...
+//       CustomApp attributes of the nodes.
+//   object <nodes> <Attribute> <TypeId> [<Attribute>=<value> ...]
+//       Object attribute of the CustomApps, such as ModuleCachePolicy or
+//       ExecutionCostModel, a new object for each node.
+//   module <name> <nodes> [file=<path>]
+//       Register a module on the nodes, read as base64 from file, or one of
+//       the modules built in the runtime (sum, div) without it.
+//   client <nodes> <Attribute>=<value> ...
+//       A WasmFaasClient with these attributes on each of the nodes.
+//   events <file>
+//       WasmFaasEventLog shared by every CustomApp.
+//
+// <nodes> is "all" or a ',' separated list of node indices and ranges such
+// as 0,2-5,8-, the last one running to the last node. Every attribute
+// default can also be set on the command line, e.g.
+// --ns3::CustomApp::PeerSelection=LeastLoaded, so sweeps only change
+// arguments. The latency report of every node and the client counts are
+// printed at the end of the run.
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("WasmFaasRunner");
+
+namespace {
+
+/// Directive of the scenario file
+struct Directive
+{
+  uint32_t line; //!< Line of the scenario file
+  std::vector<std::string> words; //!< Directive name and positional arguments
+  std::vector<std::pair<std::string, std::string>> options; //!< key=value arguments, in order
+};
+
+std::string g_scenario; //!< Scenario file name, for error messages
+
+#define SCENARIO_ERROR(directive, msg)                                                            \
+  NS_FATAL_ERROR (g_scenario << ":" << (directive).line << ": " << msg)
+
+/**
+ * \param text a line of the scenario file
+ * \param vars the defined variables
+ * \param line the line number
+ * \return the line with every $name and ${name} replaced
+ */
+std::string
+Substitute (const std::string &text, const std::map<std::string, std::string> &vars,
+            uint32_t line)
+{
+  std::string out;
+  for (std::size_t i = 0; i < text.size (); i++)
+    {
+      if (text[i] != '$')
+        {
+          out += text[i];
+          continue;
+        }
+
+      std::string name;
+      if (i + 1 < text.size () && text[i + 1] == '{')
+        {
+          auto end = text.find ('}', i);
+          if (end == std::string::npos)
+            {
+              NS_FATAL_ERROR (g_scenario << ":" << line << ": unterminated ${");
+            }
+          name = text.substr (i + 2, end - i - 2);
+          i = end;
+        }
+      else
+        {
+          while (i + 1 < text.size () && (isalnum (text[i + 1]) || text[i + 1] == '_'))
+            {
+              name += text[++i];
+            }
+        }
+
+      auto var = vars.find (name);
+      if (var == vars.end ())
+        {
+          NS_FATAL_ERROR (g_scenario << ":" << line << ": undefined variable " << name);
+        }
+      out += var->second;
+    }
+  return out;
+}
+
+/**
+ * \param directive the directive
+ * \param key the option
+ * \param value returned when the option is missing
+ * \return the option value
+ */
+std::string
+GetOption (const Directive &directive, const std::string &key, const std::string &value)
+{
+  for (auto &option : directive.options)
+    {
+      if (option.first == key)
+        {
+          return option.second;
+        }
+    }
+  return value;
+}
+
+/**
+ * \param directive the directive holding the number
+ * \param what the number, for error messages
+ * \param text the number as written
+ * \param max the largest value accepted
+ * \return the unsigned decimal integer written in text
+ */
+uint64_t
+ParseUnsigned (const Directive &directive, const std::string &what, const std::string &text,
+               uint64_t max = std::numeric_limits<uint32_t>::max ())
+{
+  char *end = 0;
+  errno = 0;
+  uint64_t value = strtoull (text.c_str (), &end, 10);
+  // strtoull skips spaces and takes "-1" as its largest value
+  if (text.empty () || !isdigit (text[0]) || *end != '\0' || errno == ERANGE || value > max)
+    {
+      SCENARIO_ERROR (directive, "bad " << what << " " << text);
+    }
+  return value;
+}
+
+/**
+ * \param directive the directive holding the number
+ * \param what the number, for error messages
+ * \param text the number as written
+ * \param min the smallest value accepted
+ * \param max the largest value accepted
+ * \return the real number written in text
+ */
+double
+ParseDouble (const Directive &directive, const std::string &what, const std::string &text,
+             double min, double max)
+{
+  char *end = 0;
+  double value = strtod (text.c_str (), &end);
+  if (text.empty () || isspace (text[0]) || *end != '\0' || !std::isfinite (value) ||
+      value < min || value > max)
+    {
+      SCENARIO_ERROR (directive, "bad " << what << " " << text);
+    }
+  return value;
+}
+
+/**
+ * \param directive the directive holding the selector
+ * \param selector "all" or ',' separated indices and ranges
+ * \param all every node of the scenario
+ * \return the selected nodes
+ */
+NodeContainer
+SelectNodes (const Directive &directive, const std::string &selector, const NodeContainer &all)
+{
+  NodeContainer nodes;
+  if (selector == "all")
+    {
+      return all;
+    }
+
+  std::istringstream items (selector);
+  std::string item;
+  while (std::getline (items, item, ','))
+    {
+      auto dash = item.find ('-');
+      char *end = 0;
+      uint32_t first = strtoul (item.c_str (), &end, 10);
+      bool valid = end == item.c_str () + (dash == std::string::npos ? item.size () : dash);
+      uint32_t last = first;
+      if (dash + 1 == item.size ())
+        {
+          last = all.GetN () - 1;
+        }
+      else if (dash != std::string::npos)
+        {
+          last = strtoul (item.c_str () + dash + 1, &end, 10);
+          valid = valid && end == item.c_str () + item.size ();
+        }
+      if (!valid || item.empty () || last < first || last >= all.GetN ())
+        {
+          SCENARIO_ERROR (directive, "bad node selection " << item << " of " << all.GetN ()
+                                                           << " nodes");
+        }
+      for (uint32_t i = first; i <= last; i++)
+        {
+          nodes.Add (all.Get (i));
+        }
+    }
+  return nodes;
+}
+
+/**
+ * \param directive the directive giving the attributes
+ * \param object the object to configure
+ */
+void
+SetAttributes (const Directive &directive, Ptr<Object> object)
+{
+  for (auto &option : directive.options)
+    {
+      if (!object->SetAttributeFailSafe (option.first, StringValue (option.second)))
+        {
+          SCENARIO_ERROR (directive, "cannot set " << option.first << "=" << option.second << " on "
+                                                   << object->GetInstanceTypeId ().GetName ());
+        }
+    }
+}
+
+/**
+ * \param directive the topology directive
+ * \param devices wired devices to drop packets on
+ */
+void
+SetLoss (const Directive &directive, const NetDeviceContainer &devices)
+{
+  double loss = ParseDouble (directive, "loss", GetOption (directive, "loss", "0"), 0, 1);
+  if (loss <= 0)
+    {
+      return;
+    }
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      Ptr<RateErrorModel> em = CreateObject<RateErrorModel> ();
+      em->SetAttribute ("ErrorUnit", StringValue ("ERROR_UNIT_PACKET"));
+      em->SetAttribute ("ErrorRate", DoubleValue (loss));
+      devices.Get (i)->SetAttribute ("ReceiveErrorModel", PointerValue (em));
+    }
+}
+
+/**
+ * \brief Create the nodes, links, addresses and positions of the topology.
+ * \param directive the topology directive
+ * \param nodes filled with every node of the scenario
+ */
+void
+BuildTopology (const Directive &directive, NodeContainer &nodes)
+{
+  if (directive.words.size () < 2)
+    {
+      SCENARIO_ERROR (directive, "topology needs a type");
+    }
+  std::string type = directive.words[1];
+  uint32_t n = ParseUnsigned (directive, "node count", GetOption (directive, "nodes", "2"));
+  std::string dataRate = GetOption (directive, "dataRate", "100Mbps");
+  std::string delay = GetOption (directive, "delay", "2ms");
+
+  InternetStackHelper stack;
+  Ipv4AddressHelper address;
+  if (type == "csma")
+    {
+      nodes.Create (n);
+      stack.Install (nodes);
+
+      CsmaHelper csma;
+      csma.SetChannelAttribute ("DataRate", StringValue (dataRate));
+      csma.SetChannelAttribute ("Delay", StringValue (delay));
+      NetDeviceContainer devices = csma.Install (nodes);
+      SetLoss (directive, devices);
+      address.SetBase ("10.1.0.0", "255.255.0.0");
+      address.Assign (devices);
+    }
+  else if (type == "chain" || type == "star")
+    {
+      nodes.Create (n);
+      stack.Install (nodes);
+
+      PointToPointHelper pointToPoint;
+      pointToPoint.SetDeviceAttribute ("DataRate", StringValue (dataRate));
+      pointToPoint.SetChannelAttribute ("Delay", StringValue (delay));
+      address.SetBase ("10.0.0.0", "255.255.255.252");
+      for (uint32_t i = 1; i < n; i++)
+        {
+          NetDeviceContainer devices =
+              pointToPoint.Install (nodes.Get (type == "chain" ? i - 1 : 0), nodes.Get (i));
+          SetLoss (directive, devices);
+          address.Assign (devices);
+          address.NewNetwork ();
+        }
+    }
+  else if (type == "wifi")
+    {
+      uint32_t nStations =
+          ParseUnsigned (directive, "station count", GetOption (directive, "stations", "3"));
+      nodes.Create (2 + nStations);
+      stack.Install (nodes);
+
+      PointToPointHelper pointToPoint;
+      pointToPoint.SetDeviceAttribute ("DataRate", StringValue (dataRate));
+      pointToPoint.SetChannelAttribute ("Delay", StringValue (delay));
+      NetDeviceContainer p2pDevices = pointToPoint.Install (nodes.Get (0), nodes.Get (1));
+      SetLoss (directive, p2pDevices);
+
+      NodeContainer stations;
+      for (uint32_t i = 2; i < nodes.GetN (); i++)
+        {
+          stations.Add (nodes.Get (i));
+        }
+
+      YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+      YansWifiPhyHelper phy;
+      phy.SetChannel (channel.Create ());
+      WifiHelper wifi;
+      wifi.SetRemoteStationManager ("ns3::AarfWifiManager");
+      WifiMacHelper mac;
+      Ssid ssid = Ssid ("wasmfaas");
+      mac.SetType ("ns3::StaWifiMac", "Ssid", SsidValue (ssid), "ActiveProbing",
+                   BooleanValue (false));
+      NetDeviceContainer stationDevices = wifi.Install (phy, mac, stations);
+      mac.SetType ("ns3::ApWifiMac", "Ssid", SsidValue (ssid));
+      NetDeviceContainer apDevices = wifi.Install (phy, mac, nodes.Get (1));
+
+      address.SetBase ("10.1.1.0", "255.255.255.0");
+      address.Assign (p2pDevices);
+      address.SetBase ("10.1.2.0", "255.255.255.0");
+      address.Assign (stationDevices);
+      address.Assign (apDevices);
+    }
+  else
+    {
+      SCENARIO_ERROR (directive, "unknown topology " << type);
+    }
+
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator (
+      "ns3::GridPositionAllocator", "DeltaX", StringValue (GetOption (directive, "spacing", "10")),
+      "DeltaY", StringValue (GetOption (directive, "spacing", "10")), "GridWidth",
+      StringValue (GetOption (directive, "gridWidth", "10")), "LayoutType",
+      StringValue ("RowFirst"));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+}
+
+/**
+ * \brief Register the peers of every CustomApp.
+ * \param directive the peers directive
+ * \param topology the topology directive
+ * \param nodes every node of the scenario
+ */
+void
+RegisterPeers (const Directive &directive, const Directive &topology, const NodeContainer &nodes)
+{
+  if (directive.words.size () < 2)
+    {
+      SCENARIO_ERROR (directive, "peers needs a mode");
+    }
+  std::string mode = directive.words[1];
+  if (mode == "mesh")
+    {
+      CustomAppHelper::RegisterFullMesh (nodes);
+    }
+  else if (mode == "one-hop")
+    {
+      CustomAppHelper::RegisterOneHopPeers (nodes);
+    }
+  else if (mode == "nearest")
+    {
+      uint32_t k = ParseUnsigned (directive, "peer count", GetOption (directive, "k", "4"));
+      double distance = ParseDouble (directive, "distance", GetOption (directive, "distance", "0"),
+                                     0, std::numeric_limits<double>::max ());
+      CustomAppHelper::RegisterNearestPeers (nodes, k, distance);
+    }
+  else if (mode == "hierarchy")
+    {
+      bool isWifi = topology.words[1] == "wifi";
+      std::string edges = GetOption (directive, "edges", "");
+      if (edges.empty () && isWifi)
+        {
+          edges = "2-" + std::to_string (nodes.GetN () - 1);
+        }
+      std::string aps = GetOption (directive, "aps", isWifi ? "1" : "");
+      std::string cloud = GetOption (directive, "cloud", isWifi ? "0" : "");
+      if (edges.empty () || aps.empty ())
+        {
+          SCENARIO_ERROR (directive, "hierarchy needs edges= and aps= on a " << topology.words[1]
+                                                                             << " topology");
+        }
+      CustomAppHelper::RegisterHierarchy (
+          SelectNodes (directive, edges, nodes), SelectNodes (directive, aps, nodes),
+          cloud.empty () ? NodeContainer () : SelectNodes (directive, cloud, nodes));
+    }
+  else
+    {
+      SCENARIO_ERROR (directive, "unknown peers mode " << mode);
+    }
+}
+
+} // namespace
+
+int
+main (int argc, char *argv[])
+{
+  std::string defines = "";
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("scenario", "Scenario file to run", g_scenario);
+  cmd.AddValue ("define", "';' separated name=value variables of the scenario", defines);
+  cmd.Parse (argc, argv);
+
+  std::ifstream in (g_scenario);
+  if (!in.is_open ())
+    {
+      NS_FATAL_ERROR ("Cannot open scenario " << g_scenario);
+    }
+
+  std::map<std::string, std::string> vars;
+  std::map<std::string, std::string> overrides;
+  std::istringstream defineList (defines);
+  std::string define;
+  while (std::getline (defineList, define, ';'))
+    {
+      auto eq = define.find ('=');
+      if (eq != std::string::npos)
+        {
+          overrides[define.substr (0, eq)] = define.substr (eq + 1);
+        }
+    }
+  vars = overrides;
+
+  std::map<std::string, std::vector<Directive>> directives;
+  std::string text;
+  uint32_t line = 0;
+  while (std::getline (in, text))
+    {
+      line++;
+      text = text.substr (0, text.find ('#'));
+
+      Directive directive;
+      directive.line = line;
+      std::istringstream words (Substitute (text, vars, line));
+      std::string word;
+      if (!(words >> word))
+        {
+          continue;
+        }
+
+      // Variables apply to the lines after their definition
+      if (word == "define")
+        {
+          std::string name;
+          std::string value;
+          if (!(words >> name >> value))
+            {
+              SCENARIO_ERROR (directive, "define needs a name and a value");
+            }
+          if (!overrides.count (name))
+            {
+              vars[name] = value;
+            }
+          continue;
+        }
+
+      directive.words.push_back (word);
+      while (words >> word)
+        {
+          auto eq = word.find ('=');
+          if (eq != std::string::npos && eq > 0)
+            {
+              directive.options.push_back (
+                  std::make_pair (word.substr (0, eq), word.substr (eq + 1)));
+            }
+          else
+            {
+              directive.words.push_back (word);
+            }
+        }
+      directives[directive.words[0]].push_back (directive);
+    }
+
+  for (auto &entry : directives)
+    {
+      static const std::set<std::string> known = {"seed",   "time",   "topology", "peers", "app",
+                                                  "object", "module", "client",   "events"};
+      if (!known.count (entry.first))
+        {
+          SCENARIO_ERROR (entry.second.front (), "unknown directive " << entry.first);
+        }
+    }
+  if (directives["topology"].size () != 1)
+    {
+      NS_FATAL_ERROR (g_scenario << ": needs exactly one topology directive");
+    }
+
+  for (auto &directive : directives["seed"])
+    {
+      if (directive.words.size () > 1)
+        {
+          RngSeedManager::SetSeed (ParseUnsigned (directive, "seed", directive.words[1]));
+        }
+      RngSeedManager::SetRun (ParseUnsigned (directive, "run", GetOption (directive, "run", "1"),
+                                             std::numeric_limits<uint64_t>::max ()));
+    }
+
+  Time start = Seconds (1);
+  Time clientStart = Seconds (2);
+  Time stop = Seconds (20);
+  Time::SetResolution (Time::NS);
+  for (auto &directive : directives["time"])
+    {
+      start = Time (GetOption (directive, "start", "1s"));
+      clientStart = Time (GetOption (directive, "clients", "2s"));
+      stop = Time (GetOption (directive, "stop", "20s"));
+    }
+
+  auto &topology = directives["topology"].front ();
+  NodeContainer nodes;
+  BuildTopology (topology, nodes);
+
+  CustomAppHelper wasmFaasHelper (3000);
+  ApplicationContainer apps = wasmFaasHelper.Install (nodes);
+
+  for (auto &directive : directives["app"])
+    {
+      if (directive.words.size () < 2)
+        {
+          SCENARIO_ERROR (directive, "app needs nodes");
+        }
+      NodeContainer selected = SelectNodes (directive, directive.words[1], nodes);
+      for (uint32_t i = 0; i < selected.GetN (); i++)
+        {
+          SetAttributes (directive, CustomAppHelper::GetCustomApp (selected.Get (i)));
+        }
+    }
+
+  for (auto &directive : directives["object"])
+    {
+      if (directive.words.size () < 4)
+        {
+          SCENARIO_ERROR (directive, "object needs nodes, an attribute and a TypeId");
+        }
+      TypeId tid;
+      if (!TypeId::LookupByNameFailSafe (directive.words[3], &tid))
+        {
+          SCENARIO_ERROR (directive, "unknown TypeId " << directive.words[3]);
+        }
+      NodeContainer selected = SelectNodes (directive, directive.words[1], nodes);
+      for (uint32_t i = 0; i < selected.GetN (); i++)
+        {
+          ObjectFactory factory;
+          factory.SetTypeId (tid);
+          Ptr<Object> object = factory.Create ();
+          SetAttributes (directive, object);
+          if (!CustomAppHelper::GetCustomApp (selected.Get (i))
+                   ->SetAttributeFailSafe (directive.words[2], PointerValue (object)))
+            {
+              SCENARIO_ERROR (directive, "cannot set " << directive.words[2] << " to a "
+                                                       << directive.words[3]);
+            }
+        }
+    }
+
+  for (auto &directive : directives["events"])
+    {
+      if (directive.words.size () != 2)
+        {
+          SCENARIO_ERROR (directive, "events needs a file");
+        }
+      Ptr<WasmFaasEventLog> eventLog = CreateObject<WasmFaasEventLog> ();
+      eventLog->SetAttribute ("FileName", StringValue (directive.words[1]));
+      for (uint32_t i = 0; i < apps.GetN (); i++)
+        {
+          apps.Get (i)->SetAttribute ("EventLog", PointerValue (eventLog));
+        }
+    }
+
+  for (auto &directive : directives["peers"])
+    {
+      RegisterPeers (directive, topology, nodes);
+    }
+
+  for (auto &directive : directives["module"])
+    {
+      if (directive.words.size () != 3)
+        {
+          SCENARIO_ERROR (directive, "module needs a name and nodes");
+        }
+      std::string name = directive.words[1];
+      std::string data;
+      std::string file = GetOption (directive, "file", "");
+      if (!file.empty ())
+        {
+          std::ifstream moduleFile (file);
+          if (!moduleFile.is_open ())
+            {
+              SCENARIO_ERROR (directive, "cannot open " << file);
+            }
+          std::ostringstream base64;
+          base64 << moduleFile.rdbuf ();
+          for (char c : base64.str ())
+            {
+              if (!isspace (c))
+                {
+                  data += c;
+                }
+            }
+        }
+      else if (name == "sum" || name == "div")
+        {
+          data = get_static_module_data (name == "sum" ? StaticModuleList::WasmSum
+                                                       : StaticModuleList::WasmDiv);
+        }
+      else
+        {
+          SCENARIO_ERROR (directive, "module " << name << " is not built in and has no file=");
+        }
+
+      NodeContainer selected = SelectNodes (directive, directive.words[2], nodes);
+      for (uint32_t i = 0; i < selected.GetN (); i++)
+        {
+          CustomAppHelper::GetCustomApp (selected.Get (i))
+              ->RegisterWasmModule (const_cast<char *> (name.c_str ()),
+                                    const_cast<char *> (data.c_str ()));
+        }
+    }
+
+  ApplicationContainer clients;
+  for (auto &directive : directives["client"])
+    {
+      if (directive.words.size () != 2)
+        {
+          SCENARIO_ERROR (directive, "client needs nodes");
+        }
+      WasmFaasClientHelper clientHelper;
+      ApplicationContainer installed =
+          clientHelper.Install (SelectNodes (directive, directive.words[1], nodes));
+      for (uint32_t i = 0; i < installed.GetN (); i++)
+        {
+          SetAttributes (directive, installed.Get (i));
+        }
+      clients.Add (installed);
+    }
+
+  apps.Start (start);
+  apps.Stop (stop);
+  clients.Start (clientStart);
+  clients.Stop (stop);
+
+  Simulator::Stop (stop);
+  Simulator::Run ();
+
+  CustomAppHelper::PrintLatencyReport (apps, std::cout);
+  for (uint32_t i = 0; i < clients.GetN (); i++)
+    {
+      Ptr<WasmFaasClient> client = DynamicCast<WasmFaasClient> (clients.Get (i));
+      std::cout << "client " << client->GetNode ()->GetId () << " sent=" << client->GetSent ()
+                << " completed=" << client->GetCompleted () << " failed=" << client->GetFailed ()
+                << std::endl;
+    }
+
+  Simulator::Destroy ();
+  return 0;
+}